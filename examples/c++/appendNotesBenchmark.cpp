@@ -0,0 +1,97 @@
+/**
+ * @file    appendNotesBenchmark.cpp
+ * @brief   Times repeated appendNotes/appendTestAnnotation calls
+ * @author
+ */
+
+#include <tsb/TSBTypes.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+
+static double secondsSince(const chrono::steady_clock::time_point& start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
+int main(int argc,char** argv)
+{
+  // usage: appendNotesBenchmark [numComments] [appendsPerComment]
+
+  unsigned int numComments = (argc > 1) ? (unsigned int)atoi(argv[1]) : 10000;
+  unsigned int numAppends  = (argc > 2) ? (unsigned int)atoi(argv[2]) : 20;
+
+  TSBDocument document(1, 1);
+  for (unsigned int i = 0; i < numComments; ++i)
+  {
+    TSBComment *comment = document.createComment();
+    comment->setContributor("benchmark");
+    comment->setNumber(i);
+  }
+
+  // parse the fragments once so that only the append itself is timed
+
+  XMLNode* note = XMLNode::convertStringToXMLNode(
+    "<p xmlns=\"http://www.w3.org/1999/xhtml\">enriched</p>");
+
+  vector<XMLNode*> annotations;
+  for (unsigned int n = 0; n < numAppends; ++n)
+  {
+    ostringstream oss;
+    oss << "<tool" << n << ":data xmlns:tool" << n << "=\"http://tool" << n
+        << ".org\" value=\"" << n << "\"/>";
+    annotations.push_back(XMLNode::convertStringToXMLNode(oss.str()));
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (unsigned int i = 0; i < numComments; ++i)
+  {
+    TSBComment *comment = document.getComment(i);
+    for (unsigned int n = 0; n < numAppends; ++n)
+    {
+      comment->appendNotes(note);
+    }
+  }
+  double notesTime = secondsSince(start);
+
+  start = chrono::steady_clock::now();
+  for (unsigned int i = 0; i < numComments; ++i)
+  {
+    TSBComment *comment = document.getComment(i);
+    for (unsigned int n = 0; n < numAppends; ++n)
+    {
+      comment->appendTestAnnotation(annotations[n]);
+    }
+  }
+  double annotationTime = secondsSince(start);
+
+  start = chrono::steady_clock::now();
+  for (unsigned int i = 0; i < numComments; ++i)
+  {
+    document.getComment(i)->replaceTopLevelTestAnnotationElement(annotations[0]);
+  }
+  double replaceTime = secondsSince(start);
+
+  unsigned long total = (unsigned long)numComments * numAppends;
+
+  cout << numComments << " comments, " << numAppends << " appends each\n";
+  cout << "appendNotes:          " << notesTime << " s ("
+       << (notesTime * 1e6 / total) << " us per call)\n";
+  cout << "appendTestAnnotation: " << annotationTime << " s ("
+       << (annotationTime * 1e6 / total) << " us per call)\n";
+  cout << "replaceTopLevelTestAnnotationElement: " << replaceTime << " s ("
+       << (replaceTime * 1e6 / numComments) << " us per call)\n";
+
+  delete note;
+  for (unsigned int n = 0; n < numAppends; ++n)
+  {
+    delete annotations[n];
+  }
+
+  return 0;
+}
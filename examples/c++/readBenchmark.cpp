@@ -0,0 +1,81 @@
+/**
+ * @file    readBenchmark.cpp
+ * @brief   Times reading documents of increasing size
+ * @author
+ */
+
+#include <tsb/TSBTypes.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+
+/*
+ * Builds a document holding numComments comments.  The comments are split
+ * over blocks of blockSize, each block in its own top-level
+ * <listOfComments>, so that the document has many top-level children.
+ */
+static string createDocument(unsigned int numComments, unsigned int blockSize)
+{
+  ostringstream oss;
+  oss << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">";
+
+  for (unsigned int i = 0; i < numComments; ++i)
+  {
+    if (i % blockSize == 0)
+    {
+      if (i > 0) oss << "</listOfComments>";
+      oss << "<listOfComments>";
+    }
+    oss << "<comment contributor=\"reader\" number=\"" << i
+        << "\" point=\"p\"/>";
+  }
+  if (numComments > 0) oss << "</listOfComments>";
+
+  oss << "</tsb>\n";
+  return oss.str();
+}
+
+
+int main(int argc,char** argv)
+{
+  // usage: readBenchmark [maxComments] [commentsPerBlock]
+
+  unsigned int maxComments = (argc > 1) ? (unsigned int)atoi(argv[1]) : 160000;
+  unsigned int blockSize   = (argc > 2) ? (unsigned int)atoi(argv[2]) : 10;
+
+  if (blockSize == 0) blockSize = 1;
+
+  cout << "comments  seconds  us/comment\n";
+
+  // the time per comment should stay flat as the document grows
+  for (unsigned int n = maxComments / 16; n <= maxComments; n *= 2)
+  {
+    string xml = createDocument(n, blockSize);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    TSBDocument* document = readTSBFromString(xml.c_str());
+    double seconds =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (document->getNumComments() != n)
+    {
+      cerr << "expected " << n << " comments, read "
+           << document->getNumComments() << endl;
+      delete document;
+      return 1;
+    }
+
+    cout << n << "  " << seconds << "  " << (seconds * 1e6 / n) << "\n";
+
+    delete document;
+
+    if (n == 0) break;
+  }
+
+  return 0;
+}
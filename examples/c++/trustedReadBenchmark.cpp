@@ -0,0 +1,137 @@
+/**
+ * @file    trustedReadBenchmark.cpp
+ * @brief   Compares reading with and without TSBReader::setTrustedInput()
+ * @author
+ */
+
+#include <tsb/TSBTypes.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * The standard benchmark document: numComments comments, each with all of
+ * its attributes, a <notes> element and a <testAnnotation> element, as
+ * libTSB itself writes them.
+ */
+static string createDocument(unsigned int numComments)
+{
+  TSBDocument document(1, 1);
+
+  for (unsigned int i = 0; i < numComments; ++i)
+  {
+    TSBComment *comment = document.createComment();
+
+    ostringstream id;
+    id << "c" << i;
+    comment->setMetaId(id.str());
+    comment->setContributor("benchmark");
+    comment->setNumber(i + 0.5);
+    comment->setPoint("a point worth making");
+
+    comment->setNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">"
+                      "A note on this comment.</p>");
+
+    XMLNode* annotation = XMLNode::convertStringToXMLNode(
+      "<tool:data xmlns:tool=\"http://tool.org\" value=\"1\"/>");
+    comment->appendTestAnnotation(annotation);
+    delete annotation;
+  }
+
+  char* xml = writeTSBToString(&document);
+  string result(xml);
+  free(xml);
+
+  return result;
+}
+
+
+/*
+ * Returns the median of numRuns timed reads, in seconds.
+ */
+static double timeRead(const string& xml, bool trusted, bool lazy,
+                       int numRuns)
+{
+  vector<double> times;
+
+  for (int run = 0; run < numRuns; ++run)
+  {
+    TSBReader reader;
+    reader.setTrustedInput(trusted);
+    reader.setLazyParsing(lazy);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    TSBDocument* document = reader.readTSBFromString(xml);
+    double seconds =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (document->getNumErrors(LIBTSB_SEV_ERROR) > 0)
+    {
+      cerr << "unexpected errors reading the benchmark document: "
+           << document->getError(0)->getMessage() << endl;
+    }
+    delete document;
+
+    times.push_back(seconds);
+  }
+
+  sort(times.begin(), times.end());
+  size_t middle = times.size() / 2;
+
+  return (times.size() % 2 == 1) ? times[middle]
+                                 : (times[middle - 1] + times[middle]) / 2;
+}
+
+
+int main(int argc,char** argv)
+{
+  // usage: trustedReadBenchmark [numComments | file.xml] [numRuns]
+
+  string xml;
+
+  if (argc > 1 && atoi(argv[1]) == 0)
+  {
+    ifstream file(argv[1]);
+    if (!file)
+    {
+      cerr << "cannot open " << argv[1] << endl;
+      return 1;
+    }
+    ostringstream contents;
+    contents << file.rdbuf();
+    xml = contents.str();
+  }
+  else
+  {
+    xml = createDocument((argc > 1) ? (unsigned int)atoi(argv[1]) : 20000);
+  }
+
+  int numRuns = (argc > 2) ? atoi(argv[2]) : 11;
+  if (numRuns < 1) numRuns = 1;
+
+  double megabytes = xml.size() / (1024.0 * 1024.0);
+  cout << "document: " << megabytes << " MB, median of " << numRuns
+       << " runs\n";
+
+  const char* modes[] = { "default", "lazy", "trusted", "trusted+lazy" };
+  double baseline = 0;
+
+  for (int mode = 0; mode < 4; ++mode)
+  {
+    double seconds = timeRead(xml, mode >= 2, mode % 2 == 1, numRuns);
+    if (mode == 0) baseline = seconds;
+
+    cout << modes[mode] << ": " << seconds << " s, "
+         << (megabytes / seconds) << " MB/s, "
+         << (baseline / seconds) << "x\n";
+  }
+
+  return 0;
+}
@@ -84,6 +84,13 @@
 %include <std_basic_string.i>
 %include <std_string.i>
 
+/**
+ * Let readTSBFromBuffer() read a bytes, bytearray or memoryview object in
+ * place, without converting it to a string first.
+ */
+%include <pybuffer.i>
+%pybuffer_binary(const char* data, size_t length);
+
 #pragma SWIG nowarn=509
 %warnfilter(401) basic_ios<char>;
 
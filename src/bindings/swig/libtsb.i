@@ -147,6 +147,20 @@ LIBTSB_CPP_NAMESPACE_USE
 %ignore *::writeElements;
 %ignore *::setTSBDocument;
 %ignore *::setParentTSBObject;
+%ignore *::aboutToChange;
+%ignore TSBDocument::objectAboutToChange;
+%ignore TSBDocument::setLazyParsing;
+%ignore TSBDocument::getLazyParsing;
+%ignore TSBDocument::setTrustedInput;
+%ignore TSBDocument::getTrustedInput;
+%ignore TSBDocument::setCommentPool;
+%ignore TSBDocument::createPooledComment;
+%ignore TSBDocument::reset;
+%ignore TSBListOf::releaseItems;
+%ignore TSBListOf::readItem;
+%ignore TSBListOfComments::unindexComment;
+%ignore TSBListOfComments::indexComment;
+%ignore *::reinitialize;
 
 /**
  * Ignore internal implementation methods in MathML.h
@@ -230,13 +244,22 @@ LIBTSB_CPP_NAMESPACE_USE
 %typemap(newfree) char * "free($1);";
 
 %newobject *::clone;
+%newobject TSBDocument::cloneSnapshot;
 %newobject TSBBase::toTSB;
 %newobject TSBReader::readTSBFromString;
 %newobject TSBReader::readTSBFromFile;
 %newobject TSBReader::readTSB;
+%newobject TSBReader::readTSBFromBuffer;
+%newobject TSBReader::takeCompletedComment;
+%newobject TSBReader::finish;
 %newobject readTSB(const char *);
 %newobject readTSBFromString(const char *);
 %newobject readTSBFromFile(const char *);
+%newobject readTSBFromBuffer(const char *, size_t);
+%newobject TSBReader::readTSBBinary;
+%newobject TSBReader::readTSBBinaryFromBuffer;
+%newobject readTSBBinary(const char *);
+%newobject readTSBBinaryFromBuffer(const char *, size_t);
 %newobject TSBWriter::writeToString;
 %newobject writeTSBToString;
 %newobject readMathMLFromString;
@@ -312,6 +335,7 @@ LIBTSB_CPP_NAMESPACE_USE
  */
 
 %include "std_string.i"
+%include "stdint.i"
 %include "std_vector.i"
 %template(DoubleStdVector) std::vector<double>;
 typedef std::vector<double> DoubleStdVector;
@@ -319,6 +343,8 @@ typedef std::vector<double> DoubleStdVector;
 typedef std::vector<XMLError*> XmlErrorStdVector;
 %template(TSBErrorStdVector) std::vector<TSBError>;
 typedef std::vector<TSBError> TSBErrorStdVector;
+%template(TSBCommentStdVector) std::vector<TSBComment*>;
+typedef std::vector<TSBComment*> TSBCommentStdVector;
 
 %include tsb/common/libtsb-version.h
 %include tsb/common/TSBOperationReturnValues.h
@@ -343,7 +369,12 @@ typedef std::vector<TSBError> TSBErrorStdVector;
 
 
 
+/**
+ * TSBReader::recycleDocument() takes ownership of the document.
+ */
+%apply SWIGTYPE *DISOWN { TSBDocument* document };
 %include <tsb/TSBReader.h>
+%clear TSBDocument* document;
 %include <tsb/TSBWriter.h>
 %include <tsb/TSBTypeCodes.h>
 %include <tsb/TSBTypes.h>
@@ -358,4 +389,7 @@ typedef std::vector<TSBError> TSBErrorStdVector;
 
 %include <tsb/TSBComment.h>
 %include <tsb/TSBListOfComments.h>
+%include <tsb/TSBDocumentView.h>
+%include <tsb/TSBDocumentDiff.h>
+%include <tsb/TSBAllocationTrace.h>
 
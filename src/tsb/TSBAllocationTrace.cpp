@@ -0,0 +1,673 @@
+/**
+ * @file TSBAllocationTrace.cpp
+ * @brief Implementation of the TSBAllocationTrace class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+
+
+#include <tsb/TSBAllocationTrace.h>
+#include <tsb/common/TSBOperationReturnValues.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#elif defined(__GLIBC__) || defined(__APPLE__)
+#  include <execinfo.h>
+#  define TSB_HAVE_BACKTRACE
+#endif
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * The counts of a TSBAllocationCounts_t, in the order of its members.
+ */
+static const unsigned int numCountFields = 4;
+
+static const char* allocationTypeNames[TSB_ALLOCATION_NUM_TYPES] =
+  { "memory", "TSBComment", "TSBNamespaces", "XMLNode" };
+
+
+/*
+ * The counters of one thread.  Only the owning thread writes them, with a
+ * plain load and store, so counting needs no locked instruction; other
+ * threads read them to add them up.  The counters are zeroed by their
+ * owner when it finds that a reset has moved the generation on.
+ */
+struct ThreadAllocationCounts
+{
+  ThreadAllocationCounts();
+  ~ThreadAllocationCounts();
+
+  std::atomic<uint64_t> values[TSB_ALLOCATION_NUM_TYPES][numCountFields];
+  std::atomic<unsigned long> generation;
+  uint64_t bytesToSample;
+};
+
+
+/*
+ * The state shared by all threads.  It is never destroyed, so threads
+ * that exit after the end of main() can still fold their counts in.
+ */
+struct AllocationTraceState
+{
+  AllocationTraceState()
+    : generation (0)
+    , sampleInterval (0)
+    , maxSamples (1024)
+  {
+    memset(retired, 0, sizeof(retired));
+  }
+
+  std::mutex mutex;
+  std::vector<ThreadAllocationCounts*> threads;
+  uint64_t retired[TSB_ALLOCATION_NUM_TYPES][numCountFields];
+  std::atomic<unsigned long> generation;
+
+  std::atomic<uint64_t> sampleInterval;
+  std::mutex sampleMutex;
+  std::deque<TSBAllocationSample_t> samples;
+  unsigned int maxSamples;
+};
+
+
+static AllocationTraceState&
+getTraceState()
+{
+  static AllocationTraceState* state = new AllocationTraceState();
+  return *state;
+}
+
+
+/*
+ * Set once the counters of the thread are destroyed, so that allocations
+ * made by later thread-exit code are ignored rather than counted into a
+ * dead object.
+ */
+static thread_local bool threadCountsDestroyed = false;
+
+
+ThreadAllocationCounts::ThreadAllocationCounts()
+  : generation (0)
+  , bytesToSample (0)
+{
+  AllocationTraceState& state = getTraceState();
+
+  for (unsigned int t = 0; t < TSB_ALLOCATION_NUM_TYPES; ++t)
+  {
+    for (unsigned int f = 0; f < numCountFields; ++f)
+    {
+      values[t][f].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(state.mutex);
+  generation.store(state.generation.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+  state.threads.push_back(this);
+}
+
+
+ThreadAllocationCounts::~ThreadAllocationCounts()
+{
+  AllocationTraceState& state = getTraceState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+
+  if (generation.load(std::memory_order_relaxed) ==
+      state.generation.load(std::memory_order_relaxed))
+  {
+    for (unsigned int t = 0; t < TSB_ALLOCATION_NUM_TYPES; ++t)
+    {
+      for (unsigned int f = 0; f < numCountFields; ++f)
+      {
+        state.retired[t][f] += values[t][f].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  for (size_t n = 0; n < state.threads.size(); ++n)
+  {
+    if (state.threads[n] == this)
+    {
+      state.threads.erase(state.threads.begin() + n);
+      break;
+    }
+  }
+
+  threadCountsDestroyed = true;
+}
+
+
+/*
+ * Returns the counters of the calling thread, zeroed if a reset has
+ * happened since they were last used.
+ */
+static ThreadAllocationCounts&
+getThreadAllocationCounts()
+{
+  static thread_local ThreadAllocationCounts counts;
+
+  unsigned long generation =
+    getTraceState().generation.load(std::memory_order_relaxed);
+
+  if (counts.generation.load(std::memory_order_relaxed) != generation)
+  {
+    for (unsigned int t = 0; t < TSB_ALLOCATION_NUM_TYPES; ++t)
+    {
+      for (unsigned int f = 0; f < numCountFields; ++f)
+      {
+        counts.values[t][f].store(0, std::memory_order_relaxed);
+      }
+    }
+    counts.bytesToSample = 0;
+
+    // readers only add up counters whose generation is current, and the
+    // release makes sure they then see them zeroed
+    counts.generation.store(generation, std::memory_order_release);
+  }
+
+  return counts;
+}
+
+
+static void
+addToCount(std::atomic<uint64_t>& count, uint64_t value)
+{
+  count.store(count.load(std::memory_order_relaxed) + value,
+              std::memory_order_relaxed);
+}
+
+
+static TSBAllocationCounts_t
+makeCounts(const uint64_t values[numCountFields])
+{
+  TSBAllocationCounts_t counts;
+  counts.numAllocations = values[0];
+  counts.numFrees       = values[1];
+  counts.bytesAllocated = values[2];
+  counts.bytesFreed     = values[3];
+  return counts;
+}
+
+
+/*
+ * Adds the sample to those held, dropping the oldest if there are too
+ * many.
+ */
+static void
+storeSample(const TSBAllocationSample_t& sample)
+{
+  AllocationTraceState& state = getTraceState();
+  std::lock_guard<std::mutex> lock(state.sampleMutex);
+
+  if (state.maxSamples == 0)
+  {
+    return;
+  }
+
+  if (state.samples.size() >= state.maxSamples)
+  {
+    state.samples.pop_front();
+  }
+  state.samples.push_back(sample);
+}
+
+/** @endcond */
+
+
+std::atomic<bool> TSBAllocationTrace::sEnabled(false);
+
+
+/*
+ * Turns the tracing of allocations on or off.
+ */
+void
+TSBAllocationTrace::setEnabled(bool enabled)
+{
+  sEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+/*
+ * Sets the number of bytes between sampled allocations.
+ */
+void
+TSBAllocationTrace::setSampleInterval(uint64_t bytes)
+{
+  getTraceState().sampleInterval.store(bytes, std::memory_order_relaxed);
+}
+
+
+/*
+ * Returns the number of bytes between sampled allocations.
+ */
+uint64_t
+TSBAllocationTrace::getSampleInterval()
+{
+  return getTraceState().sampleInterval.load(std::memory_order_relaxed);
+}
+
+
+/*
+ * Sets the number of samples kept.
+ */
+void
+TSBAllocationTrace::setMaxSamples(unsigned int numSamples)
+{
+  AllocationTraceState& state = getTraceState();
+  std::lock_guard<std::mutex> lock(state.sampleMutex);
+
+  state.maxSamples = numSamples;
+  while (state.samples.size() > numSamples)
+  {
+    state.samples.pop_front();
+  }
+}
+
+
+/*
+ * Returns the number of samples kept.
+ */
+unsigned int
+TSBAllocationTrace::getMaxSamples()
+{
+  AllocationTraceState& state = getTraceState();
+  std::lock_guard<std::mutex> lock(state.sampleMutex);
+
+  return state.maxSamples;
+}
+
+
+/*
+ * Sets all counts back to zero and discards the samples.
+ */
+void
+TSBAllocationTrace::reset()
+{
+  AllocationTraceState& state = getTraceState();
+
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.generation.fetch_add(1, std::memory_order_relaxed);
+    memset(state.retired, 0, sizeof(state.retired));
+  }
+
+  std::lock_guard<std::mutex> lock(state.sampleMutex);
+  state.samples.clear();
+}
+
+
+/*
+ * Returns the allocations of the given type counted in all threads.
+ */
+TSBAllocationCounts_t
+TSBAllocationTrace::getCounts(TSBAllocationType_t type)
+{
+  uint64_t values[numCountFields] = { 0, 0, 0, 0 };
+
+  if (type >= 0 && type < TSB_ALLOCATION_NUM_TYPES)
+  {
+    AllocationTraceState& state = getTraceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    unsigned long generation =
+      state.generation.load(std::memory_order_relaxed);
+
+    for (unsigned int f = 0; f < numCountFields; ++f)
+    {
+      values[f] = state.retired[type][f];
+    }
+
+    for (size_t n = 0; n < state.threads.size(); ++n)
+    {
+      const ThreadAllocationCounts* counts = state.threads[n];
+      if (counts->generation.load(std::memory_order_acquire) != generation)
+      {
+        continue;
+      }
+
+      for (unsigned int f = 0; f < numCountFields; ++f)
+      {
+        values[f] += counts->values[type][f].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  return makeCounts(values);
+}
+
+
+/*
+ * Returns the allocations of the given type counted in the calling thread.
+ */
+TSBAllocationCounts_t
+TSBAllocationTrace::getThreadCounts(TSBAllocationType_t type)
+{
+  uint64_t values[numCountFields] = { 0, 0, 0, 0 };
+
+  if (type >= 0 && type < TSB_ALLOCATION_NUM_TYPES && !threadCountsDestroyed)
+  {
+    const ThreadAllocationCounts& counts = getThreadAllocationCounts();
+
+    for (unsigned int f = 0; f < numCountFields; ++f)
+    {
+      values[f] = counts.values[type][f].load(std::memory_order_relaxed);
+    }
+  }
+
+  return makeCounts(values);
+}
+
+
+/*
+ * Returns the number of samples held.
+ */
+unsigned int
+TSBAllocationTrace::getNumSamples()
+{
+  AllocationTraceState& state = getTraceState();
+  std::lock_guard<std::mutex> lock(state.sampleMutex);
+
+  return (unsigned int)state.samples.size();
+}
+
+
+/*
+ * Copies the nth sample, counting from the oldest one held.
+ */
+bool
+TSBAllocationTrace::getSample(unsigned int n, TSBAllocationSample_t& sample)
+{
+  AllocationTraceState& state = getTraceState();
+  std::lock_guard<std::mutex> lock(state.sampleMutex);
+
+  if (n >= state.samples.size())
+  {
+    return false;
+  }
+
+  sample = state.samples[n];
+  return true;
+}
+
+
+/*
+ * Writes the counts of every type of allocation to stream.
+ */
+void
+TSBAllocationTrace::printStatistics(std::ostream& stream)
+{
+  stream << "Allocation trace statistics:\n";
+
+  for (unsigned int t = 0; t < TSB_ALLOCATION_NUM_TYPES; ++t)
+  {
+    TSBAllocationCounts_t counts = getCounts((TSBAllocationType_t)t);
+
+    stream << "  " << allocationTypeNames[t] << ": "
+           << counts.numAllocations << " allocations ("
+           << counts.bytesAllocated << " bytes), "
+           << counts.numFrees << " frees ("
+           << counts.bytesFreed << " bytes)\n";
+  }
+}
+
+
+/*
+ * Writes the samples held, oldest first, to stream.
+ */
+void
+TSBAllocationTrace::printSamples(std::ostream& stream)
+{
+  std::deque<TSBAllocationSample_t> samples;
+  {
+    AllocationTraceState& state = getTraceState();
+    std::lock_guard<std::mutex> lock(state.sampleMutex);
+    samples = state.samples;
+  }
+
+  for (size_t n = 0; n < samples.size(); ++n)
+  {
+    const TSBAllocationSample_t& sample = samples[n];
+    stream << "Sample " << n << ": " << allocationTypeNames[sample.type]
+           << ", " << sample.size << " bytes\n";
+
+#ifdef TSB_HAVE_BACKTRACE
+    char** symbols = backtrace_symbols(sample.frames, (int)sample.numFrames);
+#endif
+
+    for (unsigned int f = 0; f < sample.numFrames; ++f)
+    {
+      stream << "  #" << f << " ";
+#ifdef TSB_HAVE_BACKTRACE
+      if (symbols != NULL)
+      {
+        stream << symbols[f] << "\n";
+        continue;
+      }
+#endif
+      stream << sample.frames[f] << "\n";
+    }
+
+#ifdef TSB_HAVE_BACKTRACE
+    free(symbols);
+#endif
+  }
+}
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Counts count allocations of type covering size bytes in all, sampling
+ * the call stack if the thread has allocated past the sample interval.
+ */
+void
+TSBAllocationTrace::countAllocation(TSBAllocationType_t type, size_t size,
+                                    size_t count)
+{
+  if (type < 0 || type >= TSB_ALLOCATION_NUM_TYPES || threadCountsDestroyed)
+  {
+    return;
+  }
+
+  ThreadAllocationCounts& counts = getThreadAllocationCounts();
+  addToCount(counts.values[type][0], count);
+  addToCount(counts.values[type][2], size);
+
+  uint64_t interval =
+    getTraceState().sampleInterval.load(std::memory_order_relaxed);
+  if (interval == 0)
+  {
+    return;
+  }
+
+  // the interval may have been lowered since the countdown started
+  if (counts.bytesToSample == 0 || counts.bytesToSample > interval)
+  {
+    counts.bytesToSample = interval;
+  }
+
+  if (size < counts.bytesToSample)
+  {
+    counts.bytesToSample -= size;
+    return;
+  }
+
+  counts.bytesToSample = interval - (size - counts.bytesToSample) % interval;
+
+  TSBAllocationSample_t sample;
+  sample.type = type;
+  sample.size = size;
+  sample.numFrames = 0;
+
+  // the stack is captured here, so only this frame is skipped
+#if defined(_WIN32)
+  sample.numFrames = CaptureStackBackTrace(1, TSB_ALLOCATION_MAX_FRAMES,
+                                           sample.frames, NULL);
+#elif defined(TSB_HAVE_BACKTRACE)
+  void* frames[TSB_ALLOCATION_MAX_FRAMES + 1];
+  int numFrames = backtrace(frames, TSB_ALLOCATION_MAX_FRAMES + 1);
+  if (numFrames > 1)
+  {
+    sample.numFrames = (unsigned int)numFrames - 1;
+    memcpy(sample.frames, frames + 1, sample.numFrames * sizeof(void*));
+  }
+#endif
+
+  storeSample(sample);
+}
+
+
+/*
+ * Counts a free of size bytes of type.
+ */
+void
+TSBAllocationTrace::countFree(TSBAllocationType_t type, size_t size)
+{
+  if (type < 0 || type >= TSB_ALLOCATION_NUM_TYPES || threadCountsDestroyed)
+  {
+    return;
+  }
+
+  ThreadAllocationCounts& counts = getThreadAllocationCounts();
+  addToCount(counts.values[type][1], 1);
+  addToCount(counts.values[type][3], size);
+}
+
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+/** @cond doxygenIgnored */
+
+
+LIBTSB_EXTERN
+void
+TSBAllocationTrace_setEnabled(int enabled)
+{
+  TSBAllocationTrace::setEnabled(enabled != 0);
+}
+
+
+LIBTSB_EXTERN
+int
+TSBAllocationTrace_isEnabled(void)
+{
+  return static_cast<int>(TSBAllocationTrace::isEnabled());
+}
+
+
+LIBTSB_EXTERN
+void
+TSBAllocationTrace_setSampleInterval(uint64_t bytes)
+{
+  TSBAllocationTrace::setSampleInterval(bytes);
+}
+
+
+LIBTSB_EXTERN
+void
+TSBAllocationTrace_reset(void)
+{
+  TSBAllocationTrace::reset();
+}
+
+
+LIBTSB_EXTERN
+TSBAllocationCounts_t
+TSBAllocationTrace_getCounts(TSBAllocationType_t type)
+{
+  return TSBAllocationTrace::getCounts(type);
+}
+
+
+LIBTSB_EXTERN
+TSBAllocationCounts_t
+TSBAllocationTrace_getThreadCounts(TSBAllocationType_t type)
+{
+  return TSBAllocationTrace::getThreadCounts(type);
+}
+
+
+LIBTSB_EXTERN
+unsigned int
+TSBAllocationTrace_getNumSamples(void)
+{
+  return TSBAllocationTrace::getNumSamples();
+}
+
+
+LIBTSB_EXTERN
+int
+TSBAllocationTrace_getSample(unsigned int n, TSBAllocationSample_t* sample)
+{
+  if (sample == NULL)
+  {
+    return LIBTSB_INVALID_OBJECT;
+  }
+
+  return TSBAllocationTrace::getSample(n, *sample)
+    ? LIBTSB_OPERATION_SUCCESS : LIBTSB_INDEX_EXCEEDS_SIZE;
+}
+
+
+LIBTSB_EXTERN
+void
+TSBAllocationTrace_recordAllocation(TSBAllocationType_t type, size_t size)
+{
+  TSBAllocationTrace::recordAllocation(type, size);
+}
+
+
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
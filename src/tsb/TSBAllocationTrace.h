@@ -0,0 +1,469 @@
+/**
+ * @file TSBAllocationTrace.h
+ * @brief Definition of the TSBAllocationTrace class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class TSBAllocationTrace
+ * @sbmlbrief{} Counts the memory allocated by libTSB, thread by thread.
+ *
+ * TSBAllocationTrace keeps, for each TSBAllocationType_t, the number of
+ * allocations and frees and the bytes they cover.  Tracing is off until
+ * setEnabled() turns it on; while it is off each instrumented allocation
+ * costs a single relaxed atomic load, so libTSB is always built with it.
+ *
+ * Every thread counts into counters of its own, without locking or atomic
+ * read-modify-write instructions, and getCounts() adds up the counters of
+ * all threads, including threads that have since finished.
+ * getThreadCounts() returns those of the calling thread alone.
+ *
+ * With setSampleInterval() a thread also records the call stack of the
+ * allocation that takes the bytes it has allocated past each multiple of
+ * the interval, so each sample stands for about that many bytes.  The
+ * most recent getMaxSamples() samples are kept.  Stacks are captured on
+ * platforms that provide backtrace() and on Windows; elsewhere samples
+ * have no frames.
+ *
+ * TSBComment and TSBNamespaces objects are counted when they are
+ * constructed and destroyed, wherever they live, at the size of the object
+ * itself.  XMLNode objects belong to libLX, which frees them unseen; the
+ * nodes of the notes and annotations that the reader builds, including
+ * those built on first use with TSBReader::setLazyParsing(), are counted
+ * as allocations only.  So are the blocks from safe_malloc() and
+ * safe_calloc(), which are released with a plain free().  safe_realloc()
+ * cannot tell the size of the block it resizes, so it only counts the
+ * blocks it allocates from a NULL pointer; resizing a block is not
+ * counted.
+ *
+ * This replaces the MemTrace functions of the @c TRACE_MEMORY build,
+ * which keep global lists that are not safe to use from several threads.
+ */
+
+
+#ifndef TSBAllocationTrace_H__
+#define TSBAllocationTrace_H__
+
+
+#include <tsb/common/extern.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+BEGIN_C_DECLS
+
+
+/**
+ * @enum  TSBAllocationType_t
+ * @brief The kinds of allocation that TSBAllocationTrace counts apart.
+ */
+typedef enum
+{
+    TSB_ALLOCATION_MEMORY = 0   /*!< safe_malloc(), safe_calloc(), safe_realloc(NULL) */
+  , TSB_ALLOCATION_COMMENT      /*!< TSBComment objects */
+  , TSB_ALLOCATION_NAMESPACES   /*!< TSBNamespaces objects */
+  , TSB_ALLOCATION_XMLNODE      /*!< XMLNode objects of notes and annotations */
+  , TSB_ALLOCATION_NUM_TYPES
+} TSBAllocationType_t;
+
+
+/**
+ * The allocations of one TSBAllocationType_t counted by
+ * TSBAllocationTrace.
+ */
+typedef struct
+{
+  uint64_t numAllocations;
+  uint64_t numFrees;
+  uint64_t bytesAllocated;
+  uint64_t bytesFreed;
+} TSBAllocationCounts_t;
+
+
+/**
+ * The largest number of stack frames kept for a sampled allocation.
+ */
+#define TSB_ALLOCATION_MAX_FRAMES 32
+
+
+#ifndef SWIG
+
+/**
+ * An allocation sampled by TSBAllocationTrace, with the return addresses
+ * of the call stack that made it, innermost first.
+ */
+typedef struct
+{
+  TSBAllocationType_t type;
+  uint64_t size;
+  unsigned int numFrames;
+  void* frames[TSB_ALLOCATION_MAX_FRAMES];
+} TSBAllocationSample_t;
+
+#endif /* !SWIG */
+
+
+END_C_DECLS
+LIBTSB_CPP_NAMESPACE_END
+
+
+#ifdef __cplusplus
+
+
+#include <atomic>
+#include <iostream>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+class LIBTSB_EXTERN TSBAllocationTrace
+{
+public:
+
+  /**
+   * Turns the tracing of allocations on or off.  Turning it off keeps the
+   * counts and samples taken so far.
+   *
+   * @param enabled @c true to count allocations from now on.
+   */
+  static void setEnabled(bool enabled);
+
+
+  /**
+   * Predicate returning @c true if allocations are being counted.
+   *
+   * @return @c true if tracing is on, @c false otherwise.
+   */
+  static bool isEnabled()
+  {
+    return sEnabled.load(std::memory_order_relaxed);
+  }
+
+
+  /**
+   * Sets the number of bytes between sampled allocations.
+   *
+   * @param bytes the number of bytes a thread allocates between two
+   * samples; @c 0 (the default) takes no samples, @c 1 samples every
+   * allocation.
+   */
+  static void setSampleInterval(uint64_t bytes);
+
+
+  /**
+   * Returns the number of bytes between sampled allocations.
+   *
+   * @return the sample interval, @c 0 if no samples are taken.
+   */
+  static uint64_t getSampleInterval();
+
+
+  /**
+   * Sets the number of samples kept; once there are that many, each new
+   * sample replaces the oldest.  Existing samples beyond the new number
+   * are discarded.
+   *
+   * @param numSamples the number of samples to keep (1024 by default).
+   */
+  static void setMaxSamples(unsigned int numSamples);
+
+
+  /**
+   * Returns the number of samples kept.
+   *
+   * @return the largest number of samples kept.
+   */
+  static unsigned int getMaxSamples();
+
+
+  /**
+   * Sets all counts back to zero and discards the samples.  Threads that
+   * are allocating at the time start over with their next allocation.
+   */
+  static void reset();
+
+
+  /**
+   * Returns the allocations of the given type counted in all threads since
+   * the last reset().
+   *
+   * @param type the TSBAllocationType_t of the allocations.
+   *
+   * @return the counts, all zero if @p type is not valid.
+   */
+  static TSBAllocationCounts_t getCounts(TSBAllocationType_t type);
+
+
+  /**
+   * Returns the allocations of the given type counted in the calling thread
+   * since the last reset().
+   *
+   * @param type the TSBAllocationType_t of the allocations.
+   *
+   * @return the counts, all zero if @p type is not valid.
+   */
+  static TSBAllocationCounts_t getThreadCounts(TSBAllocationType_t type);
+
+
+  /**
+   * Returns the number of samples held.
+   *
+   * @return the number of samples, at most getMaxSamples().
+   */
+  static unsigned int getNumSamples();
+
+
+#ifndef SWIG
+
+  /**
+   * Copies the nth sample, counting from the oldest one held.
+   *
+   * @param n the index of the sample.
+   * @param sample the TSBAllocationSample_t to copy it into.
+   *
+   * @return @c true if there was an nth sample, @c false otherwise.
+   */
+  static bool getSample(unsigned int n, TSBAllocationSample_t& sample);
+
+#endif /* !SWIG */
+
+
+  /**
+   * Writes the counts of every type of allocation to @p stream.
+   *
+   * @param stream the stream to write to.
+   */
+  static void printStatistics(std::ostream& stream = std::cerr);
+
+
+  /**
+   * Writes the samples held, oldest first, to @p stream with one line per
+   * stack frame.  Frames are given a symbol name where the platform can
+   * tell it.
+   *
+   * @param stream the stream to write to.
+   */
+  static void printSamples(std::ostream& stream = std::cerr);
+
+
+  /** @cond doxygenlibTSBInternal */
+
+  /*
+   * Counts count allocations of type covering size bytes in all, if
+   * tracing is on.
+   */
+  static void recordAllocation(TSBAllocationType_t type, size_t size,
+                               size_t count = 1)
+  {
+    if (isEnabled())
+    {
+      countAllocation(type, size, count);
+    }
+  }
+
+
+  /*
+   * Counts a free of size bytes of type, if tracing is on.
+   */
+  static void recordFree(TSBAllocationType_t type, size_t size)
+  {
+    if (isEnabled())
+    {
+      countFree(type, size);
+    }
+  }
+
+  /** @endcond */
+
+
+private:
+
+  /** @cond doxygenlibTSBInternal */
+
+  static void countAllocation(TSBAllocationType_t type, size_t size,
+                              size_t count);
+
+  static void countFree(TSBAllocationType_t type, size_t size);
+
+  static std::atomic<bool> sEnabled;
+
+  /** @endcond */
+};
+
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+
+
+#endif  /* __cplusplus */
+
+
+
+
+#ifndef SWIG
+
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+BEGIN_C_DECLS
+
+
+/**
+ * Turns the tracing of allocations on or off.
+ *
+ * @param enabled nonzero to count allocations from now on.
+ */
+LIBTSB_EXTERN
+void
+TSBAllocationTrace_setEnabled(int enabled);
+
+
+/**
+ * Predicate returning @c 1 (true) if allocations are being counted.
+ *
+ * @return @c 1 (true) if tracing is on, @c 0 (false) otherwise.
+ */
+LIBTSB_EXTERN
+int
+TSBAllocationTrace_isEnabled(void);
+
+
+/**
+ * Sets the number of bytes between sampled allocations.
+ *
+ * @param bytes the sample interval, @c 0 to take no samples.
+ */
+LIBTSB_EXTERN
+void
+TSBAllocationTrace_setSampleInterval(uint64_t bytes);
+
+
+/**
+ * Sets all counts back to zero and discards the samples.
+ */
+LIBTSB_EXTERN
+void
+TSBAllocationTrace_reset(void);
+
+
+/**
+ * Returns the allocations of the given type counted in all threads since
+ * the last reset.
+ *
+ * @param type the TSBAllocationType_t of the allocations.
+ *
+ * @return the counts, all zero if @p type is not valid.
+ */
+LIBTSB_EXTERN
+TSBAllocationCounts_t
+TSBAllocationTrace_getCounts(TSBAllocationType_t type);
+
+
+/**
+ * Returns the allocations of the given type counted in the calling thread
+ * since the last reset.
+ *
+ * @param type the TSBAllocationType_t of the allocations.
+ *
+ * @return the counts, all zero if @p type is not valid.
+ */
+LIBTSB_EXTERN
+TSBAllocationCounts_t
+TSBAllocationTrace_getThreadCounts(TSBAllocationType_t type);
+
+
+/**
+ * Returns the number of samples held.
+ *
+ * @return the number of samples.
+ */
+LIBTSB_EXTERN
+unsigned int
+TSBAllocationTrace_getNumSamples(void);
+
+
+/**
+ * Copies the nth sample, counting from the oldest one held.
+ *
+ * @param n the index of the sample.
+ * @param sample the TSBAllocationSample_t to copy it into.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INDEX_EXCEEDS_SIZE, OperationReturnValues_t}
+ */
+LIBTSB_EXTERN
+int
+TSBAllocationTrace_getSample(unsigned int n, TSBAllocationSample_t* sample);
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Counts an allocation of size bytes of type, if tracing is on; used by
+ * the C code of libTSB.
+ */
+LIBTSB_EXTERN
+void
+TSBAllocationTrace_recordAllocation(TSBAllocationType_t type, size_t size);
+
+/** @endcond */
+
+
+
+
+END_C_DECLS
+
+
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+
+
+#endif  /* !SWIG */
+
+
+
+
+#endif /* !TSBAllocationTrace_H__ */
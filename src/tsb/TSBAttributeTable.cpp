@@ -0,0 +1,162 @@
+/**
+ * @file TSBAttributeTable.cpp
+ * @brief Implementation of the attribute value conversions.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+
+
+#include <tsb/TSBAttributeTable.h>
+
+#include <cerrno>
+#include <climits>
+#include <clocale>
+#include <cstdlib>
+#include <limits>
+#include <locale>
+#include <sstream>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+#ifdef __cplusplus
+
+
+/** @cond doxygenlibTSBInternal */
+
+static std::string
+trimAttributeValue(const std::string& value)
+{
+  static const char* whitespace = " \t\r\n";
+
+  std::string::size_type start = value.find_first_not_of(whitespace);
+  if (start == std::string::npos)
+  {
+    return "";
+  }
+
+  std::string::size_type end = value.find_last_not_of(whitespace);
+  return value.substr(start, end - start + 1);
+}
+
+
+bool
+TSBAttribute_readDouble(const std::string& value, double& result)
+{
+  const std::string trimmed = trimAttributeValue(value);
+
+  if (trimmed.empty())
+  {
+    return false;
+  }
+  else if (trimmed == "INF")
+  {
+    result = std::numeric_limits<double>::infinity();
+    return true;
+  }
+  else if (trimmed == "-INF")
+  {
+    result = -std::numeric_limits<double>::infinity();
+    return true;
+  }
+  else if (trimmed == "NaN")
+  {
+    result = std::numeric_limits<double>::quiet_NaN();
+    return true;
+  }
+
+  // strtod follows the C locale of the process; values in XML always use
+  // '.', so fall back to a classic-locale stream if that differs
+  const struct lconv* conv = localeconv();
+  if (conv == NULL || conv->decimal_point == NULL ||
+      conv->decimal_point[0] != '.' || conv->decimal_point[1] != '\0')
+  {
+    std::istringstream stream(trimmed);
+    stream.imbue(std::locale::classic());
+
+    double converted;
+    stream >> converted;
+    if (stream.fail() || !stream.eof())
+    {
+      return false;
+    }
+
+    result = converted;
+    return true;
+  }
+
+  char* end = NULL;
+  errno = 0;
+  double converted = strtod(trimmed.c_str(), &end);
+
+  if (*end != '\0' || errno == ERANGE)
+  {
+    return false;
+  }
+
+  result = converted;
+  return true;
+}
+
+
+bool
+TSBAttribute_readUnsignedInt(const std::string& value, unsigned int& result)
+{
+  const std::string trimmed = trimAttributeValue(value);
+
+  if (trimmed.empty())
+  {
+    return false;
+  }
+
+  char* end = NULL;
+  errno = 0;
+  long converted = strtol(trimmed.c_str(), &end, 10);
+
+  if (*end != '\0' || errno == ERANGE || converted < 0 ||
+      (unsigned long)converted > UINT_MAX)
+  {
+    return false;
+  }
+
+  result = (unsigned int)converted;
+  return true;
+}
+
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+LIBTSB_CPP_NAMESPACE_END
@@ -0,0 +1,286 @@
+/**
+ * @file TSBAttributeTable.h
+ * @brief Definition of TSBAttributeSpec, the per-class attribute tables.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ *
+ * @class TSBAttributeSpec
+ * @sbmlbrief{} One row of the attribute table of a TSB class.
+ *
+ * Classes that read their XML attributes with
+ * TSBBase::readAttributeTable() describe them in a @c constexpr array of
+ * TSBAttributeSpec, one row per attribute, giving its name, its type,
+ * whether it is required, the errors to log for it and the data member it
+ * is stored in.  The attributes of an element are then visited once each:
+ * an attribute named in the table is converted and bound to its member
+ * directly, anything else is checked against the ExpectedAttributes of
+ * the object.
+ */
+
+
+#ifndef TSBAttributeTable_H__
+#define TSBAttributeTable_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+#include <tsb/TSBBase.h>
+
+
+#ifdef __cplusplus
+
+
+#include <string>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+/** @cond doxygenlibTSBInternal */
+#ifndef SWIG
+
+typedef enum
+{
+    TSB_ATTRIBUTE_STRING
+  , TSB_ATTRIBUTE_POOLED_STRING
+  , TSB_ATTRIBUTE_DOUBLE
+  , TSB_ATTRIBUTE_UINT
+} TSBAttributeType_t;
+
+
+template <class T>
+struct TSBAttributeSpec
+{
+  const char*         name;
+  TSBAttributeType_t  type;
+  bool                required;
+
+  /* logged when a required attribute is missing */
+  unsigned int        missingError;
+
+  /* logged when the value cannot be converted to the type */
+  unsigned int        invalidError;
+
+  /* the member the value is stored in; only the one matching type is set */
+  std::string T::*    stringValue;
+  double T::*         doubleValue;
+  unsigned int T::*   uintValue;
+
+  /* the flag recording whether a numeric value was read, if any */
+  bool T::*           isSetValue;
+
+  /* the member a value kept in the string pool of the document is stored
+   * in */
+  TSBPooledString T::* pooledValue;
+};
+
+
+/*
+ * Converts an attribute value the way XMLAttributes::readInto() does:
+ * surrounding whitespace is ignored, "INF", "-INF" and "NaN" are accepted
+ * for doubles, and the whole value must be consumed.
+ */
+LIBTSB_EXTERN
+bool
+TSBAttribute_readDouble(const std::string& value, double& result);
+
+
+LIBTSB_EXTERN
+bool
+TSBAttribute_readUnsignedInt(const std::string& value, unsigned int& result);
+
+
+/*
+ * The attributes are visited in document order.  The errors for the
+ * table's own attributes are logged after the loop, in table order, so
+ * that they do not depend on the order the attributes were written in.
+ */
+template <class T, unsigned int N>
+void
+TSBBase::readAttributeTable (const XMLAttributes& attributes,
+                             const ExpectedAttributes& expectedAttributes,
+                             const TSBAttributeSpec<T> (&table)[N],
+                             const std::string& element,
+                             unsigned int unknownError)
+{
+  static_assert(N <= 32, "an attribute table has at most 32 rows");
+
+  T& object = static_cast<T&>(*this);
+
+  const unsigned int level   = getLevel  ();
+  const unsigned int version = getVersion();
+  TSBErrorLog* log = getErrorLog();
+
+  const bool check = !skipReadChecks();
+
+  unsigned int found = 0;
+  unsigned int invalid = 0;
+  bool readMetaId = false;
+
+  for (int i = 0; i < attributes.getLength(); i++)
+  {
+    const std::string name = attributes.getName(i);
+
+    unsigned int n = 0;
+    while (n < N && ((found >> n & 1) || name != table[n].name))
+    {
+      ++n;
+    }
+
+    if (n < N)
+    {
+      const TSBAttributeSpec<T>& spec = table[n];
+      bool valid = true;
+
+      found |= 1u << n;
+
+      switch (spec.type)
+      {
+      case TSB_ATTRIBUTE_STRING:
+        object.*spec.stringValue = attributes.getValue(i);
+        break;
+      case TSB_ATTRIBUTE_POOLED_STRING:
+        object.*spec.pooledValue = internString(attributes.getValue(i));
+        break;
+      case TSB_ATTRIBUTE_DOUBLE:
+        valid = TSBAttribute_readDouble(attributes.getValue(i),
+                                        object.*spec.doubleValue);
+        break;
+      case TSB_ATTRIBUTE_UINT:
+        valid = TSBAttribute_readUnsignedInt(attributes.getValue(i),
+                                             object.*spec.uintValue);
+        break;
+      }
+
+      if (!valid)
+      {
+        invalid |= 1u << n;
+      }
+      continue;
+    }
+
+    if (!readMetaId && name == "metaid")
+    {
+      readMetaId = true;
+      mMetaId = attributes.getValue(i);
+      continue;
+    }
+
+    if (!check)
+    {
+      continue;
+    }
+
+    //
+    // To allow prefixed attribute whose namespace doesn't belong to
+    // core or extension package.
+    //
+    const std::string prefix = attributes.getPrefix(i);
+    if (!prefix.empty())
+    {
+      if ( expectedAttributes.hasAttribute(prefix, name) ) continue;
+    }
+
+    if (!expectedAttributes.hasAttribute(name))
+    {
+      logUnknownAttribute(name, level, version, getElementName(), prefix,
+                          unknownError);
+    }
+  }
+
+  if (check && readMetaId && mMetaId.empty())
+  {
+    logEmptyString("metaid", level, version,
+                   TSBTypeCode_toString(getTypeCode()));
+  }
+
+  for (unsigned int n = 0; n < N; n++)
+  {
+    const TSBAttributeSpec<T>& spec = table[n];
+    bool isFound = (found >> n & 1) != 0;
+    bool isValid = isFound && (invalid >> n & 1) == 0;
+
+    if (spec.isSetValue != NULL)
+    {
+      object.*spec.isSetValue = isValid;
+    }
+
+    if (isFound && spec.type == TSB_ATTRIBUTE_STRING)
+    {
+      if (check && (object.*spec.stringValue).empty())
+      {
+        logEmptyString(spec.name, level, version, element);
+      }
+    }
+    else if (isFound && spec.type == TSB_ATTRIBUTE_POOLED_STRING)
+    {
+      // the pool stores an empty value as NULL
+      if (check && object.*spec.pooledValue == NULL)
+      {
+        logEmptyString(spec.name, level, version, element);
+      }
+    }
+    else if (isFound && !isValid)
+    {
+      if (log)
+      {
+        std::string message = std::string("Tsb attribute '") + spec.name +
+          "' from the " + element + " element must be " +
+          (spec.type == TSB_ATTRIBUTE_DOUBLE ? "a double." : "an integer.");
+        log->logError(spec.invalidError, level, version, message,
+          getLine(), getColumn());
+      }
+    }
+    else if (!isFound && spec.required)
+    {
+      if (log)
+      {
+        std::string message = std::string("Tsb attribute '") + spec.name +
+          "' is missing from the " + element + " element.";
+        log->logError(spec.missingError, level, version, message,
+          getLine(), getColumn());
+      }
+    }
+  }
+}
+
+
+#endif /* !SWIG */
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+
+
+#endif /* !TSBAttributeTable_H__ */
@@ -51,6 +51,10 @@
 #include <tsb/TSBDocument.h>
 #include <tsb/TSBListOf.h>
 #include <tsb/TSBBase.h>
+#include <tsb/util/XMLTokenBuffer.h>
+#include <tsb/TSBWriteContext.h>
+#include <tsb/TSBContentHasher.h>
+#include <tsb/TSBAllocationTrace.h>
 
 
 /** @cond doxygenIgnored */
@@ -61,6 +65,41 @@ LIBTSB_CPP_NAMESPACE_BEGIN
 
 #ifdef __cplusplus
 
+/** @cond doxygenLibtsbInternal */
+/*
+ * Returns the number of nodes in the tree rooted at node.
+ */
+static size_t
+countXMLNodes(const XMLNode& node)
+{
+  size_t count = 1;
+  for (unsigned int n = 0; n < node.getNumChildren(); ++n)
+  {
+    count += countXMLNodes(node.getChild(n));
+  }
+  return count;
+}
+
+
+/*
+ * Counts the nodes of a notes or annotation tree built by the reader with
+ * TSBAllocationTrace, at the size of an XMLNode each.
+ */
+static void
+recordXMLNodeAllocation(const XMLNode* node)
+{
+  if (node == NULL || !TSBAllocationTrace::isEnabled())
+  {
+    return;
+  }
+
+  size_t numNodes = countXMLNodes(*node);
+  TSBAllocationTrace::recordAllocation(TSB_ALLOCATION_XMLNODE,
+                                       numNodes * sizeof(XMLNode), numNodes);
+}
+/** @endcond */
+
+
 TSBBase*
 TSBBase::getElementBySId(const std::string& id)
 {
@@ -112,15 +151,20 @@ TSBBase::TSBBase (unsigned int level, unsigned int version)
  , mId ("")
  , mNotes(NULL)
  , mTestAnnotation( NULL )
+ , mDeferredNotes( NULL )
+ , mDeferredTestAnnotation( NULL )
  , mTSB      ( NULL )
  , mTSBNamespaces (NULL)
  , mUserData(NULL)
  , mLine      ( 0 )
  , mColumn    ( 0 )
  , mParentTSBObject (NULL)
-  , mHasBeenDeleted(false)
   , mEmptyString("")
  , mURI("")
+ , mContentHash(0)
+ , mIsSetContentHash(false)
+ , mContentHashCounted(false)
+ , mContentHashIndex(0)
 {
   mTSBNamespaces = new TSBNamespaces(level, version);
 
@@ -143,15 +187,20 @@ TSBBase::TSBBase (TSBNamespaces *tsbns)
  , mId("")
  , mNotes(NULL)
  , mTestAnnotation( NULL )
+ , mDeferredNotes( NULL )
+ , mDeferredTestAnnotation( NULL )
  , mTSB      ( NULL )
  , mTSBNamespaces (NULL)
  , mUserData(NULL)
  , mLine      ( 0 )
  , mColumn    ( 0 )
  , mParentTSBObject (NULL)
-  , mHasBeenDeleted(false)
   , mEmptyString("")
  , mURI("")
+ , mContentHash(0)
+ , mIsSetContentHash(false)
+ , mContentHashCounted(false)
+ , mContentHashIndex(0)
 {
   if (!tsbns)
   {
@@ -162,6 +211,39 @@ TSBBase::TSBBase (TSBNamespaces *tsbns)
 
   setElementNamespace(static_cast<TSBNamespaces>(*mTSBNamespaces).getURI());
 }
+
+
+/*
+ * Creates a new TSBBase object that is about to be added to parent,
+ * sharing the TSBNamespaces of the document of parent.
+ */
+TSBBase::TSBBase (const TSBBase* parent)
+ : mMetaId("")
+ , mId("")
+ , mNotes(NULL)
+ , mTestAnnotation( NULL )
+ , mDeferredNotes( NULL )
+ , mDeferredTestAnnotation( NULL )
+ , mTSB      ( parent->mTSB )
+ , mTSBNamespaces (NULL)
+ , mUserData(NULL)
+ , mLine      ( 0 )
+ , mColumn    ( 0 )
+ , mParentTSBObject (NULL)
+  , mEmptyString("")
+ , mURI("")
+ , mContentHash(0)
+ , mIsSetContentHash(false)
+ , mContentHashCounted(false)
+ , mContentHashIndex(0)
+{
+  if (mTSB == NULL)
+  {
+    mTSBNamespaces = parent->getTSBNamespaces()->clone();
+  }
+
+  setElementNamespace(getTSBNamespaces()->getURI());
+}
 /** @endcond */
 
 
@@ -174,6 +256,8 @@ TSBBase::TSBBase(const TSBBase& orig)
   , mId (orig.mId)
   , mNotes (NULL)
   , mTestAnnotation (NULL)
+  , mDeferredNotes (NULL)
+  , mDeferredTestAnnotation (NULL)
   , mTSB (NULL)
   , mTSBNamespaces(NULL)
   , mUserData(orig.mUserData)
@@ -181,9 +265,13 @@ TSBBase::TSBBase(const TSBBase& orig)
   , mColumn(orig.mColumn)
   , mParentTSBObject(NULL)
   , mURI(orig.mURI)
+  , mContentHash(0)
+  , mIsSetContentHash(false)
+  , mContentHashCounted(false)
+  , mContentHashIndex(0)
 {
   if(orig.mNotes != NULL)
-    this->mNotes = new  XMLNode(*const_cast<TSBBase&>(orig).getNotes());
+    this->mNotes = new  XMLNode(*orig.getNotes());
   else
     this->mNotes = NULL;
 
@@ -192,13 +280,58 @@ TSBBase::TSBBase(const TSBBase& orig)
   else
     this->mTestAnnotation = NULL;
 
+  if(orig.mDeferredNotes != NULL)
+    this->mDeferredNotes = new XMLTokenBuffer(*orig.mDeferredNotes);
+
+  if(orig.mDeferredTestAnnotation != NULL)
+    this->mDeferredTestAnnotation =
+      new XMLTokenBuffer(*orig.mDeferredTestAnnotation);
+
   if(orig.getTSBNamespaces() != NULL)
     this->mTSBNamespaces =
     new TSBNamespaces(*const_cast<TSBBase&>(orig).getTSBNamespaces());
   else
     this->mTSBNamespaces = NULL;
+}
+/** @endcond */
+
 
-  this->mHasBeenDeleted = false;
+/** @cond doxygenLibtsbInternal */
+/*
+ * Move constructor.
+ */
+TSBBase::TSBBase(TSBBase&& orig) noexcept
+  : mMetaId (std::move(orig.mMetaId))
+  , mId (std::move(orig.mId))
+  , mNotes (orig.mNotes)
+  , mTestAnnotation (orig.mTestAnnotation)
+  , mDeferredNotes (orig.mDeferredNotes)
+  , mDeferredTestAnnotation (orig.mDeferredTestAnnotation)
+  , mTSB (NULL)
+  , mTSBNamespaces(orig.mTSBNamespaces)
+  , mUserData(orig.mUserData)
+  , mLine(orig.mLine)
+  , mColumn(orig.mColumn)
+  , mParentTSBObject(NULL)
+  , mURI(std::move(orig.mURI))
+  , mContentHash(0)
+  , mIsSetContentHash(false)
+  , mContentHashCounted(false)
+  , mContentHashIndex(0)
+{
+  orig.invalidateContentHash();
+
+  orig.mNotes = NULL;
+  orig.mTestAnnotation = NULL;
+  orig.mDeferredNotes = NULL;
+  orig.mDeferredTestAnnotation = NULL;
+  orig.mTSBNamespaces = NULL;
+
+  // the new object is not connected to the document orig was in
+  if (mTSBNamespaces == NULL && orig.mTSB != NULL && orig.mTSB != &orig)
+  {
+    mTSBNamespaces = orig.mTSB->getTSBNamespaces()->clone();
+  }
 }
 /** @endcond */
 
@@ -210,6 +343,8 @@ TSBBase::~TSBBase ()
 {
   if (mNotes != NULL)       delete mNotes;
   if (mTestAnnotation != NULL)  delete mTestAnnotation;
+  delete mDeferredNotes;
+  delete mDeferredTestAnnotation;
   if (mTSBNamespaces != NULL)  delete mTSBNamespaces;
 }
 
@@ -220,13 +355,15 @@ TSBBase& TSBBase::operator=(const TSBBase& rhs)
 {
   if(&rhs!=this)
   {
+    aboutToChange();
+
     this->mMetaId = rhs.mMetaId;
     this->mId = rhs.mId;
 
     delete this->mNotes;
 
     if(rhs.mNotes != NULL)
-      this->mNotes = new  XMLNode(*const_cast<TSBBase&>(rhs).getNotes());
+      this->mNotes = new  XMLNode(*rhs.getNotes());
     else
       this->mNotes = NULL;
 
@@ -237,20 +374,34 @@ TSBBase& TSBBase::operator=(const TSBBase& rhs)
     else
       this->mTestAnnotation = NULL;
 
-    this->mTSB       = rhs.mTSB;
+    delete this->mDeferredNotes;
+
+    if(rhs.mDeferredNotes != NULL)
+      this->mDeferredNotes = new XMLTokenBuffer(*rhs.mDeferredNotes);
+    else
+      this->mDeferredNotes = NULL;
+
+    delete this->mDeferredTestAnnotation;
+
+    if(rhs.mDeferredTestAnnotation != NULL)
+      this->mDeferredTestAnnotation =
+        new XMLTokenBuffer(*rhs.mDeferredTestAnnotation);
+    else
+      this->mDeferredTestAnnotation = NULL;
+
+    // this object stays where it is: it keeps its own parent and document
     this->mLine       = rhs.mLine;
     this->mColumn     = rhs.mColumn;
-    this->mParentTSBObject = rhs.mParentTSBObject;
     this->mUserData   = rhs.mUserData;
 
-    delete this->mTSBNamespaces;
-
-    if(rhs.mTSBNamespaces != NULL)
+    // an object owned by another document uses the namespaces of that
+    // document
+    if (!isOwnedByOtherDocument())
+    {
+      delete this->mTSBNamespaces;
       this->mTSBNamespaces =
-      new TSBNamespaces(*const_cast<TSBBase&>(rhs).mTSBNamespaces);
-    else
-      this->mTSBNamespaces = NULL;
-
+        new TSBNamespaces(*const_cast<TSBBase&>(rhs).getTSBNamespaces());
+    }
 
     this->mURI = rhs.mURI;
   }
@@ -259,6 +410,63 @@ TSBBase& TSBBase::operator=(const TSBBase& rhs)
 }
 
 
+/*
+ * Move assignment operator
+ */
+TSBBase& TSBBase::operator=(TSBBase&& rhs) noexcept
+{
+  if(&rhs!=this)
+  {
+    aboutToChange();
+    rhs.aboutToChange();
+
+    this->mMetaId = std::move(rhs.mMetaId);
+    this->mId = std::move(rhs.mId);
+
+    delete this->mNotes;
+    this->mNotes = rhs.mNotes;
+    rhs.mNotes = NULL;
+
+    delete this->mTestAnnotation;
+    this->mTestAnnotation = rhs.mTestAnnotation;
+    rhs.mTestAnnotation = NULL;
+
+    delete this->mDeferredNotes;
+    this->mDeferredNotes = rhs.mDeferredNotes;
+    rhs.mDeferredNotes = NULL;
+
+    delete this->mDeferredTestAnnotation;
+    this->mDeferredTestAnnotation = rhs.mDeferredTestAnnotation;
+    rhs.mDeferredTestAnnotation = NULL;
+
+    // this object stays where it is: it keeps its own parent and document
+    this->mLine       = rhs.mLine;
+    this->mColumn     = rhs.mColumn;
+    this->mUserData   = rhs.mUserData;
+
+    // an object owned by another document uses the namespaces of that
+    // document
+    if (!isOwnedByOtherDocument())
+    {
+      delete this->mTSBNamespaces;
+      if (rhs.isOwnedByOtherDocument())
+      {
+        this->mTSBNamespaces = rhs.getTSBNamespaces()->clone();
+      }
+      else
+      {
+        this->mTSBNamespaces = rhs.mTSBNamespaces;
+        rhs.mTSBNamespaces = NULL;
+      }
+    }
+
+    this->mURI = std::move(rhs.mURI);
+  }
+
+  return *this;
+}
+
+
 /*
  * @return the metaid of this TSB object.
  */
@@ -292,6 +500,9 @@ TSBBase::getId() const
  XMLNode*
 TSBBase::getNotes()
 {
+  // the notes may be modified through the node returned
+  aboutToChange();
+  parseDeferredNotes();
   return mNotes;
 }
 
@@ -299,6 +510,7 @@ TSBBase::getNotes()
 const  XMLNode*
 TSBBase::getNotes() const
 {
+  parseDeferredNotes();
   return mNotes;
 }
 
@@ -309,14 +521,15 @@ TSBBase::getNotes() const
 std::string
 TSBBase::getNotesString()
 {
-  return  XMLNode::convertXMLNodeToString(mNotes);
+  return  XMLNode::convertXMLNodeToString(
+                                   static_cast<const TSBBase*>(this)->getNotes());
 }
 
 
 std::string
 TSBBase::getNotesString() const
 {
-  return  XMLNode::convertXMLNodeToString(mNotes);
+  return  XMLNode::convertXMLNodeToString(getNotes());
 }
 
 
@@ -326,6 +539,9 @@ TSBBase::getNotesString() const
  XMLNode*
 TSBBase::getTestAnnotation ()
 {
+  // the annotation may be modified through the node returned
+  aboutToChange();
+  parseDeferredTestAnnotation();
   return mTestAnnotation;
 }
 
@@ -333,7 +549,8 @@ TSBBase::getTestAnnotation ()
 const  XMLNode*
 TSBBase::getTestAnnotation () const
 {
-  return const_cast<TSBBase *>(this)->getTestAnnotation();
+  parseDeferredTestAnnotation();
+  return mTestAnnotation;
 }
 
 
@@ -343,7 +560,8 @@ TSBBase::getTestAnnotation () const
 std::string
 TSBBase::getTestAnnotationString ()
 {
-  return  XMLNode::convertXMLNodeToString(getTestAnnotation());
+  return  XMLNode::convertXMLNodeToString(
+                          static_cast<const TSBBase*>(this)->getTestAnnotation());
 }
 
 
@@ -354,6 +572,26 @@ TSBBase::getTestAnnotationString () const
 }
 
 
+/*
+ * Returns the content hash of this object, computing it if it is not
+ * cached.
+ */
+uint64_t
+TSBBase::getContentHash () const
+{
+  if (!mIsSetContentHash)
+  {
+    TSBContentHasher hasher;
+    hashContent(hasher);
+
+    mContentHash = hasher.getHash();
+    mIsSetContentHash = true;
+  }
+
+  return mContentHash;
+}
+
+
 /** @cond doxygenLibtsbInternal */
 std::string
 TSBBase::getURI() const
@@ -434,7 +672,7 @@ TSBBase::getNamespaces()
   if (mTSB != NULL)
     return mTSB->getTSBNamespaces()->getNamespaces();
   else
-    return mTSBNamespaces->getNamespaces();
+    return getTSBNamespaces()->getNamespaces();
 }
 
 
@@ -444,37 +682,20 @@ TSBBase::getNamespaces() const
   if (mTSB != NULL)
     return mTSB->getTSBNamespaces()->getNamespaces();
   else
-    return mTSBNamespaces->getNamespaces();
+    return getTSBNamespaces()->getNamespaces();
 }
 
 
 /*
  * @return the parent TSBDocument of this TSB object.
+ *
+ * An object only points at its document while the document owns it:
+ * TSBListOf::remove() and TSBListOf::clear() disconnect the items they give
+ * up, so a non-NULL mTSB is always a live document.
  */
 const TSBDocument*
 TSBBase::getTSBDocument () const
 {
-  if (mTSB != NULL)
-  {
-    // if the doc object has been deleted the pointer is
-    // still valid but points to nothing
-    try
-    {
-      if (mTSB->getHasBeenDeleted())
-      {
-        return NULL;
-      }
-      else
-      {
-        return mTSB;
-      }
-    }
-    catch ( ... )
-    {
-      return NULL;
-    }
-  }
-
   return mTSB;
 }
 
@@ -484,79 +705,17 @@ TSBBase::getTSBDocument () const
 TSBDocument*
 TSBBase::getTSBDocument ()
 {
-  if (mTSB != NULL)
-  {
-    // if the doc object has been deleted the pointer is
-    // still valid but points to nothing
-    try
-    {
-      if (mTSB->getHasBeenDeleted())
-      {
-        return NULL;
-      }
-      else
-      {
-        return mTSB;
-      }
-    }
-    catch ( ... )
-    {
-      return NULL;
-    }
-  }
   return mTSB;
 }
 TSBBase*
 TSBBase::getParentTSBObject ()
 {
-  if (mParentTSBObject != NULL)
-  {
-    // if the parent object has been deleted the pointer is
-    // still valid but points to nothing
-    try
-    {
-      if (mParentTSBObject->getHasBeenDeleted())
-      {
-        return NULL;
-      }
-      else
-      {
-        return mParentTSBObject;
-      }
-    }
-    catch ( ... )
-    {
-      return NULL;
-    }
-  }
-
   return mParentTSBObject;
 }
 
 const TSBBase*
 TSBBase::getParentTSBObject () const
 {
-  if (mParentTSBObject != NULL)
-  {
-    // if the parent object has been deleted the pointer is
-    // still valid but points to nothing
-    try
-    {
-      if (mParentTSBObject->getHasBeenDeleted())
-      {
-        return NULL;
-      }
-      else
-      {
-        return mParentTSBObject;
-      }
-    }
-    catch ( ... )
-    {
-      return NULL;
-    }
-  }
-
   return mParentTSBObject;
 }
 
@@ -606,7 +765,7 @@ TSBBase::isSetId() const
 bool
 TSBBase::isSetNotes () const
 {
-  return (mNotes != NULL);
+  return (mNotes != NULL || mDeferredNotes != NULL);
 }
 
 
@@ -617,7 +776,7 @@ TSBBase::isSetNotes () const
 bool
 TSBBase::isSetTestAnnotation () const
 {
-  return (mTestAnnotation != NULL);
+  return (mTestAnnotation != NULL || mDeferredTestAnnotation != NULL);
 }
 
 
@@ -627,6 +786,8 @@ TSBBase::isSetTestAnnotation () const
 int
 TSBBase::setMetaId (const std::string& metaid)
 {
+  aboutToChange();
+
   if (metaid.empty())
   {
     mMetaId.erase();
@@ -645,6 +806,8 @@ TSBBase::setMetaId (const std::string& metaid)
 int
 TSBBase::setId (const std::string& sid)
 {
+  aboutToChange();
+
   if (sid.empty())
   {
     mId.erase();
@@ -664,6 +827,11 @@ TSBBase::setId (const std::string& sid)
 int
 TSBBase::setTestAnnotation ( XMLNode* annotation)
 {
+  aboutToChange();
+
+  delete mDeferredTestAnnotation;
+  mDeferredTestAnnotation = NULL;
+
   if (annotation == NULL)
   {
     delete mTestAnnotation;
@@ -725,83 +893,66 @@ TSBBase::setTestAnnotation (const std::string& annotation)
 int
 TSBBase::appendTestAnnotation (const  XMLNode* annotation)
 {
-  int success = LIBTSB_OPERATION_FAILED;
-  unsigned int duplicates = 0;
+  aboutToChange();
+  parseDeferredTestAnnotation();
 
   if(annotation == NULL)
     return LIBTSB_OPERATION_SUCCESS;
 
-   XMLNode* new_annotation = NULL;
-  const string&  name = annotation->getName();
-
-  // check for annotation tags and add if necessary
-  if (name != "testAnnotation")
-  {
-     XMLToken ann_t =  XMLToken( XMLTriple("testAnnotation", "", ""),  XMLAttributes());
-    new_annotation = new  XMLNode(ann_t);
-    new_annotation->addChild(*annotation);
-  }
-  else
-  {
-    new_annotation = annotation->clone();
-  }
-
+  // the given node is either a complete <testAnnotation> element or a
+  // single top-level element to go inside one
+  bool wrapped = (annotation->getName() == "testAnnotation");
 
-  if (mTestAnnotation != NULL)
+  if (mTestAnnotation == NULL)
   {
-    // if mTestAnnotation is just <annotation/> need to tell
-    // it to no longer be an end
-    if (mTestAnnotation->isEnd())
+    if (wrapped)
     {
-      mTestAnnotation->unsetEnd();
+      mTestAnnotation = annotation->clone();
     }
-
-
-    // create a list of existing top level ns
-      vector<string> topLevelNs;
-    unsigned int i = 0;
-    for(i = 0; i < mTestAnnotation->getNumChildren(); i++)
+    else
     {
-          topLevelNs.push_back(mTestAnnotation->getChild(i).getName());
+       XMLToken ann_t =  XMLToken( XMLTriple("testAnnotation", "", ""),  XMLAttributes());
+      mTestAnnotation = new  XMLNode(ann_t);
+      mTestAnnotation->addChild(*annotation);
     }
 
+    return LIBTSB_OPERATION_SUCCESS;
+  }
 
+  //
+  // the new top-level elements are added to the existing annotation in
+  // place; they are all checked first so that nothing is added if one
+  // of them clashes with an element that is already there
+  //
+  unsigned int numAdded = wrapped ? annotation->getNumChildren() : 1;
+  unsigned int i;
 
-    for(i = 0; i < new_annotation->getNumChildren(); i++)
+  for (i = 0; i < numAdded; i++)
+  {
+    const  XMLNode& added = wrapped ? annotation->getChild(i) : *annotation;
+    if (mTestAnnotation->getIndex(added.getName()) >= 0)
     {
-          if (find(topLevelNs.begin(), topLevelNs.end(), (new_annotation->getChild(i).getName())) != topLevelNs.end())
-      {
-        mTestAnnotation->addChild(new_annotation->getChild(i));
-      }
-      else
-      {
-        duplicates++;
-      }
+      return LIBTSB_DUPLICATE_ANNOTATION_NS;
     }
+  }
 
-    delete new_annotation;
+  // if mTestAnnotation is just <annotation/> need to tell
+  // it to no longer be an end
+  if (mTestAnnotation->isEnd())
+  {
+    mTestAnnotation->unsetEnd();
+  }
 
-    if (duplicates > 0)
-    {
-      success = LIBTSB_DUPLICATE_ANNOTATION_NS;
-    }
-    else
+  for (i = 0; i < numAdded; i++)
+  {
+    const  XMLNode& added = wrapped ? annotation->getChild(i) : *annotation;
+    if (mTestAnnotation->addChild(added) < 0)
     {
-       XMLNode *copy = mTestAnnotation->clone();
-      success = setTestAnnotation(copy);
-      delete copy;
+      return LIBTSB_OPERATION_FAILED;
     }
-
-
-  }
-  else
-  {
-    success = setTestAnnotation(new_annotation);
-
-    delete new_annotation;
   }
 
-  return success;
+  return LIBTSB_OPERATION_SUCCESS;
 }
 
 /*
@@ -838,6 +989,9 @@ int
 TSBBase::removeTopLevelTestAnnotationElement(const std::string elementName,
     const std::string elementURI)
 {
+  aboutToChange();
+  parseDeferredTestAnnotation();
+
 
   int success = LIBTSB_OPERATION_FAILED;
   if (mTestAnnotation == NULL)
@@ -912,34 +1066,37 @@ TSBBase::removeTopLevelTestAnnotationElement(const std::string elementName,
 int
 TSBBase::replaceTopLevelTestAnnotationElement(const  XMLNode* annotation)
 {
-  int success = LIBTSB_OPERATION_FAILED;
-   XMLNode * replacement = NULL;
+  aboutToChange();
+  parseDeferredTestAnnotation();
+
+  const  XMLNode* replacement = annotation;
   if (annotation->getName() == "testAnnotation")
   {
     if (annotation->getNumChildren() != 1)
     {
-      success = LIBTSB_INVALID_OBJECT;
-      return success;
-    }
-    else
-    {
-      replacement = annotation->getChild(0).clone();
+      return LIBTSB_INVALID_OBJECT;
     }
+    replacement = &annotation->getChild(0);
   }
-  else
+
+  if (mTestAnnotation == NULL)
   {
-    replacement = annotation->clone();
+    return appendTestAnnotation(annotation);
   }
 
-  success = removeTopLevelTestAnnotationElement(replacement->getName());
-  if (success == LIBTSB_OPERATION_SUCCESS)
+  int index = mTestAnnotation->getIndex(replacement->getName());
+  if (index < 0)
   {
-    success = appendTestAnnotation(annotation);
+    // the annotation does not have a child of this name
+    return LIBTSB_ANNOTATION_NAME_NOT_FOUND;
   }
 
-  delete (replacement);
+  // swap the element in place rather than removing it and appending a
+  // copy of the whole annotation
+  delete mTestAnnotation->removeChild((unsigned int)index);
+  mTestAnnotation->insertChild((unsigned int)index, *replacement);
 
-  return success;
+  return LIBTSB_OPERATION_SUCCESS;
 }
 
 
@@ -975,6 +1132,11 @@ TSBBase::replaceTopLevelTestAnnotationElement(const std::string& annotation)
 int
 TSBBase::setNotes(const  XMLNode* notes)
 {
+  aboutToChange();
+
+  delete mDeferredNotes;
+  mDeferredNotes = NULL;
+
   if (mNotes == notes)
   {
     return LIBTSB_OPERATION_SUCCESS;
@@ -1100,6 +1262,9 @@ TSBBase::setNotes(const std::string& notes, bool addXHTMLMarkup)
 int
 TSBBase::appendNotes(const  XMLNode* notes)
 {
+  aboutToChange();
+  parseDeferredNotes();
+
   int success = LIBTSB_OPERATION_FAILED;
   if(notes == NULL)
   {
@@ -1108,6 +1273,87 @@ TSBBase::appendNotes(const  XMLNode* notes)
 
   const string&  name = notes->getName();
 
+  //------------------------------------------------------------
+  //
+  // FAST PATH : when the given notes are XHTML content permitted
+  // within a body element (the _ANotesAny case described below), they
+  // are added straight to the existing notes, without first being
+  // copied into a temporary node.
+  //
+  //------------------------------------------------------------
+
+  if (mNotes != NULL && mNotes->getNumChildren() > 0)
+  {
+    // either a container whose children are to be added, or a single
+    // element to be added as it is
+    const  XMLNode* fragment = NULL;
+    bool single = false;
+
+    if (name == "notes")
+    {
+      if (notes->getNumChildren() == 0)
+      {
+        return LIBTSB_OPERATION_SUCCESS;
+      }
+
+      const string& first = notes->getChild(0).getName();
+      if (first != "html" && first != "body")
+      {
+        fragment = notes;
+      }
+    }
+    else if (!notes->isStart() && !notes->isEnd() && !notes->isText())
+    {
+      if (notes->getNumChildren() == 0)
+      {
+        return LIBTSB_OPERATION_SUCCESS;
+      }
+      fragment = notes;
+    }
+    else
+    {
+      single = (name != "html" && name != "body");
+    }
+
+    if (fragment != NULL || single)
+    {
+       XMLNode* target = mNotes;
+      const string& cname = mNotes->getChild(0).getName();
+
+      if (cname == "html")
+      {
+         XMLNode& curHTML = mNotes->getChild(0);
+        if ((curHTML.getNumChildren() != 2) ||
+            ( (curHTML.getChild(0).getName() != "head") ||
+              (curHTML.getChild(1).getName() != "body")
+            )
+           )
+        {
+          return LIBTSB_INVALID_OBJECT;
+        }
+        target = &curHTML.getChild(1);
+      }
+      else if (cname == "body")
+      {
+        target = &mNotes->getChild(0);
+      }
+
+      if (single)
+      {
+        return (target->addChild(*notes) < 0) ? LIBTSB_OPERATION_FAILED
+                                              : LIBTSB_OPERATION_SUCCESS;
+      }
+
+      for (unsigned int i = 0; i < fragment->getNumChildren(); i++)
+      {
+        if (target->addChild(fragment->getChild(i)) < 0)
+          return LIBTSB_OPERATION_FAILED;
+      }
+
+      return LIBTSB_OPERATION_SUCCESS;
+    }
+  }
+
   // The content of notes in TSB can consist only of the following
   // possibilities:
   //
@@ -1234,25 +1480,6 @@ TSBBase::appendNotes(const  XMLNode* notes)
     }
   }
 
-  // check whether notes is valid xhtml
-  if (getLevel() > 2
-    || (getLevel() == 2 && getVersion() > 1))
-  {
-     XMLNode tmpNotes( XMLTriple("notes","",""),  XMLAttributes());
-
-    if (addedNotesType == _ANotesAny)
-    {
-      for (unsigned int i=0; i < addedNotes.getNumChildren(); i++)
-      {
-        tmpNotes.addChild(addedNotes.getChild(i));
-      }
-    }
-    else
-    {
-      tmpNotes.addChild(addedNotes);
-    }
- }
-
 
   if ( mNotes != NULL )
   {
@@ -1473,6 +1700,13 @@ TSBBase::appendNotes(const std::string& notes)
 void
 TSBBase::setTSBDocument (TSBDocument* d)
 {
+  // an object that shares the namespaces of its document keeps a copy of
+  // them when it moves away from it
+  if (d != mTSB)
+  {
+    copyDocumentNamespaces();
+  }
+
   mTSB = d;
 }
 
@@ -1502,17 +1736,114 @@ TSBBase::connectToParent (TSBBase* parent)
 
 
 /*
- * Sets this TSB object to child TSB objects (if any).
- * (Creates a child-parent relationship by the parent)
- *
- * Subclasses must override this function if they define
- * one ore more child elements.
- * Basically, this function needs to be called in
- * constructors, copy constructors and assignment operators.
+ * Sets this TSB object to child TSB objects (if any).
+ * (Creates a child-parent relationship by the parent)
+ *
+ * Subclasses must override this function if they define
+ * one ore more child elements.
+ * Basically, this function needs to be called in
+ * constructors, copy constructors and assignment operators.
+ */
+void
+TSBBase::connectToChild()
+{
+}
+
+
+/*
+ * Lets the owning TSBDocument preserve this object before it changes.
+ */
+void
+TSBBase::aboutToChange() const
+{
+  invalidateContentHash();
+
+  if (mTSB != NULL && mTSB != this)
+  {
+    mTSB->objectAboutToChange(this);
+  }
+}
+
+
+/*
+ * Discards the cached content hash of this object and its ancestors.
+ */
+void
+TSBBase::invalidateContentHash() const
+{
+  // an ancestor's hash is only ever valid while this one is, so there is
+  // nothing more to do once an invalid hash is met
+  if (!mIsSetContentHash)
+  {
+    return;
+  }
+
+  mIsSetContentHash = false;
+
+  if (mParentTSBObject != NULL)
+  {
+    mParentTSBObject->childContentChanged(this);
+  }
+
+  mContentHashCounted = false;
+}
+
+
+/*
+ * Called when the content hash of a child is invalidated.
+ */
+void
+TSBBase::childContentChanged(const TSBBase*) const
+{
+  invalidateContentHash();
+}
+
+
+/*
+ * Feeds the type, attributes, notes and annotation of this object to the
+ * hasher.
+ */
+void
+TSBBase::hashContent(TSBContentHasher& hasher) const
+{
+  hasher.addUInt((unsigned int)getTypeCode());
+  hasher.addString(mMetaId);
+  hasher.addString(mId);
+
+  hasher.addBool(isSetNotes());
+  if (isSetNotes())
+  {
+    hasher.addString(getNotesString());
+  }
+
+  hasher.addBool(isSetTestAnnotation());
+  if (isSetTestAnnotation())
+  {
+    hasher.addString(getTestAnnotationString());
+  }
+}
+
+
+/*
+ * Returns this object to the state of TSBBase(parent) for reuse.
  */
 void
-TSBBase::connectToChild()
+TSBBase::reinitialize (const TSBBase* parent)
 {
+  clearBaseFields();
+
+  mTSB = parent->mTSB;
+  mParentTSBObject = NULL;
+
+  delete mTSBNamespaces;
+  mTSBNamespaces = NULL;
+
+  if (mTSB == NULL)
+  {
+    mTSBNamespaces = parent->getTSBNamespaces()->clone();
+  }
+
+  setElementNamespace(getTSBNamespaces()->getURI());
 }
 /** @endcond */
 
@@ -1580,6 +1911,8 @@ TSBBase::getAncestorOfType(int type) const
 int
 TSBBase::setNamespaces( XMLNamespaces* xmlns)
 {
+  copyDocumentNamespaces();
+
   if (xmlns == NULL)
   {
     mTSBNamespaces->setNamespaces(NULL);
@@ -1600,6 +1933,8 @@ TSBBase::setNamespaces( XMLNamespaces* xmlns)
 int
 TSBBase::unsetMetaId ()
 {
+  aboutToChange();
+
   mMetaId.erase();
 
   if (mMetaId.empty())
@@ -1619,6 +1954,8 @@ TSBBase::unsetMetaId ()
 int
 TSBBase::unsetId ()
 {
+  aboutToChange();
+
   mId.erase();
 
   if (mId.empty())
@@ -1638,6 +1975,11 @@ TSBBase::unsetId ()
 int
 TSBBase::unsetNotes ()
 {
+  aboutToChange();
+
+  delete mDeferredNotes;
+  mDeferredNotes = NULL;
+
   delete mNotes;
   mNotes = NULL;
   return LIBTSB_OPERATION_SUCCESS;
@@ -1877,6 +2219,29 @@ TSBBase::setTSBNamespacesAndOwn(TSBNamespaces * tsbns)
 }
 
 
+/*
+ * Gives this object its own copy of the namespaces of its document.
+ */
+void
+TSBBase::copyDocumentNamespaces()
+{
+  if (mTSBNamespaces == NULL && mTSB != NULL && mTSB != this)
+  {
+    mTSBNamespaces = mTSB->getTSBNamespaces()->clone();
+  }
+}
+
+
+/*
+ * Returns true if this object belongs to a document other than itself.
+ */
+bool
+TSBBase::isOwnedByOtherDocument() const
+{
+  return mTSB != NULL && mTSB != this;
+}
+
+
 /* gets the TSBnamespaces - internal use only*/
 TSBNamespaces *
 TSBBase::getTSBNamespaces() const
@@ -2113,10 +2478,100 @@ TSBBase::read ( XMLInputStream& stream)
 
   setTSBBaseFields( element );
 
-  ExpectedAttributes expectedAttributes;
-  addExpectedAttributes(expectedAttributes);
-  readAttributes( element.getAttributes(), expectedAttributes );
+  // classes that keep a static set of expected attributes share it; for
+  // any other class the set is built for this element
+  const ExpectedAttributes* expectedAttributes = getStaticExpectedAttributes();
+  ExpectedAttributes elementAttributes;
+  if (expectedAttributes == NULL)
+  {
+    addExpectedAttributes(elementAttributes);
+    expectedAttributes = &elementAttributes;
+  }
+  readAttributes( element.getAttributes(), *expectedAttributes );
+
+  const bool check = !skipReadChecks();
+
+  if (check)
+  {
+    checkElementNamespaces(element);
+  }
+
+  if ( element.isEnd() ) return;
+
+  while ( stream.isGood() )
+  {
+    // this used to skip the text
+    //    stream.skipText();
+    // instead, read text and store in variable
+    std::string text;
+    while(stream.isGood() && stream.peek().isText())
+    {
+      text += stream.next().getCharacters();
+    }
+    setElementText(text);
+
+    const  XMLToken& next = stream.peek();
+
+    // Re-check stream.isGood() because stream.peek() could hit something.
+    if ( !stream.isGood() ) break;
+
+    if ( next.isEndFor(element) )
+    {
+      stream.next();
+      break;
+    }
+    else if ( next.isStart() )
+    {
+      const std::string nextName = next.getName();
+
+      TSBBase * object = createObject(stream);
+
+      if (object != NULL)
+      {
+        position = object->getElementPosition();
+
+        // objects created by appendAndOwn() are already connected
+        if (object->mParentTSBObject != this)
+        {
+          object->connectToParent(static_cast <TSBBase*>(this));
+        }
+
+        object->read(stream);
+
+        if ( !stream.isGood() ) break;
+
+        if (check)
+        {
+          checkTSBListOfPopulated(object);
+        }
+      }
+      else if ( !( readOtherXML(stream)
+                   || readTestAnnotation(stream)
+                   || readNotes(stream) ))
+      {
+        if (check)
+        {
+          logUnknownElement(nextName, getLevel(), getVersion());
+        }
+        stream.skipPastEnd( stream.next() );
+      }
+    }
+    else
+    {
+      stream.skipPastEnd( stream.next() );
+    }
+  }
+}
+/** @endcond */
+
 
+/** @cond doxygenLibtsbInternal */
+/*
+ * Checks the namespace and prefix of an element that has just been read.
+ */
+void
+TSBBase::checkElementNamespaces (const XMLToken& element)
+{
   /* if we are reading a document pass the
    * TSB Namespace information to the input stream object
    * thus the MathML reader can find out what level/version
@@ -2151,10 +2606,10 @@ TSBBase::read ( XMLInputStream& stream)
         /* if there is a mismatch in level/version this will already
          * be logged; do not need another error
          */
-        for (unsigned int n = 0; n < this->getErrorLog()->getNumErrors(); n++)
+        const XMLErrorLog* log = this->getErrorLog();
+        for (unsigned int n = 0; n < log->getNumErrors(); n++)
         {
-          unsigned int errorId =
-                             this->getErrorLog()->getError(n)->getErrorId();
+          unsigned int errorId = log->getError(n)->getErrorId();
           if ( errorId == TsbDocumentAllowedCoreAttributes
             || errorId == TsbDocumentLevelMustBeNonNegativeInteger
             || errorId == TsbDocumentVersionMustBeNonNegativeInteger
@@ -2185,7 +2640,7 @@ TSBBase::read ( XMLInputStream& stream)
     // checks if the given default namespace (if any) is a valid
     // TSB namespace
     //
-    checkDefaultNamespace(mTSBNamespaces->getNamespaces(), element.getName());
+    checkDefaultNamespace(getTSBNamespaces()->getNamespaces(), element.getName());
     if (!element.getPrefix().empty())
     {
        XMLNamespaces * prefixedNS = new  XMLNamespaces();
@@ -2194,62 +2649,70 @@ TSBBase::read ( XMLInputStream& stream)
       delete prefixedNS;
     }
   }
+}
 
-  if ( element.isEnd() ) return;
 
-  while ( stream.isGood() )
-  {
-    // this used to skip the text
-    //    stream.skipText();
-    // instead, read text and store in variable
-    std::string text;
-    while(stream.isGood() && stream.peek().isText())
-    {
-      text += stream.next().getCharacters();
-    }
-    setElementText(text);
+/*
+ * Returns true while this object is read from input that the TSBReader
+ * was told to trust.
+ */
+bool
+TSBBase::skipReadChecks () const
+{
+  return mTSB != NULL && mTSB->getTrustedInput();
+}
 
-    const  XMLToken& next = stream.peek();
 
-    // Re-check stream.isGood() because stream.peek() could hit something.
-    if ( !stream.isGood() ) break;
+/*
+ * Returns value as stored in the string pool of the document.
+ */
+TSBPooledString
+TSBBase::internString (const std::string& value) const
+{
+  if (mTSB != NULL)
+  {
+    return mTSB->getStringPool().intern(value);
+  }
 
-    if ( next.isEndFor(element) )
-    {
-      stream.next();
-      break;
-    }
-    else if ( next.isStart() )
-    {
-      const std::string nextName = next.getName();
+  return value.empty() ? TSBPooledString()
+                       : std::make_shared<const std::string>(value);
+}
 
-      TSBBase * object = createObject(stream);
 
-      if (object != NULL)
-      {
-        position = object->getElementPosition();
+/*
+ * Returns value as stored in the string pool of the document, sharing its
+ * storage if the pool does not hold it.
+ */
+TSBPooledString
+TSBBase::internString (const TSBPooledString& value) const
+{
+  return (mTSB != NULL) ? mTSB->getStringPool().intern(value) : value;
+}
 
-        object->connectToParent(static_cast <TSBBase*>(this));
 
-        object->read(stream);
+/*
+ * Clears the fields of TSBBase that describe the element read.
+ */
+void
+TSBBase::clearBaseFields ()
+{
+  invalidateContentHash();
 
-        if ( !stream.isGood() ) break;
+  mMetaId.clear();
+  mId.clear();
 
-        checkTSBListOfPopulated(object);
-      }
-      else if ( !( readOtherXML(stream)
-                   || readTestAnnotation(stream)
-                   || readNotes(stream) ))
-      {
-        logUnknownElement(nextName, getLevel(), getVersion());
-        stream.skipPastEnd( stream.next() );
-      }
-    }
-    else
-    {
-      stream.skipPastEnd( stream.next() );
-    }
-  }
+  delete mNotes;
+  mNotes = NULL;
+  delete mTestAnnotation;
+  mTestAnnotation = NULL;
+  delete mDeferredNotes;
+  mDeferredNotes = NULL;
+  delete mDeferredTestAnnotation;
+  mDeferredTestAnnotation = NULL;
+
+  mUserData = NULL;
+  mLine = 0;
+  mColumn = 0;
 }
 /** @endcond */
 
@@ -2266,13 +2729,26 @@ TSBBase::setElementText(const std::string &text)
 void
 TSBBase::write ( XMLOutputStream& stream) const
 {
-  stream.startElement( getElementName(), getPrefix() );
+  TSBWriteContext context;
+  write(stream, context);
+}
+
+
+/*
+ * Writes this object using the prefixes resolved in the given context.
+ */
+void
+TSBBase::write ( XMLOutputStream& stream, TSBWriteContext& context) const
+{
+  const std::string prefix = context.getPrefix(this);
+
+  stream.startElement( getElementName(), prefix );
 
   writeXMLNS     ( stream );
-  writeAttributes( stream );
-  writeElements  ( stream );
+  writeAttributes( stream, context );
+  writeElements  ( stream, context );
 
-  stream.endElement( getElementName(), getPrefix() );
+  stream.endElement( getElementName(), prefix );
 
 }
 /** @endcond */
@@ -2287,9 +2763,35 @@ TSBBase::write ( XMLOutputStream& stream) const
 void
 TSBBase::writeElements ( XMLOutputStream& stream) const
 {
+  TSBWriteContext context;
+  writeElements(stream, context);
+}
+
+
+void
+TSBBase::writeElements ( XMLOutputStream& stream,
+                         TSBWriteContext& context) const
+{
+  //
+  // content that was read lazily and has not been asked for is written
+  // from a temporary tree, so that writing a document does not leave
+  // every notes and annotation element built in memory
+  //
   if ( mNotes != NULL ) stream << *mNotes;
+  else if (mDeferredNotes != NULL)
+  {
+     XMLNode* notes = mDeferredNotes->createXMLNode();
+    stream << *notes;
+    delete notes;
+  }
 
   if (mTestAnnotation != NULL) stream << *mTestAnnotation;
+  else if (mDeferredTestAnnotation != NULL)
+  {
+     XMLNode* annotation = mDeferredTestAnnotation->createXMLNode();
+    stream << *annotation;
+    delete annotation;
+  }
 }
 
 
@@ -2342,7 +2844,7 @@ TSBBase::readTestAnnotation ( XMLInputStream& stream)
     // If an annotation already exists, log it as an error and replace
     // the content of the existing annotation with the new one.
 
-    if (mTestAnnotation != NULL)
+    if (isSetTestAnnotation())
     {
       string msg = "An TSB <" + getElementName() + "> element ";
       msg += "has multiple <annotation> children.";
@@ -2350,8 +2852,33 @@ TSBBase::readTestAnnotation ( XMLInputStream& stream)
     }
 
     delete mTestAnnotation;
-    mTestAnnotation = new  XMLNode(stream);
-    checkTestAnnotation();
+    mTestAnnotation = NULL;
+    delete mDeferredTestAnnotation;
+    mDeferredTestAnnotation = NULL;
+
+    if (mTSB != NULL && mTSB->getLazyParsing())
+    {
+      //
+      // keep the tokens and only check the top-level children now;
+      // the full tree is built on the first call to getTestAnnotation()
+      //
+      mDeferredTestAnnotation = new XMLTokenBuffer(stream);
+      if (!skipReadChecks())
+      {
+         XMLNode* outline = mDeferredTestAnnotation->createOutline();
+        checkTestAnnotation(outline);
+        delete outline;
+      }
+    }
+    else
+    {
+      mTestAnnotation = new  XMLNode(stream);
+      recordXMLNodeAllocation(mTestAnnotation);
+      if (!skipReadChecks())
+      {
+        checkTestAnnotation();
+      }
+    }
     return true;
   }
 
@@ -2375,20 +2902,36 @@ TSBBase::readNotes ( XMLInputStream& stream)
     // If an annotation element already exists, then the ordering is wrong.
     // In either case, replace existing content with the new notes read.
 
-    if (mNotes != NULL)
+    if (isSetNotes())
     {
       logError(TSBOnlyOneNotesElementAllowed, getLevel(), getVersion());
     }
 
     delete mNotes;
-    mNotes = new  XMLNode(stream);
+    mNotes = NULL;
+    delete mDeferredNotes;
+    mDeferredNotes = NULL;
+
+    if (mTSB != NULL && mTSB->getLazyParsing())
+    {
+      mDeferredNotes = new XMLTokenBuffer(stream);
+    }
+    else
+    {
+      mNotes = new  XMLNode(stream);
+      recordXMLNodeAllocation(mNotes);
+    }
 
     //
     // checks if the given default namespace (if any) is a valid
     // TSB namespace
     //
-    const  XMLNamespaces &xmlns = mNotes->getNamespaces();
-    checkDefaultNamespace(&xmlns,"notes");
+    if (!skipReadChecks())
+    {
+      const  XMLNamespaces &xmlns = (mNotes != NULL) ? mNotes->getNamespaces()
+        : mDeferredNotes->getElement().getNamespaces();
+      checkDefaultNamespace(&xmlns,"notes");
+    }
 
     return true;
   }
@@ -2396,11 +2939,31 @@ TSBBase::readNotes ( XMLInputStream& stream)
   return false;
 }
 
-bool
-TSBBase::getHasBeenDeleted() const
+void
+TSBBase::parseDeferredNotes () const
+{
+  if (mDeferredNotes == NULL) return;
+
+  TSBBase* self = const_cast<TSBBase*>(this);
+  self->mNotes = mDeferredNotes->createXMLNode();
+  recordXMLNodeAllocation(self->mNotes);
+  delete self->mDeferredNotes;
+  self->mDeferredNotes = NULL;
+}
+
+
+void
+TSBBase::parseDeferredTestAnnotation () const
 {
-  return mHasBeenDeleted;
+  if (mDeferredTestAnnotation == NULL) return;
+
+  TSBBase* self = const_cast<TSBBase*>(this);
+  self->mTestAnnotation = mDeferredTestAnnotation->createXMLNode();
+  recordXMLNodeAllocation(self->mTestAnnotation);
+  delete self->mDeferredTestAnnotation;
+  self->mDeferredTestAnnotation = NULL;
 }
+
 /** @endcond */
 
 
@@ -2435,7 +2998,8 @@ TSBBase::logUnknownAttribute( const string& attribute,
                             const unsigned int level,
                             const unsigned int version,
                             const string& element,
-                            const string& prefix)
+                            const string& prefix,
+                            const unsigned int errorId)
 {
   ostringstream msg;
 
@@ -2449,7 +3013,7 @@ TSBBase::logUnknownAttribute( const string& attribute,
   // (TODO) Needs to be fixed so that error can be added when
   // no TSBDocument attached.
   //
-        getErrorLog()->logError(TSBUnknownCoreAttribute, level,
+        getErrorLog()->logError(errorId, level,
           version, msg.str(), getLine(), getColumn());
   }
 }
@@ -2550,6 +3114,30 @@ TSBBase::addExpectedAttributes(ExpectedAttributes& attributes)
 }
 
 
+/*
+ * Classes whose expected attributes never change override this to return
+ * a set built once with collectExpectedAttributes().
+ */
+const ExpectedAttributes*
+TSBBase::getStaticExpectedAttributes() const
+{
+  return NULL;
+}
+
+
+/*
+ * Returns the attributes added by addExpectedAttributes() for the class
+ * of this object.
+ */
+ExpectedAttributes
+TSBBase::collectExpectedAttributes() const
+{
+  ExpectedAttributes attributes;
+  const_cast<TSBBase*>(this)->addExpectedAttributes(attributes);
+  return attributes;
+}
+
+
 /*
  * Subclasses should override this method to read values from the given
  * XMLAttributes set into their specific fields.  Be sure to call your
@@ -2567,10 +3155,10 @@ TSBBase::readAttributes (const  XMLAttributes& attributes,
   //
   // check that all attributes are expected
   //
-  for (int i = 0; i < attributes.getLength(); i++)
+  const int numAttributes = skipReadChecks() ? 0 : attributes.getLength();
+  for (int i = 0; i < numAttributes; i++)
   {
     std::string name   = attributes.getName(i);
-    std::string uri    = attributes.getURI(i);
     std::string prefix = attributes.getPrefix(i);
 
     //
@@ -2581,7 +3169,7 @@ TSBBase::readAttributes (const  XMLAttributes& attributes,
     //
     if (!prefix.empty())
     {
-      if ( expectedAttributes.hasAttribute(prefix + ":" + name) ) continue;
+      if ( expectedAttributes.hasAttribute(prefix, name) ) continue;
     }
 
 
@@ -2606,7 +3194,7 @@ TSBBase::readAttributes (const  XMLAttributes& attributes,
 
     bool assigned = attributes.readInto("metaid", mMetaId, getErrorLog(), false, getLine(), getColumn());
 
-    if (assigned && mMetaId.empty())
+    if (assigned && mMetaId.empty() && !skipReadChecks())
     {
       logEmptyString("metaid", level, version,
                      TSBTypeCode_toString(getTypeCode()));
@@ -2689,7 +3277,16 @@ TSBBase::getRootElement()
 void
 TSBBase::writeAttributes ( XMLOutputStream& stream) const
 {
-  string tsbPrefix    = getTSBPrefix();
+  TSBWriteContext context;
+  writeAttributes(stream, context);
+}
+
+
+void
+TSBBase::writeAttributes ( XMLOutputStream& stream,
+                           TSBWriteContext& context) const
+{
+  const string tsbPrefix = context.getTSBPrefix(this);
   if ( !mMetaId.empty() )
   {
     stream.writeAttribute("metaid", tsbPrefix, mMetaId);
@@ -2847,6 +3444,17 @@ TSBBase::checkDefaultNamespace(const  XMLNamespaces* xmlns,
   */
 void
 TSBBase::checkTestAnnotation()
+{
+  checkTestAnnotation(mTestAnnotation);
+}
+
+
+/*
+ * Only the element itself and its direct children are looked at, so
+ * @p annotation may be an outline built from buffered tokens.
+ */
+void
+TSBBase::checkTestAnnotation(const  XMLNode* annotation)
 {
   unsigned int nNodes = 0;
   unsigned int match = 0;
@@ -2854,18 +3462,18 @@ TSBBase::checkTestAnnotation()
   std::vector<std::string> uri_list;
   uri_list.clear();
 
-  if (mTestAnnotation == NULL) return;
+  if (annotation == NULL) return;
 
   //
   // checks if the given default namespace (if any) is a valid
   // TSB namespace
   //
-  const  XMLNamespaces &xmlns = mTestAnnotation->getNamespaces();
+  const  XMLNamespaces &xmlns = annotation->getNamespaces();
   checkDefaultNamespace(&xmlns,"testAnnotation");
 
-  while (nNodes < mTestAnnotation->getNumChildren())
+  while (nNodes < annotation->getNumChildren())
   {
-     XMLNode topLevel = mTestAnnotation->getChild(nNodes);
+     XMLNode topLevel = annotation->getChild(nNodes);
 
     // the top level must be an element (so it should be a start)
     if (topLevel.isStart() == false)
@@ -2988,13 +3596,14 @@ TSBBase::checkXHTML(const  XMLNode * xhtml)
   * it will be in the XML currently being checked and so a more
   * informative message can be added
   */
-  for (i = 0; i < getErrorLog()->getNumErrors(); i++)
+  const XMLErrorLog* log = getErrorLog();
+  for (i = 0; i < log->getNumErrors(); i++)
   {
-    if (getErrorLog()->getError(i)->getErrorId() == BadXMLDeclLocation)
+    if (log->getError(i)->getErrorId() == BadXMLDeclLocation)
     {
       logError(errorXML);
     }
-    if (getErrorLog()->getError(i)->getErrorId() == BadlyFormedXML)
+    if (log->getError(i)->getErrorId() == BadlyFormedXML)
     {
       logError(errorDOC);
     }
@@ -3464,6 +4073,14 @@ TSBBase_unsetTestAnnotation (TSBBase_t *sb)
 }
 
 
+LIBTSB_EXTERN
+uint64_t
+TSBBase_getContentHash (const TSBBase_t *sb)
+{
+  return (sb != NULL) ? sb->getContentHash() : 0;
+}
+
+
 LIBTSB_EXTERN
 const char *
 TSBBase_getElementName (const TSBBase_t *sb)
@@ -52,15 +52,19 @@
 #include <tsb/util/ExpectedAttributes.h>
 #include <xml/XMLNode.h>
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 
 
 #include <string>
 #include <stdexcept>
 #include <algorithm>
+#include <utility>
 
 #include <tsb/TSBErrorLog.h>
 #include <tsb/TSBVisitor.h>
+#include <tsb/TSBStringPool.h>
 
 class Model;
 
@@ -75,6 +79,10 @@ class XMLToken;
 LIBTSB_CPP_NAMESPACE_BEGIN
 
 class TSBDocument;
+class TSBWriteContext;
+class TSBContentHasher;
+class XMLTokenBuffer;
+template <class T> struct TSBAttributeSpec;
 
 
 class LIBTSB_EXTERN TSBBase
@@ -96,6 +104,19 @@ public:
   TSBBase& operator=(const TSBBase& rhs);
 
 
+#ifndef SWIG
+  /**
+   * Move assignment operator for TSBBase.
+   *
+   * The notes, annotation and TSBNamespaces of @p rhs are transferred
+   * without being copied; @p rhs is left without them.
+   *
+   * @param rhs The object whose values are moved into this object.
+   */
+  TSBBase& operator=(TSBBase&& rhs) noexcept;
+#endif /* !SWIG */
+
+
   /** @cond doxygenLibtsbInternal */
   /**
    * Accepts the given TSBVisitor for this TSBBase object.
@@ -225,6 +246,13 @@ public:
    * objects.  For an alternative method of accessing the notes, see
    * getNotesString().
    *
+   * As the notes can be modified through the node returned, this method
+   * discards the cached content hash of this object and its ancestors, and
+   * lets a snapshot of the document preserve this object first.  Changes
+   * made through the node after a later call to getContentHash() or
+   * TSBDocument::takeSnapshot() are not seen, so call getNotes() again to
+   * make them.
+   *
    * @return the content of the "notes" subelement of this TSB object as a
    * tree structure composed of XMLNode objects.
    *
@@ -324,6 +352,13 @@ public:
    * content.  See the ModelHistory, CVTerm and RDFAnnotationParser classes
    * for more information about the facilities available.
    *
+   * As the annotation can be modified through the node returned, this
+   * method discards the cached content hash of this object and its
+   * ancestors, and lets a snapshot of the document preserve this object
+   * first.  Changes made through the node after a later call to
+   * getContentHash() or TSBDocument::takeSnapshot() are not seen, so call
+   * getTestAnnotation() again to make them.
+   *
    * @return the annotation of this TSB object as a tree of XMLNode objects.
    *
    * @see getTestAnnotationString()
@@ -868,6 +903,7 @@ public:
    * function.  The possible values returned by this function are:
    * @li @link OperationReturnValues_t#LIBTSB_OPERATION_SUCCESS LIBTSB_OPERATION_SUCCESS @endlink
    * @li @link OperationReturnValues_t#LIBTSB_OPERATION_FAILED LIBTSB_OPERATION_FAILED @endlink
+   * @li @link OperationReturnValues_t#LIBTSB_DUPLICATE_ANNOTATION_NS LIBTSB_DUPLICATE_ANNOTATION_NS @endlink
    *
    * @see getTestAnnotationString()
    * @see isSetTestAnnotation()
@@ -1196,6 +1232,33 @@ public:
   int appendNotes(const std::string& notes);
 
 
+  /**
+   * Returns a 64-bit hash of the content of this TSB object.
+   *
+   * The hash covers the type of the object, its attributes, its notes and
+   * annotation in canonical form, and the content hashes of its children
+   * in order.  Objects with the same content have the same hash, on every
+   * platform and in every run, so the hash can be stored and used to tell
+   * whether an object has changed since it was last processed.  Different
+   * content gives a different hash with very high probability, but a
+   * match is not a proof of equality.
+   *
+   * The hash is cached.  A setter invalidates the cached hash of the object
+   * it modifies and those of its ancestors, as do the non-const getNotes()
+   * and getTestAnnotation(), so after one comment of a
+   * document is edited, the hash of the document is recomputed in time
+   * proportional to the depth of the comment, not to the size of the
+   * document.  Adding, removing or reordering the items of a list makes
+   * the list recompute from the cached hashes of all its items.
+   *
+   * @return the content hash.
+   *
+   * @note Because it fills the cache, this method must not be called on
+   * objects of the same document from several threads at once.
+   */
+  uint64_t getContentHash () const;
+
+
   /** @cond doxygenLibtsbInternal */
   /**
    * Sets the parent TSBDocument of this TSB object.
@@ -1241,6 +1304,42 @@ public:
    */
   virtual void connectToChild ();
 
+
+  /**
+   * Called by the setters and unsetters before this TSB object is
+   * modified, and by TSBListOf before it is removed from a list, so that
+   * the owning TSBDocument can preserve its state for a snapshot.
+   *
+   * @see TSBDocument::takeSnapshot()
+   */
+  void aboutToChange () const;
+
+
+  /**
+   * Discards the cached content hash of this TSB object and of its
+   * ancestors.  Called by aboutToChange(); objects whose content changes
+   * without going through a setter call it directly.
+   *
+   * @see getContentHash()
+   */
+  void invalidateContentHash () const;
+
+
+  /**
+   * Returns this object to the state of an object newly created with
+   * TSBBase(const TSBBase* parent), keeping the storage it has already
+   * allocated.  Used to reuse objects recycled by a TSBReader.
+   *
+   * The object must not belong to a list or a document when this is
+   * called; subclasses that add data members must override it and clear
+   * them too.
+   *
+   * @param parent the object this one is about to be added to.
+   *
+   * @see TSBReader::recycleDocument()
+   */
+  virtual void reinitialize (const TSBBase* parent);
+
   /** @endcond */
 
 
@@ -1567,6 +1666,15 @@ public:
    * Writes (serializes) this TSB object by writing it to XMLOutputStream.
    */
   virtual void write ( XMLOutputStream& stream) const;
+
+
+#ifndef SWIG
+  /**
+   * Writes (serializes) this TSB object by writing it to XMLOutputStream,
+   * using the prefixes already resolved in @p context.
+   */
+  virtual void write ( XMLOutputStream& stream, TSBWriteContext& context) const;
+#endif /* !SWIG */
   /** @endcond */
 
 
@@ -1583,6 +1691,15 @@ public:
    * </pre>@endif@~
    */
   virtual void writeElements ( XMLOutputStream& stream) const;
+
+
+  /**
+   * Subclasses should override this method to write out their contained
+   * TSB objects, passing @p context on to their write() calls.  The
+   * version without a context creates one and calls this method.
+   */
+  virtual void writeElements ( XMLOutputStream& stream,
+                               TSBWriteContext& context) const;
   /** @endcond */
 
 
@@ -1754,8 +1871,6 @@ public:
 
 protected:
 
-  bool getHasBeenDeleted() const;
-
   /** 
    * When overridden allows TSBBase elements to use the text included in between
    * the elements tags. The default implementation does nothing.
@@ -1784,6 +1899,18 @@ protected:
   TSBBase (TSBNamespaces* tsbns);
 
 
+  /**
+   * Creates a new TSBBase object that is about to be added to @p parent.
+   *
+   * If @p parent belongs to a TSBDocument, the new object uses the
+   * TSBNamespaces of that document instead of owning a copy of them; the
+   * copy is only made if the object is later moved to another document
+   * or detached.  This is what the createObject() methods use while a
+   * document is read.
+   */
+  TSBBase (const TSBBase* parent);
+
+
   /**
   * Copy constructor. Creates a copy of this TSBBase object.
    *
@@ -1792,6 +1919,17 @@ protected:
   TSBBase(const TSBBase& orig);
 
 
+#ifndef SWIG
+  /**
+   * Move constructor. Takes over the notes, annotation and TSBNamespaces
+   * of @p orig instead of copying them.
+   *
+   * @param orig the object to move from.
+   */
+  TSBBase(TSBBase&& orig) noexcept;
+#endif /* !SWIG */
+
+
   /**
    * Subclasses should override this method to create, store, and then
    * return an TSB object corresponding to the next XMLToken in the
@@ -1864,7 +2002,8 @@ protected:
           const unsigned int level,
           const unsigned int version,
           const std::string& element,
-          const std::string& prefix="");
+          const std::string& prefix="",
+          const unsigned int errorId = TSBUnknownCoreAttribute);
 
 
   /**
@@ -1891,6 +2030,23 @@ protected:
    */
   virtual void addExpectedAttributes(ExpectedAttributes& attributes);
 
+  /**
+   * Returns the expected attributes shared by every object of this class,
+   * or @c NULL if they are built per element with addExpectedAttributes().
+   *
+   * Subclasses whose expected attributes do not depend on the object
+   * override this to return a set built once, so that reading an element
+   * does not rebuild it.  The override must return @c NULL for classes
+   * derived from it that may add attributes of their own.
+   */
+  virtual const ExpectedAttributes* getStaticExpectedAttributes() const;
+
+  /**
+   * Returns the attributes added by addExpectedAttributes() for this
+   * object.
+   */
+  ExpectedAttributes collectExpectedAttributes() const;
+
   /**
    * Subclasses should override this method to read values from the given
    * XMLAttributes set into their specific fields.  Be sure to call your
@@ -1900,6 +2056,25 @@ protected:
                                const  ExpectedAttributes& expectedAttributes);
 
 
+#ifndef SWIG
+  /**
+   * Reads the attributes of this object in a single pass, binding those
+   * described by @p table directly to the members of the subclass @p T.
+   * "metaid" is read as TSBBase::readAttributes() reads it, and any other
+   * attribute not listed in @p expectedAttributes is logged with
+   * @p unknownError.  Subclasses call this from their readAttributes()
+   * instead of calling their parent's implementation; the definition is
+   * in TSBAttributeTable.h.
+   */
+  template <class T, unsigned int N>
+  void readAttributeTable (const XMLAttributes& attributes,
+                           const ExpectedAttributes& expectedAttributes,
+                           const TSBAttributeSpec<T> (&table)[N],
+                           const std::string& element,
+                           unsigned int unknownError);
+#endif
+
+
   /**
    * Subclasses should override this method to write their XML attributes
    * to the XMLOutputStream.  Be sure to call your parents implementation
@@ -1917,6 +2092,15 @@ protected:
   virtual void writeAttributes ( XMLOutputStream& stream) const;
 
 
+  /**
+   * Subclasses should override this method to write their XML attributes,
+   * taking the prefixes from @p context rather than calling getPrefix().
+   * The version without a context creates one and calls this method.
+   */
+  virtual void writeAttributes ( XMLOutputStream& stream,
+                                 TSBWriteContext& context) const;
+
+
   /**
    *
    * Subclasses should override this method to write their xmlns attriubutes
@@ -1940,6 +2124,41 @@ protected:
   void checkDefaultNamespace(const  XMLNamespaces* xmlns, 
     const std::string& elementName, const std::string& prefix = "");
 
+  /**
+   * Checks the namespace and prefix of an element that has just been read
+   * into this object.  If they are not valid, an error is logged.
+   */
+  void checkElementNamespaces(const XMLToken& element);
+
+  /**
+   * Returns @c true while this object is read by a TSBReader that trusts
+   * its input, in which case the validation checks are skipped.
+   *
+   * @see TSBReader::setTrustedInput()
+   */
+  bool skipReadChecks() const;
+
+#ifndef SWIG
+  /**
+   * Returns @p value as stored in the string pool of the TSBDocument of
+   * this object, or as a string of its own if there is no document.
+   */
+  TSBPooledString internString(const std::string& value) const;
+
+  /**
+   * Returns @p value as stored in the string pool of the TSBDocument of
+   * this object, sharing the storage of @p value when the pool does not
+   * hold it yet.
+   */
+  TSBPooledString internString(const TSBPooledString& value) const;
+#endif
+
+  /**
+   * Clears the metaid, id, notes, annotation, user data and location of
+   * this object.  Used when an object is reinitialized for reuse.
+   */
+  void clearBaseFields();
+
   /**
    * Checks the annotation does not declare an tsb namespace.
    * If the annotation declares an tsb namespace an error is logged.
@@ -1947,6 +2166,32 @@ protected:
   void checkTestAnnotation();
 
 
+  /**
+   * Performs the checks of checkTestAnnotation() on the given annotation,
+   * which need only hold the top-level children of the element.
+   */
+  void checkTestAnnotation(const  XMLNode* annotation);
+
+
+  /**
+   * Gives this object its own copy of the namespaces of its document, if
+   * it has been sharing them.
+   */
+  void copyDocumentNamespaces();
+
+
+  /**
+   * Returns @c true if this object belongs to a document other than
+   * itself, and so uses the namespaces of that document.
+   */
+  bool isOwnedByOtherDocument() const;
+
+
+  friend class TSBWriteContext;
+  friend class TSBBinaryFormat;
+  friend class TSBListOf;
+
+
   /**
    * Checks that the XHTML is valid.
    * If the xhtml does not conform to the specification of valid xhtml within
@@ -2007,6 +2252,22 @@ protected:
   TSBBase* getRootElement();
 
 
+  /**
+   * Feeds the content of this object to @p hasher.  Subclasses that add
+   * attributes or children override this, calling the implementation of
+   * their parent class first.
+   */
+  virtual void hashContent (TSBContentHasher& hasher) const;
+
+
+  /**
+   * Called when the content hash of @p child, a child of this object, is
+   * invalidated.  The default discards the content hash of this object;
+   * TSBListOf also updates the sum of the hashes of its items.
+   */
+  virtual void childContentChanged (const TSBBase* child) const;
+
+
   // ------------------------------------------------------------------
 
 
@@ -2014,6 +2275,8 @@ protected:
   std::string     mId;
    XMLNode*        mNotes;
    XMLNode*        mTestAnnotation;
+  XMLTokenBuffer* mDeferredNotes;
+  XMLTokenBuffer* mDeferredTestAnnotation;
   TSBDocument*   mTSB;
   TSBNamespaces* mTSBNamespaces;
   void*           mUserData;
@@ -2023,7 +2286,6 @@ protected:
 
   /* store the parent TSB object */
   TSBBase* mParentTSBObject;
-  bool mHasBeenDeleted;
 
   std::string mEmptyString;
 
@@ -2045,6 +2307,15 @@ protected:
   //
   std::string mURI;
 
+  /* the cached content hash, valid if mIsSetContentHash */
+  mutable uint64_t      mContentHash;
+  mutable bool          mIsSetContentHash;
+
+  /* set while mContentHash is included, at position mContentHashIndex, in
+   * the item hash sum of the TSBListOf this object belongs to */
+  mutable bool          mContentHashCounted;
+  mutable unsigned int  mContentHashIndex;
+
   
   /** @endcond */
 
@@ -2073,6 +2344,20 @@ private:
   bool readNotes ( XMLInputStream& stream);
 
 
+  /**
+   * If the notes were read with lazy parsing enabled, builds mNotes from
+   * the buffered tokens and releases the buffer.
+   */
+  void parseDeferredNotes () const;
+
+
+  /**
+   * If the annotation was read with lazy parsing enabled, builds
+   * mTestAnnotation from the buffered tokens and releases the buffer.
+   */
+  void parseDeferredTestAnnotation () const;
+
+
   /** @endcond */
 };
 
@@ -2550,6 +2835,21 @@ int
 TSBBase_unsetTestAnnotation (TSBBase_t *sb);
 
 
+/**
+ * Returns a 64-bit hash of the content of the given TSBBase_t structure,
+ * which is the same for structures with the same content.
+ *
+ * @param sb the TSBBase_t structure.
+ *
+ * @return the content hash, or @c 0 if @p sb is @c NULL.
+ *
+ * @memberof TSBBase_t
+ */
+LIBTSB_EXTERN
+uint64_t
+TSBBase_getContentHash (const TSBBase_t *sb);
+
+
 /**
  * Returns the TSB Level of the overall TSB document.
  *
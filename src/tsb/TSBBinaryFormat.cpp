@@ -0,0 +1,666 @@
+/**
+ * @file TSBBinaryFormat.cpp
+ * @brief Implementation of the TSBBinaryFormat class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+
+
+#include <tsb/TSBBinaryFormat.h>
+#include <tsb/TSBDocument.h>
+#include <tsb/TSBErrorLog.h>
+
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/** @cond doxygenlibTSBInternal */
+
+static const char binaryMagic[4] = { 'T', 'S', 'B', 'B' };
+
+/* the string codes stored for each comment, without and with markup */
+static const unsigned int numCommentCodes = 3;
+static const unsigned int numMarkupCodes = 5;
+
+
+/*
+ * Reads a value from data, which need not be aligned.
+ */
+template <class T>
+static T
+loadValue(const char* data)
+{
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+
+template <class T>
+static void
+appendValue(string& output, const T& value)
+{
+  output.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+
+/*
+ * Pads output with zeros so that its size from base is a multiple of 8.
+ */
+static void
+appendPadding(string& output, size_t base)
+{
+  output.append((8 - (output.size() - base) % 8) % 8, '\0');
+}
+
+
+/*
+ * The strings of the data being written, each stored once.
+ */
+class TSBBinaryStringTable
+{
+public:
+  TSBBinaryStringTable() : mOffsets(1, 0), mData(1, '\0'), mCodes()
+  {
+    mOffsets.push_back(mData.size());
+  };
+
+  uint32_t getCode(const string& value)
+  {
+    if (value.empty()) return 0;
+
+    unordered_map<string, uint32_t>::const_iterator it = mCodes.find(value);
+    if (it != mCodes.end()) return it->second;
+
+    uint32_t code = (uint32_t)(mOffsets.size() - 1);
+    mCodes.insert(make_pair(value, code));
+    mData += value;
+    mData += '\0';
+    mOffsets.push_back(mData.size());
+    return code;
+  };
+
+  vector<uint64_t> mOffsets;
+  string mData;
+
+private:
+  unordered_map<string, uint32_t> mCodes;
+};
+
+
+/*
+ * Returns markup without the line break that ends it, which would
+ * otherwise be read back as text beside the element.
+ */
+static string
+trimMarkup(const string& markup)
+{
+  size_t end = markup.find_last_not_of(" \t\r\n");
+  return (end == string::npos) ? string() : markup.substr(0, end + 1);
+}
+
+
+/*
+ * Stores the string codes of the metaid, id, notes and annotation of
+ * element in codes.
+ */
+static void
+getElementCodes(const TSBBase& element, TSBBinaryStringTable& table,
+                bool withMarkup, uint32_t* codes)
+{
+  codes[0] = table.getCode(element.getMetaId());
+  codes[1] = table.getCode(element.getId());
+  codes[2] = (withMarkup && element.isSetNotes())
+           ? table.getCode(trimMarkup(element.getNotesString())) : 0;
+  codes[3] = (withMarkup && element.isSetTestAnnotation())
+           ? table.getCode(trimMarkup(element.getTestAnnotationString())) : 0;
+}
+
+
+/*
+ * Appends the binary form of document to output.
+ */
+void
+TSBBinaryFormat::write(const TSBDocument& document, string& output,
+                       bool withMarkup)
+{
+  const TSBListOfComments* list = document.getListOfComments();
+  const unsigned int numComments = list->size();
+  const unsigned int numCodes = withMarkup ? numMarkupCodes : numCommentCodes;
+
+  TSBBinaryHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+  header.formatVersion = formatVersion;
+  header.byteOrder = byteOrderMark;
+  header.flags = (withMarkup ? hasMarkup : 0)
+               | (document.isSetLevel() ? hasLevel : 0)
+               | (document.isSetVersion() ? hasVersion : 0);
+  header.level = document.getLevel();
+  header.version = document.getVersion();
+  header.numComments = numComments;
+
+  TSBBinaryStringTable table;
+  getElementCodes(document, table, withMarkup, header.document);
+  getElementCodes(*list, table, withMarkup, header.listOfComments);
+
+  const XMLNamespaces* xmlns = document.getNamespaces();
+  vector<uint32_t> namespaces;
+  for (int n = 0; xmlns != NULL && n < xmlns->getLength(); ++n)
+  {
+    namespaces.push_back(table.getCode(xmlns->getPrefix(n)));
+    namespaces.push_back(table.getCode(xmlns->getURI(n)));
+  }
+  header.numNamespaces = (uint32_t)(namespaces.size() / 2);
+
+  vector<double> numbers(numComments);
+  vector<uint64_t> validity((numComments + 63) / 64, 0);
+  vector<uint32_t> codes(numComments * numCodes);
+  vector<uint64_t> pointOffsets(numComments);
+  string points;
+
+  for (unsigned int n = 0; n < numComments; ++n)
+  {
+    const TSBComment* comment = static_cast<const TSBComment*>(list->get(n));
+    uint32_t* commentCodes = &codes[n * numCodes];
+
+    numbers[n] = comment->getNumber();
+    if (comment->isSetNumber())
+    {
+      validity[n / 64] |= (uint64_t)1 << (n % 64);
+    }
+
+    uint32_t elementCodes[4];
+    getElementCodes(*comment, table, withMarkup, elementCodes);
+
+    commentCodes[0] = table.getCode(comment->getContributor());
+    commentCodes[1] = elementCodes[0];
+    commentCodes[2] = elementCodes[1];
+    if (withMarkup)
+    {
+      commentCodes[3] = elementCodes[2];
+      commentCodes[4] = elementCodes[3];
+    }
+
+    const string& point = comment->getPoint();
+    pointOffsets[n] = points.size();
+    appendValue(points, (uint32_t)point.size());
+    points += point;
+    points += '\0';
+  }
+
+  header.numStrings = (uint32_t)(table.mOffsets.size() - 1);
+  header.stringDataSize = table.mData.size();
+  header.pointDataSize = points.size();
+
+  const size_t base = output.size();
+  output.reserve(base + sizeof(header)
+                 + table.mOffsets.size() * sizeof(uint64_t)
+                 + table.mData.size() + 8
+                 + namespaces.size() * sizeof(uint32_t) + 8
+                 + numbers.size() * sizeof(double)
+                 + validity.size() * sizeof(uint64_t)
+                 + codes.size() * sizeof(uint32_t) + 8
+                 + pointOffsets.size() * sizeof(uint64_t)
+                 + points.size());
+
+  appendValue(output, header);
+
+  output.append(reinterpret_cast<const char*>(table.mOffsets.data()),
+                table.mOffsets.size() * sizeof(uint64_t));
+  output += table.mData;
+  appendPadding(output, base);
+
+  output.append(reinterpret_cast<const char*>(namespaces.data()),
+                namespaces.size() * sizeof(uint32_t));
+  appendPadding(output, base);
+
+  output.append(reinterpret_cast<const char*>(numbers.data()),
+                numbers.size() * sizeof(double));
+  output.append(reinterpret_cast<const char*>(validity.data()),
+                validity.size() * sizeof(uint64_t));
+
+  output.append(reinterpret_cast<const char*>(codes.data()),
+                codes.size() * sizeof(uint32_t));
+  appendPadding(output, base);
+
+  output.append(reinterpret_cast<const char*>(pointOffsets.data()),
+                pointOffsets.size() * sizeof(uint64_t));
+  output += points;
+}
+
+
+/*
+ * Walks through binary data, checking that each section lies within it.
+ */
+class TSBBinaryCursor
+{
+public:
+  TSBBinaryCursor(const char* data, size_t length)
+    : mData(data), mLength(length), mPosition(0)
+  {
+  };
+
+  /*
+   * Sets section to the next size bytes, starting at a multiple of 8 bytes
+   * if aligned is true, and returns false if the data is too short.
+   */
+  bool next(uint64_t size, const char*& section, bool aligned = true)
+  {
+    uint64_t start = mPosition;
+    if (aligned)
+    {
+      start = (start + 7) & ~(uint64_t)7;
+    }
+
+    if (start > mLength || size > mLength - start)
+    {
+      return false;
+    }
+
+    section = mData + start;
+    mPosition = start + size;
+    return true;
+  };
+
+private:
+  const char* mData;
+  uint64_t mLength;
+  uint64_t mPosition;
+};
+
+
+/*
+ * Finds the sections of binary data, checking the header and that every
+ * section lies within the data.  The sections themselves are not read.
+ */
+bool
+TSBBinaryFormat::locate(const char* data, size_t length,
+                        TSBBinarySections& sections, string& error)
+{
+  if (data == NULL || !isBinary(data, length))
+  {
+    error = "The data is not binary TSB data.";
+    return false;
+  }
+
+  if (length < sizeof(TSBBinaryHeader))
+  {
+    error = "The data ends within its header.";
+    return false;
+  }
+
+  const TSBBinaryHeader& header = sections.header;
+  sections.header = loadValue<TSBBinaryHeader>(data);
+
+  if (header.byteOrder != byteOrderMark)
+  {
+    error = "The data was written on a machine with another byte order.";
+    return false;
+  }
+
+  if (header.formatVersion == 0 || header.formatVersion > formatVersion)
+  {
+    ostringstream details;
+    details << "The data has format version " << header.formatVersion
+            << "; this copy of libTSB reads versions up to "
+            << formatVersion << ".";
+    error = details.str();
+    return false;
+  }
+
+  sections.numCodes = ((header.flags & hasMarkup) != 0)
+                    ? numMarkupCodes : numCommentCodes;
+
+  const uint64_t numComments = header.numComments;
+  const uint64_t numStrings = header.numStrings;
+
+  TSBBinaryCursor cursor(data, length);
+  const char* start;
+
+  if (numStrings == 0
+    || !cursor.next(sizeof(TSBBinaryHeader), start)
+    || !cursor.next((numStrings + 1) * sizeof(uint64_t),
+                    sections.stringOffsets)
+    || !cursor.next(header.stringDataSize, sections.strings, false)
+    || !cursor.next((uint64_t)header.numNamespaces * 2 * sizeof(uint32_t),
+                    sections.namespaces)
+    || !cursor.next(numComments * sizeof(double), sections.numbers)
+    || !cursor.next((numComments + 63) / 64 * sizeof(uint64_t),
+                    sections.validity, false)
+    || !cursor.next(numComments * sections.numCodes * sizeof(uint32_t),
+                    sections.codes, false)
+    || !cursor.next(numComments * sizeof(uint64_t), sections.pointOffsets)
+    || !cursor.next(header.pointDataSize, sections.points, false))
+  {
+    error = "The data is truncated.";
+    return false;
+  }
+
+  // string 0 is the empty string and the table ends with the data
+  if (header.stringDataSize == 0 || sections.strings[0] != '\0'
+    || loadValue<uint64_t>(sections.stringOffsets) != 0
+    || loadValue<uint64_t>(sections.stringOffsets + 8) != 1
+    || loadValue<uint64_t>(sections.stringOffsets + numStrings * 8)
+       != header.stringDataSize)
+  {
+    error = "The string table is malformed.";
+    return false;
+  }
+
+  return true;
+}
+
+
+/*
+ * Returns the string with the given code, or NULL if the string table
+ * does not hold it.
+ */
+const char*
+TSBBinaryFormat::getString(const TSBBinarySections& sections, uint32_t code)
+{
+  if (code >= sections.header.numStrings)
+  {
+    return NULL;
+  }
+
+  const uint64_t start = loadValue<uint64_t>(sections.stringOffsets
+                                             + (uint64_t)code * 8);
+  const uint64_t end = loadValue<uint64_t>(sections.stringOffsets
+                                           + ((uint64_t)code + 1) * 8);
+
+  if (start >= end || end > sections.header.stringDataSize
+    || sections.strings[end - 1] != '\0')
+  {
+    return NULL;
+  }
+
+  return sections.strings + start;
+}
+
+
+/*
+ * Returns the string code of field of comment n.
+ */
+uint32_t
+TSBBinaryFormat::getCode(const TSBBinarySections& sections, uint32_t n,
+                         unsigned int field)
+{
+  return loadValue<uint32_t>(sections.codes
+    + ((uint64_t)n * sections.numCodes + field) * sizeof(uint32_t));
+}
+
+
+/*
+ * Returns true if the number of comment n is set.
+ */
+bool
+TSBBinaryFormat::isSetNumber(const TSBBinarySections& sections, uint32_t n)
+{
+  return ((loadValue<uint64_t>(sections.validity + n / 64 * 8)
+           >> (n % 64)) & 1) != 0;
+}
+
+
+/*
+ * Returns the number of comment n.
+ */
+double
+TSBBinaryFormat::getNumber(const TSBBinarySections& sections, uint32_t n)
+{
+  return loadValue<double>(sections.numbers + (uint64_t)n * 8);
+}
+
+
+/*
+ * Returns the point of comment n and sets length to its length, or
+ * returns NULL if the point data does not hold it.
+ */
+const char*
+TSBBinaryFormat::getPoint(const TSBBinarySections& sections, uint32_t n,
+                          uint32_t& length)
+{
+  const uint64_t size = sections.header.pointDataSize;
+  const uint64_t offset = loadValue<uint64_t>(sections.pointOffsets
+                                              + (uint64_t)n * 8);
+
+  if (offset > size || size - offset < sizeof(uint32_t) + 1)
+  {
+    return NULL;
+  }
+
+  length = loadValue<uint32_t>(sections.points + offset);
+  const uint64_t start = offset + sizeof(uint32_t);
+
+  if (length > size - start - 1 || sections.points[start + length] != '\0')
+  {
+    return NULL;
+  }
+
+  return sections.points + start;
+}
+
+
+/*
+ * Logs that the data could not be read and returns false.
+ */
+static bool
+logBinaryError(TSBDocument& document, const string& details)
+{
+  document.getErrorLog()->logError(TSBBadBinaryFormat, document.getLevel(),
+                                   document.getVersion(), details);
+  return false;
+}
+
+
+/*
+ * Sets the metaid, id, notes and annotation of element from their codes.
+ */
+static void
+setElementFields(TSBBase& element, const vector<string>& strings,
+                 const uint32_t* codes)
+{
+  if (codes[0] != 0) element.setMetaId(strings[codes[0]]);
+  if (codes[1] != 0) element.setId(strings[codes[1]]);
+  if (codes[2] != 0) element.setNotes(strings[codes[2]]);
+  if (codes[3] != 0) element.setTestAnnotation(strings[codes[3]]);
+}
+
+
+/*
+ * Reads binary data into document.
+ */
+bool
+TSBBinaryFormat::read(const char* data, size_t length, TSBDocument& document)
+{
+  TSBBinarySections sections;
+  string error;
+
+  if (!locate(data, length, sections, error))
+  {
+    return logBinaryError(document, error);
+  }
+
+  const TSBBinaryHeader& header = sections.header;
+  const uint32_t numComments = header.numComments;
+  const uint32_t numStrings = header.numStrings;
+
+  // check every string, string code and point before anything is created
+  vector<string> strings(numStrings);
+  uint64_t previous = 0;
+  for (uint32_t n = 0; n < numStrings; ++n)
+  {
+    const char* value = getString(sections, n);
+    const uint64_t start = loadValue<uint64_t>(sections.stringOffsets
+                                               + (uint64_t)n * 8);
+    if (value == NULL || start < previous)
+    {
+      return logBinaryError(document, "The string table is malformed.");
+    }
+    previous = start;
+    strings[n].assign(value, (size_t)(loadValue<uint64_t>(
+      sections.stringOffsets + ((uint64_t)n + 1) * 8) - start - 1));
+  }
+
+  for (unsigned int n = 0; n < 4; ++n)
+  {
+    if (header.document[n] >= numStrings
+      || header.listOfComments[n] >= numStrings)
+    {
+      return logBinaryError(document, "A string code is out of range.");
+    }
+  }
+
+  for (uint64_t n = 0; n < (uint64_t)header.numNamespaces * 2; ++n)
+  {
+    if (loadValue<uint32_t>(sections.namespaces + n * 4) >= numStrings)
+    {
+      return logBinaryError(document, "A string code is out of range.");
+    }
+  }
+
+  uint64_t pointOffset = 0;
+  for (uint32_t n = 0; n < numComments; ++n)
+  {
+    for (unsigned int field = 0; field < sections.numCodes; ++field)
+    {
+      if (getCode(sections, n, field) >= numStrings)
+      {
+        return logBinaryError(document, "A string code is out of range.");
+      }
+    }
+
+    uint32_t size;
+    if (loadValue<uint64_t>(sections.pointOffsets + (uint64_t)n * 8)
+        != pointOffset || getPoint(sections, n, size) == NULL)
+    {
+      return logBinaryError(document, "The points are malformed.");
+    }
+    pointOffset += sizeof(uint32_t) + size + 1;
+  }
+
+  // the data is sound: build the document
+  if ((header.flags & hasLevel) != 0)
+  {
+    document.setLevel(header.level);
+  }
+  if ((header.flags & hasVersion) != 0)
+  {
+    document.setVersion(header.version);
+  }
+
+  if (header.numNamespaces > 0)
+  {
+    XMLNamespaces xmlns;
+    for (uint64_t n = 0; n < header.numNamespaces; ++n)
+    {
+      xmlns.add(strings[loadValue<uint32_t>(sections.namespaces + n * 8 + 4)],
+                strings[loadValue<uint32_t>(sections.namespaces + n * 8)]);
+    }
+    document.setNamespaces(&xmlns);
+  }
+  document.setElementNamespace(document.getTSBNamespaces()->getURI());
+
+  TSBListOfComments* list = document.getListOfComments();
+  setElementFields(document, strings, header.document);
+  setElementFields(*list, strings, header.listOfComments);
+
+  for (uint32_t n = 0; n < numComments; ++n)
+  {
+    TSBComment* comment = document.createPooledComment(list);
+    if (comment == NULL)
+    {
+      comment = new TSBComment(list);
+    }
+    list->appendAndOwn(comment);
+
+    const uint32_t contributor = getCode(sections, n, 0);
+    if (contributor != 0)
+    {
+      comment->setContributor(strings[contributor]);
+    }
+
+    if (isSetNumber(sections, n))
+    {
+      comment->setNumber(getNumber(sections, n));
+    }
+
+    uint32_t elementCodes[4] = { 0, 0, 0, 0 };
+    for (unsigned int field = 1; field < sections.numCodes; ++field)
+    {
+      elementCodes[field - 1] = getCode(sections, n, field);
+    }
+    setElementFields(*comment, strings, elementCodes);
+
+    uint32_t size;
+    const char* point = getPoint(sections, n, size);
+    if (size > 0)
+    {
+      comment->setPoint(string(point, size));
+    }
+  }
+
+  return true;
+}
+
+
+/*
+ * Returns true if data starts like binary TSB data.
+ */
+bool
+TSBBinaryFormat::isBinary(const char* data, size_t length)
+{
+  return data != NULL && length >= sizeof(binaryMagic)
+    && memcmp(data, binaryMagic, sizeof(binaryMagic)) == 0;
+}
+
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+LIBTSB_CPP_NAMESPACE_END
@@ -0,0 +1,238 @@
+/**
+ * @file TSBBinaryFormat.h
+ * @brief Definition of the TSBBinaryFormat class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class TSBBinaryFormat
+ * @sbmlbrief{} Reads and writes the binary TSB format.
+ *
+ * The binary format holds the same content as the XML form of a
+ * TSBDocument, laid out so that it can be loaded in a single pass without
+ * parsing, or mapped into memory and read in place.  All values are stored
+ * in the byte order of the machine that wrote them, which the reader
+ * checks.  The data starts with a TSBBinaryHeader and continues with the
+ * following sections, each starting at a multiple of 8 bytes:
+ *
+ * @li the string table: <code>numStrings + 1</code> 64-bit offsets into
+ * the string data, followed by the string data itself, in which each
+ * string ends with a NUL character.  String 0 is always the empty string,
+ * which stands for an unset value.  Contributors, identifiers, namespaces
+ * and notes are stored as 32-bit string codes.
+ * @li the namespaces of the document: a prefix code and a URI code for
+ * each of them.
+ * @li the numbers of the comments, as raw @c double values, NaN where the
+ * number is not set.
+ * @li a bitmap with one bit per comment, set when its number is set.
+ * @li the string codes of each comment: its contributor, metaid and id,
+ * followed by its notes and annotation when the data has markup.
+ * @li the 64-bit offset of the point of each comment within the point
+ * data.
+ * @li the points of the comments, each as a 32-bit length followed by that
+ * many bytes and a NUL character.
+ *
+ * TSBDocumentView reads comments straight from these sections.
+ */
+
+
+#ifndef TSBBinaryFormat_H__
+#define TSBBinaryFormat_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+
+
+#ifdef __cplusplus
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+class TSBDocument;
+
+
+/** @cond doxygenlibTSBInternal */
+#ifndef SWIG
+
+/**
+ * The fixed-size start of binary TSB data.
+ */
+struct TSBBinaryHeader
+{
+  char     magic[4];
+  uint32_t formatVersion;
+  uint32_t byteOrder;
+  uint32_t flags;
+  uint32_t level;
+  uint32_t version;
+  uint32_t numComments;
+  uint32_t numStrings;
+  uint32_t numNamespaces;
+  uint32_t reserved;
+  uint64_t stringDataSize;
+  uint64_t pointDataSize;
+
+  /* string codes of the metaid, id, notes and annotation of the document
+   * and of its list of comments */
+  uint32_t document[4];
+  uint32_t listOfComments[4];
+};
+
+
+/**
+ * The header and the start of each section of binary TSB data.
+ */
+struct TSBBinarySections
+{
+  TSBBinaryHeader header;
+
+  /* the number of string codes stored for each comment */
+  uint32_t numCodes;
+
+  const char* stringOffsets;
+  const char* strings;
+  const char* namespaces;
+  const char* numbers;
+  const char* validity;
+  const char* codes;
+  const char* pointOffsets;
+  const char* points;
+};
+
+
+class LIBTSB_EXTERN TSBBinaryFormat
+{
+public:
+
+  /* the format version written by this copy of libTSB */
+  static const uint32_t formatVersion = 1;
+
+  /* the value of TSBBinaryHeader::byteOrder as written by this machine */
+  static const uint32_t byteOrderMark = 0x01020304;
+
+  /* flags of TSBBinaryHeader::flags */
+  static const uint32_t hasMarkup = 1;
+  static const uint32_t hasLevel = 2;
+  static const uint32_t hasVersion = 4;
+
+
+  /**
+   * Appends the binary form of the given document to output.  The notes
+   * and annotations are included if withMarkup is true.
+   */
+  static void write(const TSBDocument& document, std::string& output,
+                    bool withMarkup);
+
+
+  /**
+   * Reads the binary data of the given length into the given document,
+   * which must be empty.  The data is checked before any comment is
+   * created; if it is malformed, or written on a machine with another byte
+   * order, an error is logged and the document is left empty.
+   *
+   * @return true if the data was read.
+   */
+  static bool read(const char* data, size_t length, TSBDocument& document);
+
+
+  /**
+   * Returns true if the data starts like binary TSB data.
+   */
+  static bool isBinary(const char* data, size_t length);
+
+
+  /**
+   * Finds the sections of the binary data of the given length.  The header
+   * is checked and every section must lie within the data, but the
+   * contents of the sections are not read, so this takes the same time
+   * whatever the size of the data.
+   *
+   * @return true if the sections were found; otherwise error is set to a
+   * description of the problem.
+   */
+  static bool locate(const char* data, size_t length,
+                     TSBBinarySections& sections, std::string& error);
+
+
+  /**
+   * Returns the NUL-terminated string with the given code, or NULL if the
+   * string table does not hold it.
+   */
+  static const char* getString(const TSBBinarySections& sections,
+                               uint32_t code);
+
+
+  /**
+   * Returns the string code of the given field of comment n: 0 for its
+   * contributor, then its metaid, id, notes and annotation.  Both n and
+   * field must be in range.
+   */
+  static uint32_t getCode(const TSBBinarySections& sections, uint32_t n,
+                          unsigned int field);
+
+
+  /**
+   * Returns true if the number of comment n, which must be in range, is
+   * set.
+   */
+  static bool isSetNumber(const TSBBinarySections& sections, uint32_t n);
+
+
+  /**
+   * Returns the number of comment n, which must be in range.
+   */
+  static double getNumber(const TSBBinarySections& sections, uint32_t n);
+
+
+  /**
+   * Returns the NUL-terminated point of comment n, which must be in range,
+   * and sets length to its length.  Returns NULL if the point data does
+   * not hold it.
+   */
+  static const char* getPoint(const TSBBinarySections& sections, uint32_t n,
+                              uint32_t& length);
+};
+
+#endif /* !SWIG */
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+#endif /* !TSBBinaryFormat_H__ */
@@ -37,6 +37,11 @@
 #include <tsb/TSBComment.h>
 #include <tsb/TSBListOfComments.h>
 #include <xml/XMLInputStream.h>
+#include <typeinfo>
+#include <tsb/TSBWriteContext.h>
+#include <tsb/TSBAttributeTable.h>
+#include <tsb/TSBContentHasher.h>
+#include <tsb/TSBAllocationTrace.h>
 
 
 using namespace std;
@@ -56,11 +61,13 @@ LIBTSB_CPP_NAMESPACE_BEGIN
  */
 TSBComment::TSBComment(unsigned int level, unsigned int version)
   : TSBBase(level, version)
-  , mContributor ("")
+  , mContributor ()
   , mNumber (tsb_util_NaN())
   , mIsSetNumber (false)
   , mPoint ("")
 {
+  TSBAllocationTrace::recordAllocation(TSB_ALLOCATION_COMMENT,
+                                       sizeof(TSBComment));
   setTSBNamespacesAndOwn(new TSBNamespaces(level, version));
 }
 
@@ -70,15 +77,35 @@ TSBComment::TSBComment(unsigned int level, unsigned int version)
  */
 TSBComment::TSBComment(TSBNamespaces *tsbns)
   : TSBBase(tsbns)
-  , mContributor ("")
+  , mContributor ()
   , mNumber (tsb_util_NaN())
   , mIsSetNumber (false)
   , mPoint ("")
 {
+  TSBAllocationTrace::recordAllocation(TSB_ALLOCATION_COMMENT,
+                                       sizeof(TSBComment));
   setElementNamespace(tsbns->getURI());
 }
 
 
+/** @cond doxygenlibTSBInternal */
+/*
+ * Creates a new TSBComment that shares the namespaces of the document of
+ * parent.
+ */
+TSBComment::TSBComment(const TSBBase* parent)
+  : TSBBase(parent)
+  , mContributor ()
+  , mNumber (tsb_util_NaN())
+  , mIsSetNumber (false)
+  , mPoint ("")
+{
+  TSBAllocationTrace::recordAllocation(TSB_ALLOCATION_COMMENT,
+                                       sizeof(TSBComment));
+}
+/** @endcond */
+
+
 /*
  * Copy constructor for TSBComment.
  */
@@ -89,6 +116,8 @@ TSBComment::TSBComment(const TSBComment& orig)
   , mIsSetNumber ( orig.mIsSetNumber )
   , mPoint ( orig.mPoint )
 {
+  TSBAllocationTrace::recordAllocation(TSB_ALLOCATION_COMMENT,
+                                       sizeof(TSBComment));
 }
 
 
@@ -100,11 +129,66 @@ TSBComment::operator=(const TSBComment& rhs)
 {
   if (&rhs != this)
   {
+    aboutToChange();
+
+    TSBListOfComments* list = getIndexingList();
+    if (list != NULL) list->unindexComment(this);
+
     TSBBase::operator=(rhs);
-    mContributor = rhs.mContributor;
+
+    mContributor = internString(rhs.mContributor);
     mNumber = rhs.mNumber;
     mIsSetNumber = rhs.mIsSetNumber;
     mPoint = rhs.mPoint;
+
+    if (list != NULL) list->indexComment(this);
+  }
+
+  return *this;
+}
+
+
+/*
+ * Move constructor for TSBComment.
+ */
+TSBComment::TSBComment(TSBComment&& orig) noexcept
+  : TSBBase( std::move(orig) )
+  , mContributor ( std::move(orig.mContributor) )
+  , mNumber ( orig.mNumber )
+  , mIsSetNumber ( orig.mIsSetNumber )
+  , mPoint ( std::move(orig.mPoint) )
+{
+  TSBAllocationTrace::recordAllocation(TSB_ALLOCATION_COMMENT,
+                                       sizeof(TSBComment));
+}
+
+
+/*
+ * Move assignment operator for TSBComment.
+ */
+TSBComment&
+TSBComment::operator=(TSBComment&& rhs) noexcept
+{
+  if (&rhs != this)
+  {
+    aboutToChange();
+    rhs.aboutToChange();
+
+    TSBListOfComments* list = getIndexingList();
+    if (list != NULL) list->unindexComment(this);
+    TSBListOfComments* rhsList = rhs.getIndexingList();
+    if (rhsList != NULL) rhsList->unindexComment(&rhs);
+
+    TSBBase::operator=(std::move(rhs));
+
+    mContributor = internString(rhs.mContributor);
+    rhs.mContributor.reset();
+    mNumber = rhs.mNumber;
+    mIsSetNumber = rhs.mIsSetNumber;
+    mPoint = std::move(rhs.mPoint);
+
+    if (list != NULL) list->indexComment(this);
+    if (rhsList != NULL) rhsList->indexComment(&rhs);
   }
 
   return *this;
@@ -126,6 +210,7 @@ TSBComment::clone() const
  */
 TSBComment::~TSBComment()
 {
+  TSBAllocationTrace::recordFree(TSB_ALLOCATION_COMMENT, sizeof(TSBComment));
 }
 
 
@@ -135,7 +220,9 @@ TSBComment::~TSBComment()
 const std::string&
 TSBComment::getContributor() const
 {
-  return mContributor;
+  static const std::string empty;
+
+  return (mContributor != NULL) ? *mContributor : empty;
 }
 
 
@@ -166,7 +253,29 @@ TSBComment::getPoint() const
 bool
 TSBComment::isSetContributor() const
 {
-  return (mContributor.empty() == false);
+  return (mContributor != NULL);
+}
+
+
+/*
+ * Predicate returning @c true if this TSBComment and other have the same
+ * "contributor" attribute.
+ */
+bool
+TSBComment::hasSameContributor(const TSBComment& other) const
+{
+  if (mContributor == other.mContributor)
+  {
+    return true;
+  }
+
+  // within a document, equal contributors share one pooled string
+  if (mTSB != NULL && mTSB == other.mTSB)
+  {
+    return false;
+  }
+
+  return getContributor() == other.getContributor();
 }
 
 
@@ -196,7 +305,14 @@ TSBComment::isSetPoint() const
 int
 TSBComment::setContributor(const std::string& contributor)
 {
-  mContributor = contributor;
+  aboutToChange();
+
+  TSBListOfComments* list = getIndexingList();
+  if (list != NULL) list->unindexComment(this);
+
+  mContributor = internString(contributor);
+
+  if (list != NULL) list->indexComment(this);
   return LIBTSB_OPERATION_SUCCESS;
 }
 
@@ -207,8 +323,15 @@ TSBComment::setContributor(const std::string& contributor)
 int
 TSBComment::setNumber(double number)
 {
+  aboutToChange();
+
+  TSBListOfComments* list = getIndexingList();
+  if (list != NULL) list->unindexComment(this);
+
   mNumber = number;
   mIsSetNumber = true;
+
+  if (list != NULL) list->indexComment(this);
   return LIBTSB_OPERATION_SUCCESS;
 }
 
@@ -219,6 +342,8 @@ TSBComment::setNumber(double number)
 int
 TSBComment::setPoint(const std::string& point)
 {
+  aboutToChange();
+
   mPoint = point;
   return LIBTSB_OPERATION_SUCCESS;
 }
@@ -230,9 +355,16 @@ TSBComment::setPoint(const std::string& point)
 int
 TSBComment::unsetContributor()
 {
-  mContributor.erase();
+  aboutToChange();
+
+  TSBListOfComments* list = getIndexingList();
+  if (list != NULL) list->unindexComment(this);
+
+  mContributor.reset();
 
-  if (mContributor.empty() == true)
+  if (list != NULL) list->indexComment(this);
+
+  if (mContributor == NULL)
   {
     return LIBTSB_OPERATION_SUCCESS;
   }
@@ -249,9 +381,16 @@ TSBComment::unsetContributor()
 int
 TSBComment::unsetNumber()
 {
+  aboutToChange();
+
+  TSBListOfComments* list = getIndexingList();
+  if (list != NULL) list->unindexComment(this);
+
   mNumber = tsb_util_NaN();
   mIsSetNumber = false;
 
+  if (list != NULL) list->indexComment(this);
+
   if (isSetNumber() == false)
   {
     return LIBTSB_OPERATION_SUCCESS;
@@ -269,6 +408,8 @@ TSBComment::unsetNumber()
 int
 TSBComment::unsetPoint()
 {
+  aboutToChange();
+
   mPoint.erase();
 
   if (mPoint.empty() == true)
@@ -333,10 +474,10 @@ TSBComment::hasRequiredAttributes() const
  * Write any contained elements
  */
 void
-TSBComment::writeElements( XMLOutputStream&
-  stream) const
+TSBComment::writeElements( XMLOutputStream& stream,
+  TSBWriteContext& context) const
 {
-  TSBBase::writeElements(stream);
+  TSBBase::writeElements(stream, context);
 }
 
 /** @endcond */
@@ -358,6 +499,50 @@ TSBComment::accept(TSBVisitor& v) const
 
 
 
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Returns the list holding this TSBComment if that list is indexed.
+ */
+TSBListOfComments*
+TSBComment::getIndexingList() const
+{
+  TSBBase* parent = mParentTSBObject;
+
+  if (parent == NULL || parent->getTypeCode() != TSB_LIST_OF
+    || static_cast<TSBListOf*>(parent)->getItemTypeCode() != TSB_COMMENT)
+  {
+    return NULL;
+  }
+
+  TSBListOfComments* list = static_cast<TSBListOfComments*>(parent);
+  return list->isIndexed() ? list : NULL;
+}
+
+/** @endcond */
+
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Returns this TSBComment to the state of TSBComment(parent)
+ */
+void
+TSBComment::reinitialize(const TSBBase* parent)
+{
+  TSBBase::reinitialize(parent);
+
+  mContributor.reset();
+  mNumber = tsb_util_NaN();
+  mIsSetNumber = false;
+  mPoint.clear();
+}
+
+/** @endcond */
+
+
+
 /** @cond doxygenlibTSBInternal */
 
 /*
@@ -366,7 +551,15 @@ TSBComment::accept(TSBVisitor& v) const
 void
 TSBComment::setTSBDocument(TSBDocument* d)
 {
+  // keep the contributor in the string pool of the new document
+  bool moved = (d != NULL && d != mTSB);
+
   TSBBase::setTSBDocument(d);
+
+  if (moved && mContributor != NULL)
+  {
+    mContributor = internString(mContributor);
+  }
 }
 
 /** @endcond */
@@ -670,6 +863,49 @@ TSBComment::addExpectedAttributes(
 /** @endcond */
 
 
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Feeds the attributes of this TSBComment to the hasher
+ */
+void
+TSBComment::hashContent(TSBContentHasher& hasher) const
+{
+  TSBBase::hashContent(hasher);
+
+  hasher.addString(getContributor());
+  hasher.addBool(mIsSetNumber);
+  if (mIsSetNumber)
+  {
+    hasher.addDouble(mNumber);
+  }
+  hasher.addString(mPoint);
+}
+
+/** @endcond */
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Returns the expected attributes shared by all TSBComment objects
+ */
+const ExpectedAttributes*
+TSBComment::getStaticExpectedAttributes() const
+{
+  // a class derived from TSBComment may expect more attributes
+  if (typeid(*this) != typeid(TSBComment))
+  {
+    return NULL;
+  }
+
+  static const ExpectedAttributes attributes = collectExpectedAttributes();
+  return &attributes;
+}
+
+/** @endcond */
+
+
 
 /** @cond doxygenlibTSBInternal */
 
@@ -686,10 +922,9 @@ TSBComment::readAttributes(
   unsigned int level = getLevel();
   unsigned int version = getVersion();
   unsigned int numErrs;
-  bool assigned = false;
   TSBErrorLog* log = getErrorLog();
 
-  if (log && getParentTSBObject() &&
+  if (log && !skipReadChecks() && getParentTSBObject() &&
     static_cast<TSBListOfComments*>(getParentTSBObject())->size() < 2)
   {
     numErrs = log->getNumErrors();
@@ -705,88 +940,26 @@ TSBComment::readAttributes(
     }
   }
 
-  TSBBase::readAttributes(attributes, expectedAttributes);
-
-  if (log)
-  {
-    numErrs = log->getNumErrors();
-
-    for (int n = numErrs-1; n >= 0; n--)
-    {
-      if (log->getError(n)->getErrorId() == TSBUnknownCoreAttribute)
-      {
-        const std::string details = log->getError(n)->getMessage();
-        log->remove(TSBUnknownCoreAttribute);
-        log->logError(TsbCommentAllowedAttributes, level, version, details,
-          getLine(), getColumn());
-      }
-    }
-  }
-
-  // 
-  // contributor string (use = "required" )
-  // 
-
-  assigned = attributes.readInto("contributor", mContributor);
-
-  if (assigned == true)
+  static constexpr TSBAttributeSpec<TSBComment> table[] =
   {
-    if (mContributor.empty() == true)
-    {
-      logEmptyString(mContributor, level, version, "<TSBComment>");
-    }
-  }
-  else
-  {
-    if (log)
-    {
-      std::string message = "Tsb attribute 'contributor' is missing from the "
-        "<TSBComment> element.";
-      log->logError(TsbCommentAllowedAttributes, level, version, message,
-        getLine(), getColumn());
-    }
-  }
-
-  // 
-  // number double (use = "required" )
-  // 
-
-  numErrs = log ? log->getNumErrors() : 0;
-  mIsSetNumber = attributes.readInto("number", mNumber);
-
-  if ( mIsSetNumber == false && log)
-  {
-    if (log && log->getNumErrors() == numErrs + 1 &&
-      log->contains(XMLAttributeTypeMismatch))
-    {
-      log->remove(XMLAttributeTypeMismatch);
-      std::string message = "Tsb attribute 'number' from the <TSBComment> "
-        "element must be an integer.";
-      log->logError(TsbCommentNumberMustBeDouble, level, version, message,
-        getLine(), getColumn());
-    }
-    else
-    {
-      std::string message = "Tsb attribute 'number' is missing from the "
-        "<TSBComment> element.";
-      log->logError(TsbCommentAllowedAttributes, level, version, message,
-        getLine(), getColumn());
-    }
-  }
-
-  // 
-  // point string (use = "optional" )
-  // 
-
-  assigned = attributes.readInto("point", mPoint);
-
-  if (assigned == true)
-  {
-    if (mPoint.empty() == true)
-    {
-      logEmptyString(mPoint, level, version, "<TSBComment>");
-    }
-  }
+    { "contributor", TSB_ATTRIBUTE_POOLED_STRING, true,
+      TsbCommentAllowedAttributes, TsbCommentAllowedAttributes,
+      NULL, NULL, NULL, NULL, &TSBComment::mContributor },
+    { "number", TSB_ATTRIBUTE_DOUBLE, true,
+      TsbCommentAllowedAttributes, TsbCommentNumberMustBeDouble,
+      NULL, &TSBComment::mNumber, NULL, &TSBComment::mIsSetNumber, NULL },
+    { "point", TSB_ATTRIBUTE_STRING, false,
+      TsbCommentAllowedAttributes, TsbCommentAllowedAttributes,
+      &TSBComment::mPoint, NULL, NULL, NULL, NULL }
+  };
+
+  TSBListOfComments* list = getIndexingList();
+  if (list != NULL) list->unindexComment(this);
+
+  readAttributeTable(attributes, expectedAttributes, table, "<TSBComment>",
+                     TsbCommentAllowedAttributes);
+
+  if (list != NULL) list->indexComment(this);
 }
 
 /** @endcond */
@@ -799,24 +972,26 @@ TSBComment::readAttributes(
  * Writes the attributes to the stream
  */
 void
-TSBComment::writeAttributes( XMLOutputStream&
-  stream) const
+TSBComment::writeAttributes( XMLOutputStream& stream,
+  TSBWriteContext& context) const
 {
-  TSBBase::writeAttributes(stream);
+  TSBBase::writeAttributes(stream, context);
+
+  const std::string prefix = context.getPrefix(this);
 
   if (isSetContributor() == true)
   {
-    stream.writeAttribute("contributor", getPrefix(), mContributor);
+    stream.writeAttribute("contributor", prefix, *mContributor);
   }
 
   if (isSetNumber() == true)
   {
-    stream.writeAttribute("number", getPrefix(), mNumber);
+    stream.writeAttribute("number", prefix, mNumber);
   }
 
   if (isSetPoint() == true)
   {
-    stream.writeAttribute("point", getPrefix(), mPoint);
+    stream.writeAttribute("point", prefix, mPoint);
   }
 }
 
@@ -928,6 +1103,20 @@ TSBComment_isSetContributor(const TSBComment_t * tsbc)
 }
 
 
+/*
+ * Predicate returning @c 1 (true) if two TSBComment_t structures have the
+ * same "contributor" attribute.
+ */
+LIBTSB_EXTERN
+int
+TSBComment_hasSameContributor(const TSBComment_t * tsbc,
+                              const TSBComment_t * other)
+{
+  return (tsbc != NULL && other != NULL) ?
+    static_cast<int>(tsbc->hasSameContributor(*other)) : 0;
+}
+
+
 /*
  * Predicate returning @c 1 (true) if this TSBComment_t's "number" attribute is
  * set.
@@ -58,6 +58,8 @@
 
 LIBTSB_CPP_NAMESPACE_BEGIN
 
+class TSBListOfComments;
+
 
 class LIBTSB_EXTERN TSBComment : public TSBBase
 {
@@ -65,11 +67,23 @@ protected:
 
   /** @cond doxygenlibTSBInternal */
 
-  std::string mContributor;
+  TSBPooledString mContributor;
   double mNumber;
   bool mIsSetNumber;
   std::string mPoint;
 
+
+  /**
+   * Creates a new TSBComment that is about to be added to @p parent while
+   * a document is read.  It shares the TSBNamespaces of the document
+   * instead of starting with its own copy.
+   */
+  TSBComment(const TSBBase* parent);
+
+  friend class TSBListOfComments;
+  friend class TSBBinaryFormat;
+  friend class TSBDocumentDiff;
+
   /** @endcond */
 
 public:
@@ -115,6 +129,24 @@ public:
   TSBComment& operator=(const TSBComment& rhs);
 
 
+#ifndef SWIG
+  /**
+   * Move constructor for TSBComment.
+   *
+   * @param orig the TSBComment instance to move from.
+   */
+  TSBComment(TSBComment&& orig) noexcept;
+
+
+  /**
+   * Move assignment operator for TSBComment.
+   *
+   * @param rhs the TSBComment object whose values are moved into this one.
+   */
+  TSBComment& operator=(TSBComment&& rhs) noexcept;
+#endif /* !SWIG */
+
+
   /**
    * Creates and returns a deep copy of this TSBComment object.
    *
@@ -165,6 +197,22 @@ public:
   bool isSetContributor() const;
 
 
+  /**
+   * Predicate returning @c true if this TSBComment and @p other have the
+   * same "contributor" attribute.
+   *
+   * The contributors of the comments of a TSBDocument are kept in its
+   * string pool, so for two comments of the same document this compares
+   * two pointers rather than two strings.
+   *
+   * @param other the TSBComment to compare with.
+   *
+   * @return @c true if both contributors are unset or equal, otherwise
+   * @c false is returned.
+   */
+  bool hasSameContributor(const TSBComment& other) const;
+
+
   /**
    * Predicate returning @c true if this TSBComment's "number" attribute is
    * set.
@@ -301,8 +349,22 @@ public:
   /**
    * Write any contained elements
    */
-  virtual void writeElements( XMLOutputStream&
-    stream) const;
+  virtual void writeElements( XMLOutputStream& stream,
+    TSBWriteContext& context) const;
+
+  using TSBBase::writeElements;
+
+  /** @endcond */
+
+
+
+  /** @cond doxygenlibTSBInternal */
+
+  /**
+   * Returns this TSBComment to the state of a newly created one, keeping
+   * the storage of its strings.
+   */
+  virtual void reinitialize(const TSBBase* parent);
 
   /** @endcond */
 
@@ -584,6 +646,28 @@ protected:
 
 
 
+  /** @cond doxygenlibTSBInternal */
+
+  /**
+   * Feeds the attributes of this TSBComment to the hasher
+   */
+  virtual void hashContent(TSBContentHasher& hasher) const;
+
+  /** @endcond */
+
+
+
+  /** @cond doxygenlibTSBInternal */
+
+  /**
+   * Returns the expected attributes shared by all TSBComment objects
+   */
+  virtual const ExpectedAttributes* getStaticExpectedAttributes() const;
+
+  /** @endcond */
+
+
+
   /** @cond doxygenlibTSBInternal */
 
   /**
@@ -604,8 +688,22 @@ protected:
   /**
    * Writes the attributes to the stream
    */
-  virtual void writeAttributes( XMLOutputStream&
-    stream) const;
+  virtual void writeAttributes( XMLOutputStream& stream,
+    TSBWriteContext& context) const;
+
+  using TSBBase::writeAttributes;
+
+  /** @endcond */
+
+
+
+  /** @cond doxygenlibTSBInternal */
+
+  /**
+   * Returns the list holding this TSBComment if that list is indexed, so
+   * that it can be told when the contributor or number changes.
+   */
+  TSBListOfComments* getIndexingList() const;
 
   /** @endcond */
 
@@ -749,6 +847,25 @@ int
 TSBComment_isSetContributor(const TSBComment_t * tsbc);
 
 
+/**
+ * Predicate returning @c 1 (true) if two TSBComment_t structures have the
+ * same "contributor" attribute.
+ *
+ * @param tsbc the TSBComment_t structure.
+ *
+ * @param other the TSBComment_t structure to compare with.
+ *
+ * @return @c 1 (true) if both contributors are unset or equal, otherwise
+ * @c 0 (false) is returned.
+ *
+ * @memberof TSBComment_t
+ */
+LIBTSB_EXTERN
+int
+TSBComment_hasSameContributor(const TSBComment_t * tsbc,
+                              const TSBComment_t * other);
+
+
 /**
  * Predicate returning @c 1 (true) if this TSBComment_t's "number" attribute is
  * set.
@@ -0,0 +1,464 @@
+/**
+ * @file TSBCommentColumns.cpp
+ * @brief Implementation of the TSBCommentColumns class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+
+
+#include <tsb/TSBCommentColumns.h>
+#include <tsb/TSBDocument.h>
+#include <tsb/util/util.h>
+
+#include <limits>
+#include <unordered_map>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+ || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TSB_COLUMNS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/*
+ * Creates empty columns.
+ */
+TSBCommentColumns::TSBCommentColumns()
+  : mNumbers()
+  , mNumberValidity()
+  , mContributors()
+  , mContributorCodes()
+  , mPointData()
+  , mPointOffsets(1, 0)
+{
+}
+
+
+/*
+ * Creates the columns of the comments of document.
+ */
+TSBCommentColumns::TSBCommentColumns(const TSBDocument& document)
+  : mNumbers()
+  , mNumberValidity()
+  , mContributors()
+  , mContributorCodes()
+  , mPointData()
+  , mPointOffsets()
+{
+  assign(*document.getListOfComments());
+}
+
+
+/*
+ * Creates the columns of the comments in list.
+ */
+TSBCommentColumns::TSBCommentColumns(const TSBListOfComments& list)
+  : mNumbers()
+  , mNumberValidity()
+  , mContributors()
+  , mContributorCodes()
+  , mPointData()
+  , mPointOffsets()
+{
+  assign(list);
+}
+
+
+/*
+ * Copies the comments in list into the columns, in one pass.
+ */
+void
+TSBCommentColumns::assign(const TSBListOfComments& list)
+{
+  const unsigned int numComments = list.size();
+
+  mNumbers.clear();
+  mNumberValidity.assign((numComments + 63) / 64, 0);
+  mContributors.clear();
+  mContributorCodes.clear();
+  mPointData.clear();
+  mPointOffsets.clear();
+
+  mNumbers.reserve(numComments);
+  mContributorCodes.reserve(numComments);
+  mPointOffsets.reserve(numComments + 1);
+  mPointOffsets.push_back(0);
+
+  // comments of one document share their pooled contributor strings, so
+  // most lookups are by address; equal strings stored apart are matched
+  // by value
+  unordered_map<const string*, unsigned int> codesByAddress;
+  unordered_map<string, unsigned int> codes;
+
+  for (unsigned int n = 0; n < numComments; ++n)
+  {
+    const TSBComment* comment = list.get(n);
+
+    if (comment->isSetNumber())
+    {
+      mNumbers.push_back(comment->getNumber());
+      mNumberValidity[n / 64] |= (uint64_t)1 << (n % 64);
+    }
+    else
+    {
+      mNumbers.push_back(tsb_util_NaN());
+    }
+
+    const string& contributor = comment->getContributor();
+    unordered_map<const string*, unsigned int>::const_iterator known =
+      codesByAddress.find(&contributor);
+
+    if (known == codesByAddress.end())
+    {
+      unordered_map<string, unsigned int>::const_iterator it =
+        codes.find(contributor);
+
+      if (it == codes.end())
+      {
+        it = codes.insert(make_pair(contributor,
+                                    (unsigned int)mContributors.size())).first;
+        mContributors.push_back(contributor);
+      }
+      known = codesByAddress.insert(make_pair(&contributor, it->second)).first;
+    }
+    mContributorCodes.push_back(known->second);
+
+    mPointData += comment->getPoint();
+    mPointOffsets.push_back(mPointData.size());
+  }
+}
+
+
+unsigned int
+TSBCommentColumns::getNumComments() const
+{
+  return (unsigned int)mNumbers.size();
+}
+
+
+const double*
+TSBCommentColumns::getNumbers() const
+{
+  return mNumbers.empty() ? NULL : &mNumbers[0];
+}
+
+
+const uint64_t*
+TSBCommentColumns::getNumberValidity() const
+{
+  return mNumberValidity.empty() ? NULL : &mNumberValidity[0];
+}
+
+
+bool
+TSBCommentColumns::isSetNumber(unsigned int n) const
+{
+  if (n >= mNumbers.size())
+  {
+    return false;
+  }
+
+  return ((mNumberValidity[n / 64] >> (n % 64)) & 1) != 0;
+}
+
+
+unsigned int
+TSBCommentColumns::getNumContributors() const
+{
+  return (unsigned int)mContributors.size();
+}
+
+
+const string&
+TSBCommentColumns::getContributor(unsigned int code) const
+{
+  static const string empty;
+  return (code < mContributors.size()) ? mContributors[code] : empty;
+}
+
+
+const unsigned int*
+TSBCommentColumns::getContributorCodes() const
+{
+  return mContributorCodes.empty() ? NULL : &mContributorCodes[0];
+}
+
+
+string
+TSBCommentColumns::getPoint(unsigned int n) const
+{
+  if (n >= mNumbers.size())
+  {
+    return string();
+  }
+
+  return mPointData.substr(mPointOffsets[n],
+                           mPointOffsets[n + 1] - mPointOffsets[n]);
+}
+
+
+const string&
+TSBCommentColumns::getPointData() const
+{
+  return mPointData;
+}
+
+
+const size_t*
+TSBCommentColumns::getPointOffsets() const
+{
+  return &mPointOffsets[0];
+}
+
+
+/*
+ * The aggregates skip NaN, which is how unset numbers are stored, so they
+ * never need to look at the validity bitmap.  The SSE2 versions handle two
+ * vectors of two numbers per iteration; the portable versions keep four
+ * independent accumulators, which gives the same additions in the same
+ * order as the SSE2 lanes and lets the compiler overlap them.
+ */
+
+unsigned int
+TSBCommentColumns::countNumbers() const
+{
+  const double* numbers = getNumbers();
+  const size_t size = mNumbers.size();
+  size_t n = 0;
+  unsigned int count = 0;
+
+#ifdef TSB_COLUMNS_USE_SSE2
+  for (; n + 4 <= size; n += 4)
+  {
+    __m128d a = _mm_loadu_pd(numbers + n);
+    __m128d b = _mm_loadu_pd(numbers + n + 2);
+    int mask = _mm_movemask_pd(_mm_cmpord_pd(a, a))
+             | (_mm_movemask_pd(_mm_cmpord_pd(b, b)) << 2);
+    count += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1)
+             + ((mask >> 3) & 1);
+  }
+#endif
+
+  for (; n < size; ++n)
+  {
+    if (numbers[n] == numbers[n]) ++count;
+  }
+
+  return count;
+}
+
+
+double
+TSBCommentColumns::sumNumbers() const
+{
+  const double* numbers = getNumbers();
+  const size_t size = mNumbers.size();
+  size_t n = 0;
+  double lanes[4] = { 0, 0, 0, 0 };
+
+#ifdef TSB_COLUMNS_USE_SSE2
+  __m128d sum01 = _mm_setzero_pd();
+  __m128d sum23 = _mm_setzero_pd();
+
+  for (; n + 4 <= size; n += 4)
+  {
+    __m128d a = _mm_loadu_pd(numbers + n);
+    __m128d b = _mm_loadu_pd(numbers + n + 2);
+    sum01 = _mm_add_pd(sum01, _mm_and_pd(_mm_cmpord_pd(a, a), a));
+    sum23 = _mm_add_pd(sum23, _mm_and_pd(_mm_cmpord_pd(b, b), b));
+  }
+
+  _mm_storeu_pd(lanes, sum01);
+  _mm_storeu_pd(lanes + 2, sum23);
+#else
+  for (; n + 4 <= size; n += 4)
+  {
+    for (unsigned int lane = 0; lane < 4; ++lane)
+    {
+      const double x = numbers[n + lane];
+      if (x == x) lanes[lane] += x;
+    }
+  }
+#endif
+
+  for (unsigned int lane = 0; n < size; ++n, ++lane)
+  {
+    if (numbers[n] == numbers[n]) lanes[lane] += numbers[n];
+  }
+
+  return (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+}
+
+
+/** @cond doxygenlibTSBInternal */
+/*
+ * Returns the smallest (or, if largest is true, the largest) number that is
+ * not NaN, or NaN if there is none.
+ */
+static double
+findExtreme(const double* numbers, size_t size, bool largest)
+{
+  const double infinity = numeric_limits<double>::infinity();
+  const double start = largest ? -infinity : infinity;
+  double lanes[4] = { start, start, start, start };
+  bool found = false;
+  size_t n = 0;
+
+#ifdef TSB_COLUMNS_USE_SSE2
+  const __m128d fill = _mm_set1_pd(start);
+  __m128d best01 = fill;
+  __m128d best23 = fill;
+  int valid = 0;
+
+  for (; n + 4 <= size; n += 4)
+  {
+    __m128d a = _mm_loadu_pd(numbers + n);
+    __m128d b = _mm_loadu_pd(numbers + n + 2);
+    __m128d maskA = _mm_cmpord_pd(a, a);
+    __m128d maskB = _mm_cmpord_pd(b, b);
+
+    // NaN lanes are replaced by the starting value
+    a = _mm_or_pd(_mm_and_pd(maskA, a), _mm_andnot_pd(maskA, fill));
+    b = _mm_or_pd(_mm_and_pd(maskB, b), _mm_andnot_pd(maskB, fill));
+
+    best01 = largest ? _mm_max_pd(best01, a) : _mm_min_pd(best01, a);
+    best23 = largest ? _mm_max_pd(best23, b) : _mm_min_pd(best23, b);
+    valid |= _mm_movemask_pd(maskA) | _mm_movemask_pd(maskB);
+  }
+
+  _mm_storeu_pd(lanes, best01);
+  _mm_storeu_pd(lanes + 2, best23);
+  found = (valid != 0);
+#else
+  for (; n + 4 <= size; n += 4)
+  {
+    for (unsigned int lane = 0; lane < 4; ++lane)
+    {
+      const double x = numbers[n + lane];
+      if (x != x) continue;
+
+      found = true;
+      if (largest ? (x > lanes[lane]) : (x < lanes[lane])) lanes[lane] = x;
+    }
+  }
+#endif
+
+  for (; n < size; ++n)
+  {
+    const double x = numbers[n];
+    if (x != x) continue;
+
+    found = true;
+    if (largest ? (x > lanes[0]) : (x < lanes[0])) lanes[0] = x;
+  }
+
+  if (!found)
+  {
+    return tsb_util_NaN();
+  }
+
+  double best = lanes[0];
+  for (unsigned int lane = 1; lane < 4; ++lane)
+  {
+    if (largest ? (lanes[lane] > best) : (lanes[lane] < best))
+    {
+      best = lanes[lane];
+    }
+  }
+
+  return best;
+}
+/** @endcond */
+
+
+double
+TSBCommentColumns::minNumber() const
+{
+  return findExtreme(getNumbers(), mNumbers.size(), false);
+}
+
+
+double
+TSBCommentColumns::maxNumber() const
+{
+  return findExtreme(getNumbers(), mNumbers.size(), true);
+}
+
+
+std::vector<unsigned int>
+TSBCommentColumns::histogram(double min, double max,
+                             unsigned int numBins) const
+{
+  vector<unsigned int> counts;
+
+  if (numBins == 0 || !(min < max))
+  {
+    return counts;
+  }
+
+  counts.assign(numBins, 0);
+
+  const double* numbers = getNumbers();
+  const double scale = numBins / (max - min);
+
+  for (size_t n = 0; n < mNumbers.size(); ++n)
+  {
+    const double x = numbers[n];
+
+    // false for NaN as well as for numbers outside the range
+    if (!(x >= min && x <= max)) continue;
+
+    unsigned int bin = (unsigned int)((x - min) * scale);
+    if (bin >= numBins) bin = numBins - 1;
+    ++counts[bin];
+  }
+
+  return counts;
+}
+
+
+#endif /* __cplusplus */
+
+
+LIBTSB_CPP_NAMESPACE_END
@@ -0,0 +1,283 @@
+/**
+ * @file TSBCommentColumns.h
+ * @brief Definition of the TSBCommentColumns class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class TSBCommentColumns
+ * @sbmlbrief{} Column-wise copy of the comments of a document, for analysis.
+ *
+ * A TSBListOfComments holds a pointer to each TSBComment, and every comment
+ * is a separate object, so a loop over the numbers of a large document
+ * follows a pointer and touches a whole object for every value it reads.
+ * A TSBCommentColumns copies the attributes of all the comments, in one
+ * pass, into one contiguous array per attribute:
+ *
+ * @li the numbers, as an array of @c double, with a bitmap recording
+ * which of them are set.  Unset numbers are stored as NaN.
+ * @li the contributors, dictionary-encoded: each distinct contributor is
+ * stored once and every comment has the code of its contributor.  Codes
+ * are given in order of first appearance.
+ * @li the points, packed one after the other in a single buffer, comment
+ * @em i occupying the bytes from offset @em i to offset @em i+1.
+ *
+ * The columns are a copy: they do not change when the document does.  The
+ * aggregate methods read the number column with SIMD instructions where the
+ * compiler targets SSE2, and with an equivalent portable loop otherwise.
+ */
+
+
+#ifndef TSBCommentColumns_H__
+#define TSBCommentColumns_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+
+
+#ifdef __cplusplus
+
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+class TSBDocument;
+class TSBListOfComments;
+
+
+#ifndef SWIG
+class LIBTSB_EXTERN TSBCommentColumns
+{
+public:
+
+  /**
+   * Creates empty columns.
+   */
+  TSBCommentColumns();
+
+
+  /**
+   * Creates the columns of the comments of the given document.
+   *
+   * @param document the document whose comments are copied.
+   */
+  TSBCommentColumns(const TSBDocument& document);
+
+
+  /**
+   * Creates the columns of the comments in the given list.
+   *
+   * @param list the list whose comments are copied.
+   */
+  TSBCommentColumns(const TSBListOfComments& list);
+
+
+  /**
+   * Replaces the content of these columns with the comments in the given
+   * list, reusing the storage already allocated.
+   *
+   * @param list the list whose comments are copied.
+   */
+  void assign(const TSBListOfComments& list);
+
+
+  /**
+   * Returns the number of comments in these columns.
+   *
+   * @return the number of comments.
+   */
+  unsigned int getNumComments() const;
+
+
+  /**
+   * Returns the number column.
+   *
+   * @return a pointer to getNumComments() numbers, NaN for those that are
+   * not set, or @c NULL if there are no comments.
+   */
+  const double* getNumbers() const;
+
+
+  /**
+   * Returns the bitmap recording which numbers are set.
+   *
+   * Bit <code>i % 64</code> of word <code>i / 64</code> is set if the
+   * number of comment @em i is set.
+   *
+   * @return a pointer to <code>(getNumComments() + 63) / 64</code> words,
+   * or @c NULL if there are no comments.
+   */
+  const uint64_t* getNumberValidity() const;
+
+
+  /**
+   * Predicate returning @c true if the number of the given comment is set.
+   *
+   * @param n the index of the comment.
+   *
+   * @return @c true if the number of comment @p n is set, @c false if it
+   * is not or if there is no such comment.
+   */
+  bool isSetNumber(unsigned int n) const;
+
+
+  /**
+   * Returns the number of distinct contributors.
+   *
+   * @return the size of the contributor dictionary.  An unset contributor
+   * is the empty string, which is a contributor like any other here.
+   */
+  unsigned int getNumContributors() const;
+
+
+  /**
+   * Returns the contributor with the given code.
+   *
+   * @param code a code from getContributorCodes().
+   *
+   * @return the contributor, or an empty string if there is no such code.
+   */
+  const std::string& getContributor(unsigned int code) const;
+
+
+  /**
+   * Returns the contributor column.
+   *
+   * @return a pointer to the getNumComments() codes of the contributors,
+   * or @c NULL if there are no comments.
+   */
+  const unsigned int* getContributorCodes() const;
+
+
+  /**
+   * Returns the point of the given comment.
+   *
+   * @param n the index of the comment.
+   *
+   * @return a copy of the point of comment @p n, empty if there is no
+   * such comment.
+   */
+  std::string getPoint(unsigned int n) const;
+
+
+  /**
+   * Returns the buffer holding the points of all the comments.
+   *
+   * @return the points, one after the other and without separators.
+   */
+  const std::string& getPointData() const;
+
+
+  /**
+   * Returns the offsets of the points in getPointData().
+   *
+   * @return a pointer to getNumComments() + 1 offsets.
+   */
+  const size_t* getPointOffsets() const;
+
+
+  /**
+   * Returns the number of set numbers that are not NaN.
+   *
+   * @return the number of values the aggregates below are computed over.
+   */
+  unsigned int countNumbers() const;
+
+
+  /**
+   * Returns the sum of the set numbers, skipping NaN.
+   *
+   * The numbers are added in several lanes that are summed at the end, so
+   * the result may differ in the last bits from a sequential sum.
+   *
+   * @return the sum, @c 0 if no number is set.
+   */
+  double sumNumbers() const;
+
+
+  /**
+   * Returns the smallest set number, skipping NaN.
+   *
+   * @return the minimum, or NaN if no number is set.
+   */
+  double minNumber() const;
+
+
+  /**
+   * Returns the largest set number, skipping NaN.
+   *
+   * @return the maximum, or NaN if no number is set.
+   */
+  double maxNumber() const;
+
+
+  /**
+   * Counts the set numbers in each of @p numBins bins of equal width
+   * covering [@p min, @p max].
+   *
+   * Bin @em k counts the numbers in
+   * <code>[min + k * width, min + (k + 1) * width)</code>; the last bin
+   * also counts the numbers equal to @p max.  Numbers outside the range,
+   * and NaN, are not counted.
+   *
+   * @param min the lower bound of the first bin.
+   * @param max the upper bound of the last bin.
+   * @param numBins the number of bins.
+   *
+   * @return the counts, empty if @p numBins is zero or if @p min is not
+   * smaller than @p max.
+   */
+  std::vector<unsigned int> histogram(double min, double max,
+                                      unsigned int numBins) const;
+
+
+private:
+
+  std::vector<double> mNumbers;
+  std::vector<uint64_t> mNumberValidity;
+  std::vector<std::string> mContributors;
+  std::vector<unsigned int> mContributorCodes;
+  std::string mPointData;
+  std::vector<size_t> mPointOffsets;
+};
+#endif /* !SWIG */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+#endif /* !TSBCommentColumns_H__ */
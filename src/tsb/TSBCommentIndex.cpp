@@ -0,0 +1,201 @@
+/**
+ * @file TSBCommentIndex.cpp
+ * @brief Implementation of the TSBCommentIndex class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+
+
+#include <tsb/TSBCommentIndex.h>
+#include <tsb/TSBComment.h>
+#include <tsb/TSBListOf.h>
+
+#include <cmath>
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Returns true if the number of the comment can be ordered.
+ */
+static bool
+hasOrderedNumber(const TSBComment* comment)
+{
+  return comment->isSetNumber() && !std::isnan(comment->getNumber());
+}
+
+
+/*
+ * Creates an index of the comments in list.
+ */
+TSBCommentIndex::TSBCommentIndex(const TSBListOf& list)
+  : mByContributor()
+  , mByNumber()
+{
+  rebuild(list);
+}
+
+
+/*
+ * Adds the comment under its current contributor and number.
+ */
+void
+TSBCommentIndex::add(const TSBComment* comment)
+{
+  TSBComment* item = const_cast<TSBComment*>(comment);
+
+  if (comment->isSetContributor())
+  {
+    mByContributor.insert(make_pair(comment->getContributor(), item));
+  }
+
+  if (hasOrderedNumber(comment))
+  {
+    mByNumber.insert(make_pair(comment->getNumber(), item));
+  }
+}
+
+
+/*
+ * Removes the comment from under its current contributor and number.
+ */
+void
+TSBCommentIndex::remove(const TSBComment* comment)
+{
+  if (comment->isSetContributor())
+  {
+    pair<ContributorMap::iterator, ContributorMap::iterator> range =
+      mByContributor.equal_range(comment->getContributor());
+
+    for (ContributorMap::iterator it = range.first; it != range.second; ++it)
+    {
+      if (it->second == comment)
+      {
+        mByContributor.erase(it);
+        break;
+      }
+    }
+  }
+
+  if (hasOrderedNumber(comment))
+  {
+    pair<NumberMap::iterator, NumberMap::iterator> range =
+      mByNumber.equal_range(comment->getNumber());
+
+    for (NumberMap::iterator it = range.first; it != range.second; ++it)
+    {
+      if (it->second == comment)
+      {
+        mByNumber.erase(it);
+        break;
+      }
+    }
+  }
+}
+
+
+/*
+ * Replaces the content of this index with the comments in list.
+ */
+void
+TSBCommentIndex::rebuild(const TSBListOf& list)
+{
+  mByContributor.clear();
+  mByNumber.clear();
+
+  mByContributor.reserve(list.size());
+
+  for (unsigned int n = 0; n < list.size(); ++n)
+  {
+    add(static_cast<const TSBComment*>(list.get(n)));
+  }
+}
+
+
+/*
+ * Appends the comments with the given contributor to result.
+ */
+void
+TSBCommentIndex::getByContributor(const string& contributor,
+                                  vector<TSBComment*>& result) const
+{
+  pair<ContributorMap::const_iterator, ContributorMap::const_iterator> range =
+    mByContributor.equal_range(contributor);
+
+  for (ContributorMap::const_iterator it = range.first;
+       it != range.second; ++it)
+  {
+    result.push_back(it->second);
+  }
+}
+
+
+/*
+ * Appends the comments whose number lies in [min, max] to result.
+ */
+void
+TSBCommentIndex::getInNumberRange(double min, double max,
+                                  vector<TSBComment*>& result) const
+{
+  if (!(min <= max))
+  {
+    return;
+  }
+
+  NumberMap::const_iterator end = mByNumber.upper_bound(max);
+
+  for (NumberMap::const_iterator it = mByNumber.lower_bound(min);
+       it != end; ++it)
+  {
+    result.push_back(it->second);
+  }
+}
+
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+LIBTSB_CPP_NAMESPACE_END
@@ -0,0 +1,138 @@
+/**
+ * @file TSBCommentIndex.h
+ * @brief Definition of the TSBCommentIndex class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class TSBCommentIndex
+ * @sbmlbrief{} Secondary indexes on the comments of a TSBListOfComments.
+ *
+ * A TSBCommentIndex is created by TSBListOfComments::setIndexed().  It maps
+ * each contributor to the comments that have it and keeps the comments in
+ * the order of their numbers, so that TSBListOfComments can answer queries
+ * on either attribute without looking at every comment.  Comments whose
+ * contributor is not set are left out of the first index, and comments
+ * whose number is not set, or is NaN, are left out of the second.
+ *
+ * The list keeps the index up to date: it adds and removes comments as they
+ * enter and leave it, and a TSBComment in an indexed list removes itself
+ * before its contributor or number changes and adds itself back after.
+ */
+
+
+#ifndef TSBCommentIndex_H__
+#define TSBCommentIndex_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+
+
+#ifdef __cplusplus
+
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+class TSBComment;
+class TSBListOf;
+
+
+/** @cond doxygenlibTSBInternal */
+#ifndef SWIG
+class LIBTSB_EXTERN TSBCommentIndex
+{
+public:
+
+  /**
+   * Creates an index of the comments in the given list.
+   */
+  TSBCommentIndex(const TSBListOf& list);
+
+
+  /**
+   * Adds the given comment under its current contributor and number.
+   */
+  void add(const TSBComment* comment);
+
+
+  /**
+   * Removes the given comment, which must be indexed under its current
+   * contributor and number.
+   */
+  void remove(const TSBComment* comment);
+
+
+  /**
+   * Replaces the content of this index with the comments in the given list.
+   */
+  void rebuild(const TSBListOf& list);
+
+
+  /**
+   * Appends the comments with the given contributor to result, in no
+   * particular order.
+   */
+  void getByContributor(const std::string& contributor,
+                        std::vector<TSBComment*>& result) const;
+
+
+  /**
+   * Appends the comments whose number lies between min and max, both
+   * included, to result in increasing order of number.
+   */
+  void getInNumberRange(double min, double max,
+                        std::vector<TSBComment*>& result) const;
+
+
+private:
+
+  typedef std::unordered_multimap<std::string, TSBComment*> ContributorMap;
+  typedef std::multimap<double, TSBComment*> NumberMap;
+
+  ContributorMap mByContributor;
+  NumberMap mByNumber;
+};
+#endif /* !SWIG */
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+#endif /* !TSBCommentIndex_H__ */
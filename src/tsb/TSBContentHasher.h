@@ -0,0 +1,160 @@
+/**
+ * @file TSBContentHasher.h
+ * @brief Definition of the TSBContentHasher class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class TSBContentHasher
+ * @sbmlbrief{} Accumulates the content hash of a TSB object.
+ *
+ * TSBBase::getContentHash() feeds the fields of an object to a
+ * TSBContentHasher through the virtual TSBBase::hashContent().  The hash
+ * is 64-bit FNV-1a over a canonical encoding of the fields: integers are
+ * written as eight little-endian bytes, strings as their length followed by
+ * their bytes, and doubles as the bits of their value with every NaN
+ * written alike and -0 written as 0.  The hash of a given content is
+ * therefore the same on every platform and in every run, and may be stored.
+ */
+
+
+#ifndef TSBContentHasher_H__
+#define TSBContentHasher_H__
+
+
+#include <tsb/common/extern.h>
+
+
+#ifdef __cplusplus
+
+
+#include <stdint.h>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+/** @cond doxygenlibTSBInternal */
+#ifndef SWIG
+
+class TSBContentHasher
+{
+public:
+
+  TSBContentHasher() : mHash(14695981039346656037ULL) {}
+
+
+  void addUInt(uint64_t value)
+  {
+    for (unsigned int n = 0; n < 8; ++n)
+    {
+      addByte((unsigned char)(value >> (8 * n)));
+    }
+  }
+
+
+  void addBool(bool value)
+  {
+    addByte(value ? 1 : 0);
+  }
+
+
+  void addString(const std::string& value)
+  {
+    addUInt(value.size());
+    for (size_t n = 0; n < value.size(); ++n)
+    {
+      addByte((unsigned char)value[n]);
+    }
+  }
+
+
+  void addDouble(double value)
+  {
+    if (std::isnan(value))
+    {
+      value = NAN;
+    }
+    else if (value == 0)
+    {
+      value = 0;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    addUInt(bits);
+  }
+
+
+  uint64_t getHash() const
+  {
+    return mHash;
+  }
+
+
+  /*
+   * Mixes the bits of value; used to combine the hashes of the items of
+   * a list with their positions.
+   */
+  static uint64_t mix(uint64_t value)
+  {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+  }
+
+
+private:
+
+  void addByte(unsigned char byte)
+  {
+    mHash ^= byte;
+    mHash *= 1099511628211ULL;
+  }
+
+  uint64_t mHash;
+};
+
+#endif /* !SWIG */
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+
+
+#endif /* !TSBContentHasher_H__ */
@@ -35,7 +35,12 @@
  * ------------------------------------------------------------------------ -->
  */
 #include <tsb/TSBDocument.h>
+#include <tsb/TSBDocumentSnapshot.h>
 #include <xml/XMLInputStream.h>
+#include <typeinfo>
+#include <tsb/TSBWriteContext.h>
+#include <tsb/TSBAttributeTable.h>
+#include <tsb/TSBContentHasher.h>
 
 
 using namespace std;
@@ -59,7 +64,12 @@ TSBDocument::TSBDocument(unsigned int level, unsigned int version)
   , mIsSetLevel (false)
   , mVersion (TSB_INT_MAX)
   , mIsSetVersion (false)
+  , mStringPool ()
   , mComments (level, version)
+  , mSnapshot (NULL)
+  , mLazyParsing (false)
+  , mTrustedInput (false)
+  , mCommentPool (NULL)
 {
   setTSBNamespacesAndOwn(new TSBNamespaces(level, version));
   setLevel(level);
@@ -78,7 +88,12 @@ TSBDocument::TSBDocument(TSBNamespaces *tsbns)
   , mIsSetLevel (false)
   , mVersion (TSB_INT_MAX)
   , mIsSetVersion (false)
+  , mStringPool ()
   , mComments (tsbns)
+  , mSnapshot (NULL)
+  , mLazyParsing (false)
+  , mTrustedInput (false)
+  , mCommentPool (NULL)
 {
   setElementNamespace(tsbns->getURI());
   setLevel(tsbns->getLevel());
@@ -97,7 +112,12 @@ TSBDocument::TSBDocument(const TSBDocument& orig)
   , mIsSetLevel ( orig.mIsSetLevel )
   , mVersion ( orig.mVersion )
   , mIsSetVersion ( orig.mIsSetVersion )
+  , mStringPool ()
   , mComments ( orig.mComments )
+  , mSnapshot (NULL)
+  , mLazyParsing (false)
+  , mTrustedInput (false)
+  , mCommentPool (NULL)
 {
   setTSBDocument(this);
 
@@ -113,11 +133,13 @@ TSBDocument::operator=(const TSBDocument& rhs)
 {
   if (&rhs != this)
   {
+    releaseSnapshot();
     TSBBase::operator=(rhs);
     mLevel = rhs.mLevel;
     mIsSetLevel = rhs.mIsSetLevel;
     mVersion = rhs.mVersion;
     mIsSetVersion = rhs.mIsSetVersion;
+    mStringPool.clear();
     mComments = rhs.mComments;
     connectToChild();
     setTSBDocument(this);
@@ -127,6 +149,57 @@ TSBDocument::operator=(const TSBDocument& rhs)
 }
 
 
+/*
+ * Move constructor for TSBDocument.
+ */
+TSBDocument::TSBDocument(TSBDocument&& orig) noexcept
+  : TSBBase( std::move(orig) )
+  , mLevel ( orig.mLevel )
+  , mIsSetLevel ( orig.mIsSetLevel )
+  , mVersion ( orig.mVersion )
+  , mIsSetVersion ( orig.mIsSetVersion )
+  , mStringPool ( std::move(orig.mStringPool) )
+  , mComments ( std::move(orig.mComments) )
+  , mErrorLog ( std::move(orig.mErrorLog) )
+  , mSnapshot ( orig.mSnapshot )
+  , mLazyParsing (false)
+  , mTrustedInput (false)
+  , mCommentPool (NULL)
+{
+  orig.mSnapshot = NULL;
+  setTSBDocument(this);
+
+  connectToChild();
+}
+
+
+/*
+ * Move assignment operator for TSBDocument.
+ */
+TSBDocument&
+TSBDocument::operator=(TSBDocument&& rhs) noexcept
+{
+  if (&rhs != this)
+  {
+    releaseSnapshot();
+    TSBBase::operator=(std::move(rhs));
+    mLevel = rhs.mLevel;
+    mIsSetLevel = rhs.mIsSetLevel;
+    mVersion = rhs.mVersion;
+    mIsSetVersion = rhs.mIsSetVersion;
+    mStringPool = std::move(rhs.mStringPool);
+    mComments = std::move(rhs.mComments);
+    mErrorLog = std::move(rhs.mErrorLog);
+    mSnapshot = rhs.mSnapshot;
+    rhs.mSnapshot = NULL;
+    connectToChild();
+    setTSBDocument(this);
+  }
+
+  return *this;
+}
+
+
 /*
  * Creates and returns a deep copy of this TSBDocument object.
  */
@@ -142,6 +215,7 @@ TSBDocument::clone() const
  */
 TSBDocument::~TSBDocument()
 {
+  delete mSnapshot;
 }
 
 
@@ -192,6 +266,7 @@ TSBDocument::isSetVersion() const
 int
 TSBDocument::setLevel(unsigned int level)
 {
+  invalidateContentHash();
   mLevel = level;
   mIsSetLevel = true;
 
@@ -210,6 +285,7 @@ TSBDocument::setLevel(unsigned int level)
 int
 TSBDocument::setVersion(unsigned int version)
 {
+  invalidateContentHash();
   mVersion = version;
   mIsSetVersion = true;
 
@@ -228,6 +304,7 @@ TSBDocument::setVersion(unsigned int version)
 int
 TSBDocument::unsetLevel()
 {
+  invalidateContentHash();
   mLevel = TSB_INT_MAX;
   mIsSetLevel = false;
 
@@ -248,6 +325,7 @@ TSBDocument::unsetLevel()
 int
 TSBDocument::unsetVersion()
 {
+  invalidateContentHash();
   mVersion = TSB_INT_MAX;
   mIsSetVersion = false;
 
@@ -336,6 +414,28 @@ TSBDocument::addComment(const TSBComment* tsbc)
 }
 
 
+/*
+ * Adds the given TSBComment to this TSBDocument, taking ownership.
+ */
+int
+TSBDocument::addComment(std::unique_ptr<TSBComment> tsbc)
+{
+  return mComments.addComment(std::move(tsbc));
+}
+
+
+/*
+ * Adds the given TSBComment objects to this TSBDocument, taking ownership of
+ * all of them or of none.
+ */
+int
+TSBDocument::addComments(std::vector<std::unique_ptr<TSBComment> >&&
+  comments)
+{
+  return mComments.addComments(std::move(comments));
+}
+
+
 /*
  * Get the number of TSBComment objects in this TSBDocument.
  */
@@ -372,6 +472,16 @@ TSBDocument::createComment()
 }
 
 
+/*
+ * Creates n new TSBComment objects and adds them to this TSBDocument.
+ */
+int
+TSBDocument::createComments(unsigned int n)
+{
+  return mComments.createComments(n);
+}
+
+
 /*
  * Removes the nth TSBComment from this TSBDocument and returns a pointer to
  * it.
@@ -434,14 +544,14 @@ TSBDocument::hasRequiredAttributes() const
  * Write any contained elements
  */
 void
-TSBDocument::writeElements( XMLOutputStream&
-  stream) const
+TSBDocument::writeElements( XMLOutputStream& stream,
+  TSBWriteContext& context) const
 {
-  TSBBase::writeElements(stream);
+  TSBBase::writeElements(stream, context);
 
   if (getNumComments() > 0)
   {
-    mComments.write(stream);
+    mComments.write(stream, context);
   }
 }
 
@@ -971,6 +1081,194 @@ TSBDocument::getNumErrors(unsigned int severity) const
 }
 
 
+/*
+ * Takes a snapshot of the current state of this TSBDocument.
+ */
+int
+TSBDocument::takeSnapshot()
+{
+  delete mSnapshot;
+  mSnapshot = new TSBDocumentSnapshot(*this);
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+/*
+ * Predicate returning true if a snapshot is held.
+ */
+bool
+TSBDocument::hasSnapshot() const
+{
+  return (mSnapshot != NULL);
+}
+
+
+/*
+ * Restores the state recorded by takeSnapshot().
+ */
+int
+TSBDocument::restoreSnapshot()
+{
+  if (mSnapshot == NULL)
+  {
+    return LIBTSB_OPERATION_FAILED;
+  }
+
+  // detach first so that the restore itself is not recorded
+  TSBDocumentSnapshot* snapshot = mSnapshot;
+  mSnapshot = NULL;
+
+  snapshot->restore(*this);
+  delete snapshot;
+
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+/*
+ * Discards the snapshot.
+ */
+int
+TSBDocument::releaseSnapshot()
+{
+  delete mSnapshot;
+  mSnapshot = NULL;
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+/*
+ * Creates a deep copy of the recorded state.
+ */
+TSBDocument*
+TSBDocument::cloneSnapshot() const
+{
+  if (mSnapshot == NULL)
+  {
+    return NULL;
+  }
+
+  return mSnapshot->createDocument(*this);
+}
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Preserves a comment of this document before it changes.
+ */
+void
+TSBDocument::objectAboutToChange(const TSBBase* object)
+{
+  if (mSnapshot != NULL && object->getParentTSBObject() == &mComments)
+  {
+    mSnapshot->preserve(object);
+  }
+}
+
+
+/*
+ * Sets whether notes and testAnnotation elements are kept unparsed
+ * while this document is read.
+ */
+void
+TSBDocument::setLazyParsing(bool lazy)
+{
+  mLazyParsing = lazy;
+}
+
+
+bool
+TSBDocument::getLazyParsing() const
+{
+  return mLazyParsing;
+}
+
+
+/*
+ * Sets whether the validation checks are skipped while this document is
+ * read.
+ */
+void
+TSBDocument::setTrustedInput(bool trusted)
+{
+  mTrustedInput = trusted;
+}
+
+
+bool
+TSBDocument::getTrustedInput() const
+{
+  return mTrustedInput;
+}
+
+
+/*
+ * Sets the pool the comments read into this document are taken from.
+ */
+void
+TSBDocument::setCommentPool(std::vector<TSBComment*>* pool)
+{
+  mCommentPool = pool;
+}
+
+
+/*
+ * Takes a comment from the pool and reinitializes it for parent.
+ */
+TSBComment*
+TSBDocument::createPooledComment(const TSBBase* parent)
+{
+  if (mCommentPool == NULL || mCommentPool->empty())
+  {
+    return NULL;
+  }
+
+  TSBComment* comment = mCommentPool->back();
+  mCommentPool->pop_back();
+  comment->reinitialize(parent);
+
+  return comment;
+}
+
+
+/*
+ * Returns the string pool of this document.
+ */
+TSBStringPool&
+TSBDocument::getStringPool()
+{
+  return mStringPool;
+}
+
+
+/*
+ * Returns this document to the state of TSBDocument() for reuse.
+ */
+void
+TSBDocument::reset(std::vector<TSBBase*>& items)
+{
+  releaseSnapshot();
+
+  mComments.releaseItems(items);
+  mComments.reinitialize(this);
+  mComments.setIndexed(false);
+  mStringPool.clear();
+  mErrorLog.clearLog();
+
+  clearBaseFields();
+  mIsSetLevel = false;
+  mIsSetVersion = false;
+  setLevel(TSB_DEFAULT_LEVEL);
+  setVersion(TSB_DEFAULT_VERSION);
+  setElementNamespace(getTSBNamespaces()->getURI());
+
+  connectToChild();
+}
+
+/** @endcond */
+
+
 
 /** @cond doxygenlibTSBInternal */
 
@@ -987,7 +1285,7 @@ TSBDocument::createObject( XMLInputStream&
 
   if (name == "listOfComments")
   {
-    if (getErrorLog() && mComments.size() != 0)
+    if (getErrorLog() && mComments.size() != 0 && !skipReadChecks())
     {
       getErrorLog()->logError(TsbDocumentAllowedElements, getLevel(),
         getVersion(), "", getLine(), getColumn());
@@ -996,7 +1294,8 @@ TSBDocument::createObject( XMLInputStream&
     obj = &mComments;
   }
 
-  connectToChild();
+  // mComments is connected to this document when the document is
+  // constructed or assigned, so there is nothing to rewire here
 
   return obj;
 }
@@ -1024,96 +1323,78 @@ TSBDocument::addExpectedAttributes(
 /** @endcond */
 
 
-
 /** @cond doxygenlibTSBInternal */
 
 /*
- * Reads the expected attributes into the member data variables
+ * Feeds the attributes and the comments of this TSBDocument to the hasher
  */
 void
-TSBDocument::readAttributes(
-                            const 
-                              XMLAttributes& attributes,
-                            const 
-                              ExpectedAttributes& expectedAttributes)
+TSBDocument::hashContent(TSBContentHasher& hasher) const
 {
-  unsigned int level = getLevel();
-  unsigned int version = getVersion();
-  unsigned int numErrs;
-  bool assigned = false;
-  TSBErrorLog* log = getErrorLog();
+  TSBBase::hashContent(hasher);
 
-  TSBBase::readAttributes(attributes, expectedAttributes);
-
-  if (log)
+  hasher.addBool(mIsSetLevel);
+  if (mIsSetLevel)
   {
-    numErrs = log->getNumErrors();
-
-    for (int n = numErrs-1; n >= 0; n--)
-    {
-      if (log->getError(n)->getErrorId() == TSBUnknownCoreAttribute)
-      {
-        const std::string details = log->getError(n)->getMessage();
-        log->remove(TSBUnknownCoreAttribute);
-        log->logError(TsbDocumentAllowedAttributes, level, version, details,
-          getLine(), getColumn());
-      }
-    }
+    hasher.addUInt(mLevel);
+  }
+  hasher.addBool(mIsSetVersion);
+  if (mIsSetVersion)
+  {
+    hasher.addUInt(mVersion);
   }
+  hasher.addUInt(mComments.getContentHash());
+}
 
-  // 
-  // level uint (use = "required" )
-  // 
+/** @endcond */
 
-  numErrs = log ? log->getNumErrors() : 0;
-  mIsSetLevel = attributes.readInto("level", mLevel);
 
-  if ( mIsSetLevel == false && log)
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Returns the expected attributes shared by all TSBDocument objects
+ */
+const ExpectedAttributes*
+TSBDocument::getStaticExpectedAttributes() const
+{
+  // a class derived from TSBDocument may expect more attributes
+  if (typeid(*this) != typeid(TSBDocument))
   {
-    if (log && log->getNumErrors() == numErrs + 1 &&
-      log->contains(XMLAttributeTypeMismatch))
-    {
-      log->remove(XMLAttributeTypeMismatch);
-      std::string message = "Tsb attribute 'level' from the <TSBDocument> "
-        "element must be an integer.";
-      log->logError(TsbDocumentLevelMustBeNonNegativeInteger, level, version,
-        message, getLine(), getColumn());
-    }
-    else
-    {
-      std::string message = "Tsb attribute 'level' is missing from the "
-        "<TSBDocument> element.";
-      log->logError(TsbDocumentAllowedAttributes, level, version, message,
-        getLine(), getColumn());
-    }
+    return NULL;
   }
 
-  // 
-  // version uint (use = "required" )
-  // 
+  static const ExpectedAttributes attributes = collectExpectedAttributes();
+  return &attributes;
+}
+
+/** @endcond */
+
+
 
-  numErrs = log ? log->getNumErrors() : 0;
-  mIsSetVersion = attributes.readInto("version", mVersion);
+/** @cond doxygenlibTSBInternal */
 
-  if ( mIsSetVersion == false && log)
+/*
+ * Reads the expected attributes into the member data variables
+ */
+void
+TSBDocument::readAttributes(
+                            const 
+                              XMLAttributes& attributes,
+                            const 
+                              ExpectedAttributes& expectedAttributes)
+{
+  static constexpr TSBAttributeSpec<TSBDocument> table[] =
   {
-    if (log && log->getNumErrors() == numErrs + 1 &&
-      log->contains(XMLAttributeTypeMismatch))
-    {
-      log->remove(XMLAttributeTypeMismatch);
-      std::string message = "Tsb attribute 'version' from the <TSBDocument> "
-        "element must be an integer.";
-      log->logError(TsbDocumentVersionMustBeNonNegativeInteger, level, version,
-        message, getLine(), getColumn());
-    }
-    else
-    {
-      std::string message = "Tsb attribute 'version' is missing from the "
-        "<TSBDocument> element.";
-      log->logError(TsbDocumentAllowedAttributes, level, version, message,
-        getLine(), getColumn());
-    }
-  }
+    { "level", TSB_ATTRIBUTE_UINT, true,
+      TsbDocumentAllowedAttributes, TsbDocumentLevelMustBeNonNegativeInteger,
+      NULL, NULL, &TSBDocument::mLevel, &TSBDocument::mIsSetLevel, NULL },
+    { "version", TSB_ATTRIBUTE_UINT, true,
+      TsbDocumentAllowedAttributes, TsbDocumentVersionMustBeNonNegativeInteger,
+      NULL, NULL, &TSBDocument::mVersion, &TSBDocument::mIsSetVersion, NULL }
+  };
+
+  readAttributeTable(attributes, expectedAttributes, table, "<TSBDocument>",
+                     TsbDocumentAllowedAttributes);
 }
 
 /** @endcond */
@@ -1126,19 +1407,21 @@ TSBDocument::readAttributes(
  * Writes the attributes to the stream
  */
 void
-TSBDocument::writeAttributes( XMLOutputStream&
-  stream) const
+TSBDocument::writeAttributes( XMLOutputStream& stream,
+  TSBWriteContext& context) const
 {
-  TSBBase::writeAttributes(stream);
+  TSBBase::writeAttributes(stream, context);
+
+  const std::string prefix = context.getPrefix(this);
 
   if (isSetLevel() == true)
   {
-    stream.writeAttribute("level", getPrefix(), mLevel);
+    stream.writeAttribute("level", prefix, mLevel);
   }
 
   if (isSetVersion() == true)
   {
-    stream.writeAttribute("version", getPrefix(), mVersion);
+    stream.writeAttribute("version", prefix, mVersion);
   }
 }
 
@@ -1370,6 +1653,17 @@ TSBDocument_createComment(TSBDocument_t* tsbd)
 }
 
 
+/*
+ * Creates n new TSBComment_t objects and adds them to this TSBDocument_t.
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_createComments(TSBDocument_t* tsbd, unsigned int n)
+{
+  return (tsbd != NULL) ? tsbd->createComments(n) : LIBTSB_INVALID_OBJECT;
+}
+
+
 /*
  * Removes the nth TSBComment_t from this TSBDocument_t and returns a pointer
  * to it.
@@ -1394,6 +1688,61 @@ TSBDocument_hasRequiredAttributes(const TSBDocument_t * tsbd)
 }
 
 
+/*
+ * Takes a snapshot of the current state of this TSBDocument_t.
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_takeSnapshot(TSBDocument_t * tsbd)
+{
+  return (tsbd != NULL) ? tsbd->takeSnapshot() : LIBTSB_INVALID_OBJECT;
+}
+
+
+/*
+ * Predicate returning @c 1 (true) if this TSBDocument_t holds a snapshot.
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_hasSnapshot(const TSBDocument_t * tsbd)
+{
+  return (tsbd != NULL) ? static_cast<int>(tsbd->hasSnapshot()) : 0;
+}
+
+
+/*
+ * Restores the state recorded by TSBDocument_takeSnapshot().
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_restoreSnapshot(TSBDocument_t * tsbd)
+{
+  return (tsbd != NULL) ? tsbd->restoreSnapshot() : LIBTSB_INVALID_OBJECT;
+}
+
+
+/*
+ * Discards the snapshot of this TSBDocument_t.
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_releaseSnapshot(TSBDocument_t * tsbd)
+{
+  return (tsbd != NULL) ? tsbd->releaseSnapshot() : LIBTSB_INVALID_OBJECT;
+}
+
+
+/*
+ * Creates a deep copy of the state recorded by TSBDocument_takeSnapshot().
+ */
+LIBTSB_EXTERN
+TSBDocument_t*
+TSBDocument_cloneSnapshot(const TSBDocument_t * tsbd)
+{
+  return (tsbd != NULL) ? tsbd->cloneSnapshot() : NULL;
+}
+
+
 
 
 LIBTSB_CPP_NAMESPACE_END
@@ -60,6 +60,8 @@
 
 LIBTSB_CPP_NAMESPACE_BEGIN
 
+class TSBDocumentSnapshot;
+
 
 class LIBTSB_EXTERN TSBDocument : public TSBBase
 {
@@ -71,8 +73,15 @@ protected:
   bool mIsSetLevel;
   unsigned int mVersion;
   bool mIsSetVersion;
+  TSBStringPool mStringPool;
   TSBListOfComments mComments;
   TSBErrorLog mErrorLog;
+  TSBDocumentSnapshot* mSnapshot;
+  bool mLazyParsing;
+  bool mTrustedInput;
+  std::vector<TSBComment*>* mCommentPool;
+
+  friend class TSBDocumentSnapshot;
 
   /** @endcond */
 
@@ -120,6 +129,25 @@ public:
   TSBDocument& operator=(const TSBDocument& rhs);
 
 
+#ifndef SWIG
+  /**
+   * Move constructor for TSBDocument.
+   *
+   * @param orig the TSBDocument instance to move from.
+   */
+  TSBDocument(TSBDocument&& orig) noexcept;
+
+
+  /**
+   * Move assignment operator for TSBDocument.
+   *
+   * @param rhs the TSBDocument object whose contents are moved into this
+   * one.
+   */
+  TSBDocument& operator=(TSBDocument&& rhs) noexcept;
+#endif /* !SWIG */
+
+
   /**
    * Creates and returns a deep copy of this TSBDocument object.
    *
@@ -320,6 +348,56 @@ public:
   int addComment(const TSBComment* tsbc);
 
 
+#ifndef SWIG
+  /**
+   * Adds the given TSBComment to this TSBDocument, taking ownership of it
+   * instead of copying it.
+   *
+   * If the TSBComment is rejected it is deleted when @p tsbc goes out of
+   * scope.
+   *
+   * @param tsbc the TSBComment object to add.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_NAMESPACES_MISMATCH, OperationReturnValues_t}
+   *
+   * @see addComment(const TSBComment* tsbc)
+   */
+  int addComment(std::unique_ptr<TSBComment> tsbc);
+
+  /**
+   * Adds the given TSBComment objects to the end of this TSBDocument, taking
+   * ownership of them.
+   *
+   * Each comment is checked as addComment() checks it, but the namespaces
+   * of the list of comments are looked up once for the whole batch, and a
+   * comment that shares its TSBNamespaces with the one before it is not
+   * checked against them again.  Either every comment is added or none
+   * is: if one of them is rejected, @p comments is left unchanged.  On
+   * success, @p comments is left empty.
+   *
+   * @param comments the TSBComment objects to add.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_NAMESPACES_MISMATCH, OperationReturnValues_t}
+   *
+   * @see addComment(std::unique_ptr<TSBComment> tsbc)
+   * @see createComments(unsigned int n)
+   */
+  int addComments(std::vector<std::unique_ptr<TSBComment> >&& comments);
+#endif /* !SWIG */
+
+
   /**
    * Get the number of TSBComment objects in this TSBDocument.
    *
@@ -335,6 +413,34 @@ public:
   unsigned int getNumComments() const;
 
 
+#ifndef SWIG
+  /**
+   * Applies a worker functor to every TSBComment in this TSBDocument,
+   * splitting the comments across several threads.
+   *
+   * Each thread works on its own copy of @p prototype, calling
+   * <code>worker(const TSBComment* comment)</code> for every comment of its
+   * partition; the copies are then combined with
+   * <code>merge(const Worker& other)</code> and the result is returned.
+   * The document must not be modified while the traversal runs.
+   *
+   * @param prototype the worker that is copied for each thread.
+   * @param numThreads the number of threads to use; if @c 0 (default),
+   * the number of hardware threads is used.
+   *
+   * @return the merged worker.
+   *
+   * @see TSBListOf::parallelForEach()
+   */
+  template<class Worker>
+  Worker parallelForEachComment(const Worker& prototype,
+                                unsigned int numThreads = 0) const
+  {
+    return mComments.parallelForEachComment(prototype, numThreads);
+  }
+#endif /* !SWIG */
+
+
   /**
    * Creates a new TSBComment object, adds it to this TSBDocument object and
    * returns the TSBComment object created.
@@ -353,6 +459,28 @@ public:
   TSBComment* createComment();
 
 
+  /**
+   * Creates @p n new TSBComment objects and adds them to the end of this
+   * TSBDocument.
+   *
+   * The storage for the new comments is reserved once, and they share the
+   * TSBNamespaces of the TSBDocument rather than each taking a copy.  The
+   * comments created are the last @p n of the list, starting at index
+   * <code>getNumComments() - n</code>.
+   *
+   * @param n the number of TSBComment objects to create.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   *
+   * If the comments cannot all be allocated, none of them is added.
+   *
+   * @see createComment()
+   */
+  int createComments(unsigned int n);
+
+
   /**
    * Removes the nth TSBComment from this TSBDocument and returns a pointer to
    * it.
@@ -420,8 +548,10 @@ public:
   /**
    * Write any contained elements
    */
-  virtual void writeElements( XMLOutputStream&
-    stream) const;
+  virtual void writeElements( XMLOutputStream& stream,
+    TSBWriteContext& context) const;
+
+  using TSBBase::writeElements;
 
   /** @endcond */
 
@@ -891,6 +1021,144 @@ public:
   unsigned int getNumErrors(unsigned int severity) const;
 
 
+  /**
+   * Takes a snapshot of the current state of this TSBDocument, replacing
+   * any snapshot taken earlier.
+   *
+   * Taking a snapshot does not copy the TSBComment objects of the document.
+   * A comment is only copied the first time it is modified or removed after
+   * the snapshot was taken, so the cost of a snapshot grows with the number
+   * of edits rather than with the size of the document.  Changes are tracked
+   * through the setters and unsetters of the objects, through the TSBListOf
+   * removal methods and through the non-const getNotes() and
+   * getTestAnnotation(); a node obtained from those before the snapshot was
+   * taken must be fetched again before it is modified.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   *
+   * @see restoreSnapshot()
+   * @see releaseSnapshot()
+   * @see cloneSnapshot()
+   */
+  int takeSnapshot();
+
+
+  /**
+   * Predicate returning @c true if a snapshot of this TSBDocument is
+   * currently held.
+   *
+   * @return @c true if takeSnapshot() has been called and the snapshot has
+   * neither been restored nor released, @c false otherwise.
+   */
+  bool hasSnapshot() const;
+
+
+  /**
+   * Puts this TSBDocument back into the state recorded by takeSnapshot(),
+   * and discards the snapshot.
+   *
+   * Unmodified TSBComment objects stay in place; modified or removed ones
+   * are replaced by their preserved copies and comments added since the
+   * snapshot are deleted.  Pointers to comments that were modified, removed
+   * or added after the snapshot are therefore no longer valid.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   */
+  int restoreSnapshot();
+
+
+  /**
+   * Discards the snapshot of this TSBDocument, keeping all changes made
+   * since it was taken.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   */
+  int releaseSnapshot();
+
+
+  /**
+   * Creates a standalone deep copy of this TSBDocument as it was when
+   * takeSnapshot() was called.
+   *
+   * @return a new TSBDocument, or @c NULL if no snapshot is held.  The
+   * caller owns the returned object.
+   */
+  TSBDocument* cloneSnapshot() const;
+
+
+  /** @cond doxygenlibTSBInternal */
+  /**
+   * Called by TSBBase::aboutToChange() before a child of this document is
+   * modified or removed.
+   */
+  void objectAboutToChange(const TSBBase* object);
+
+
+  /**
+   * Set by TSBReader while this document is read; when @c true, objects
+   * keep their notes and testAnnotation elements as buffered tokens.
+   *
+   * @see TSBReader::setLazyParsing()
+   */
+  void setLazyParsing(bool lazy);
+
+
+  bool getLazyParsing() const;
+
+
+  /**
+   * Set by TSBReader while this document is read; when @c true, the
+   * validation checks made while reading are skipped.
+   *
+   * @see TSBReader::setTrustedInput()
+   */
+  void setTrustedInput(bool trusted);
+
+
+  bool getTrustedInput() const;
+
+
+  /**
+   * Set by TSBReader while this document is read; the comments read are
+   * taken from @p pool, if it holds any, instead of being allocated.
+   *
+   * @see TSBReader::recycleDocument()
+   */
+  void setCommentPool(std::vector<TSBComment*>* pool);
+
+
+  /**
+   * Takes a comment from the pool set with setCommentPool() and
+   * reinitializes it for @p parent.
+   *
+   * @return the comment, or @c NULL if there is no pool or it is empty.
+   */
+  TSBComment* createPooledComment(const TSBBase* parent);
+
+
+  /**
+   * Returns the pool in which the objects of this document keep string
+   * values that repeat, such as the contributors of the comments.
+   */
+  TSBStringPool& getStringPool();
+
+
+  /**
+   * Returns this document to the state of a newly created TSBDocument,
+   * keeping the storage it has already allocated.  Its comments are
+   * appended to @p items without being detached; the caller must delete
+   * them or reinitialize them before they are used again.
+   *
+   * @see TSBReader::recycleDocument()
+   */
+  void reset(std::vector<TSBBase*>& items);
+  /** @endcond */
+
+
 protected:
 
 
@@ -918,6 +1186,28 @@ protected:
 
 
 
+  /** @cond doxygenlibTSBInternal */
+
+  /**
+   * Feeds the attributes of this TSBDocument to the hasher
+   */
+  virtual void hashContent(TSBContentHasher& hasher) const;
+
+  /** @endcond */
+
+
+
+  /** @cond doxygenlibTSBInternal */
+
+  /**
+   * Returns the expected attributes shared by all TSBDocument objects
+   */
+  virtual const ExpectedAttributes* getStaticExpectedAttributes() const;
+
+  /** @endcond */
+
+
+
   /** @cond doxygenlibTSBInternal */
 
   /**
@@ -938,8 +1228,10 @@ protected:
   /**
    * Writes the attributes to the stream
    */
-  virtual void writeAttributes( XMLOutputStream&
-    stream) const;
+  virtual void writeAttributes( XMLOutputStream& stream,
+    TSBWriteContext& context) const;
+
+  using TSBBase::writeAttributes;
 
   /** @endcond */
 
@@ -1266,6 +1558,27 @@ TSBComment_t*
 TSBDocument_createComment(TSBDocument_t* tsbd);
 
 
+/**
+ * Creates @p n new TSBComment_t objects and adds them to the end of this
+ * TSBDocument_t.  The comments created are the last @p n of the document.
+ *
+ * @param tsbd the TSBDocument_t structure to which the TSBComment_t
+ * objects should be added.
+ *
+ * @param n the number of TSBComment_t objects to create.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @memberof TSBDocument_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_createComments(TSBDocument_t* tsbd, unsigned int n);
+
+
 /**
  * Removes the nth TSBComment_t from this TSBDocument_t and returns a pointer
  * to it.
@@ -1307,6 +1620,87 @@ int
 TSBDocument_hasRequiredAttributes(const TSBDocument_t * tsbd);
 
 
+/**
+ * Takes a snapshot of the current state of this TSBDocument_t.
+ *
+ * @param tsbd the TSBDocument_t structure.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @memberof TSBDocument_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_takeSnapshot(TSBDocument_t * tsbd);
+
+
+/**
+ * Predicate returning @c 1 (true) if this TSBDocument_t holds a snapshot.
+ *
+ * @param tsbd the TSBDocument_t structure.
+ *
+ * @return @c 1 (true) if a snapshot is held, @c 0 (false) otherwise.
+ *
+ * @memberof TSBDocument_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_hasSnapshot(const TSBDocument_t * tsbd);
+
+
+/**
+ * Puts this TSBDocument_t back into the state recorded by
+ * TSBDocument_takeSnapshot() and discards the snapshot.
+ *
+ * @param tsbd the TSBDocument_t structure.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @memberof TSBDocument_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_restoreSnapshot(TSBDocument_t * tsbd);
+
+
+/**
+ * Discards the snapshot of this TSBDocument_t, keeping all changes.
+ *
+ * @param tsbd the TSBDocument_t structure.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @memberof TSBDocument_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocument_releaseSnapshot(TSBDocument_t * tsbd);
+
+
+/**
+ * Creates a deep copy of this TSBDocument_t as it was when
+ * TSBDocument_takeSnapshot() was called.
+ *
+ * @param tsbd the TSBDocument_t structure.
+ *
+ * @return a new TSBDocument_t, or @c NULL if no snapshot is held.
+ *
+ * @copydetails doc_warning_returns_owned_pointer
+ *
+ * @memberof TSBDocument_t
+ */
+LIBTSB_EXTERN
+TSBDocument_t*
+TSBDocument_cloneSnapshot(const TSBDocument_t * tsbd);
+
+
 
 
 END_C_DECLS
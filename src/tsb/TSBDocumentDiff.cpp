@@ -0,0 +1,1106 @@
+/**
+ * @file TSBDocumentDiff.cpp
+ * @brief Implementation of the TSBDocumentDiff class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+
+
+#include <tsb/TSBDocumentDiff.h>
+#include <tsb/TSBDocument.h>
+#include <tsb/TSBListOfComments.h>
+#include <tsb/TSBComment.h>
+#include <tsb/TSBAttributeTable.h>
+#include <tsb/common/TSBOperationReturnValues.h>
+#include <tsb/util/util.h>
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <locale>
+#include <sstream>
+#include <unordered_map>
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/** @cond doxygenlibTSBInternal */
+
+static const unsigned int ALL_FIELDS = TSB_COMMENT_FIELD_CONTRIBUTOR
+                                     | TSB_COMMENT_FIELD_NUMBER
+                                     | TSB_COMMENT_FIELD_POINT
+                                     | TSB_COMMENT_FIELD_METAID
+                                     | TSB_COMMENT_FIELD_ID
+                                     | TSB_COMMENT_FIELD_NOTES
+                                     | TSB_COMMENT_FIELD_ANNOTATION;
+
+
+/*
+ * Returns the notes of comment as text, without the line break that
+ * getNotesString() ends them with, so that setNotes() gives them back
+ * unchanged; an empty string if the comment has no notes.
+ */
+static string
+getNotesText(const TSBComment& comment)
+{
+  if (!comment.isSetNotes()) return string();
+
+  string notes = comment.getNotesString();
+  size_t end = notes.find_last_not_of(" \t\r\n");
+  return (end == string::npos) ? string() : notes.substr(0, end + 1);
+}
+
+
+/*
+ * Returns the annotation of comment as text, as getNotesText() does for
+ * the notes.
+ */
+static string
+getAnnotationText(const TSBComment& comment)
+{
+  if (!comment.isSetTestAnnotation()) return string();
+
+  string annotation = comment.getTestAnnotationString();
+  size_t end = annotation.find_last_not_of(" \t\r\n");
+  return (end == string::npos) ? string() : annotation.substr(0, end + 1);
+}
+
+
+/*
+ * Returns the key comments are matched by: the id, or else the metaid,
+ * prefixed so that the two cannot be confused; empty if there is neither.
+ */
+static string
+getMatchKey(const TSBComment& comment)
+{
+  if (comment.isSetId()) return "i" + comment.getId();
+  if (comment.isSetMetaId()) return "m" + comment.getMetaId();
+  return string();
+}
+
+
+static bool
+sameNumber(const TSBComment& a, const TSBComment& b)
+{
+  if (a.isSetNumber() != b.isSetNumber()) return false;
+  if (!a.isSetNumber()) return true;
+
+  double x = a.getNumber();
+  double y = b.getNumber();
+  return x == y || (std::isnan(x) && std::isnan(y));
+}
+
+
+static bool
+sameMarkup(const TSBComment& a, const TSBComment& b, bool notes)
+{
+  if (notes)
+  {
+    if (!a.isSetNotes() && !b.isSetNotes()) return true;
+    return getNotesText(a) == getNotesText(b);
+  }
+
+  if (!a.isSetTestAnnotation() && !b.isSetTestAnnotation()) return true;
+  return getAnnotationText(a) == getAnnotationText(b);
+}
+
+
+/*
+ * Returns the mask of the fields in which a and b differ.
+ */
+static unsigned int
+compareComments(const TSBComment& a, const TSBComment& b)
+{
+  unsigned int fields = 0;
+
+  if (!a.hasSameContributor(b))   fields |= TSB_COMMENT_FIELD_CONTRIBUTOR;
+  if (!sameNumber(a, b))          fields |= TSB_COMMENT_FIELD_NUMBER;
+  if (a.getPoint() != b.getPoint()) fields |= TSB_COMMENT_FIELD_POINT;
+  if (a.getMetaId() != b.getMetaId()) fields |= TSB_COMMENT_FIELD_METAID;
+  if (a.getId() != b.getId())     fields |= TSB_COMMENT_FIELD_ID;
+  if (!sameMarkup(a, b, true))    fields |= TSB_COMMENT_FIELD_NOTES;
+  if (!sameMarkup(a, b, false))   fields |= TSB_COMMENT_FIELD_ANNOTATION;
+
+  return fields;
+}
+
+
+/*
+ * Returns the mask of the fields of comment that are set.
+ */
+static unsigned int
+getSetFields(const TSBComment& comment)
+{
+  unsigned int fields = 0;
+
+  if (comment.isSetContributor())    fields |= TSB_COMMENT_FIELD_CONTRIBUTOR;
+  if (comment.isSetNumber())         fields |= TSB_COMMENT_FIELD_NUMBER;
+  if (comment.isSetPoint())          fields |= TSB_COMMENT_FIELD_POINT;
+  if (comment.isSetMetaId())         fields |= TSB_COMMENT_FIELD_METAID;
+  if (comment.isSetId())             fields |= TSB_COMMENT_FIELD_ID;
+  if (comment.isSetNotes())          fields |= TSB_COMMENT_FIELD_NOTES;
+  if (comment.isSetTestAnnotation()) fields |= TSB_COMMENT_FIELD_ANNOTATION;
+
+  return fields;
+}
+
+
+/*
+ * Hashes the fields compared by compareComments(), so that comments that
+ * compare equal hash equal.  Used for comments without an id or metaid,
+ * whose metaid and id are therefore both empty.
+ */
+static size_t
+hashContent(const TSBComment& comment)
+{
+  hash<string> hashString;
+  size_t seed = hashString(comment.getContributor());
+
+  if (comment.isSetNumber())
+  {
+    double number = comment.getNumber();
+
+    // NaNs compare equal to each other, and 0 to -0
+    if (std::isnan(number))
+    {
+      number = tsb_util_NaN();
+    }
+    else if (number == 0)
+    {
+      number = 0;
+    }
+
+    seed = seed * 31 + hash<double>()(number);
+  }
+
+  seed = seed * 31 + hashString(comment.getPoint());
+
+  if (comment.isSetNotes())
+  {
+    seed = seed * 31 + hashString(getNotesText(comment));
+  }
+
+  if (comment.isSetTestAnnotation())
+  {
+    seed = seed * 31 + hashString(getAnnotationText(comment));
+  }
+
+  return seed;
+}
+
+
+/*
+ * Sets the fields of comment given in fields to values.
+ */
+static void
+applyValues(TSBComment& comment, unsigned int fields,
+            const TSBDocumentDiff::CommentValues& values)
+{
+  if (fields & TSB_COMMENT_FIELD_CONTRIBUTOR)
+  {
+    comment.setContributor(values.contributor);
+  }
+
+  if (fields & TSB_COMMENT_FIELD_NUMBER)
+  {
+    if (values.isSetNumber)
+    {
+      comment.setNumber(values.number);
+    }
+    else
+    {
+      comment.unsetNumber();
+    }
+  }
+
+  if (fields & TSB_COMMENT_FIELD_POINT)  comment.setPoint(values.point);
+  if (fields & TSB_COMMENT_FIELD_METAID) comment.setMetaId(values.metaid);
+  if (fields & TSB_COMMENT_FIELD_ID)     comment.setId(values.id);
+
+  if (fields & TSB_COMMENT_FIELD_NOTES)
+  {
+    if (values.notes.empty())
+    {
+      comment.unsetNotes();
+    }
+    else
+    {
+      comment.setNotes(values.notes);
+    }
+  }
+
+  if (fields & TSB_COMMENT_FIELD_ANNOTATION)
+  {
+    if (values.annotation.empty())
+    {
+      comment.unsetTestAnnotation();
+    }
+    else
+    {
+      comment.setTestAnnotation(values.annotation);
+    }
+  }
+}
+
+
+/*
+ * Writes a value of a patch: its length, a colon, the value and a line
+ * break.
+ */
+static void
+writeValue(ostream& out, const string& value)
+{
+  out << value.size() << ':' << value << '\n';
+}
+
+
+static string
+numberToString(bool isSet, double number)
+{
+  if (!isSet) return string();
+  if (std::isnan(number)) return "NaN";
+  if (std::isinf(number)) return (number > 0) ? "INF" : "-INF";
+
+  ostringstream text;
+  text.imbue(locale::classic());
+  text.precision(17);
+  text << number;
+  return text.str();
+}
+
+
+/*
+ * Reads the tokens and values of a patch, failing on anything that does
+ * not match the expected format.
+ */
+class TSBPatchReader
+{
+public:
+
+  TSBPatchReader(const string& patch) : mPatch(patch), mPos(0) {}
+
+  /* reads a token ended by a space or a line break, consuming the end */
+  bool readToken(string& token)
+  {
+    size_t end = mPatch.find_first_of(" \n", mPos);
+    if (end == string::npos || end == mPos) return false;
+
+    token.assign(mPatch, mPos, end - mPos);
+    mPos = end + 1;
+    return true;
+  }
+
+  bool readUInt(unsigned int& value)
+  {
+    string token;
+    return readToken(token) && TSBAttribute_readUnsignedInt(token, value);
+  }
+
+  bool readValue(string& value)
+  {
+    size_t colon = mPatch.find(':', mPos);
+    if (colon == string::npos || colon == mPos) return false;
+
+    unsigned int length = 0;
+    if (!TSBAttribute_readUnsignedInt(mPatch.substr(mPos, colon - mPos),
+                                      length))
+    {
+      return false;
+    }
+
+    size_t end = colon + 1 + length;
+    if (end >= mPatch.size() || mPatch[end] != '\n') return false;
+
+    value.assign(mPatch, colon + 1, length);
+    mPos = end + 1;
+    return true;
+  }
+
+  bool atEnd() const { return mPos == mPatch.size(); }
+
+private:
+
+  const string& mPatch;
+  size_t        mPos;
+};
+
+
+static bool
+readValues(TSBPatchReader& reader, unsigned int fields,
+           TSBDocumentDiff::CommentValues& values)
+{
+  if (fields & ~ALL_FIELDS) return false;
+
+  if ((fields & TSB_COMMENT_FIELD_CONTRIBUTOR)
+    && !reader.readValue(values.contributor))
+  {
+    return false;
+  }
+
+  if (fields & TSB_COMMENT_FIELD_NUMBER)
+  {
+    string number;
+    if (!reader.readValue(number)) return false;
+
+    values.isSetNumber = !number.empty();
+    if (values.isSetNumber
+      && !TSBAttribute_readDouble(number, values.number))
+    {
+      return false;
+    }
+  }
+
+  return (!(fields & TSB_COMMENT_FIELD_POINT)
+            || reader.readValue(values.point))
+      && (!(fields & TSB_COMMENT_FIELD_METAID)
+            || reader.readValue(values.metaid))
+      && (!(fields & TSB_COMMENT_FIELD_ID)
+            || reader.readValue(values.id))
+      && (!(fields & TSB_COMMENT_FIELD_NOTES)
+            || reader.readValue(values.notes))
+      && (!(fields & TSB_COMMENT_FIELD_ANNOTATION)
+            || reader.readValue(values.annotation));
+}
+
+
+/*
+ * The older comments without an id or metaid that share a content hash,
+ * in list order; those before next have all been matched.
+ */
+struct TSBContentBucket
+{
+  vector<unsigned int> older;
+  size_t               next;
+
+  TSBContentBucket() : older(), next(0) {}
+};
+
+/** @endcond */
+
+
+/*
+ * Creates an empty TSBDocumentDiff.
+ */
+TSBDocumentDiff::TSBDocumentDiff()
+  : mLevel(0)
+  , mVersion(0)
+  , mNumOlder(0)
+  , mNumNewer(0)
+{
+}
+
+
+/*
+ * Creates the difference between the given documents.
+ */
+TSBDocumentDiff::TSBDocumentDiff(const TSBDocument& older,
+                                 const TSBDocument& newer)
+  : mLevel(0)
+  , mVersion(0)
+  , mNumOlder(0)
+  , mNumNewer(0)
+{
+  compute(older, newer);
+}
+
+
+/*
+ * Computes the difference between the comments of the given documents.
+ */
+int
+TSBDocumentDiff::compute(const TSBDocument& older, const TSBDocument& newer)
+{
+  return compute(*older.getListOfComments(), *newer.getListOfComments());
+}
+
+
+/*
+ * Computes the difference between the comments of the given lists.
+ */
+int
+TSBDocumentDiff::compute(const TSBListOfComments& older,
+                         const TSBListOfComments& newer)
+{
+  clear();
+
+  if (older.getLevel() != newer.getLevel())
+  {
+    return LIBTSB_LEVEL_MISMATCH;
+  }
+  else if (older.getVersion() != newer.getVersion())
+  {
+    return LIBTSB_VERSION_MISMATCH;
+  }
+
+  mLevel = older.getLevel();
+  mVersion = older.getVersion();
+  mNumOlder = older.size();
+  mNumNewer = newer.size();
+
+  unordered_map<string, unsigned int> byKey;
+  unordered_map<size_t, TSBContentBucket> byContent;
+  byKey.reserve(mNumOlder);
+
+  for (unsigned int i = 0; i < mNumOlder; ++i)
+  {
+    const TSBComment& comment = *older.get(i);
+    string key = getMatchKey(comment);
+
+    // a comment that repeats the key of an earlier one is matched by
+    // content instead
+    if (key.empty() || !byKey.insert(make_pair(key, i)).second)
+    {
+      byContent[hashContent(comment)].older.push_back(i);
+    }
+  }
+
+  vector<bool> matched(mNumOlder, false);
+
+  for (unsigned int j = 0; j < mNumNewer; ++j)
+  {
+    const TSBComment& comment = *newer.get(j);
+    unsigned int match = mNumOlder;
+    string key = getMatchKey(comment);
+
+    if (!key.empty())
+    {
+      unordered_map<string, unsigned int>::const_iterator it =
+        byKey.find(key);
+      if (it != byKey.end() && !matched[it->second])
+      {
+        match = it->second;
+      }
+    }
+
+    if (match == mNumOlder)
+    {
+      unordered_map<size_t, TSBContentBucket>::iterator it =
+        byContent.find(hashContent(comment));
+
+      if (it != byContent.end())
+      {
+        TSBContentBucket& bucket = it->second;
+        while (bucket.next < bucket.older.size()
+          && matched[bucket.older[bucket.next]])
+        {
+          ++bucket.next;
+        }
+
+        for (size_t n = bucket.next; n < bucket.older.size(); ++n)
+        {
+          unsigned int candidate = bucket.older[n];
+          if (!matched[candidate]
+            && compareComments(*older.get(candidate), comment) == 0)
+          {
+            match = candidate;
+            break;
+          }
+        }
+      }
+    }
+
+    if (match == mNumOlder)
+    {
+      Entry entry = { ENTRY_ADD, 0, 1, getSetFields(comment), 0 };
+      addValues(entry, comment);
+      mEntries.push_back(entry);
+      continue;
+    }
+
+    matched[match] = true;
+
+    unsigned int fields = compareComments(*older.get(match), comment);
+    if (fields == 0)
+    {
+      addKept(match);
+    }
+    else
+    {
+      Entry entry = { ENTRY_CHANGE, match, 1, fields, 0 };
+      addValues(entry, comment);
+      mEntries.push_back(entry);
+    }
+  }
+
+  summarize();
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+/*
+ * Empties this TSBDocumentDiff.
+ */
+void
+TSBDocumentDiff::clear()
+{
+  mLevel = 0;
+  mVersion = 0;
+  mNumOlder = 0;
+  mNumNewer = 0;
+
+  mEntries.clear();
+  mValues.clear();
+  mAdded.clear();
+  mRemoved.clear();
+  mChangedOlder.clear();
+  mChangedNewer.clear();
+  mChangedFields.clear();
+}
+
+
+/*
+ * Returns true if the documents compared have the same comments.
+ */
+bool
+TSBDocumentDiff::isEmpty() const
+{
+  if (mEntries.empty())
+  {
+    return mNumOlder == 0;
+  }
+
+  return mEntries.size() == 1 && mEntries[0].kind == ENTRY_KEEP
+    && mEntries[0].older == 0 && mEntries[0].count == mNumOlder;
+}
+
+
+unsigned int
+TSBDocumentDiff::getNumOlderComments() const
+{
+  return mNumOlder;
+}
+
+
+unsigned int
+TSBDocumentDiff::getNumNewerComments() const
+{
+  return mNumNewer;
+}
+
+
+unsigned int
+TSBDocumentDiff::getNumAdded() const
+{
+  return (unsigned int)mAdded.size();
+}
+
+
+unsigned int
+TSBDocumentDiff::getAddedIndex(unsigned int n) const
+{
+  return (n < mAdded.size()) ? mAdded[n] : mNumNewer;
+}
+
+
+unsigned int
+TSBDocumentDiff::getNumRemoved() const
+{
+  return (unsigned int)mRemoved.size();
+}
+
+
+unsigned int
+TSBDocumentDiff::getRemovedIndex(unsigned int n) const
+{
+  return (n < mRemoved.size()) ? mRemoved[n] : mNumOlder;
+}
+
+
+unsigned int
+TSBDocumentDiff::getNumChanged() const
+{
+  return (unsigned int)mChangedOlder.size();
+}
+
+
+unsigned int
+TSBDocumentDiff::getChangedOlderIndex(unsigned int n) const
+{
+  return (n < mChangedOlder.size()) ? mChangedOlder[n] : mNumOlder;
+}
+
+
+unsigned int
+TSBDocumentDiff::getChangedNewerIndex(unsigned int n) const
+{
+  return (n < mChangedNewer.size()) ? mChangedNewer[n] : mNumNewer;
+}
+
+
+unsigned int
+TSBDocumentDiff::getChangedFields(unsigned int n) const
+{
+  return (n < mChangedFields.size()) ? mChangedFields[n] : 0;
+}
+
+
+/*
+ * Returns this difference as a patch.
+ */
+std::string
+TSBDocumentDiff::getPatch() const
+{
+  ostringstream out;
+  out.imbue(locale::classic());
+
+  out << "TSBPATCH 1 " << mLevel << ' ' << mVersion << ' ' << mNumOlder
+      << ' ' << mNumNewer << ' ' << mEntries.size() << '\n';
+
+  for (size_t n = 0; n < mEntries.size(); ++n)
+  {
+    const Entry& entry = mEntries[n];
+
+    switch (entry.kind)
+    {
+    case ENTRY_KEEP:
+      out << "K " << entry.older << ' ' << entry.count << '\n';
+      continue;
+    case ENTRY_CHANGE:
+      out << "C " << entry.older << ' ' << entry.fields << '\n';
+      break;
+    case ENTRY_ADD:
+      out << "A " << entry.fields << '\n';
+      break;
+    }
+
+    const CommentValues& values = mValues[entry.values];
+    if (entry.fields & TSB_COMMENT_FIELD_CONTRIBUTOR)
+      writeValue(out, values.contributor);
+    if (entry.fields & TSB_COMMENT_FIELD_NUMBER)
+      writeValue(out, numberToString(values.isSetNumber, values.number));
+    if (entry.fields & TSB_COMMENT_FIELD_POINT)
+      writeValue(out, values.point);
+    if (entry.fields & TSB_COMMENT_FIELD_METAID)
+      writeValue(out, values.metaid);
+    if (entry.fields & TSB_COMMENT_FIELD_ID)
+      writeValue(out, values.id);
+    if (entry.fields & TSB_COMMENT_FIELD_NOTES)
+      writeValue(out, values.notes);
+    if (entry.fields & TSB_COMMENT_FIELD_ANNOTATION)
+      writeValue(out, values.annotation);
+  }
+
+  return out.str();
+}
+
+
+/*
+ * Replaces the content of this TSBDocumentDiff with the given patch.
+ */
+int
+TSBDocumentDiff::setPatch(const std::string& patch)
+{
+  clear();
+
+  TSBPatchReader reader(patch);
+  string token;
+  unsigned int formatVersion = 0;
+  unsigned int numEntries = 0;
+
+  bool valid = reader.readToken(token) && token == "TSBPATCH"
+    && reader.readUInt(formatVersion) && formatVersion == 1
+    && reader.readUInt(mLevel) && reader.readUInt(mVersion)
+    && reader.readUInt(mNumOlder) && reader.readUInt(mNumNewer)
+    && reader.readUInt(numEntries);
+
+  for (unsigned int n = 0; valid && n < numEntries; ++n)
+  {
+    Entry entry = { ENTRY_KEEP, 0, 1, 0, 0 };
+
+    valid = reader.readToken(token);
+    if (!valid) break;
+
+    if (token == "K")
+    {
+      valid = reader.readUInt(entry.older) && reader.readUInt(entry.count)
+        && entry.count > 0;
+    }
+    else if (token == "C" || token == "A")
+    {
+      entry.kind = (token == "C") ? ENTRY_CHANGE : ENTRY_ADD;
+      valid = (entry.kind == ENTRY_ADD || reader.readUInt(entry.older))
+        && reader.readUInt(entry.fields);
+
+      if (valid)
+      {
+        CommentValues values = { "", 0, false, "", "", "", "", "" };
+        valid = readValues(reader, entry.fields, values);
+        entry.values = (unsigned int)mValues.size();
+        mValues.push_back(values);
+      }
+    }
+    else
+    {
+      valid = false;
+    }
+
+    if (valid)
+    {
+      mEntries.push_back(entry);
+    }
+  }
+
+  if (!valid || !reader.atEnd() || !summarize())
+  {
+    clear();
+    return LIBTSB_OPERATION_FAILED;
+  }
+
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+/*
+ * Applies this difference to the given document.
+ */
+int
+TSBDocumentDiff::apply(TSBDocument& older) const
+{
+  return apply(*older.getListOfComments());
+}
+
+
+/*
+ * Applies this difference to the given list of comments.
+ */
+int
+TSBDocumentDiff::apply(TSBListOfComments& older) const
+{
+  if (older.getLevel() != mLevel)
+  {
+    return LIBTSB_LEVEL_MISMATCH;
+  }
+  else if (older.getVersion() != mVersion)
+  {
+    return LIBTSB_VERSION_MISMATCH;
+  }
+  else if (older.size() != mNumOlder)
+  {
+    return LIBTSB_OPERATION_FAILED;
+  }
+
+  // everything that can fail is done before the list is touched
+  vector<TSBComment*> added;
+
+  try
+  {
+    added.reserve(mAdded.size());
+    for (size_t n = 0; n < mEntries.size(); ++n)
+    {
+      if (mEntries[n].kind == ENTRY_ADD)
+      {
+        added.push_back(new TSBComment(&older));
+        applyValues(*added.back(), mEntries[n].fields,
+                    mValues[mEntries[n].values]);
+      }
+    }
+
+    older.reserve(mNumOlder > mNumNewer ? mNumOlder : mNumNewer);
+  }
+  catch (...)
+  {
+    for (size_t n = 0; n < added.size(); ++n)
+    {
+      delete added[n];
+    }
+
+    return LIBTSB_OPERATION_FAILED;
+  }
+
+  for (size_t n = 0; n < mEntries.size(); ++n)
+  {
+    const Entry& entry = mEntries[n];
+    if (entry.kind == ENTRY_CHANGE)
+    {
+      applyValues(*older.get(entry.older), entry.fields,
+                  mValues[entry.values]);
+    }
+  }
+
+  for (size_t n = 0; n < mRemoved.size(); ++n)
+  {
+    older.get(mRemoved[n])->aboutToChange();
+  }
+
+  vector<TSBBase*> items;
+  items.reserve(mNumOlder);
+  older.releaseItems(items);
+
+  size_t nextAdded = 0;
+  for (size_t n = 0; n < mEntries.size(); ++n)
+  {
+    const Entry& entry = mEntries[n];
+    switch (entry.kind)
+    {
+    case ENTRY_KEEP:
+      for (unsigned int k = 0; k < entry.count; ++k)
+      {
+        older.appendAndOwn(items[entry.older + k]);
+      }
+      break;
+    case ENTRY_CHANGE:
+      older.appendAndOwn(items[entry.older]);
+      break;
+    case ENTRY_ADD:
+      older.appendAndOwn(added[nextAdded++]);
+      break;
+    }
+  }
+
+  for (size_t n = 0; n < mRemoved.size(); ++n)
+  {
+    delete items[mRemoved[n]];
+  }
+
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Records that the older comment is kept unchanged, extending the last
+ * run of kept comments if it follows on from it.
+ */
+void
+TSBDocumentDiff::addKept(unsigned int older)
+{
+  if (!mEntries.empty())
+  {
+    Entry& last = mEntries.back();
+    if (last.kind == ENTRY_KEEP && last.older + last.count == older)
+    {
+      ++last.count;
+      return;
+    }
+  }
+
+  Entry entry = { ENTRY_KEEP, older, 1, 0, 0 };
+  mEntries.push_back(entry);
+}
+
+
+/*
+ * Stores the fields of comment named by entry.fields as the values of
+ * entry.
+ */
+void
+TSBDocumentDiff::addValues(Entry& entry, const TSBComment& comment)
+{
+  CommentValues values = { "", 0, false, "", "", "", "", "" };
+
+  if (entry.fields & TSB_COMMENT_FIELD_CONTRIBUTOR)
+    values.contributor = comment.getContributor();
+  if (entry.fields & TSB_COMMENT_FIELD_NUMBER)
+  {
+    values.isSetNumber = comment.isSetNumber();
+    values.number = comment.getNumber();
+  }
+  if (entry.fields & TSB_COMMENT_FIELD_POINT)
+    values.point = comment.getPoint();
+  if (entry.fields & TSB_COMMENT_FIELD_METAID)
+    values.metaid = comment.getMetaId();
+  if (entry.fields & TSB_COMMENT_FIELD_ID)
+    values.id = comment.getId();
+  if (entry.fields & TSB_COMMENT_FIELD_NOTES)
+    values.notes = getNotesText(comment);
+  if (entry.fields & TSB_COMMENT_FIELD_ANNOTATION)
+    values.annotation = getAnnotationText(comment);
+
+  entry.values = (unsigned int)mValues.size();
+  mValues.push_back(values);
+}
+
+
+/*
+ * Derives the added, removed and changed comments from the entries,
+ * returning false if the entries do not describe a valid change of
+ * mNumOlder comments into mNumNewer: an older comment out of range or
+ * used twice.
+ */
+bool
+TSBDocumentDiff::summarize()
+{
+  vector<bool> used(mNumOlder, false);
+  unsigned int newer = 0;
+
+  for (size_t n = 0; n < mEntries.size(); ++n)
+  {
+    const Entry& entry = mEntries[n];
+
+    if (entry.kind == ENTRY_ADD)
+    {
+      mAdded.push_back(newer++);
+      continue;
+    }
+
+    if (entry.older >= mNumOlder || entry.count > mNumOlder - entry.older)
+    {
+      return false;
+    }
+
+    for (unsigned int k = 0; k < entry.count; ++k)
+    {
+      if (used[entry.older + k]) return false;
+      used[entry.older + k] = true;
+    }
+
+    if (entry.kind == ENTRY_CHANGE)
+    {
+      mChangedOlder.push_back(entry.older);
+      mChangedNewer.push_back(newer);
+      mChangedFields.push_back(entry.fields);
+    }
+
+    newer += entry.count;
+  }
+
+  for (unsigned int i = 0; i < mNumOlder; ++i)
+  {
+    if (!used[i]) mRemoved.push_back(i);
+  }
+
+  return newer == mNumNewer;
+}
+
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+/** @cond doxygenIgnored */
+
+
+LIBTSB_EXTERN
+TSBDocumentDiff_t *
+TSBDocumentDiff_create ()
+{
+  return new(nothrow) TSBDocumentDiff;
+}
+
+
+LIBTSB_EXTERN
+void
+TSBDocumentDiff_free (TSBDocumentDiff_t *dd)
+{
+  delete dd;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBDocumentDiff_compute (TSBDocumentDiff_t *dd,
+                         const TSBDocument_t *older,
+                         const TSBDocument_t *newer)
+{
+  if (dd == NULL || older == NULL || newer == NULL)
+  {
+    return LIBTSB_INVALID_OBJECT;
+  }
+
+  return dd->compute(*older, *newer);
+}
+
+
+LIBTSB_EXTERN
+unsigned int
+TSBDocumentDiff_getNumAdded (const TSBDocumentDiff_t *dd)
+{
+  return (dd != NULL) ? dd->getNumAdded() : 0;
+}
+
+
+LIBTSB_EXTERN
+unsigned int
+TSBDocumentDiff_getNumRemoved (const TSBDocumentDiff_t *dd)
+{
+  return (dd != NULL) ? dd->getNumRemoved() : 0;
+}
+
+
+LIBTSB_EXTERN
+unsigned int
+TSBDocumentDiff_getNumChanged (const TSBDocumentDiff_t *dd)
+{
+  return (dd != NULL) ? dd->getNumChanged() : 0;
+}
+
+
+LIBTSB_EXTERN
+char *
+TSBDocumentDiff_getPatch (const TSBDocumentDiff_t *dd)
+{
+  return (dd != NULL) ? tsb_safe_strdup(dd->getPatch().c_str()) : NULL;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBDocumentDiff_setPatch (TSBDocumentDiff_t *dd, const char *patch)
+{
+  if (dd == NULL || patch == NULL)
+  {
+    return LIBTSB_INVALID_OBJECT;
+  }
+
+  return dd->setPatch(patch);
+}
+
+
+LIBTSB_EXTERN
+int
+TSBDocumentDiff_apply (const TSBDocumentDiff_t *dd, TSBDocument_t *older)
+{
+  if (dd == NULL || older == NULL)
+  {
+    return LIBTSB_INVALID_OBJECT;
+  }
+
+  return dd->apply(*older);
+}
+
+
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
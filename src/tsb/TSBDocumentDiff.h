@@ -0,0 +1,588 @@
+/**
+ * @file TSBDocumentDiff.h
+ * @brief Definition of the TSBDocumentDiff class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class TSBDocumentDiff
+ * @sbmlbrief{} Structural difference between two versions of a document.
+ *
+ * A TSBDocumentDiff compares the comments of an older and a newer
+ * TSBDocument object by object rather than as text.  Comments are matched
+ * by their "id" attribute, or by their "metaid" if they have no id.
+ * Comments with neither attribute are matched by a hash of their content,
+ * so an unchanged comment is found wherever it moved to.  Each comparison
+ * is a hash table lookup, so the time taken grows linearly with the number
+ * of comments.
+ *
+ * The result lists the comments added to the newer document and the
+ * comments removed from the older one.  It also lists the matched comments
+ * whose attributes, notes or annotation differ, with a mask of
+ * TSBCommentField_t values telling which of them changed.
+ *
+ * The difference can be written as a patch with getPatch().  The patch
+ * records the comments of the newer document in order.  A run of
+ * unchanged comments becomes a single range of indexes into the older
+ * document, so the patch for two similar documents is small.  Applying
+ * the patch to the older document with apply() turns it into the newer
+ * one.  A patch read back with setPatch() can be applied in the same way.
+ */
+
+
+#ifndef TSBDocumentDiff_H__
+#define TSBDocumentDiff_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+BEGIN_C_DECLS
+
+
+/**
+ * @enum  TSBCommentField_t
+ * @brief The parts of a TSBComment that TSBDocumentDiff compares; the
+ * values are bits that are combined into a mask.
+ */
+typedef enum
+{
+    TSB_COMMENT_FIELD_CONTRIBUTOR  = 0x01
+  , TSB_COMMENT_FIELD_NUMBER       = 0x02
+  , TSB_COMMENT_FIELD_POINT        = 0x04
+  , TSB_COMMENT_FIELD_METAID       = 0x08
+  , TSB_COMMENT_FIELD_ID           = 0x10
+  , TSB_COMMENT_FIELD_NOTES        = 0x20
+  , TSB_COMMENT_FIELD_ANNOTATION   = 0x40
+} TSBCommentField_t;
+
+
+END_C_DECLS
+LIBTSB_CPP_NAMESPACE_END
+
+
+#ifdef __cplusplus
+
+
+#include <string>
+#include <vector>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+class TSBComment;
+class TSBDocument;
+class TSBListOfComments;
+
+
+class LIBTSB_EXTERN TSBDocumentDiff
+{
+public:
+
+  /**
+   * Creates an empty TSBDocumentDiff, the difference between two documents
+   * with no comments.
+   */
+  TSBDocumentDiff();
+
+
+  /**
+   * Creates the difference between the comments of the given documents.
+   *
+   * @param older the older document.
+   * @param newer the newer document.
+   *
+   * @see compute()
+   */
+  TSBDocumentDiff(const TSBDocument& older, const TSBDocument& newer);
+
+
+  /**
+   * Computes the difference between the comments of the given documents,
+   * replacing the content of this TSBDocumentDiff.
+   *
+   * @param older the older document.
+   * @param newer the newer document.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+   *
+   * If the documents differ in level or version, this TSBDocumentDiff is
+   * left empty.
+   */
+  int compute(const TSBDocument& older, const TSBDocument& newer);
+
+
+  /**
+   * Computes the difference between the comments of the given lists,
+   * replacing the content of this TSBDocumentDiff.
+   *
+   * @param older the older list.
+   * @param newer the newer list.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+   */
+  int compute(const TSBListOfComments& older,
+              const TSBListOfComments& newer);
+
+
+  /**
+   * Empties this TSBDocumentDiff.
+   */
+  void clear();
+
+
+  /**
+   * Predicate returning @c true if the two documents compared have the
+   * same comments, in the same order.
+   *
+   * @return @c true if applying this difference changes nothing.
+   */
+  bool isEmpty() const;
+
+
+  /**
+   * Returns the number of comments of the older document.
+   *
+   * @return the number of comments the difference applies to.
+   */
+  unsigned int getNumOlderComments() const;
+
+
+  /**
+   * Returns the number of comments of the newer document.
+   *
+   * @return the number of comments after the difference is applied.
+   */
+  unsigned int getNumNewerComments() const;
+
+
+  /**
+   * Returns the number of comments of the newer document that have no
+   * match in the older one.
+   *
+   * @return the number of added comments.
+   */
+  unsigned int getNumAdded() const;
+
+
+  /**
+   * Returns the index in the newer document of the <em>n</em>th added
+   * comment.  The added comments are listed in the order of the newer
+   * document.
+   *
+   * @param n the index of the added comment, less than getNumAdded().
+   *
+   * @return the index of the comment in the newer document.
+   */
+  unsigned int getAddedIndex(unsigned int n) const;
+
+
+  /**
+   * Returns the number of comments of the older document that have no
+   * match in the newer one.
+   *
+   * @return the number of removed comments.
+   */
+  unsigned int getNumRemoved() const;
+
+
+  /**
+   * Returns the index in the older document of the <em>n</em>th removed
+   * comment.  The removed comments are listed in the order of the older
+   * document.
+   *
+   * @param n the index of the removed comment, less than getNumRemoved().
+   *
+   * @return the index of the comment in the older document.
+   */
+  unsigned int getRemovedIndex(unsigned int n) const;
+
+
+  /**
+   * Returns the number of matched comments whose attributes, notes or
+   * annotation differ.
+   *
+   * @return the number of changed comments.
+   */
+  unsigned int getNumChanged() const;
+
+
+  /**
+   * Returns the index in the older document of the <em>n</em>th changed
+   * comment.  The changed comments are listed in the order of the newer
+   * document.
+   *
+   * @param n the index of the changed comment, less than getNumChanged().
+   *
+   * @return the index of the comment in the older document.
+   */
+  unsigned int getChangedOlderIndex(unsigned int n) const;
+
+
+  /**
+   * Returns the index in the newer document of the <em>n</em>th changed
+   * comment.
+   *
+   * @param n the index of the changed comment, less than getNumChanged().
+   *
+   * @return the index of the comment in the newer document.
+   */
+  unsigned int getChangedNewerIndex(unsigned int n) const;
+
+
+  /**
+   * Returns which parts of the <em>n</em>th changed comment differ.
+   *
+   * @param n the index of the changed comment, less than getNumChanged().
+   *
+   * @return a mask of TSBCommentField_t values.
+   */
+  unsigned int getChangedFields(unsigned int n) const;
+
+
+  /**
+   * Returns this difference as a patch that setPatch() can read back.
+   *
+   * The patch is a text with one line per entry, followed by the values of
+   * any changed or added comments.  Each value is written as its length in
+   * bytes, a colon, the bytes themselves and a line break.  Any value can
+   * therefore be stored without escaping.
+   *
+   * @return the patch.
+   */
+  std::string getPatch() const;
+
+
+  /**
+   * Replaces the content of this TSBDocumentDiff with the patch @p patch,
+   * as written by getPatch().
+   *
+   * @param patch the patch to read.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   *
+   * If the patch cannot be read, this TSBDocumentDiff is left empty.
+   */
+  int setPatch(const std::string& patch);
+
+
+  /**
+   * Applies this difference to @p older, which becomes equal to the newer
+   * document.
+   *
+   * Unchanged comments stay in place and are only reordered.  Changed
+   * comments are updated through their setters.  Removed comments are
+   * deleted, and added comments are created.  Pointers to removed comments
+   * are therefore no longer valid.  The document is left unchanged if the
+   * difference cannot be applied to it.
+   *
+   * @param older the document to update; it must have the comments of the
+   * older document the difference was computed from.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+   *
+   * The operation fails if @p older does not have getNumOlderComments()
+   * comments.
+   */
+  int apply(TSBDocument& older) const;
+
+
+  /**
+   * Applies this difference to the list of comments @p older.
+   *
+   * @param older the list to update.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+   *
+   * @see apply(TSBDocument& older)
+   */
+  int apply(TSBListOfComments& older) const;
+
+
+  /** @cond doxygenlibTSBInternal */
+
+  /*
+   * The values of the fields of a comment in a patch; only the fields in
+   * the mask of the entry that refers to them are meaningful.
+   */
+  struct CommentValues
+  {
+    std::string  contributor;
+    double       number;
+    bool         isSetNumber;
+    std::string  point;
+    std::string  metaid;
+    std::string  id;
+    std::string  notes;
+    std::string  annotation;
+  };
+
+  typedef enum
+  {
+      ENTRY_KEEP
+    , ENTRY_CHANGE
+    , ENTRY_ADD
+  } EntryKind;
+
+  /*
+   * One step in building the newer list: keep the older comments
+   * [older, older + count), change the older comment older, or add a new
+   * comment.  values indexes mValues for a change or an addition.
+   */
+  struct Entry
+  {
+    EntryKind     kind;
+    unsigned int  older;
+    unsigned int  count;
+    unsigned int  fields;
+    unsigned int  values;
+  };
+
+  /** @endcond */
+
+
+private:
+
+  /** @cond doxygenlibTSBInternal */
+
+  void addKept(unsigned int older);
+
+  void addValues(Entry& entry, const TSBComment& comment);
+
+  bool summarize();
+
+  unsigned int              mLevel;
+  unsigned int              mVersion;
+  unsigned int              mNumOlder;
+  unsigned int              mNumNewer;
+
+  std::vector<Entry>          mEntries;
+  std::vector<CommentValues>  mValues;
+
+  std::vector<unsigned int>   mAdded;
+  std::vector<unsigned int>   mRemoved;
+  std::vector<unsigned int>   mChangedOlder;
+  std::vector<unsigned int>   mChangedNewer;
+  std::vector<unsigned int>   mChangedFields;
+
+  /** @endcond */
+};
+
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+
+
+#ifndef SWIG
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+BEGIN_C_DECLS
+
+
+/**
+ * Creates a new, empty TSBDocumentDiff_t structure.
+ *
+ * @return a pointer to the new TSBDocumentDiff_t structure.
+ *
+ * @memberof TSBDocumentDiff_t
+ */
+LIBTSB_EXTERN
+TSBDocumentDiff_t *
+TSBDocumentDiff_create ();
+
+
+/**
+ * Frees the given TSBDocumentDiff_t structure.
+ *
+ * @param dd the TSBDocumentDiff_t structure to be freed.
+ *
+ * @memberof TSBDocumentDiff_t
+ */
+LIBTSB_EXTERN
+void
+TSBDocumentDiff_free (TSBDocumentDiff_t *dd);
+
+
+/**
+ * Computes the difference between the comments of two documents.
+ *
+ * @param dd the TSBDocumentDiff_t structure.
+ *
+ * @param older the older TSBDocument_t structure.
+ *
+ * @param newer the newer TSBDocument_t structure.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+ *
+ * @memberof TSBDocumentDiff_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocumentDiff_compute (TSBDocumentDiff_t *dd,
+                         const TSBDocument_t *older,
+                         const TSBDocument_t *newer);
+
+
+/**
+ * Returns the number of comments added by the given difference.
+ *
+ * @param dd the TSBDocumentDiff_t structure.
+ *
+ * @return the number of added comments, or @c 0 if @p dd is @c NULL.
+ *
+ * @memberof TSBDocumentDiff_t
+ */
+LIBTSB_EXTERN
+unsigned int
+TSBDocumentDiff_getNumAdded (const TSBDocumentDiff_t *dd);
+
+
+/**
+ * Returns the number of comments removed by the given difference.
+ *
+ * @param dd the TSBDocumentDiff_t structure.
+ *
+ * @return the number of removed comments, or @c 0 if @p dd is @c NULL.
+ *
+ * @memberof TSBDocumentDiff_t
+ */
+LIBTSB_EXTERN
+unsigned int
+TSBDocumentDiff_getNumRemoved (const TSBDocumentDiff_t *dd);
+
+
+/**
+ * Returns the number of comments changed by the given difference.
+ *
+ * @param dd the TSBDocumentDiff_t structure.
+ *
+ * @return the number of changed comments, or @c 0 if @p dd is @c NULL.
+ *
+ * @memberof TSBDocumentDiff_t
+ */
+LIBTSB_EXTERN
+unsigned int
+TSBDocumentDiff_getNumChanged (const TSBDocumentDiff_t *dd);
+
+
+/**
+ * Returns the given difference as a patch.
+ *
+ * @param dd the TSBDocumentDiff_t structure.
+ *
+ * @return the patch, which the caller owns and must free, or @c NULL if
+ * @p dd is @c NULL.
+ *
+ * @memberof TSBDocumentDiff_t
+ */
+LIBTSB_EXTERN
+char *
+TSBDocumentDiff_getPatch (const TSBDocumentDiff_t *dd);
+
+
+/**
+ * Replaces the content of the given difference with a patch.
+ *
+ * @param dd the TSBDocumentDiff_t structure.
+ *
+ * @param patch the patch, as returned by TSBDocumentDiff_getPatch().
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @memberof TSBDocumentDiff_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocumentDiff_setPatch (TSBDocumentDiff_t *dd, const char *patch);
+
+
+/**
+ * Applies the given difference to the older document.
+ *
+ * @param dd the TSBDocumentDiff_t structure.
+ *
+ * @param older the TSBDocument_t structure to update.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+ *
+ * @memberof TSBDocumentDiff_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocumentDiff_apply (const TSBDocumentDiff_t *dd, TSBDocument_t *older);
+
+
+END_C_DECLS
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* !SWIG */
+
+
+#endif /* !TSBDocumentDiff_H__ */
@@ -0,0 +1,268 @@
+/**
+ * @file TSBDocumentSnapshot.cpp
+ * @brief Implementation of the TSBDocumentSnapshot class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+#include <algorithm>
+#include <unordered_set>
+
+#include <tsb/TSBDocumentSnapshot.h>
+#include <tsb/TSBDocument.h>
+#include <xml/XMLNode.h>
+#include <tsb/util/XMLTokenBuffer.h>
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Records the comment order and the document level state of doc.
+ */
+TSBDocumentSnapshot::TSBDocumentSnapshot(const TSBDocument& doc)
+  : mItems()
+  , mSortedItems()
+  , mPreserved()
+  , mLevel (doc.mLevel)
+  , mIsSetLevel (doc.mIsSetLevel)
+  , mVersion (doc.mVersion)
+  , mIsSetVersion (doc.mIsSetVersion)
+  , mMetaId (doc.mMetaId)
+  , mId (doc.mId)
+  , mNotes (NULL)
+  , mTestAnnotation (NULL)
+{
+  const TSBListOfComments& comments = doc.mComments;
+  mItems.reserve(comments.size());
+  for (unsigned int n = 0; n < comments.size(); ++n)
+  {
+    mItems.push_back(comments.get(n));
+  }
+
+  mSortedItems = mItems;
+  sort(mSortedItems.begin(), mSortedItems.end());
+
+  if (doc.isSetNotes())
+  {
+    mNotes = doc.getNotes()->clone();
+  }
+
+  if (doc.isSetTestAnnotation())
+  {
+    mTestAnnotation = doc.getTestAnnotation()->clone();
+  }
+}
+
+
+/*
+ * Destructor
+ */
+TSBDocumentSnapshot::~TSBDocumentSnapshot()
+{
+  unordered_map<const TSBBase*, TSBBase*>::iterator it;
+  for (it = mPreserved.begin(); it != mPreserved.end(); ++it)
+  {
+    delete it->second;
+  }
+
+  delete mNotes;
+  delete mTestAnnotation;
+}
+
+
+/*
+ * Keeps a copy of item, unless one has already been kept.
+ */
+void
+TSBDocumentSnapshot::preserve(const TSBBase* item)
+{
+  if (item == NULL || mPreserved.find(item) != mPreserved.end())
+  {
+    return;
+  }
+
+  // comments added after the snapshot are deleted by restore(), so there
+  // is nothing to keep for them
+  if (!binary_search(mSortedItems.begin(), mSortedItems.end(), item))
+  {
+    return;
+  }
+
+  mPreserved[item] = item->clone();
+}
+
+
+/*
+ * Returns the number of comments copied so far.
+ */
+unsigned int
+TSBDocumentSnapshot::getNumPreserved() const
+{
+  return (unsigned int)mPreserved.size();
+}
+
+
+/*
+ * Puts doc back into the recorded state.
+ */
+void
+TSBDocumentSnapshot::restore(TSBDocument& doc)
+{
+  TSBListOfComments& comments = doc.mComments;
+
+  vector<TSBBase*> current;
+  current.reserve(comments.size());
+  for (unsigned int n = 0; n < comments.size(); ++n)
+  {
+    current.push_back(comments.get(n));
+  }
+
+  comments.clear(false);
+
+  unordered_set<const TSBBase*> reused;
+  reused.reserve(mItems.size());
+
+  for (unsigned int n = 0; n < mItems.size(); ++n)
+  {
+    unordered_map<const TSBBase*, TSBBase*>::iterator it =
+      mPreserved.find(mItems[n]);
+
+    if (it != mPreserved.end())
+    {
+      comments.appendAndOwn(it->second);
+      it->second = NULL;
+    }
+    else
+    {
+      // an unmodified comment is still owned by the document
+      comments.appendAndOwn(const_cast<TSBBase*>(mItems[n]));
+      reused.insert(mItems[n]);
+    }
+  }
+
+  for (unsigned int n = 0; n < current.size(); ++n)
+  {
+    if (reused.find(current[n]) == reused.end())
+    {
+      delete current[n];
+    }
+  }
+
+  doc.mLevel = mLevel;
+  doc.mIsSetLevel = mIsSetLevel;
+  doc.mVersion = mVersion;
+  doc.mIsSetVersion = mIsSetVersion;
+  doc.mMetaId = mMetaId;
+  doc.mId = mId;
+
+  delete doc.mNotes;
+  doc.mNotes = mNotes;
+  mNotes = NULL;
+
+  delete doc.mDeferredNotes;
+  doc.mDeferredNotes = NULL;
+
+  delete doc.mTestAnnotation;
+  doc.mTestAnnotation = mTestAnnotation;
+  mTestAnnotation = NULL;
+
+  delete doc.mDeferredTestAnnotation;
+  doc.mDeferredTestAnnotation = NULL;
+}
+
+
+/*
+ * Creates a standalone TSBDocument in the recorded state.
+ */
+TSBDocument*
+TSBDocumentSnapshot::createDocument(const TSBDocument& doc) const
+{
+  TSBDocument* copy = NULL;
+
+  try
+  {
+    copy = new TSBDocument(doc.getTSBNamespaces());
+  }
+  catch (...)
+  {
+    return NULL;
+  }
+
+  copy->mLevel = mLevel;
+  copy->mIsSetLevel = mIsSetLevel;
+  copy->mVersion = mVersion;
+  copy->mIsSetVersion = mIsSetVersion;
+  copy->mMetaId = mMetaId;
+  copy->mId = mId;
+
+  if (mNotes != NULL)
+  {
+    copy->mNotes = mNotes->clone();
+  }
+
+  if (mTestAnnotation != NULL)
+  {
+    copy->mTestAnnotation = mTestAnnotation->clone();
+  }
+
+  for (unsigned int n = 0; n < mItems.size(); ++n)
+  {
+    unordered_map<const TSBBase*, TSBBase*>::const_iterator it =
+      mPreserved.find(mItems[n]);
+
+    const TSBBase* item = (it != mPreserved.end()) ? it->second : mItems[n];
+    copy->mComments.appendAndOwn(item->clone());
+  }
+
+  return copy;
+}
+
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
@@ -0,0 +1,159 @@
+/**
+ * @file TSBDocumentSnapshot.h
+ * @brief Definition of the TSBDocumentSnapshot class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class TSBDocumentSnapshot
+ * @sbmlbrief{} Copy-on-write record of the state of a TSBDocument.
+ *
+ * A TSBDocumentSnapshot is created by TSBDocument::takeSnapshot().  It does
+ * not copy the comments of the document; it only remembers which TSBComment
+ * objects the document held, and in which order.  Every TSBComment shares
+ * its storage with the live document until it is about to be modified or
+ * removed, at which point the document hands it to preserve() and the
+ * snapshot keeps a copy of its original state.  The cost of a snapshot is
+ * therefore proportional to the number of comments edited after it was
+ * taken rather than to the size of the document.
+ *
+ * The attributes, notes and annotation of the TSBDocument itself are copied
+ * when the snapshot is taken.
+ */
+
+
+#ifndef TSBDocumentSnapshot_H__
+#define TSBDocumentSnapshot_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+#include <xml/XMLNode.h>
+
+
+#ifdef __cplusplus
+
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+class TSBBase;
+class TSBDocument;
+
+
+/** @cond doxygenlibTSBInternal */
+#ifndef SWIG
+class LIBTSB_EXTERN TSBDocumentSnapshot
+{
+public:
+
+  /**
+   * Records the current state of the given TSBDocument.
+   */
+  TSBDocumentSnapshot(const TSBDocument& doc);
+
+
+  /**
+   * Destroys the copies of the comments preserved by this snapshot.
+   */
+  ~TSBDocumentSnapshot();
+
+
+  /**
+   * Keeps a copy of the given comment, unless one has already been kept
+   * or the comment was added after the snapshot was taken.  Called before
+   * a comment of the document is modified or removed.
+   */
+  void preserve(const TSBBase* item);
+
+
+  /**
+   * Returns the number of comments that have been copied since the
+   * snapshot was taken.
+   */
+  unsigned int getNumPreserved() const;
+
+
+  /**
+   * Puts the given TSBDocument back into the recorded state.
+   *
+   * Comments that were not modified are reused as they are; the copies of
+   * modified or removed comments replace the live ones, and comments added
+   * after the snapshot was taken are deleted.  The document must no longer
+   * refer to this snapshot when this is called.
+   */
+  void restore(TSBDocument& doc);
+
+
+  /**
+   * Creates a standalone TSBDocument in the recorded state.
+   *
+   * @param doc the TSBDocument this snapshot was taken from.
+   */
+  TSBDocument* createDocument(const TSBDocument& doc) const;
+
+
+private:
+
+  TSBDocumentSnapshot(const TSBDocumentSnapshot& orig);
+  TSBDocumentSnapshot& operator=(const TSBDocumentSnapshot& rhs);
+
+  /* the comments of the document, in their original order */
+  std::vector<const TSBBase*> mItems;
+
+  /* the same comments sorted by address, to look them up */
+  std::vector<const TSBBase*> mSortedItems;
+
+  /* copies of the comments modified or removed since the snapshot */
+  std::unordered_map<const TSBBase*, TSBBase*> mPreserved;
+
+  unsigned int mLevel;
+  bool mIsSetLevel;
+  unsigned int mVersion;
+  bool mIsSetVersion;
+  std::string mMetaId;
+  std::string mId;
+  XMLNode* mNotes;
+  XMLNode* mTestAnnotation;
+};
+#endif /* !SWIG */
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+#endif /* !TSBDocumentSnapshot_H__ */
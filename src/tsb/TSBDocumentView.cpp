@@ -0,0 +1,387 @@
+/**
+ * @file TSBDocumentView.cpp
+ * @brief Implementation of the TSBDocumentView class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+
+
+#include <tsb/TSBDocumentView.h>
+#include <tsb/common/TSBOperationReturnValues.h>
+#include <tsb/util/util.h>
+
+#if defined(WIN32) && !defined(CYGWIN)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/*
+ * Creates a view that is not open.
+ */
+TSBDocumentView::TSBDocumentView()
+  : mSections()
+  , mOpen(false)
+  , mMapping(NULL)
+  , mMappingLength(0)
+  , mMappingHandle(NULL)
+{
+}
+
+
+/*
+ * Destroys this view.
+ */
+TSBDocumentView::~TSBDocumentView()
+{
+  close();
+}
+
+
+/*
+ * Maps the given binary TSB file into memory and opens this view on it.
+ */
+int
+TSBDocumentView::open(const std::string& filename)
+{
+  close();
+
+#if defined(WIN32) && !defined(CYGWIN)
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return LIBTSB_OPERATION_FAILED;
+  }
+
+  LARGE_INTEGER size;
+  HANDLE mapping = NULL;
+  if (GetFileSizeEx(file, &size) && size.QuadPart > 0
+    && (uint64_t)size.QuadPart <= (size_t)-1)
+  {
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  }
+  CloseHandle(file);
+
+  if (mapping == NULL)
+  {
+    return LIBTSB_OPERATION_FAILED;
+  }
+
+  mMapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (mMapping == NULL)
+  {
+    CloseHandle(mapping);
+    return LIBTSB_OPERATION_FAILED;
+  }
+  mMappingHandle = mapping;
+  mMappingLength = (size_t)size.QuadPart;
+#else
+  int file = ::open(filename.c_str(), O_RDONLY);
+  if (file < 0)
+  {
+    return LIBTSB_OPERATION_FAILED;
+  }
+
+  struct stat status;
+  void* mapping = MAP_FAILED;
+  if (fstat(file, &status) == 0 && status.st_size > 0
+    && (uint64_t)status.st_size <= (size_t)-1)
+  {
+    mapping = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED,
+                   file, 0);
+  }
+  ::close(file);
+
+  if (mapping == MAP_FAILED)
+  {
+    return LIBTSB_OPERATION_FAILED;
+  }
+  mMapping = mapping;
+  mMappingLength = (size_t)status.st_size;
+#endif
+
+  int result = openBuffer(static_cast<const char*>(mMapping), mMappingLength);
+  if (result != LIBTSB_OPERATION_SUCCESS)
+  {
+    unmap();
+  }
+  return result;
+}
+
+
+/*
+ * Opens this view on length bytes of binary TSB data at data.
+ */
+int
+TSBDocumentView::openBuffer(const char* data, size_t length)
+{
+  if (data != static_cast<const char*>(mMapping))
+  {
+    close();
+  }
+
+  string error;
+  mOpen = TSBBinaryFormat::locate(data, length, mSections, error);
+
+  return mOpen ? LIBTSB_OPERATION_SUCCESS : LIBTSB_OPERATION_FAILED;
+}
+
+
+/*
+ * Closes this view.
+ */
+void
+TSBDocumentView::close()
+{
+  mOpen = false;
+  unmap();
+}
+
+
+/*
+ * Returns true if this view is open.
+ */
+bool
+TSBDocumentView::isOpen() const
+{
+  return mOpen;
+}
+
+
+/*
+ * Returns the level of the viewed document.
+ */
+unsigned int
+TSBDocumentView::getLevel() const
+{
+  return (mOpen && (mSections.header.flags & TSBBinaryFormat::hasLevel) != 0)
+    ? mSections.header.level : 0;
+}
+
+
+/*
+ * Returns the version of the viewed document.
+ */
+unsigned int
+TSBDocumentView::getVersion() const
+{
+  return (mOpen && (mSections.header.flags & TSBBinaryFormat::hasVersion) != 0)
+    ? mSections.header.version : 0;
+}
+
+
+/*
+ * Returns the number of comments in the viewed document.
+ */
+unsigned int
+TSBDocumentView::getNumComments() const
+{
+  return mOpen ? mSections.header.numComments : 0;
+}
+
+
+/*
+ * Returns the contributor of comment n.
+ */
+const char*
+TSBDocumentView::getContributor(unsigned int n) const
+{
+  if (n >= getNumComments())
+  {
+    return NULL;
+  }
+
+  return TSBBinaryFormat::getString(mSections,
+                                    TSBBinaryFormat::getCode(mSections, n, 0));
+}
+
+
+/*
+ * Returns true if the number of comment n is set.
+ */
+bool
+TSBDocumentView::isSetNumber(unsigned int n) const
+{
+  return n < getNumComments() && TSBBinaryFormat::isSetNumber(mSections, n);
+}
+
+
+/*
+ * Returns the number of comment n.
+ */
+double
+TSBDocumentView::getNumber(unsigned int n) const
+{
+  return isSetNumber(n) ? TSBBinaryFormat::getNumber(mSections, n)
+                        : tsb_util_NaN();
+}
+
+
+/*
+ * Returns the point of comment n.
+ */
+const char*
+TSBDocumentView::getPoint(unsigned int n) const
+{
+  if (n >= getNumComments())
+  {
+    return NULL;
+  }
+
+  uint32_t length;
+  return TSBBinaryFormat::getPoint(mSections, n, length);
+}
+
+
+/** @cond doxygenlibTSBInternal */
+/*
+ * Releases the mapping of the viewed file, if there is one.
+ */
+void
+TSBDocumentView::unmap()
+{
+  if (mMapping == NULL)
+  {
+    return;
+  }
+
+#if defined(WIN32) && !defined(CYGWIN)
+  UnmapViewOfFile(mMapping);
+  CloseHandle(static_cast<HANDLE>(mMappingHandle));
+#else
+  munmap(mMapping, mMappingLength);
+#endif
+
+  mMapping = NULL;
+  mMappingLength = 0;
+  mMappingHandle = NULL;
+}
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+/** @cond doxygenIgnored */
+LIBTSB_EXTERN
+TSBDocumentView_t *
+TSBDocumentView_create ()
+{
+  return new (nothrow) TSBDocumentView;
+}
+
+
+LIBTSB_EXTERN
+void
+TSBDocumentView_free (TSBDocumentView_t *dv)
+{
+  delete dv;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBDocumentView_open (TSBDocumentView_t *dv, const char *filename)
+{
+  if (dv == NULL) return LIBTSB_INVALID_OBJECT;
+
+  return (filename != NULL) ? dv->open(filename) : LIBTSB_OPERATION_FAILED;
+}
+
+
+LIBTSB_EXTERN
+void
+TSBDocumentView_close (TSBDocumentView_t *dv)
+{
+  if (dv != NULL) dv->close();
+}
+
+
+LIBTSB_EXTERN
+unsigned int
+TSBDocumentView_getNumComments (const TSBDocumentView_t *dv)
+{
+  return (dv != NULL) ? dv->getNumComments() : 0;
+}
+
+
+LIBTSB_EXTERN
+const char *
+TSBDocumentView_getContributor (const TSBDocumentView_t *dv, unsigned int n)
+{
+  return (dv != NULL) ? dv->getContributor(n) : NULL;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBDocumentView_isSetNumber (const TSBDocumentView_t *dv, unsigned int n)
+{
+  return (dv != NULL) ? static_cast<int>(dv->isSetNumber(n)) : 0;
+}
+
+
+LIBTSB_EXTERN
+double
+TSBDocumentView_getNumber (const TSBDocumentView_t *dv, unsigned int n)
+{
+  return (dv != NULL) ? dv->getNumber(n) : tsb_util_NaN();
+}
+
+
+LIBTSB_EXTERN
+const char *
+TSBDocumentView_getPoint (const TSBDocumentView_t *dv, unsigned int n)
+{
+  return (dv != NULL) ? dv->getPoint(n) : NULL;
+}
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
@@ -0,0 +1,398 @@
+/**
+ * @file TSBDocumentView.h
+ * @brief Definition of the TSBDocumentView class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class TSBDocumentView
+ * @sbmlbrief{} Read-only view of the comments in a binary TSB file.
+ *
+ * A TSBDocumentView maps a file written by TSBWriter::writeTSBBinary()
+ * into memory and reads the comments straight from the mapping, without
+ * creating a TSBDocument or any TSBComment.  Opening a file only checks
+ * its header and the bounds of its sections, so it takes the same time
+ * whatever the number of comments, and the pages of the file are read
+ * when a comment on them is first used.  Several processes viewing the
+ * same file share a single copy of it in the page cache.
+ *
+ * Each accessor checks that the data it reads lies within the file, so a
+ * damaged file gives @c NULL or NaN values rather than undefined
+ * behavior.  The strings returned point into the mapping and remain valid
+ * until the view is closed.  The const methods may be called from several
+ * threads at once.
+ *
+ * @see TSBReader::readTSBBinary(const std::string& filename)
+ */
+
+
+#ifndef TSBDocumentView_H__
+#define TSBDocumentView_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+
+
+#ifdef __cplusplus
+
+
+#include <stddef.h>
+#include <string>
+
+#include <tsb/TSBBinaryFormat.h>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+class LIBTSB_EXTERN TSBDocumentView
+{
+public:
+
+  /**
+   * Creates a view that is not open.
+   */
+  TSBDocumentView();
+
+
+  /**
+   * Destroys this view, closing it first.
+   */
+  ~TSBDocumentView();
+
+
+  /**
+   * Maps the given binary TSB file into memory and opens this view on it.
+   * A view that is already open is closed first.
+   *
+   * @param filename the name or full pathname of the file to be viewed.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @sbmlconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @sbmlconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   *
+   * The operation fails if the file cannot be mapped, or if its header or
+   * sections are malformed.  TSBReader::readTSBBinary() reports the
+   * problems with a file in detail.
+   */
+  int open(const std::string& filename);
+
+
+#ifndef SWIG
+  /**
+   * Opens this view on @p length bytes of binary TSB data at @p data,
+   * which must remain unchanged until the view is closed.  A view that is
+   * already open is closed first.
+   *
+   * @param data the first byte of the binary data.
+   * @param length the number of bytes available at @p data.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @sbmlconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @sbmlconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   */
+  int openBuffer(const char* data, size_t length);
+#endif
+
+
+  /**
+   * Closes this view, unmapping its file.
+   */
+  void close();
+
+
+  /**
+   * Predicate returning @c true if this view is open.
+   *
+   * @return @c true if this view is open, @c false otherwise.
+   */
+  bool isOpen() const;
+
+
+  /**
+   * Returns the level of the viewed document.
+   *
+   * @return the level, or @c 0 if the view is not open or the level is not
+   * set.
+   */
+  unsigned int getLevel() const;
+
+
+  /**
+   * Returns the version of the viewed document.
+   *
+   * @return the version, or @c 0 if the view is not open or the version is
+   * not set.
+   */
+  unsigned int getVersion() const;
+
+
+  /**
+   * Returns the number of comments in the viewed document.
+   *
+   * @return the number of comments, or @c 0 if the view is not open.
+   */
+  unsigned int getNumComments() const;
+
+
+  /**
+   * Returns the contributor of comment @p n.
+   *
+   * @param n the index of the comment.
+   *
+   * @return the contributor, an empty string if it is not set, or @c NULL
+   * if @p n is out of range or the data is damaged.
+   */
+  const char* getContributor(unsigned int n) const;
+
+
+  /**
+   * Predicate returning @c true if the number of comment @p n is set.
+   *
+   * @param n the index of the comment.
+   *
+   * @return @c true if the number is set, @c false if it is not or @p n is
+   * out of range.
+   */
+  bool isSetNumber(unsigned int n) const;
+
+
+  /**
+   * Returns the number of comment @p n.
+   *
+   * @param n the index of the comment.
+   *
+   * @return the number, or NaN if it is not set or @p n is out of range.
+   */
+  double getNumber(unsigned int n) const;
+
+
+  /**
+   * Returns the point of comment @p n.
+   *
+   * @param n the index of the comment.
+   *
+   * @return the point, an empty string if it is not set, or @c NULL if
+   * @p n is out of range or the data is damaged.
+   */
+  const char* getPoint(unsigned int n) const;
+
+
+protected:
+  /** @cond doxygenlibTSBInternal */
+
+  TSBBinarySections mSections;
+  bool mOpen;
+
+  /* the mapping of the viewed file, if it was opened from one */
+  void* mMapping;
+  size_t mMappingLength;
+  void* mMappingHandle;
+
+  /** @endcond */
+
+
+private:
+  /** @cond doxygenlibTSBInternal */
+
+  /* a view cannot be copied; not implemented */
+  TSBDocumentView(const TSBDocumentView& orig);
+  TSBDocumentView& operator=(const TSBDocumentView& rhs);
+
+  void unmap();
+
+  /** @endcond */
+};
+
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+
+
+#ifndef SWIG
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+BEGIN_C_DECLS
+
+
+/**
+ * Creates a new TSBDocumentView_t structure that is not open.
+ *
+ * @return a pointer to the new TSBDocumentView_t structure.
+ *
+ * @memberof TSBDocumentView_t
+ */
+LIBTSB_EXTERN
+TSBDocumentView_t *
+TSBDocumentView_create ();
+
+
+/**
+ * Frees the given TSBDocumentView_t structure, closing it first.
+ *
+ * @param dv the TSBDocumentView_t structure to be freed.
+ *
+ * @memberof TSBDocumentView_t
+ */
+LIBTSB_EXTERN
+void
+TSBDocumentView_free (TSBDocumentView_t *dv);
+
+
+/**
+ * Maps the given binary TSB file into memory and opens the view on it.
+ *
+ * @param dv the TSBDocumentView_t structure.
+ *
+ * @param filename the name or full pathname of the file to be viewed.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @sbmlconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @sbmlconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+ * @li @sbmlconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @memberof TSBDocumentView_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocumentView_open (TSBDocumentView_t *dv, const char *filename);
+
+
+/**
+ * Closes the given TSBDocumentView_t structure, unmapping its file.
+ *
+ * @param dv the TSBDocumentView_t structure.
+ *
+ * @memberof TSBDocumentView_t
+ */
+LIBTSB_EXTERN
+void
+TSBDocumentView_close (TSBDocumentView_t *dv);
+
+
+/**
+ * Returns the number of comments in the viewed document.
+ *
+ * @param dv the TSBDocumentView_t structure.
+ *
+ * @return the number of comments, or @c 0 if @p dv is @c NULL or not open.
+ *
+ * @memberof TSBDocumentView_t
+ */
+LIBTSB_EXTERN
+unsigned int
+TSBDocumentView_getNumComments (const TSBDocumentView_t *dv);
+
+
+/**
+ * Returns the contributor of comment @p n.
+ *
+ * @param dv the TSBDocumentView_t structure.
+ *
+ * @param n the index of the comment.
+ *
+ * @return the contributor, which must not be freed, or @c NULL if @p dv
+ * is @c NULL or @p n is out of range.
+ *
+ * @memberof TSBDocumentView_t
+ */
+LIBTSB_EXTERN
+const char *
+TSBDocumentView_getContributor (const TSBDocumentView_t *dv, unsigned int n);
+
+
+/**
+ * Predicate returning @c 1 (true) if the number of comment @p n is set.
+ *
+ * @param dv the TSBDocumentView_t structure.
+ *
+ * @param n the index of the comment.
+ *
+ * @return @c 1 (true) if the number is set, @c 0 (false) otherwise.
+ *
+ * @memberof TSBDocumentView_t
+ */
+LIBTSB_EXTERN
+int
+TSBDocumentView_isSetNumber (const TSBDocumentView_t *dv, unsigned int n);
+
+
+/**
+ * Returns the number of comment @p n.
+ *
+ * @param dv the TSBDocumentView_t structure.
+ *
+ * @param n the index of the comment.
+ *
+ * @return the number, or NaN if it is not set, @p dv is @c NULL or @p n
+ * is out of range.
+ *
+ * @memberof TSBDocumentView_t
+ */
+LIBTSB_EXTERN
+double
+TSBDocumentView_getNumber (const TSBDocumentView_t *dv, unsigned int n);
+
+
+/**
+ * Returns the point of comment @p n.
+ *
+ * @param dv the TSBDocumentView_t structure.
+ *
+ * @param n the index of the comment.
+ *
+ * @return the point, which must not be freed, or @c NULL if @p dv is
+ * @c NULL or @p n is out of range.
+ *
+ * @memberof TSBDocumentView_t
+ */
+LIBTSB_EXTERN
+const char *
+TSBDocumentView_getPoint (const TSBDocumentView_t *dv, unsigned int n);
+
+
+END_C_DECLS
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* !SWIG */
+
+
+#endif /* !TSBDocumentView_H__ */
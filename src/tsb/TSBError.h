@@ -57,6 +57,7 @@ typedef enum
 , TSBNotUTF8                               = 10001 /*!< File does not use UTF-8 encoding. */
 , TSBUnrecognizedElement                   = 10002 /*!< Encountered unrecognized element. */
 , TSBNotSchemaConformant                   = 10003 /*!< Document does not conform to the TSB XML schema. */
+, TSBBadBinaryFormat                       = 10004 /*!< Binary TSB data is malformed or of an unsupported version. */
 , TSBInvalidMathElement                    = 10201
 , TSBMissingTestAnnotationNamespace            = 10401 /*!< Missing declaration of the XML namespace for the annotation. */
 , TSBDuplicateTestAnnotationNamespaces         = 10402 /*!< Multiple annotations using the same XML namespace. */
@@ -83,6 +83,32 @@ TSBErrorLog& TSBErrorLog::operator=(const TSBErrorLog& other)
   return *this;
 }
 
+/*
+* Move Constructor
+*/
+TSBErrorLog::TSBErrorLog (TSBErrorLog&& other) noexcept
+  : XMLErrorLog()
+{
+  mErrors.swap(other.mErrors);
+}
+
+/*
+* Move assignment operator
+*/
+TSBErrorLog& TSBErrorLog::operator=(TSBErrorLog&& other) noexcept
+{
+  if (&other != this)
+  {
+    for (unsigned int n = 0; n < mErrors.size(); ++n)
+    {
+      delete mErrors[n];
+    }
+    mErrors.clear();
+    mErrors.swap(other.mErrors);
+  }
+  return *this;
+}
+
 
 
 /*
@@ -210,24 +236,31 @@ TSBErrorLog::remove (const unsigned int errorId)
   }
 }
 
-void
-TSBErrorLog::removeAll (const unsigned int errorId)
+/*
+ * Helper class used by TSBErrorLog::removeAll.
+ */
+class KeepUnlessErrorId
 {
-  vector<XMLError*>::iterator delIter;
-
-  // finds an item with the given errorId (the first item will be found if
-  // there are two or more items with the same Id)
-  delIter = find_if(mErrors.begin(), mErrors.end(), MatchErrorId(errorId));
+public:
+  KeepUnlessErrorId(const unsigned int theId) : idToDrop(theId) {};
 
-  while ( delIter != mErrors.end() )
+  bool operator() (const XMLError& e) const
   {
-    // deletes (invoke delete operator for the matched item) and erases (removes
-    // the pointer from mErrors) the matched item (if any)
-    delete *delIter;
-    mErrors.erase(delIter);
+    return e.getErrorId() != idToDrop;
+  };
 
-    delIter = find_if(mErrors.begin(), mErrors.end(), MatchErrorId(errorId));
-  }
+private:
+  unsigned int idToDrop;
+};
+
+
+/*
+ * Removes all errors having errorId from the TSBError list.
+ */
+void
+TSBErrorLog::removeAll (const unsigned int errorId)
+{
+  retainIf(KeepUnlessErrorId(errorId));
 }
 
 
@@ -160,6 +160,20 @@ public:
   TSBErrorLog& operator=(const TSBErrorLog& other);
 
 
+#ifndef SWIG
+  /**
+   * Move Constructor; takes over the errors logged in @p other.
+   */
+  TSBErrorLog (TSBErrorLog&& other) noexcept;
+
+
+  /**
+   * Move assignment operator for TSBErrorLog
+   */
+  TSBErrorLog& operator=(TSBErrorLog&& other) noexcept;
+#endif /* !SWIG */
+
+
   /**
    * Destroys this TSBErrorLog.
    */
@@ -260,6 +274,46 @@ public:
   bool contains (const unsigned int errorId) const;
 
 
+#ifndef SWIG
+  /**
+   * Keeps only the errors for which the given predicate returns @c true,
+   * deleting all others.
+   *
+   * The log is compacted in a single pass, so the cost is linear in the
+   * number of errors, and the retained errors keep their relative order.
+   *
+   * @param keep a predicate (function or function object) called with a
+   * <code>const XMLError&</code> for each error in the log.  The log also
+   * holds the errors of the XML parser, which are not TSBError objects.
+   *
+   * @return the number of errors removed from the log.
+   */
+  template <class Predicate>
+  unsigned int retainIf (Predicate keep)
+  {
+    std::vector<XMLError*>::iterator kept = mErrors.begin();
+
+    for (std::vector<XMLError*>::iterator it = mErrors.begin();
+         it != mErrors.end(); ++it)
+    {
+      if (keep(**it))
+      {
+        *kept++ = *it;
+      }
+      else
+      {
+        delete *it;
+      }
+    }
+
+    unsigned int removed = (unsigned int)(mErrors.end() - kept);
+    mErrors.erase(kept, mErrors.end());
+
+    return removed;
+  }
+#endif /* !SWIG */
+
+
   /** @endcond */
 };
 
@@ -115,6 +115,19 @@ static const tsbErrorTableEntry tsbErrorTable[] =
     }
   },
 
+  //10004
+  {
+    TSBBadBinaryFormat,
+    "Malformed binary TSB data",
+    LIBTSB_CAT_TSB,
+    LIBTSB_SEV_ERROR,
+    "Binary TSB data must have been written by TSBWriter::writeTSBBinary() "
+    "with a format version this copy of libTSB supports, and must be "
+    "complete.",
+    {""
+    }
+  },
+
   //10201
   {
     TSBInvalidMathElement,
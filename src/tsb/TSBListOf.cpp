@@ -38,10 +38,15 @@
 
 #include <algorithm>
 #include <functional>
+#include <exception>
+#include <thread>
 
 #include <tsb/TSBVisitor.h>
 #include <tsb/TSBListOf.h>
 #include <tsb/common/common.h>
+#include <tsb/TSBWriteContext.h>
+#include <tsb/TSBContentHasher.h>
+#include <xml/XMLInputStream.h>
 
 /** @cond doxygenIgnored */
 
@@ -57,6 +62,8 @@ LIBTSB_CPP_NAMESPACE_BEGIN
  */
 TSBListOf::TSBListOf (unsigned int level, unsigned int version)
 : TSBBase(level,version)
+, mItemHashSum(0)
+, mIsSetItemHashSum(false)
 {
     if (!hasValidLevelVersionNamespaceCombination())
     throw TSBConstructorException();
@@ -68,6 +75,8 @@ TSBListOf::TSBListOf (unsigned int level, unsigned int version)
  */
 TSBListOf::TSBListOf (TSBNamespaces* tsbns)
 : TSBBase(tsbns)
+, mItemHashSum(0)
+, mIsSetItemHashSum(false)
 {
     if (!hasValidLevelVersionNamespaceCombination())
     throw TSBConstructorException();
@@ -104,7 +113,11 @@ struct Clone : public unary_function<TSBBase*, TSBBase*>
 /*
  * Copy constructor. Creates a copy of this TSBListOf items.
  */
-TSBListOf::TSBListOf (const TSBListOf& orig) : TSBBase(orig), mItems()
+TSBListOf::TSBListOf (const TSBListOf& orig)
+  : TSBBase(orig)
+  , mItems()
+  , mItemHashSum(0)
+  , mIsSetItemHashSum(false)
 {
   mItems.resize( orig.size() );
   transform( orig.mItems.begin(), orig.mItems.end(), mItems.begin(), Clone() );
@@ -125,6 +138,43 @@ TSBListOf& TSBListOf::operator=(const TSBListOf& rhs)
     mItems.resize( rhs.size() );
     transform( rhs.mItems.begin(), rhs.mItems.end(), mItems.begin(), Clone() );
     connectToChild();
+    itemsReplaced();
+  }
+
+  return *this;
+}
+
+
+/*
+ * Move constructor
+ */
+TSBListOf::TSBListOf (TSBListOf&& orig) noexcept
+  : TSBBase(std::move(orig))
+  , mItems()
+  , mItemHashSum(0)
+  , mIsSetItemHashSum(false)
+{
+  mItems.swap(orig.mItems);
+  orig.invalidateItemHashes();
+  connectToChild();
+}
+
+
+/*
+ * Move assignment operator
+ */
+TSBListOf& TSBListOf::operator=(TSBListOf&& rhs) noexcept
+{
+  if(&rhs!=this)
+  {
+    this->TSBBase::operator =(std::move(rhs));
+    // Deletes existing items
+    for_each( mItems.begin(), mItems.end(), Delete() );
+    mItems.clear();
+    mItems.swap(rhs.mItems);
+    connectToChild();
+    itemsReplaced();
+    rhs.itemsReplaced();
   }
 
   return *this;
@@ -176,6 +226,7 @@ TSBListOf::insertAndOwn(int location, TSBBase* item)
   {
     mItems.insert( mItems.begin() + location, item );
     item->connectToParent(this);
+    itemAdded(item);
     return LIBTSB_OPERATION_SUCCESS;
   }
   else if (!isValidTypeForList(item))
@@ -186,11 +237,31 @@ TSBListOf::insertAndOwn(int location, TSBBase* item)
   {
     mItems.insert( mItems.begin() + location, item );
     item->connectToParent(this);
+    itemAdded(item);
     return LIBTSB_OPERATION_SUCCESS;
   }
 }
 
 
+/*
+ * Inserts item at the given location, taking ownership of it only if it is
+ * accepted.
+ */
+int
+TSBListOf::insertAndOwn(int location, std::unique_ptr<TSBBase> item)
+{
+  if (item.get() == NULL) return LIBTSB_INVALID_OBJECT;
+
+  int ret = insertAndOwn(location, item.get());
+  if (ret == LIBTSB_OPERATION_SUCCESS)
+  {
+    item.release();
+  }
+
+  return ret;
+}
+
+
 /*
  * Adds item to the end of this TSBListOf items.  This TSBListOf items assumes
  * no ownership of item and will not delete it.
@@ -220,6 +291,7 @@ TSBListOf::appendAndOwn (TSBBase* item)
   {
     mItems.push_back( item );
     item->connectToParent(this);
+    itemAdded(item);
     return LIBTSB_OPERATION_SUCCESS;
   }
   else if (!isValidTypeForList(item))
@@ -230,10 +302,30 @@ TSBListOf::appendAndOwn (TSBBase* item)
   {
     mItems.push_back( item );
     item->connectToParent(this);
+    itemAdded(item);
     return LIBTSB_OPERATION_SUCCESS;
   }
 }
 
+/*
+ * Adds item to the end of this TSBListOf items, taking ownership of it
+ * only if it is accepted.
+ */
+int
+TSBListOf::appendAndOwn (std::unique_ptr<TSBBase> item)
+{
+  if (item.get() == NULL) return LIBTSB_INVALID_OBJECT;
+
+  int ret = appendAndOwn(item.get());
+  if (ret == LIBTSB_OPERATION_SUCCESS)
+  {
+    item.release();
+  }
+
+  return ret;
+}
+
+
 int TSBListOf::appendFrom(const TSBListOf* list)
 {
   if (list==NULL) return LIBTSB_INVALID_OBJECT;
@@ -348,10 +440,27 @@ TSBListOf::getAllElements()
 void
 TSBListOf::clear (bool doDelete)
 {
+  for (unsigned int n = 0; n < mItems.size(); ++n)
+  {
+    mItems[n]->aboutToChange();
+  }
+
   if (doDelete)
+  {
     for_each( mItems.begin(), mItems.end(), Delete() );
-  
+  }
+  else
+  {
+    // the caller now owns the items, so they must not keep pointing at
+    // this list or its document
+    for (unsigned int n = 0; n < mItems.size(); ++n)
+    {
+      mItems[n]->connectToParent(NULL);
+    }
+  }
+
   mItems.clear();
+  itemsReplaced();
 }
 
 
@@ -374,7 +483,13 @@ TSBListOf::remove (unsigned int n)
 {
   TSBBase* item = get(n);
   
-  if (item != NULL) mItems.erase( mItems.begin() + n );
+  if (item != NULL)
+  {
+    item->aboutToChange();
+    itemRemoved(item);
+    mItems.erase( mItems.begin() + n );
+    item->connectToParent(NULL);
+  }
   
   return item;
 }
@@ -390,6 +505,152 @@ TSBListOf::size () const
 }
 
 
+/*
+ * Reserves storage for at least n items.
+ */
+void
+TSBListOf::reserve (unsigned int n)
+{
+  mItems.reserve(n);
+}
+
+
+/** @cond doxygenLibtsbInternal */
+/*
+ * Returns the number of partitions used by parallelForEach().
+ */
+unsigned int
+TSBListOf::getNumPartitions (unsigned int numThreads) const
+{
+  if (numThreads == 0)
+  {
+    numThreads = std::thread::hardware_concurrency();
+  }
+
+  unsigned int numItems = size();
+  if (numThreads > numItems)
+  {
+    numThreads = numItems;
+  }
+
+  return (numThreads == 0) ? 1 : numThreads;
+}
+
+
+/*
+ * Runs function over numParts contiguous ranges of the items.
+ */
+void
+TSBListOf::runPartitioned (unsigned int numParts, PartitionFunction function,
+                           void* workers) const
+{
+  unsigned int numItems = size();
+
+  if (numParts <= 1)
+  {
+    function(*this, workers, 0, 0, numItems);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors(numParts);
+  threads.reserve(numParts - 1);
+
+  unsigned int begin = 0;
+
+  try
+  {
+    for (unsigned int part = 0; part < numParts; ++part)
+    {
+      unsigned int end = getPartitionBegin(numParts, part + 1);
+
+      auto task = [this, function, workers, part, begin, end, &errors]()
+      {
+        try
+        {
+          function(*this, workers, part, begin, end);
+        }
+        catch (...)
+        {
+          errors[part] = std::current_exception();
+        }
+      };
+
+      // the last partition runs on the calling thread
+      if (part + 1 < numParts)
+      {
+        threads.push_back(std::thread(task));
+      }
+      else
+      {
+        task();
+      }
+
+      begin = end;
+    }
+  }
+  catch (...)
+  {
+    // a thread could not be started; those that were still use errors
+    // and the items, so they must end before the exception leaves
+    for (unsigned int i = 0; i < threads.size(); ++i)
+    {
+      threads[i].join();
+    }
+    throw;
+  }
+
+  for (unsigned int i = 0; i < threads.size(); ++i)
+  {
+    threads[i].join();
+  }
+
+  for (unsigned int part = 0; part < numParts; ++part)
+  {
+    if (errors[part])
+    {
+      std::rethrow_exception(errors[part]);
+    }
+  }
+}
+
+
+/*
+ * Returns the index of the first item of the given partition.
+ */
+unsigned int
+TSBListOf::getPartitionBegin (unsigned int numParts, unsigned int part) const
+{
+  unsigned int numItems = size();
+  unsigned int chunk = numItems / numParts;
+  unsigned int extra = numItems % numParts;
+
+  // the first extra partitions hold one more item than the others
+  return part * chunk + (part < extra ? part : extra);
+}
+
+
+/*
+ * Detaches an item taken out of the list by removeIf().
+ */
+void
+TSBListOf::detachRemovedItem (TSBBase* item, std::vector<TSBBase*>* removed)
+{
+  item->aboutToChange();
+
+  if (removed != NULL)
+  {
+    item->connectToParent(NULL);
+    removed->push_back(item);
+  }
+  else
+  {
+    delete item;
+  }
+}
+/** @endcond */
+
+
 /**
  * Used by TSBListOf::setTSBDocument().
  */
@@ -437,6 +698,54 @@ TSBListOf::connectToChild()
   for_each( mItems.begin(), mItems.end(), SetParentTSBObject(this) );
 }
 
+
+/*
+ * Moves the items of this list, detached, to the end of items.
+ */
+void
+TSBListOf::releaseItems (std::vector<TSBBase*>& items)
+{
+  // the items may outlive this list, so they must not keep pointing at it;
+  // their namespaces are not copied, as reinitialize() replaces them
+  for (unsigned int n = 0; n < mItems.size(); ++n)
+  {
+    mItems[n]->mParentTSBObject = NULL;
+    mItems[n]->mTSB = NULL;
+    mItems[n]->mIsSetContentHash = false;
+    mItems[n]->mContentHashCounted = false;
+  }
+
+  items.insert(items.end(), mItems.begin(), mItems.end());
+  mItems.clear();
+  itemsReplaced();
+}
+
+
+/*
+ * Reads the element at the front of the stream as a new item.
+ */
+TSBBase*
+TSBListOf::readItem ( XMLInputStream& stream)
+{
+  TSBBase* object = createObject(stream);
+
+  if (object == NULL)
+  {
+    stream.skipPastEnd( stream.next() );
+    return NULL;
+  }
+
+  // objects created by appendAndOwn() are already connected
+  if (object->getParentTSBObject() != this)
+  {
+    object->connectToParent(this);
+  }
+
+  object->read(stream);
+
+  return object;
+}
+
 /** @endcond */
 
 
@@ -480,9 +789,10 @@ TSBListOf::getElementName () const
 struct Write : public unary_function<TSBBase*, void>
 {
   XMLOutputStream& stream;
+  TSBWriteContext& context;
 
-  Write (XMLOutputStream& s) : stream(s) { }
-  void operator() (TSBBase* sbase) { sbase->write(stream); }
+  Write (XMLOutputStream& s, TSBWriteContext& c) : stream(s), context(c) { }
+  void operator() (TSBBase* sbase) { sbase->write(stream, context); }
 };
 
 
@@ -493,10 +803,11 @@ struct Write : public unary_function<TSBBase*, void>
  * implementation of this method as well.
  */
 void
-TSBListOf::writeElements (XMLOutputStream& stream) const
+TSBListOf::writeElements (XMLOutputStream& stream,
+                          TSBWriteContext& context) const
 {
-  TSBBase::writeElements(stream);
-  for_each( mItems.begin(), mItems.end(), Write(stream) );
+  TSBBase::writeElements(stream, context);
+  for_each( mItems.begin(), mItems.end(), Write(stream, context) );
 }
 /** @endcond */
 
@@ -532,9 +843,10 @@ TSBListOf::readAttributes (const XMLAttributes& attributes,
 }
 
 void 
-TSBListOf::writeAttributes (XMLOutputStream& stream) const
+TSBListOf::writeAttributes (XMLOutputStream& stream,
+                            TSBWriteContext& context) const
 {
-  TSBBase::writeAttributes(stream);
+  TSBBase::writeAttributes(stream, context);
 }
 
 
@@ -547,6 +859,107 @@ TSBListOf::isValidTypeForList(TSBBase * item)
 
   return match;
 }
+
+
+void
+TSBListOf::itemAdded(TSBBase*)
+{
+  invalidateItemHashes();
+}
+
+
+void
+TSBListOf::itemRemoved(TSBBase*)
+{
+  invalidateItemHashes();
+}
+
+
+void
+TSBListOf::itemsReplaced()
+{
+  invalidateItemHashes();
+}
+
+
+/*
+ * Mixes the content hash of an item with its position, giving the term
+ * the item adds to the item hash sum.
+ */
+static uint64_t
+getItemHashTerm(uint64_t hash, unsigned int index)
+{
+  return TSBContentHasher::mix(hash ^ TSBContentHasher::mix(index));
+}
+
+
+void
+TSBListOf::hashContent(TSBContentHasher& hasher) const
+{
+  TSBBase::hashContent(hasher);
+
+  hasher.addUInt((unsigned int)getItemTypeCode());
+  hasher.addUInt(size());
+  hasher.addUInt(getItemHashSum());
+}
+
+
+void
+TSBListOf::childContentChanged(const TSBBase* child) const
+{
+  if (mIsSetItemHashSum && child->mContentHashCounted)
+  {
+    mItemHashSum -= getItemHashTerm(child->mContentHash,
+                                    child->mContentHashIndex);
+    mChangedItems.push_back(child);
+  }
+
+  invalidateContentHash();
+}
+
+
+uint64_t
+TSBListOf::getItemHashSum() const
+{
+  if (!mIsSetItemHashSum)
+  {
+    mItemHashSum = 0;
+    mChangedItems.clear();
+
+    for (unsigned int n = 0; n < mItems.size(); ++n)
+    {
+      const TSBBase* item = mItems[n];
+      mItemHashSum += getItemHashTerm(item->getContentHash(), n);
+      item->mContentHashIndex = n;
+      item->mContentHashCounted = true;
+    }
+
+    mIsSetItemHashSum = true;
+    return mItemHashSum;
+  }
+
+  // only the items edited in place since the sum was computed; they are
+  // still at the position recorded when they were counted
+  for (size_t n = 0; n < mChangedItems.size(); ++n)
+  {
+    const TSBBase* item = mChangedItems[n];
+    mItemHashSum += getItemHashTerm(item->getContentHash(),
+                                    item->mContentHashIndex);
+    item->mContentHashCounted = true;
+  }
+
+  mChangedItems.clear();
+  return mItemHashSum;
+}
+
+
+void
+TSBListOf::invalidateItemHashes()
+{
+  mIsSetItemHashSum = false;
+  mChangedItems.clear();
+  invalidateContentHash();
+}
 /** @endcond */
 
 
@@ -666,6 +1079,17 @@ TSBListOf_size (const TSBListOf_t *lo)
 }
 
 
+LIBTSB_EXTERN
+int
+TSBListOf_reserve (TSBListOf_t *lo, unsigned int n)
+{
+  if (lo == NULL) return LIBTSB_INVALID_OBJECT;
+
+  lo->reserve(n);
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
 LIBTSB_EXTERN
 int
 TSBListOf_getItemTypeCode (const TSBListOf_t *lo)
@@ -54,6 +54,7 @@
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <memory>
 
 #include <tsb/TSBBase.h>
 
@@ -126,6 +127,23 @@ public:
   TSBListOf& operator=(const TSBListOf& rhs);
 
 
+#ifndef SWIG
+  /**
+   * Move constructor; takes over the items of @p orig without cloning them.
+   *
+   * @param orig the TSBListOf instance to move from; it is left empty.
+   */
+  TSBListOf (TSBListOf&& orig) noexcept;
+
+
+  /**
+   * Move assignment operator for TSBListOf.  The items currently in this
+   * list are deleted and replaced by those of @p rhs, which is left empty.
+   */
+  TSBListOf& operator=(TSBListOf&& rhs) noexcept;
+#endif /* !SWIG */
+
+
 
   /** @cond doxygenLibtsbInternal */
   /**
@@ -189,6 +207,26 @@ public:
   int appendAndOwn (TSBBase* disownedItem);
 
 
+#ifndef SWIG
+  /**
+   * Adds an item to the end of this TSBListOf's list of items, taking
+   * ownership of it.
+   *
+   * If the item is accepted the list owns it from then on; if it is
+   * rejected it is deleted when @p item goes out of scope.
+   *
+   * @param item the item to be added to the list.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+   *
+   * @see appendAndOwn(TSBBase* disownedItem)
+   */
+  int appendAndOwn (std::unique_ptr<TSBBase> item);
+#endif /* !SWIG */
+
+
   /**
    * Adds a clone of a list of items to this TSBListOf's list.
    *
@@ -245,6 +283,27 @@ public:
   int insertAndOwn(int location, TSBBase* disownedItem);
 
 
+#ifndef SWIG
+  /**
+   * Inserts an item at a given position in this TSBListOf's list of items,
+   * taking ownership of it.
+   *
+   * If the item is accepted the list owns it from then on; if it is
+   * rejected it is deleted when @p item goes out of scope.
+   *
+   * @param location the location where to insert the item
+   * @param item the item to be inserted to the list
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+   *
+   * @see insertAndOwn(int location, TSBBase* disownedItem)
+   */
+  int insertAndOwn(int location, std::unique_ptr<TSBBase> item);
+#endif /* !SWIG */
+
+
   /**
    * Get an item from the list.
    *
@@ -362,6 +421,188 @@ public:
   unsigned int size () const;
 
 
+  /**
+   * Reserves storage for at least @p n items, so that adding items up to
+   * that number does not reallocate the storage of this list.
+   *
+   * @param n the number of items to reserve storage for.
+   */
+  void reserve (unsigned int n);
+
+
+#ifndef SWIG
+  /**
+   * Applies a worker functor to every item of this TSBListOf, splitting
+   * the items across several threads.
+   *
+   * The items are partitioned into @p numThreads contiguous ranges.  Each
+   * thread receives its own copy of @p prototype and calls
+   * <code>worker(const TSBBase* item)</code> on every item of its range,
+   * in list order.  Once all threads have finished, the per-thread workers
+   * are folded into a single result, in partition order, by calling
+   * <code>result.merge(const Worker& other)</code>; this is the reduction
+   * hook in which per-thread statistics are combined.  A worker that needs
+   * no reduction can implement merge() as an empty function.
+   *
+   * @param prototype the worker that is copied for each thread.
+   * @param numThreads the number of threads to use; if @c 0 (default),
+   * the number of hardware threads is used.  No more threads than there are
+   * items are ever started, and an empty or single-threaded traversal runs
+   * on the calling thread.
+   *
+   * @return the merged worker.
+   *
+   * @note The traversal only calls const methods and is therefore safe as
+   * long as no thread modifies the list or its items while it runs.  The
+   * const accessors of the libTSB objects (for instance
+   * TSBComment::getContributor(), TSBComment::getNumber(),
+   * TSBComment::getPoint(), the isSet<em>Foo</em>() methods, get() and
+   * size()) only read member data and hold no mutable caches, so they may
+   * be called concurrently from any number of threads.  The exception is
+   * TSBBase::getNotes() and TSBBase::getTestAnnotation() on a document
+   * read with TSBReader::setLazyParsing(), which build the tree on first
+   * use, and TSBBase::getContentHash(), which fills a cache.  Setters, unsetters,
+   * append/remove operations and reading into the document are not
+   * synchronised and must not overlap with a traversal.  If a worker
+   * throws, the remaining threads are still joined and the first exception
+   * is rethrown to the caller.
+   */
+  template<class Worker>
+  Worker parallelForEach (const Worker& prototype,
+                          unsigned int numThreads = 0) const
+  {
+    unsigned int numParts = getNumPartitions(numThreads);
+    std::vector<Worker> workers(numParts, prototype);
+
+    runPartitioned(numParts, &TSBListOf::applyWorker<Worker>, &workers[0]);
+
+    Worker result = workers[0];
+    for (unsigned int i = 1; i < numParts; ++i)
+    {
+      result.merge(workers[i]);
+    }
+
+    return result;
+  }
+
+
+  /**
+   * Sorts the items of this TSBListOf in place.
+   *
+   * The items are reordered within the list itself: they keep their parent
+   * and document, and any data a subclass keeps about its items is
+   * rebuilt once at the end rather than once per move.
+   *
+   * @param comp a functor or function called as
+   * <code>comp(const TSBBase* a, const TSBBase* b)</code> that returns
+   * @c true if @p a must come before @p b.  It must define a strict weak
+   * ordering and must not throw.
+   * @param numThreads the number of threads to sort with; if @c 1
+   * (default), the list is sorted on the calling thread, and if @c 0, the
+   * number of hardware threads is used.  Each thread sorts a contiguous
+   * range of the items, and the ranges are then merged on the calling
+   * thread.
+   *
+   * @note As with parallelForEach(), the list and its items must not be
+   * modified by another thread while the sort runs.
+   *
+   * @see stableSort()
+   */
+  template<class Compare>
+  void sort (Compare comp, unsigned int numThreads = 1)
+  {
+    sortItems(comp, false, numThreads);
+  }
+
+
+  /**
+   * Sorts the items of this TSBListOf in place, keeping items that compare
+   * equal in their current order.
+   *
+   * @param comp a functor or function called as
+   * <code>comp(const TSBBase* a, const TSBBase* b)</code> that returns
+   * @c true if @p a must come before @p b.  It must define a strict weak
+   * ordering and must not throw.
+   * @param numThreads the number of threads to sort with, as for sort().
+   *
+   * @see sort()
+   */
+  template<class Compare>
+  void stableSort (Compare comp, unsigned int numThreads = 1)
+  {
+    sortItems(comp, true, numThreads);
+  }
+
+
+  /**
+   * Removes every item of this TSBListOf for which @p pred returns
+   * @c true, in a single pass over the list.
+   *
+   * The remaining items keep their order.
+   *
+   * @param pred a functor or function called as
+   * <code>pred(const TSBBase* item)</code>.  It must not throw.
+   * @param removed if not @c NULL, the removed items are appended to this
+   * vector, in list order, and the caller owns them; they are detached from
+   * this list and its document, as by remove().  If @c NULL (default), the
+   * removed items are deleted.
+   *
+   * @return the number of items removed.
+   */
+  template<class Predicate>
+  unsigned int removeIf (Predicate pred,
+                         std::vector<TSBBase*>* removed = NULL)
+  {
+    ListItemIter keep = mItems.begin();
+    unsigned int numRemoved = 0;
+
+    for (ListItemIter it = mItems.begin(); it != mItems.end(); ++it)
+    {
+      TSBBase* item = *it;
+      if (pred(static_cast<const TSBBase*>(item)))
+      {
+        detachRemovedItem(item, removed);
+        ++numRemoved;
+      }
+      else
+      {
+        *keep++ = item;
+      }
+    }
+
+    if (numRemoved > 0)
+    {
+      mItems.erase(keep, mItems.end());
+      itemsReplaced();
+    }
+
+    return numRemoved;
+  }
+
+
+  /**
+   * Moves the items of this TSBListOf for which @p pred returns @c true
+   * in front of the others.  The partition is stable: the items keep their
+   * relative order within each of the two groups.
+   *
+   * @param pred a functor or function called as
+   * <code>pred(const TSBBase* item)</code>.  It must not throw.
+   *
+   * @return the number of items for which @p pred returned @c true, which
+   * is also the index of the first item of the second group.
+   */
+  template<class Predicate>
+  unsigned int partition (Predicate pred)
+  {
+    ListItemIter middle = std::stable_partition(mItems.begin(), mItems.end(),
+                                                pred);
+    itemsReplaced();
+
+    return (unsigned int)(middle - mItems.begin());
+  }
+#endif /* !SWIG */
+
+
   /** @cond doxygenLibtsbInternal */
   /**
    * Sets the parent TSBDocument of this TSB object.
@@ -389,6 +630,33 @@ public:
    * @endif
    */
   virtual void connectToChild ();
+
+
+  /**
+   * Moves the items of this TSBListOf to the end of @p items, leaving
+   * this list empty.
+   *
+   * Unlike clear(false), the items no longer refer to this list or its
+   * document but are not given namespaces of their own, so they must
+   * either be deleted or be reinitialized with TSBBase::reinitialize()
+   * before they are used again.  Used by TSBReader to recycle documents.
+   *
+   * @param items the vector the items are appended to.
+   */
+  void releaseItems (std::vector<TSBBase*>& items);
+
+
+  /**
+   * Reads the element at the front of @p stream as a new item of this
+   * list, as when it is met while this list is read.  Used by TSBReader to
+   * read the items of a document that arrives in chunks.
+   *
+   * @param stream the stream, whose next token starts the element.
+   *
+   * @return the item read, or @c NULL if the element is not an item of
+   * this list, in which case it is skipped.
+   */
+  TSBBase* readItem ( XMLInputStream& stream);
   /** @endcond */
 
 
@@ -443,7 +711,10 @@ public:
    * TSB objects as XML elements.  Be sure to call your parents
    * implementation of this method as well.
    */
-  virtual void writeElements (XMLOutputStream& stream) const;
+  virtual void writeElements (XMLOutputStream& stream,
+                              TSBWriteContext& context) const;
+
+  using TSBBase::writeElements;
   /** @endcond */
 
 
@@ -452,6 +723,123 @@ protected:
   typedef std::vector<TSBBase*>           ListItem;
   typedef std::vector<TSBBase*>::iterator ListItemIter;
 
+#ifndef SWIG
+  /**
+   * Callback invoked by runPartitioned() for the items [begin, end) of
+   * partition @p part; @p workers points to the first worker.
+   */
+  typedef void (*PartitionFunction)(const TSBListOf& list, void* workers,
+                                    unsigned int part,
+                                    unsigned int begin, unsigned int end);
+
+  /**
+   * Returns the number of partitions parallelForEach() uses for the
+   * requested number of threads.
+   */
+  unsigned int getNumPartitions (unsigned int numThreads) const;
+
+
+  /**
+   * Splits the items into @p numParts contiguous ranges and invokes
+   * @p function on each of them from its own thread, joining all threads
+   * before returning.
+   */
+  void runPartitioned (unsigned int numParts, PartitionFunction function,
+                       void* workers) const;
+
+
+  template<class Worker>
+  static void applyWorker (const TSBListOf& list, void* workers,
+                           unsigned int part,
+                           unsigned int begin, unsigned int end)
+  {
+    Worker& worker = static_cast<Worker*>(workers)[part];
+    for (unsigned int n = begin; n < end; ++n)
+    {
+      worker(static_cast<const TSBBase*>(list.mItems[n]));
+    }
+  }
+
+
+  /**
+   * Returns the index of the first item of partition @p part when the
+   * items are split into @p numParts ranges by runPartitioned();
+   * partition @p numParts begins at size().
+   */
+  unsigned int getPartitionBegin (unsigned int numParts,
+                                  unsigned int part) const;
+
+
+  /**
+   * The comparator and item storage handed to sortPartition().
+   */
+  template<class Compare>
+  struct SortTask
+  {
+    Compare*  comp;
+    TSBBase** items;
+    bool      stable;
+  };
+
+
+  template<class Compare>
+  static void sortPartition (const TSBListOf&, void* task, unsigned int,
+                             unsigned int begin, unsigned int end)
+  {
+    SortTask<Compare>& t = *static_cast<SortTask<Compare>*>(task);
+    if (t.stable)
+    {
+      std::stable_sort(t.items + begin, t.items + end, *t.comp);
+    }
+    else
+    {
+      std::sort(t.items + begin, t.items + end, *t.comp);
+    }
+  }
+
+
+  /**
+   * Implements sort() and stableSort(): sorts each partition from its own
+   * thread and merges neighbouring partitions until one is left.
+   * Merging keeps the order of equal items, so the result is stable
+   * whenever the partitions were sorted stably.
+   */
+  template<class Compare>
+  void sortItems (Compare& comp, bool stable, unsigned int numThreads)
+  {
+    if (mItems.size() > 1)
+    {
+      unsigned int numParts = getNumPartitions(numThreads);
+      SortTask<Compare> task = { &comp, &mItems[0], stable };
+
+      runPartitioned(numParts, &TSBListOf::sortPartition<Compare>, &task);
+
+      for (unsigned int width = 1; width < numParts; width *= 2)
+      {
+        for (unsigned int part = 0; part + width < numParts;
+             part += 2 * width)
+        {
+          unsigned int last = std::min(part + 2 * width, numParts);
+          std::inplace_merge(
+            mItems.begin() + getPartitionBegin(numParts, part),
+            mItems.begin() + getPartitionBegin(numParts, part + width),
+            mItems.begin() + getPartitionBegin(numParts, last),
+            comp);
+        }
+      }
+    }
+
+    itemsReplaced();
+  }
+#endif /* !SWIG */
+
+
+  /**
+   * Detaches @p item, which removeIf() has taken out of this list, and
+   * either deletes it or hands it to the caller through @p removed.
+   */
+  void detachRemovedItem (TSBBase* item, std::vector<TSBBase*>* removed);
+
   /**
    * Subclasses should override this method to get the list of
    * expected attributes.
@@ -474,17 +862,78 @@ protected:
    * to the XMLOutputStream.  Be sure to call your parents implementation
    * of this method as well.  For example:
    *
-   *   TSBBase::writeAttributes(stream);
+   *   TSBBase::writeAttributes(stream, context);
    *   stream.writeAttribute( "id"  , mId   );
    *   stream.writeAttribute( "name", mName );
    *   ...
    */
-  virtual void writeAttributes (XMLOutputStream& stream) const;
+  virtual void writeAttributes (XMLOutputStream& stream,
+                                TSBWriteContext& context) const;
+
+  using TSBBase::writeAttributes;
 
   virtual bool isValidTypeForList(TSBBase * item);
 
+
+  /**
+   * Called after @p item has been added to this list.  Subclasses that
+   * keep data about their items override this and the two methods below
+   * to keep it up to date, calling the TSBListOf implementation too: it
+   * invalidates the item hash sum.
+   */
+  virtual void itemAdded (TSBBase* item);
+
+
+  /**
+   * Called before @p item is removed from this list.
+   */
+  virtual void itemRemoved (TSBBase* item);
+
+
+  /**
+   * Called after the items of this list have been cleared or replaced as
+   * a whole.
+   */
+  virtual void itemsReplaced ();
+
+
+  /**
+   * Adds the number, type and item hash sum of the items to the content
+   * hash of this list.
+   */
+  virtual void hashContent (TSBContentHasher& hasher) const;
+
+
+  /**
+   * Takes the hash of @p child out of the item hash sum until
+   * getItemHashSum() adds its new hash back.
+   */
+  virtual void childContentChanged (const TSBBase* child) const;
+
+
+  /**
+   * Returns the sum of the content hashes of the items, each mixed with
+   * its position.  Items whose hash changed since the sum was last
+   * computed are hashed again; the sum is only computed over all the items
+   * after items have been added, removed or reordered.
+   */
+  uint64_t getItemHashSum () const;
+
+
+  /**
+   * Discards the item hash sum and the content hash of this list; called
+   * whenever the items are added, removed or reordered.
+   */
+  void invalidateItemHashes ();
+
   ListItem mItems;
 
+  /* the item hash sum, valid if mIsSetItemHashSum; the hashes of
+   * mChangedItems are left out of it until getItemHashSum() adds them */
+  mutable uint64_t                     mItemHashSum;
+  mutable bool                         mIsSetItemHashSum;
+  mutable std::vector<const TSBBase*>  mChangedItems;
+
   /** @endcond */
 };
 
@@ -713,6 +1162,23 @@ unsigned int
 TSBListOf_size (const TSBListOf_t *lo);
 
 
+/**
+ * Reserves storage for at least @p n items in this TSBListOf_t.
+ *
+ * @param lo the TSBListOf_t structure.
+ * @param n the number of items to reserve storage for.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @memberof TSBListOf_t
+ */
+LIBTSB_EXTERN
+int
+TSBListOf_reserve (TSBListOf_t *lo, unsigned int n);
+
+
 /**
  * Get the type code of the objects contained in the given TSBListOf_t
  * structure.
@@ -35,7 +35,12 @@
  * ------------------------------------------------------------------------ -->
  */
 #include <tsb/TSBListOfComments.h>
+#include <tsb/TSBCommentIndex.h>
+#include <tsb/TSBDocument.h>
 #include <xml/XMLInputStream.h>
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
 
 
 using namespace std;
@@ -56,6 +61,7 @@ LIBTSB_CPP_NAMESPACE_BEGIN
  */
 TSBListOfComments::TSBListOfComments(unsigned int level, unsigned int version)
   : TSBListOf(level, version)
+  , mIndex (NULL)
 {
   setTSBNamespacesAndOwn(new TSBNamespaces(level, version));
 }
@@ -67,6 +73,7 @@ TSBListOfComments::TSBListOfComments(unsigned int level, unsigned int version)
  */
 TSBListOfComments::TSBListOfComments(TSBNamespaces *tsbns)
   : TSBListOf(tsbns)
+  , mIndex (NULL)
 {
   setElementNamespace(tsbns->getURI());
 }
@@ -77,7 +84,9 @@ TSBListOfComments::TSBListOfComments(TSBNamespaces *tsbns)
  */
 TSBListOfComments::TSBListOfComments(const TSBListOfComments& orig)
   : TSBListOf( orig )
+  , mIndex (NULL)
 {
+  setIndexed(orig.isIndexed());
 }
 
 
@@ -90,6 +99,40 @@ TSBListOfComments::operator=(const TSBListOfComments& rhs)
   if (&rhs != this)
   {
     TSBListOf::operator=(rhs);
+    setIndexed(rhs.isIndexed());
+  }
+
+  return *this;
+}
+
+
+/*
+ * Move constructor for TSBListOfComments.
+ */
+TSBListOfComments::TSBListOfComments(TSBListOfComments&& orig) noexcept
+  : TSBListOf( std::move(orig) )
+  , mIndex (orig.mIndex)
+{
+  orig.mIndex = NULL;
+}
+
+
+/*
+ * Move assignment operator for TSBListOfComments.
+ */
+TSBListOfComments&
+TSBListOfComments::operator=(TSBListOfComments&& rhs) noexcept
+{
+  if (&rhs != this)
+  {
+    // the index of rhs describes the comments that move here
+    TSBCommentIndex* index = rhs.mIndex;
+    rhs.mIndex = NULL;
+    delete mIndex;
+    mIndex = NULL;
+
+    TSBListOf::operator=(std::move(rhs));
+    mIndex = index;
   }
 
   return *this;
@@ -111,6 +154,7 @@ TSBListOfComments::clone() const
  */
 TSBListOfComments::~TSBListOfComments()
 {
+  delete mIndex;
 }
 
 
@@ -176,18 +220,17 @@ TSBListOfComments::remove(unsigned int n)
 TSBComment*
 TSBListOfComments::remove(const std::string& sid)
 {
-  TSBBase* item = NULL;
   vector<TSBBase*>::iterator result;
 
   result = find_if(mItems.begin(), mItems.end(), TSBIdEq<TSBComment>(sid));
 
-  if (result != mItems.end())
+  if (result == mItems.end())
   {
-    item = *result;
-    mItems.erase(result);
+    return NULL;
   }
 
-  return static_cast <TSBComment*> (item);
+  // removed like any other item, so it is detached from the document
+  return remove((unsigned int)(result - mItems.begin()));
 }
 
 
@@ -225,6 +268,111 @@ TSBListOfComments::addComment(const TSBComment* tsbc)
 }
 
 
+/*
+ * Adds the given TSBComment to this TSBListOfComments, taking ownership.
+ */
+int
+TSBListOfComments::addComment(std::unique_ptr<TSBComment> tsbc)
+{
+  if (tsbc.get() == NULL)
+  {
+    return LIBTSB_OPERATION_FAILED;
+  }
+  else if (tsbc->hasRequiredAttributes() == false)
+  {
+    return LIBTSB_INVALID_OBJECT;
+  }
+  else if (getLevel() != tsbc->getLevel())
+  {
+    return LIBTSB_LEVEL_MISMATCH;
+  }
+  else if (getVersion() != tsbc->getVersion())
+  {
+    return LIBTSB_VERSION_MISMATCH;
+  }
+  else if (matchesRequiredTSBNamespacesForAddition(static_cast<const
+    TSBBase*>(tsbc.get())) == false)
+  {
+    return LIBTSB_NAMESPACES_MISMATCH;
+  }
+  else
+  {
+    return appendAndOwn(std::unique_ptr<TSBBase>(tsbc.release()));
+  }
+}
+
+
+/*
+ * Adds the given TSBComment objects to this TSBListOfComments, taking
+ * ownership of all of them or of none.
+ */
+int
+TSBListOfComments::addComments(std::vector<std::unique_ptr<TSBComment> >&&
+  comments)
+{
+  const unsigned int level = getLevel();
+  const unsigned int version = getVersion();
+  const std::string coreNs = TSBNamespaces::getTSBNamespaceURI(level,
+    version);
+  const bool listHasCoreNs =
+    getTSBNamespaces()->getNamespaces()->containsUri(coreNs);
+
+  // comments created from the same document share their TSBNamespaces, so
+  // the namespace check only needs repeating when the object changes
+  const TSBNamespaces* checked = NULL;
+
+  std::vector<std::unique_ptr<TSBComment> >::const_iterator it;
+  for (it = comments.begin(); it != comments.end(); ++it)
+  {
+    const TSBComment* tsbc = it->get();
+
+    if (tsbc == NULL)
+    {
+      return LIBTSB_OPERATION_FAILED;
+    }
+    else if (tsbc->hasRequiredAttributes() == false)
+    {
+      return LIBTSB_INVALID_OBJECT;
+    }
+    else if (level != tsbc->getLevel())
+    {
+      return LIBTSB_LEVEL_MISMATCH;
+    }
+    else if (version != tsbc->getVersion())
+    {
+      return LIBTSB_VERSION_MISMATCH;
+    }
+
+    const TSBNamespaces* tsbns = tsbc->getTSBNamespaces();
+    if (tsbns != checked)
+    {
+      if (listHasCoreNs == false
+        || tsbns->getNamespaces()->containsUri(coreNs) == false)
+      {
+        return LIBTSB_NAMESPACES_MISMATCH;
+      }
+
+      checked = tsbns;
+    }
+  }
+
+  reserve(size() + (unsigned int)comments.size());
+
+  std::vector<std::unique_ptr<TSBComment> >::iterator next;
+  for (next = comments.begin(); next != comments.end(); ++next)
+  {
+    TSBComment* tsbc = next->release();
+    mItems.push_back(tsbc);
+    tsbc->connectToParent(this);
+    itemAdded(tsbc);
+  }
+
+  comments.clear();
+
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
 /*
  * Get the number of TSBComment objects in this TSBListOfComments.
  */
@@ -261,6 +409,239 @@ TSBListOfComments::createComment()
 }
 
 
+/*
+ * Creates n new TSBComment objects and adds them to this TSBListOfComments.
+ */
+int
+TSBListOfComments::createComments(unsigned int n)
+{
+  std::vector<TSBComment*> created;
+
+  try
+  {
+    created.reserve(n);
+    mItems.reserve(mItems.size() + n);
+
+    for (unsigned int i = 0; i < n; ++i)
+    {
+      // shares the namespaces of the document when there is one
+      created.push_back(new TSBComment(this));
+    }
+  }
+  catch (...)
+  {
+    for (unsigned int i = 0; i < created.size(); ++i)
+    {
+      delete created[i];
+    }
+
+    return LIBTSB_OPERATION_FAILED;
+  }
+
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    mItems.push_back(created[i]);
+    created[i]->connectToParent(this);
+    itemAdded(created[i]);
+  }
+
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+/*
+ * Sets whether this TSBListOfComments keeps indexes on its comments.
+ */
+void
+TSBListOfComments::setIndexed(bool indexed)
+{
+  if (indexed && mIndex == NULL)
+  {
+    mIndex = new TSBCommentIndex(*this);
+  }
+  else if (!indexed)
+  {
+    delete mIndex;
+    mIndex = NULL;
+  }
+}
+
+
+/*
+ * Returns whether this TSBListOfComments keeps indexes on its comments.
+ */
+bool
+TSBListOfComments::isIndexed() const
+{
+  return (mIndex != NULL);
+}
+
+
+/*
+ * Returns the comments with the given contributor.
+ */
+std::vector<TSBComment*>
+TSBListOfComments::getCommentsByContributor(const std::string& contributor)
+{
+  vector<TSBComment*> result;
+
+  if (contributor.empty())
+  {
+    return result;
+  }
+
+  if (mIndex != NULL)
+  {
+    mIndex->getByContributor(contributor, result);
+    return result;
+  }
+
+  for (unsigned int n = 0; n < size(); ++n)
+  {
+    if (get(n)->getContributor() == contributor)
+    {
+      result.push_back(get(n));
+    }
+  }
+
+  return result;
+}
+
+
+/** @cond doxygenlibTSBInternal */
+/*
+ * Orders comments by number; used to sort the comments of a list that is
+ * not indexed.
+ */
+struct TSBCommentNumberLess
+{
+  bool operator() (const TSBComment* a, const TSBComment* b) const
+  {
+    return a->getNumber() < b->getNumber();
+  }
+};
+
+
+/*
+ * Orders comments by number, with comments whose number is unset or NaN
+ * after all the others; used by sortByNumber().
+ */
+struct TSBCommentNumberOrder
+{
+  static bool hasOrderedNumber(const TSBComment* comment)
+  {
+    return comment->isSetNumber() && !std::isnan(comment->getNumber());
+  }
+
+  bool operator() (const TSBComment* a, const TSBComment* b) const
+  {
+    if (!hasOrderedNumber(a))
+    {
+      return false;
+    }
+
+    return !hasOrderedNumber(b) || a->getNumber() < b->getNumber();
+  }
+};
+/** @endcond */
+
+
+/*
+ * Sorts the comments by increasing number.
+ */
+void
+TSBListOfComments::sortByNumber(unsigned int numThreads)
+{
+  stableSort(TSBCommentNumberOrder(), numThreads);
+}
+
+
+/*
+ * Returns the comments whose number lies in [min, max].
+ */
+std::vector<TSBComment*>
+TSBListOfComments::getCommentsInNumberRange(double min, double max)
+{
+  vector<TSBComment*> result;
+
+  if (mIndex != NULL)
+  {
+    mIndex->getInNumberRange(min, max, result);
+    return result;
+  }
+
+  for (unsigned int n = 0; n < size(); ++n)
+  {
+    TSBComment* comment = get(n);
+
+    // NaN compares false, so comments whose number is NaN are left out
+    if (comment->isSetNumber() && comment->getNumber() >= min
+      && comment->getNumber() <= max)
+    {
+      result.push_back(comment);
+    }
+  }
+
+  stable_sort(result.begin(), result.end(), TSBCommentNumberLess());
+  return result;
+}
+
+
+/*
+ * Returns the comments with the given contributor.
+ */
+std::vector<const TSBComment*>
+TSBListOfComments::getCommentsByContributor(
+  const std::string& contributor) const
+{
+  vector<TSBComment*> result =
+    const_cast<TSBListOfComments*>(this)->getCommentsByContributor(contributor);
+  return vector<const TSBComment*>(result.begin(), result.end());
+}
+
+
+/*
+ * Returns the comments whose number lies in [min, max].
+ */
+std::vector<const TSBComment*>
+TSBListOfComments::getCommentsInNumberRange(double min, double max) const
+{
+  vector<TSBComment*> result =
+    const_cast<TSBListOfComments*>(this)->getCommentsInNumberRange(min, max);
+  return vector<const TSBComment*>(result.begin(), result.end());
+}
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Removes the comment from the indexes before its keys change.
+ */
+void
+TSBListOfComments::unindexComment(const TSBComment* comment)
+{
+  if (mIndex != NULL)
+  {
+    mIndex->remove(comment);
+  }
+}
+
+
+/*
+ * Adds the comment to the indexes under its current keys.
+ */
+void
+TSBListOfComments::indexComment(const TSBComment* comment)
+{
+  if (mIndex != NULL)
+  {
+    mIndex->add(comment);
+  }
+}
+
+/** @endcond */
+
+
 /*
  * Returns the XML element name of this TSBListOfComments object.
  */
@@ -308,7 +689,13 @@ TSBListOfComments::createObject( XMLInputStream&
 
   if (name == "comment")
   {
-    object = new TSBComment(getTSBNamespaces());
+    TSBDocument* document = getTSBDocument();
+    object = (document != NULL) ? document->createPooledComment(this) : NULL;
+
+    if (object == NULL)
+    {
+      object = new TSBComment(this);
+    }
     appendAndOwn(object);
   }
 
@@ -318,6 +705,69 @@ TSBListOfComments::createObject( XMLInputStream&
 /** @endcond */
 
 
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Returns the expected attributes shared by all TSBListOfComments objects
+ */
+const ExpectedAttributes*
+TSBListOfComments::getStaticExpectedAttributes() const
+{
+  // a class derived from TSBListOfComments may expect more attributes
+  if (typeid(*this) != typeid(TSBListOfComments))
+  {
+    return NULL;
+  }
+
+  static const ExpectedAttributes attributes = collectExpectedAttributes();
+  return &attributes;
+}
+
+/** @endcond */
+
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Keeps the indexes up to date as comments are added to the list.
+ */
+void
+TSBListOfComments::itemAdded(TSBBase* item)
+{
+  TSBListOf::itemAdded(item);
+  indexComment(static_cast<TSBComment*>(item));
+}
+
+
+/*
+ * Keeps the indexes up to date as comments are removed from the list.
+ */
+void
+TSBListOfComments::itemRemoved(TSBBase* item)
+{
+  TSBListOf::itemRemoved(item);
+  unindexComment(static_cast<TSBComment*>(item));
+}
+
+
+/*
+ * Rebuilds the indexes after the comments have been replaced.
+ */
+void
+TSBListOfComments::itemsReplaced()
+{
+  TSBListOf::itemsReplaced();
+
+  if (mIndex != NULL)
+  {
+    mIndex->rebuild(*this);
+  }
+}
+
+/** @endcond */
+
+
 
 
 #endif /* __cplusplus */
@@ -391,6 +841,23 @@ TSBListOfComments_removeById(TSBListOf_t* tsblo, const char* sid)
 }
 
 
+/*
+ * Sorts the TSBComment_t objects of this TSBListOf_t by number.
+ */
+LIBTSB_EXTERN
+int
+TSBListOfComments_sortByNumber(TSBListOf_t* tsblo, unsigned int numThreads)
+{
+  if (tsblo == NULL)
+  {
+    return LIBTSB_INVALID_OBJECT;
+  }
+
+  static_cast<TSBListOfComments*>(tsblo)->sortByNumber(numThreads);
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
 
 
 LIBTSB_CPP_NAMESPACE_END
@@ -51,6 +51,7 @@
 
 
 #include <string>
+#include <vector>
 
 
 #include <tsb/TSBListOf.h>
@@ -59,6 +60,31 @@
 
 LIBTSB_CPP_NAMESPACE_BEGIN
 
+class TSBCommentIndex;
+
+
+/** @cond doxygenlibTSBInternal */
+/**
+ * Used by TSBListOfComments::parallelForEachComment() to hand the items
+ * of the list to a worker expecting TSBComment objects.
+ */
+#ifndef SWIG
+template<class Worker>
+struct TSBCommentWorker
+{
+  Worker worker;
+
+  TSBCommentWorker (const Worker& w) : worker(w) { }
+
+  void operator() (const TSBBase* item)
+       { worker(static_cast<const TSBComment*>(item)); }
+
+  void merge (const TSBCommentWorker& other)
+       { worker.merge(other.worker); }
+};
+#endif /* !SWIG */
+/** @endcond */
+
 
 class LIBTSB_EXTERN TSBListOfComments : public TSBListOf
 {
@@ -109,6 +135,25 @@ public:
   TSBListOfComments& operator=(const TSBListOfComments& rhs);
 
 
+#ifndef SWIG
+  /**
+   * Move constructor for TSBListOfComments.
+   *
+   * @param orig the TSBListOfComments instance to move from.
+   */
+  TSBListOfComments(TSBListOfComments&& orig) noexcept;
+
+
+  /**
+   * Move assignment operator for TSBListOfComments.
+   *
+   * @param rhs the TSBListOfComments object whose contents are moved into this
+   * one.
+   */
+  TSBListOfComments& operator=(TSBListOfComments&& rhs) noexcept;
+#endif /* !SWIG */
+
+
   /**
    * Creates and returns a deep copy of this TSBListOfComments object.
    *
@@ -276,6 +321,56 @@ public:
   int addComment(const TSBComment* tsbc);
 
 
+#ifndef SWIG
+  /**
+   * Adds the given TSBComment to this TSBListOfComments, taking ownership of it
+   * instead of copying it.
+   *
+   * If the TSBComment is rejected it is deleted when @p tsbc goes out of
+   * scope.
+   *
+   * @param tsbc the TSBComment object to add.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_NAMESPACES_MISMATCH, OperationReturnValues_t}
+   *
+   * @see addComment(const TSBComment* tsbc)
+   */
+  int addComment(std::unique_ptr<TSBComment> tsbc);
+
+  /**
+   * Adds the given TSBComment objects to the end of this TSBListOfComments, taking
+   * ownership of them.
+   *
+   * Each comment is checked as addComment() checks it, but the namespaces
+   * of this TSBListOfComments are looked up once for the whole batch, and a
+   * comment that shares its TSBNamespaces with the one before it is not
+   * checked against them again.  Either every comment is added or none
+   * is: if one of them is rejected, @p comments is left unchanged.  On
+   * success, @p comments is left empty.
+   *
+   * @param comments the TSBComment objects to add.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_LEVEL_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_VERSION_MISMATCH, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_NAMESPACES_MISMATCH, OperationReturnValues_t}
+   *
+   * @see addComment(std::unique_ptr<TSBComment> tsbc)
+   * @see createComments(unsigned int n)
+   */
+  int addComments(std::vector<std::unique_ptr<TSBComment> >&& comments);
+#endif /* !SWIG */
+
+
   /**
    * Get the number of TSBComment objects in this TSBListOfComments.
    *
@@ -291,6 +386,33 @@ public:
   unsigned int getNumComments() const;
 
 
+#ifndef SWIG
+  /**
+   * Applies a worker functor to every TSBComment in this TSBListOfComments,
+   * splitting the comments across several threads.
+   *
+   * This behaves like TSBListOf::parallelForEach(), except that the worker
+   * is called as <code>worker(const TSBComment* comment)</code>.
+   *
+   * @param prototype the worker that is copied for each thread; it must
+   * provide <code>merge(const Worker& other)</code>.
+   * @param numThreads the number of threads to use; if @c 0 (default),
+   * the number of hardware threads is used.
+   *
+   * @return the merged worker.
+   *
+   * @see TSBListOf::parallelForEach()
+   */
+  template<class Worker>
+  Worker parallelForEachComment(const Worker& prototype,
+                                unsigned int numThreads = 0) const
+  {
+    return parallelForEach(TSBCommentWorker<Worker>(prototype),
+                           numThreads).worker;
+  }
+#endif /* !SWIG */
+
+
   /**
    * Creates a new TSBComment object, adds it to this TSBListOfComments object
    * and returns the TSBComment object created.
@@ -309,6 +431,237 @@ public:
   TSBComment* createComment();
 
 
+  /**
+   * Creates @p n new TSBComment objects and adds them to the end of this
+   * TSBListOfComments.
+   *
+   * The storage for the new comments is reserved once, and they share the
+   * TSBNamespaces of the TSBDocument rather than each taking a copy.  The
+   * comments created are the last @p n of the list, starting at index
+   * <code>getNumComments() - n</code>.
+   *
+   * @param n the number of TSBComment objects to create.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   *
+   * If the comments cannot all be allocated, none of them is added.
+   *
+   * @see createComment()
+   */
+  int createComments(unsigned int n);
+
+
+  /**
+   * Sets whether this TSBListOfComments keeps indexes on the
+   * "contributor" and "number" attributes of its comments.
+   *
+   * getCommentsByContributor() and getCommentsInNumberRange() look at
+   * every comment when the list is not indexed.  An indexed list answers
+   * them from a hash table of contributors and from the comments sorted
+   * by number, at the cost of some memory and of updating the indexes
+   * whenever a comment is added or removed, or its contributor or number
+   * changes.  The indexes are built when they are turned on.
+   *
+   * @param indexed @c true to keep the indexes, @c false (the default) to
+   * drop them.
+   *
+   * @see isIndexed()
+   */
+  void setIndexed(bool indexed);
+
+
+  /**
+   * Returns whether this TSBListOfComments keeps indexes on its comments.
+   *
+   * @return @c true if the list is indexed, @c false otherwise.
+   *
+   * @see setIndexed(bool indexed)
+   */
+  bool isIndexed() const;
+
+
+  /**
+   * Returns the comments of this TSBListOfComments whose "contributor"
+   * attribute has the given value.
+   *
+   * The comments are returned in list order when the list is not indexed,
+   * and in no particular order when it is.
+   *
+   * @param contributor the contributor to look for.
+   *
+   * @return the comments with that contributor, none if @p contributor is
+   * empty.
+   *
+   * @copydetails doc_returned_unowned_pointer
+   *
+   * @see setIndexed(bool indexed)
+   */
+  std::vector<TSBComment*> getCommentsByContributor(
+    const std::string& contributor);
+
+
+  /**
+   * Returns the comments of this TSBListOfComments whose "number"
+   * attribute lies between @p min and @p max, both included, in increasing
+   * order of number.  Comments with the same number are returned in list
+   * order when the list is not indexed.
+   *
+   * @param min the lowest number to return.
+   * @param max the highest number to return.
+   *
+   * @return the comments in the range; comments whose number is not set
+   * or is NaN are never returned.
+   *
+   * @copydetails doc_returned_unowned_pointer
+   *
+   * @see setIndexed(bool indexed)
+   */
+  std::vector<TSBComment*> getCommentsInNumberRange(double min, double max);
+
+
+#ifndef SWIG
+  /**
+   * Returns the comments of this TSBListOfComments whose "contributor"
+   * attribute has the given value.
+   *
+   * @see getCommentsByContributor(const std::string& contributor)
+   */
+  std::vector<const TSBComment*> getCommentsByContributor(
+    const std::string& contributor) const;
+
+
+  /**
+   * Returns the comments of this TSBListOfComments whose "number"
+   * attribute lies between @p min and @p max, both included.
+   *
+   * @see getCommentsInNumberRange(double min, double max)
+   */
+  std::vector<const TSBComment*> getCommentsInNumberRange(double min,
+                                                          double max) const;
+
+
+  /**
+   * Sorts the comments of this TSBListOfComments in place.
+   *
+   * @param comp a functor or function called as
+   * <code>comp(const TSBComment* a, const TSBComment* b)</code> that
+   * returns @c true if @p a must come before @p b.  It must define a
+   * strict weak ordering and must not throw.
+   * @param numThreads the number of threads to sort with; @c 1 (default)
+   * sorts on the calling thread and @c 0 uses the number of hardware
+   * threads.
+   *
+   * @see TSBListOf::sort()
+   */
+  template<class Compare>
+  void sort(Compare comp, unsigned int numThreads = 1)
+  {
+    TSBListOf::sort(CommentCompare<Compare>(comp), numThreads);
+  }
+
+
+  /**
+   * Sorts the comments of this TSBListOfComments in place, keeping
+   * comments that compare equal in their current order.
+   *
+   * @see sort()
+   * @see TSBListOf::stableSort()
+   */
+  template<class Compare>
+  void stableSort(Compare comp, unsigned int numThreads = 1)
+  {
+    TSBListOf::stableSort(CommentCompare<Compare>(comp), numThreads);
+  }
+
+
+  /**
+   * Removes every comment of this TSBListOfComments for which @p pred,
+   * called as <code>pred(const TSBComment* comment)</code>, returns
+   * @c true.
+   *
+   * @param pred the predicate; it must not throw.
+   * @param removed if not @c NULL, the removed comments are appended to
+   * this vector and the caller owns them; otherwise they are deleted.
+   *
+   * @return the number of comments removed.
+   *
+   * @see TSBListOf::removeIf()
+   */
+  template<class Predicate>
+  unsigned int removeIf(Predicate pred,
+                        std::vector<TSBComment*>* removed = NULL)
+  {
+    if (removed == NULL)
+    {
+      return TSBListOf::removeIf(CommentPredicate<Predicate>(pred));
+    }
+
+    std::vector<TSBBase*> items;
+    unsigned int numRemoved =
+      TSBListOf::removeIf(CommentPredicate<Predicate>(pred), &items);
+
+    for (unsigned int n = 0; n < items.size(); ++n)
+    {
+      removed->push_back(static_cast<TSBComment*>(items[n]));
+    }
+
+    return numRemoved;
+  }
+
+
+  /**
+   * Moves the comments for which @p pred, called as
+   * <code>pred(const TSBComment* comment)</code>, returns @c true in front
+   * of the others, keeping the relative order within each group.
+   *
+   * @return the number of comments for which @p pred returned @c true.
+   *
+   * @see TSBListOf::partition()
+   */
+  template<class Predicate>
+  unsigned int partition(Predicate pred)
+  {
+    return TSBListOf::partition(CommentPredicate<Predicate>(pred));
+  }
+#endif /* !SWIG */
+
+
+  /**
+   * Sorts the comments of this TSBListOfComments by increasing "number".
+   *
+   * The sort is stable, so comments with the same number keep their
+   * current order.  Comments whose number is not set, or is NaN, are moved
+   * after all the others.
+   *
+   * @param numThreads the number of threads to sort with; @c 1 (default)
+   * sorts on the calling thread and @c 0 uses the number of hardware
+   * threads.
+   *
+   * @ifnot hasDefaultArgs @htmlinclude warn-default-args-in-docs.html @endif@~
+   */
+  void sortByNumber(unsigned int numThreads = 1);
+
+
+  /** @cond doxygenlibTSBInternal */
+
+  /**
+   * Removes @p comment from the indexes before its contributor or number
+   * changes; indexComment() adds it back after the change.
+   */
+  void unindexComment(const TSBComment* comment);
+
+
+  /**
+   * Adds @p comment to the indexes under its current contributor and
+   * number.
+   */
+  void indexComment(const TSBComment* comment);
+
+  /** @endcond */
+
+
   /**
    * Returns the XML element name of this TSBListOfComments object.
    *
@@ -373,6 +726,73 @@ protected:
   /** @endcond */
 
 
+
+  /** @cond doxygenlibTSBInternal */
+
+  /**
+   * Returns the expected attributes shared by all TSBListOfComments objects
+   */
+  virtual const ExpectedAttributes* getStaticExpectedAttributes() const;
+
+  /** @endcond */
+
+
+
+#ifndef SWIG
+  /** @cond doxygenlibTSBInternal */
+
+  /**
+   * Adapts a comparator on TSBComment objects to the items of the list.
+   */
+  template<class Compare>
+  struct CommentCompare
+  {
+    Compare comp;
+
+    explicit CommentCompare(const Compare& c) : comp(c) {}
+
+    bool operator()(const TSBBase* a, const TSBBase* b) const
+    {
+      return comp(static_cast<const TSBComment*>(a),
+                  static_cast<const TSBComment*>(b));
+    }
+  };
+
+
+  /**
+   * Adapts a predicate on TSBComment objects to the items of the list.
+   */
+  template<class Predicate>
+  struct CommentPredicate
+  {
+    Predicate pred;
+
+    explicit CommentPredicate(const Predicate& p) : pred(p) {}
+
+    bool operator()(const TSBBase* item) const
+    {
+      return pred(static_cast<const TSBComment*>(item));
+    }
+  };
+
+  /** @endcond */
+#endif /* !SWIG */
+
+
+
+  /** @cond doxygenlibTSBInternal */
+
+  virtual void itemAdded(TSBBase* item);
+
+  virtual void itemRemoved(TSBBase* item);
+
+  virtual void itemsReplaced();
+
+  TSBCommentIndex* mIndex;
+
+  /** @endcond */
+
+
 };
 
 
@@ -481,6 +901,27 @@ TSBComment_t*
 TSBListOfComments_removeById(TSBListOf_t* tsblo, const char* sid);
 
 
+/**
+ * Sorts the TSBComment_t objects of this TSBListOf_t by increasing
+ * "number", keeping comments with the same number in their current order
+ * and moving comments without a number to the end.
+ *
+ * @param tsblo the TSBListOf_t structure to sort.
+ *
+ * @param numThreads the number of threads to sort with; @c 1 sorts on the
+ * calling thread and @c 0 uses the number of hardware threads.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @memberof TSBListOfComments_t
+ */
+LIBTSB_EXTERN
+int
+TSBListOfComments_sortByNumber(TSBListOf_t* tsblo, unsigned int numThreads);
+
+
 
 
 END_C_DECLS
@@ -37,6 +37,7 @@
 
 
 #include <tsb/TSBNamespaces.h>
+#include <tsb/TSBAllocationTrace.h>
 #include <sstream>
 #include <tsb/common/common.h>
 #include <iostream>
@@ -87,12 +88,16 @@ TSBNamespaces::TSBNamespaces(unsigned int level, unsigned int version)
  : mLevel(level)
   ,mVersion(version)
 {
+  TSBAllocationTrace::recordAllocation(TSB_ALLOCATION_NAMESPACES,
+                                       sizeof(TSBNamespaces));
   initTSBNamespace();
 }
 
 
 TSBNamespaces::~TSBNamespaces()
 {
+  TSBAllocationTrace::recordFree(TSB_ALLOCATION_NAMESPACES,
+                                 sizeof(TSBNamespaces));
   if (mNamespaces != NULL)
     delete mNamespaces;
 }
@@ -106,6 +111,8 @@ TSBNamespaces::TSBNamespaces(const TSBNamespaces& orig)
  , mVersion(orig.mVersion)
  , mNamespaces(NULL)
 {
+  TSBAllocationTrace::recordAllocation(TSB_ALLOCATION_NAMESPACES,
+                                       sizeof(TSBNamespaces));
   if(orig.mNamespaces != NULL)
     this->mNamespaces = 
           new XMLNamespaces(*const_cast<TSBNamespaces&>(orig).mNamespaces);
@@ -0,0 +1,734 @@
+/**
+ * @file TSBPushParser.cpp
+ * @brief Implementation of the TSBPushParser class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+#include <tsb/TSBPushParser.h>
+#include <tsb/TSBDocument.h>
+#include <tsb/TSBErrorLog.h>
+#include <xml/XMLInputStream.h>
+
+#include <algorithm>
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/** @cond doxygenlibTSBInternal */
+
+static bool
+isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+
+/*
+ * Returns the XML declaration the snippets read are given, declaring the
+ * encoding named by the given declaration of the input, or the default
+ * encoding of XML if it names none.
+ */
+static string
+snippetDeclaration(const string& declaration)
+{
+  string encoding = "UTF-8";
+
+  size_t pos = declaration.find("encoding");
+  if (pos != string::npos)
+  {
+    pos += 8;
+    while (pos < declaration.size() && isSpace(declaration[pos])) ++pos;
+
+    if (pos < declaration.size() && declaration[pos] == '=')
+    {
+      ++pos;
+      while (pos < declaration.size() && isSpace(declaration[pos])) ++pos;
+
+      if (pos < declaration.size()
+        && (declaration[pos] == '"' || declaration[pos] == '\''))
+      {
+        size_t end = declaration.find(declaration[pos], pos + 1);
+        if (end != string::npos)
+        {
+          encoding = declaration.substr(pos + 1, end - pos - 1);
+        }
+      }
+    }
+  }
+
+  return "<?xml version=\"1.0\" encoding=\"" + encoding + "\"?>";
+}
+
+
+/*
+ * Returns the part of a qualified name after its prefix.
+ */
+static string
+localName(const string& name)
+{
+  size_t colon = name.find(':');
+  return (colon == string::npos) ? name : name.substr(colon + 1);
+}
+
+
+/*
+ * Predicate used with TSBErrorLog::retainIf to keep the first n errors.
+ */
+class KeepFirstErrors
+{
+public:
+  KeepFirstErrors(unsigned int n) : remaining(n) {};
+
+  bool operator() (const XMLError&)
+  {
+    if (remaining == 0) return false;
+    --remaining;
+    return true;
+  };
+
+private:
+  unsigned int remaining;
+};
+
+
+/*
+ * Creates a new TSBPushParser reading comments into document.
+ */
+TSBPushParser::TSBPushParser(TSBDocument* document)
+{
+  reset(document);
+}
+
+
+/*
+ * Starts a new input.
+ */
+void
+TSBPushParser::reset(TSBDocument* document)
+{
+  mDocument = document;
+
+  mPending.clear();
+  mPos = 0;
+  mLine = 1;
+  mColumn = 1;
+
+  mSkeleton.clear();
+  mSplitting = true;
+
+  mDepth = 0;
+  mInList = false;
+  mSeenComment = false;
+  mReadComments = false;
+  mNumEmptyLists = 0;
+
+  mDeclaration = snippetDeclaration("");
+  mRootTag.clear();
+  mRootName.clear();
+  mListTag.clear();
+  mListName.clear();
+
+  mCommentStart = string::npos;
+  mCommentLine = 0;
+  mCommentColumn = 0;
+}
+
+
+/*
+ * Appends bytes to the input and reads the comments they complete.
+ */
+void
+TSBPushParser::feed(const char* data, size_t length)
+{
+  if (data != NULL && length > 0)
+  {
+    mPending.append(data, length);
+  }
+
+  scan();
+
+  // only the current comment and incomplete markup are kept
+  size_t consumed = (mCommentStart != string::npos) ? mCommentStart : mPos;
+  if (consumed > 0)
+  {
+    mPending.erase(0, consumed);
+    mPos -= consumed;
+    if (mCommentStart != string::npos)
+    {
+      mCommentStart -= consumed;
+    }
+  }
+}
+
+
+/*
+ * Ends the input.
+ */
+void
+TSBPushParser::finish()
+{
+  // an incomplete comment or markup is left to the reader to report
+  size_t from = (mCommentStart != string::npos) ? mCommentStart : mPos;
+  mSkeleton.append(mPending, from, string::npos);
+
+  mPending.clear();
+  mPos = 0;
+  mCommentStart = string::npos;
+}
+
+
+TSBDocument*
+TSBPushParser::getDocument() const
+{
+  return mDocument;
+}
+
+
+const string&
+TSBPushParser::getSkeleton() const
+{
+  return mSkeleton;
+}
+
+
+unsigned int
+TSBPushParser::getNumEmptyLists() const
+{
+  return mNumEmptyLists;
+}
+
+
+bool
+TSBPushParser::hasReadComments() const
+{
+  return mReadComments;
+}
+
+
+/*
+ * Consumes the complete markup and text at the front of the pending bytes.
+ */
+void
+TSBPushParser::scan()
+{
+  while (mPos < mPending.size())
+  {
+    if (!mSplitting)
+    {
+      mSkeleton.append(mPending, mPos, string::npos);
+      mPos = mPending.size();
+      return;
+    }
+
+    if (mPending[mPos] != '<')
+    {
+      size_t next = mPending.find('<', mPos);
+      advance((next == string::npos) ? mPending.size() : next);
+      continue;
+    }
+
+    size_t end = findMarkupEnd(mPos);
+    if (end == string::npos)
+    {
+      // wait for the rest of the markup
+      return;
+    }
+
+    const char c = mPending[mPos + 1];
+    if (c == '/')
+    {
+      endElement(end);
+    }
+    else if (c == '!' || c == '?')
+    {
+      // the snippets are declared with the encoding of the input, so that
+      // their bytes are decoded as the reader decodes the skeleton
+      if (mDepth == 0 && mRootName.empty()
+        && mPending.compare(mPos, 5, "<?xml") == 0 && end - mPos > 5
+        && isSpace(mPending[mPos + 5]))
+      {
+        mDeclaration = snippetDeclaration(mPending.substr(mPos, end - mPos));
+      }
+
+      advance(end);
+    }
+    else
+    {
+      startElement(mPos, end);
+    }
+  }
+}
+
+
+/*
+ * Returns the position after the markup starting at start, or npos if the
+ * markup is not complete yet.
+ */
+size_t
+TSBPushParser::findMarkupEnd(size_t start) const
+{
+  const size_t available = mPending.size() - start;
+
+  if (available < 2)
+  {
+    return string::npos;
+  }
+
+  if (mPending[start + 1] == '?')
+  {
+    size_t end = mPending.find("?>", start + 2);
+    return (end == string::npos) ? end : end + 2;
+  }
+
+  if (mPending[start + 1] == '!')
+  {
+    static const string comment = "<!--";
+    static const string cdata = "<![CDATA[";
+
+    // wait until comments and CDATA sections can be told apart from
+    // declarations
+    if ((available < comment.size()
+         && mPending.compare(start, available, comment, 0, available) == 0)
+     || (available < cdata.size()
+         && mPending.compare(start, available, cdata, 0, available) == 0))
+    {
+      return string::npos;
+    }
+
+    if (mPending.compare(start, comment.size(), comment) == 0)
+    {
+      size_t end = mPending.find("-->", start + comment.size());
+      return (end == string::npos) ? end : end + 3;
+    }
+
+    if (mPending.compare(start, cdata.size(), cdata) == 0)
+    {
+      size_t end = mPending.find("]]>", start + cdata.size());
+      return (end == string::npos) ? end : end + 3;
+    }
+  }
+
+  // a tag or a declaration such as <!DOCTYPE>, which may have an internal
+  // subset in brackets, ends at the first '>' outside quotes and brackets
+  char quote = 0;
+  unsigned int brackets = 0;
+
+  for (size_t i = start + 1; i < mPending.size(); ++i)
+  {
+    const char c = mPending[i];
+
+    if (quote != 0)
+    {
+      if (c == quote) quote = 0;
+    }
+    else if (c == '"' || c == '\'')
+    {
+      quote = c;
+    }
+    else if (c == '[')
+    {
+      ++brackets;
+    }
+    else if (c == ']')
+    {
+      if (brackets > 0) --brackets;
+    }
+    else if (c == '>' && brackets == 0)
+    {
+      return i + 1;
+    }
+  }
+
+  return string::npos;
+}
+
+
+/*
+ * Moves the scan position to end, keeping track of the line and column.
+ * The bytes go to the skeleton unless they belong to a comment.
+ */
+void
+TSBPushParser::advance(size_t end)
+{
+  for (size_t i = mPos; i < end; ++i)
+  {
+    const unsigned char c = static_cast<unsigned char>(mPending[i]);
+
+    if (c == '\n')
+    {
+      ++mLine;
+      mColumn = 1;
+    }
+    else if ((c & 0xC0) != 0x80)
+    {
+      // count characters rather than UTF-8 continuation bytes
+      ++mColumn;
+    }
+  }
+
+  if (mCommentStart == string::npos)
+  {
+    mSkeleton.append(mPending, mPos, end - mPos);
+  }
+
+  mPos = end;
+}
+
+
+/*
+ * Handles the start tag between start and end.
+ */
+void
+TSBPushParser::startElement(size_t start, size_t end)
+{
+  const bool empty = (mPending[end - 2] == '/');
+
+  if (mCommentStart == string::npos && mDepth < 3)
+  {
+    string name;
+    bool hasAttributes = false;
+    string tag = rebuildStartTag(start, end, name, hasAttributes);
+
+    if (mDepth == 0)
+    {
+      if (localName(name) != "tsb")
+      {
+        // not a TSB document: leave it all to the reader
+        mSplitting = false;
+        advance(end);
+        return;
+      }
+
+      mRootTag = tag;
+      mRootName = name;
+      readHead(start, end);
+    }
+    else if (mDepth == 1 && localName(name) == "listOfComments")
+    {
+      if (mSeenComment)
+      {
+        logRepeatedList();
+      }
+      else if (hasAttributes)
+      {
+        // the first comment read turns the attribute errors of the lists
+        // before it into errors of its own: leave it all to the reader
+        mSplitting = false;
+        advance(end);
+        return;
+      }
+
+      if (!empty)
+      {
+        mInList = true;
+        mListTag = tag;
+        mListName = name;
+      }
+      else if (!mSeenComment)
+      {
+        ++mNumEmptyLists;
+      }
+    }
+    else if (mDepth == 2 && mInList && localName(name) == "comment")
+    {
+      mSeenComment = true;
+
+      mCommentStart = start;
+      mCommentLine = mLine;
+      mCommentColumn = mColumn;
+
+      if (empty)
+      {
+        advance(end);
+        readComment(end);
+        return;
+      }
+    }
+  }
+
+  advance(end);
+
+  if (!empty)
+  {
+    ++mDepth;
+  }
+}
+
+
+/*
+ * Handles the end tag that ends at end.
+ */
+void
+TSBPushParser::endElement(size_t end)
+{
+  advance(end);
+
+  if (mDepth > 0)
+  {
+    --mDepth;
+  }
+
+  if (mCommentStart != string::npos)
+  {
+    if (mDepth == 2)
+    {
+      readComment(end);
+    }
+  }
+  else if (mDepth == 1 && mInList)
+  {
+    mInList = false;
+
+    if (!mSeenComment)
+    {
+      ++mNumEmptyLists;
+    }
+  }
+}
+
+
+/*
+ * Reads the root start tag into the document, so that the comments are
+ * read with its level, version and namespaces.
+ */
+void
+TSBPushParser::readHead(size_t start, size_t end)
+{
+  // the root starts on the line and column it has in the input whenever
+  // possible, so that the errors logged for the document match
+  mSnippet = mDeclaration;
+
+  if (mLine > 1)
+  {
+    mSnippet.append(mLine - 1, '\n');
+    mSnippet.append(mColumn - 1, ' ');
+  }
+  else if (mColumn > mSnippet.size() + 1)
+  {
+    mSnippet.append(mColumn - 1 - mSnippet.size(), ' ');
+  }
+
+  mSnippet.append(mPending, start, end - start);
+
+  if (mPending[end - 2] != '/')
+  {
+    mSnippet.insert(mSnippet.size() - 1, "/");
+  }
+
+  XMLInputStream stream(mSnippet.c_str(), false, "",
+                        mDocument->getErrorLog());
+  mDocument->read(stream);
+
+  // the skeleton is read again once the input is complete, and these
+  // errors are logged then
+  mDocument->getErrorLog()->clearLog();
+}
+
+
+/*
+ * Logs the error the reader would log for a listOfComments that follows
+ * comments, which it cannot tell once those comments have been read.
+ */
+void
+TSBPushParser::logRepeatedList()
+{
+  if (mDocument->getTrustedInput())
+  {
+    return;
+  }
+
+  mDocument->getErrorLog()->logError(TsbDocumentAllowedElements,
+    mDocument->getLevel(), mDocument->getVersion(), "",
+    mDocument->getLine(), mDocument->getColumn());
+}
+
+
+/*
+ * Reads the comment between mCommentStart and end.
+ */
+void
+TSBPushParser::readComment(size_t end)
+{
+  TSBErrorLog* log = mDocument->getErrorLog();
+  TSBListOf* list = mDocument->getListOfComments();
+
+  const unsigned int numErrors = log->getNumErrors();
+  const unsigned int numComments = list->size();
+
+  // the comment with its enclosing start tags, laid out so that it starts
+  // on the line and column it has in the input whenever possible
+  mSnippet = mDeclaration;
+
+  if (mCommentLine > 2)
+  {
+    mSnippet += '\n';
+    mSnippet += mRootTag;
+    mSnippet += mListTag;
+    mSnippet.append(mCommentLine - 2, '\n');
+    mSnippet.append(mCommentColumn - 1, ' ');
+  }
+  else
+  {
+    mSnippet += mRootTag;
+    mSnippet += mListTag;
+
+    if (mCommentLine == 2)
+    {
+      mSnippet += '\n';
+      mSnippet.append(mCommentColumn - 1, ' ');
+    }
+    else if (mCommentColumn > mSnippet.size() + 1)
+    {
+      mSnippet.append(mCommentColumn - 1 - mSnippet.size(), ' ');
+    }
+  }
+
+  mSnippet.append(mPending, mCommentStart, end - mCommentStart);
+  mSnippet += "</" + mListName + "></" + mRootName + ">";
+
+  bool read = false;
+  {
+    XMLInputStream stream(mSnippet.c_str(), false, "", log);
+
+    stream.next();
+    stream.skipText();
+    stream.next();
+    stream.skipText();
+
+    if (stream.isGood() && stream.peek().isStart())
+    {
+      list->readItem(stream);
+      read = !stream.isError();
+    }
+  }
+
+  if (read)
+  {
+    mReadComments = true;
+
+    // the skeleton keeps the line breaks of the comment, so that what
+    // follows keeps its line numbers
+    mSkeleton.append(count(mPending.begin() + mCommentStart,
+                           mPending.begin() + end, '\n'), '\n');
+  }
+  else
+  {
+    // leave this comment, and all that follows, to the reader
+    while (list->size() > numComments)
+    {
+      delete list->remove(list->size() - 1);
+    }
+    log->retainIf(KeepFirstErrors(numErrors));
+
+    mSkeleton.append(mPending, mCommentStart, end - mCommentStart);
+    mSplitting = false;
+  }
+
+  mCommentStart = string::npos;
+}
+
+
+/*
+ * Returns the start tag between start and end with only its namespace
+ * declarations, sets name to its qualified name and hasAttributes to
+ * whether it has other attributes.
+ */
+string
+TSBPushParser::rebuildStartTag(size_t start, size_t end, string& name,
+                               bool& hasAttributes) const
+{
+  size_t i = start + 1;
+  while (i < end && !isSpace(mPending[i]) && mPending[i] != '/'
+         && mPending[i] != '>')
+  {
+    ++i;
+  }
+  name.assign(mPending, start + 1, i - start - 1);
+
+  string tag = "<" + name;
+
+  while (i < end)
+  {
+    while (i < end && isSpace(mPending[i])) ++i;
+
+    const size_t attributeStart = i;
+    while (i < end && mPending[i] != '=' && !isSpace(mPending[i])
+           && mPending[i] != '/' && mPending[i] != '>')
+    {
+      ++i;
+    }
+    if (i == attributeStart) break;
+
+    const string attribute(mPending, attributeStart, i - attributeStart);
+
+    while (i < end && isSpace(mPending[i])) ++i;
+    if (i == end || mPending[i] != '=') break;
+    ++i;
+    while (i < end && isSpace(mPending[i])) ++i;
+    if (i == end || (mPending[i] != '"' && mPending[i] != '\'')) break;
+
+    size_t close = mPending.find(mPending[i], i + 1);
+    if (close == string::npos || close >= end) break;
+    i = close + 1;
+
+    if (attribute == "xmlns" || attribute.compare(0, 6, "xmlns:") == 0)
+    {
+      tag += ' ';
+      tag.append(mPending, attributeStart, i - attributeStart);
+    }
+    else
+    {
+      hasAttributes = true;
+    }
+  }
+
+  tag += '>';
+  return tag;
+}
+
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+LIBTSB_CPP_NAMESPACE_END
@@ -0,0 +1,208 @@
+/**
+ * @file TSBPushParser.h
+ * @brief Definition of the TSBPushParser class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ *
+ * @class TSBPushParser
+ * @sbmlbrief{} State of a document fed to a TSBReader in chunks.
+ *
+ * A TSBPushParser is created by TSBReader::feed() and scans the bytes it is
+ * given for the boundaries of XML markup.  Each
+ * <code>&lt;comment&gt;</code> element of a top-level
+ * <code>&lt;listOfComments&gt;</code> is read as soon as its last byte
+ * arrives, with the namespace declarations of its enclosing elements and
+ * the encoding declared by the input, into a document that collects the
+ * completed comments.  The rest of the
+ * document, with each comment read replaced by its line breaks, is kept as
+ * the skeleton that TSBReader::finish() reads once the input is complete,
+ * so the document attributes, the other elements and the XML declaration
+ * are read and checked as usual.
+ *
+ * Only the current comment and any incomplete markup are buffered.  If a
+ * comment cannot be read on its own, for instance because it is not well
+ * formed, it and everything after it are left in the skeleton.  So is a
+ * <code>&lt;listOfComments&gt;</code> with attributes met before any
+ * comment, as the first comment a TSBReader reads takes over the errors
+ * of those attributes.
+ *
+ * The errors of the comments read are logged in the document, as is the
+ * error for a <code>&lt;listOfComments&gt;</code> that follows comments,
+ * which the reader cannot tell from the skeleton.
+ */
+
+
+#ifndef TSBPushParser_H__
+#define TSBPushParser_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+
+
+#ifdef __cplusplus
+
+
+#include <string>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+class TSBDocument;
+
+
+/** @cond doxygenlibTSBInternal */
+#ifndef SWIG
+class LIBTSB_EXTERN TSBPushParser
+{
+public:
+
+  /**
+   * Creates a new TSBPushParser that reads the completed comments into
+   * @p document, which it does not own.
+   */
+  TSBPushParser(TSBDocument* document);
+
+
+  /**
+   * Starts a new input, reading its completed comments into @p document.
+   * The buffers already allocated are kept.
+   */
+  void reset(TSBDocument* document);
+
+
+  /**
+   * Appends @p length bytes at @p data to the input and reads every
+   * comment they complete.
+   */
+  void feed(const char* data, size_t length);
+
+
+  /**
+   * Ends the input; the bytes still buffered are moved to the skeleton.
+   */
+  void finish();
+
+
+  /**
+   * Returns the document the completed comments are read into.
+   */
+  TSBDocument* getDocument() const;
+
+
+  /**
+   * Returns the input read so far without the comments read from it.
+   */
+  const std::string& getSkeleton() const;
+
+
+  /**
+   * Returns the number of top-level <code>&lt;listOfComments&gt;</code>
+   * elements that ended before any comment was met, which is the number
+   * of empty-list errors a single read of the input would log.
+   */
+  unsigned int getNumEmptyLists() const;
+
+
+  /**
+   * Returns @c true if comments have been read from the input, and so are
+   * missing from the skeleton.
+   */
+  bool hasReadComments() const;
+
+
+private:
+
+  void scan();
+
+  size_t findMarkupEnd(size_t start) const;
+
+  void advance(size_t end);
+
+  void startElement(size_t start, size_t end);
+
+  void endElement(size_t end);
+
+  void readHead(size_t start, size_t end);
+
+  void logRepeatedList();
+
+  void readComment(size_t end);
+
+  std::string rebuildStartTag(size_t start, size_t end, std::string& name,
+                              bool& hasAttributes) const;
+
+
+  TSBDocument* mDocument;
+
+  // the bytes not consumed yet, and the scan position within them
+  std::string mPending;
+  size_t mPos;
+  unsigned int mLine;
+  unsigned int mColumn;
+
+  std::string mSkeleton;
+
+  // false once the input cannot be split into comments
+  bool mSplitting;
+
+  unsigned int mDepth;
+  bool mInList;
+  bool mSeenComment;
+  bool mReadComments;
+  unsigned int mNumEmptyLists;
+
+  // the XML declaration of the snippets, with the encoding of the input
+  std::string mDeclaration;
+
+  // start tags of the root and list elements, with only their namespace
+  // declarations, and their qualified names
+  std::string mRootTag;
+  std::string mRootName;
+  std::string mListTag;
+  std::string mListName;
+
+  // the comment being buffered, if any
+  size_t mCommentStart;
+  unsigned int mCommentLine;
+  unsigned int mCommentColumn;
+
+  std::string mSnippet;
+};
+#endif /* !SWIG */
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+#endif /* !TSBPushParser_H__ */
@@ -45,10 +45,16 @@
 #include <tsb/TSBDocument.h>
 #include <tsb/TSBError.h>
 #include <tsb/TSBReader.h>
+#include <tsb/TSBPushParser.h>
+#include <tsb/TSBBinaryFormat.h>
 
 #include <compress/CompressCommon.h>
 #include <compress/InputDecompressor.h>
 
+#include <cstring>
+#include <fstream>
+#include <typeinfo>
+
 /** @cond doxygenIgnored */
 
 using namespace std;
@@ -63,6 +69,9 @@ LIBTSB_CPP_NAMESPACE_BEGIN
  * Creates a new TSBReader and returns it. 
  */
 TSBReader::TSBReader ()
+  : mLazyParsing (false)
+  , mTrustedInput (false)
+  , mPushParser (NULL)
 {
 }
 
@@ -72,6 +81,13 @@ TSBReader::TSBReader ()
  */
 TSBReader::~TSBReader ()
 {
+  if (mPushParser != NULL)
+  {
+    delete mPushParser->getDocument();
+    delete mPushParser;
+  }
+
+  clearRecycledDocuments();
 }
 
 
@@ -132,17 +148,123 @@ TSBReader::readTSBFromFile (const std::string& filename)
 TSBDocument*
 TSBReader::readTSBFromString (const std::string& xml)
 {
-  const static string dummy_xml ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");  
-  
-  if (!strncmp(xml.c_str(), dummy_xml.c_str(), 14))
+  // c_str() is followed by its NUL character
+  return readTSBFromBuffer(xml.c_str(), xml.size() + 1);
+}
+
+
+/*
+ * Reads an TSB document from length bytes at data, which need not be
+ * NUL-terminated.
+ */
+TSBDocument*
+TSBReader::readTSBFromBuffer (const char* data, size_t length)
+{
+  static const char dummy_xml[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+
+  if (data == NULL)
   {
-    return readInternal(xml.c_str(), false);
+    length = 0;
   }
-  else
+
+  // the parser reads up to the first NUL character
+  const char* end = (length > 0) ?
+    static_cast<const char*>(memchr(data, '\0', length)) : NULL;
+  size_t size = (end != NULL) ? (size_t)(end - data) : length;
+
+  bool hasDeclaration = (size >= 14 && !strncmp(data, dummy_xml, 14));
+
+  if (end != NULL && hasDeclaration)
+  {
+    return readInternal(data, false);
+  }
+
+  mBuffer.clear();
+  if (!hasDeclaration)
+  {
+    mBuffer.append(dummy_xml);
+  }
+  mBuffer.append(data, size);
+
+  return readInternal(mBuffer.c_str(), false);
+}
+
+
+/*
+ * Reads a TSB document from a file in the binary TSB format.
+ */
+TSBDocument*
+TSBReader::readTSBBinary (const std::string& filename)
+{
+  if (tsb_util_file_exists(filename.c_str()) == false)
   {
-    const std::string temp = (dummy_xml + xml);
-    return readInternal(temp.c_str(), false);
+    TSBDocument* d = createDocument();
+    d->getErrorLog()->logError(XMLFileUnreadable);
+    return d;
   }
+
+  std::ifstream stream(filename.c_str(), ios_base::in | ios_base::binary);
+  mBuffer.assign(std::istreambuf_iterator<char>(stream),
+                 std::istreambuf_iterator<char>());
+
+  return readTSBBinaryFromBuffer(mBuffer.data(), mBuffer.size());
+}
+
+
+/*
+ * Reads a TSB document from length bytes of binary TSB data at data.
+ */
+TSBDocument*
+TSBReader::readTSBBinaryFromBuffer (const char* data, size_t length)
+{
+  TSBDocument* d = createDocument();
+
+  d->setCommentPool(&mRecycledComments);
+  TSBBinaryFormat::read(data, length, *d);
+  d->setCommentPool(NULL);
+
+  return d;
+}
+
+
+/*
+ * Sets whether notes and testAnnotation elements are parsed lazily.
+ */
+void
+TSBReader::setLazyParsing (bool lazy)
+{
+  mLazyParsing = lazy;
+}
+
+
+/*
+ * Returns whether notes and testAnnotation elements are parsed lazily.
+ */
+bool
+TSBReader::getLazyParsing () const
+{
+  return mLazyParsing;
+}
+
+
+/*
+ * Sets whether the validation checks are skipped while reading.
+ */
+void
+TSBReader::setTrustedInput (bool trusted)
+{
+  mTrustedInput = trusted;
+}
+
+
+/*
+ * Returns whether the validation checks are skipped while reading.
+ */
+bool
+TSBReader::getTrustedInput () const
+{
+  return mTrustedInput;
 }
 
 
@@ -172,6 +294,79 @@ TSBReader::hasBzip2()
 }
 
 
+/*
+ * The number of documents and comments a TSBReader keeps for reuse.
+ */
+static const size_t maxRecycledDocuments = 4;
+static const size_t maxRecycledComments  = 16384;
+
+
+/*
+ * Resets the given document and keeps it, and its comments, for the next
+ * reads.
+ */
+void
+TSBReader::recycleDocument (TSBDocument* document)
+{
+  if (document == NULL)
+  {
+    return;
+  }
+
+  // a class derived from TSBDocument may hold more than reset() clears
+  if (typeid(*document) != typeid(TSBDocument))
+  {
+    delete document;
+    return;
+  }
+
+  vector<TSBBase*> items;
+  document->reset(items);
+
+  for (size_t i = 0; i < items.size(); ++i)
+  {
+    if (typeid(*items[i]) == typeid(TSBComment)
+      && mRecycledComments.size() < maxRecycledComments)
+    {
+      mRecycledComments.push_back(static_cast<TSBComment*>(items[i]));
+    }
+    else
+    {
+      delete items[i];
+    }
+  }
+
+  if (mRecycledDocuments.size() < maxRecycledDocuments)
+  {
+    mRecycledDocuments.push_back(document);
+  }
+  else
+  {
+    delete document;
+  }
+}
+
+
+/*
+ * Deletes the documents and comments kept for reuse.
+ */
+void
+TSBReader::clearRecycledDocuments ()
+{
+  for (size_t i = 0; i < mRecycledDocuments.size(); ++i)
+  {
+    delete mRecycledDocuments[i];
+  }
+  mRecycledDocuments.clear();
+
+  for (size_t i = 0; i < mRecycledComments.size(); ++i)
+  {
+    delete mRecycledComments[i];
+  }
+  mRecycledComments.clear();
+}
+
+
 /** @cond doxygenLibtsbInternal */
 static bool
 isCriticalError(const unsigned int errorId)
@@ -202,9 +397,180 @@ isCriticalError(const unsigned int errorId)
     return false;
   }
 }
+
+
+/*
+ * Returns the nth error logged for d.  The log also holds the plain
+ * XMLError objects of the parser, which TSBErrorLog::getError() would
+ * cast to TSBError.
+ */
+static const XMLError*
+getLoggedError(const TSBDocument* d, unsigned int n)
+{
+  const XMLErrorLog* log = d->getErrorLog();
+  return log->getError(n);
+}
+
+
+/*
+ * Predicate used with TSBErrorLog::retainIf to keep only critical errors.
+ */
+struct IsCriticalError
+{
+  bool operator() (const XMLError& error) const
+  {
+    return isCriticalError(error.getErrorId());
+  }
+};
+/** @endcond */
+
+
+/** @cond doxygenLibtsbInternal */
+/*
+ * Predicate used with TSBErrorLog::retainIf to drop the empty list errors
+ * logged for lists that are only empty in the skeleton of a fed document.
+ */
+class KeepEmptyListErrors
+{
+public:
+  KeepEmptyListErrors(unsigned int n) : remaining(n) {};
+
+  bool operator() (const XMLError& error)
+  {
+    if (error.getErrorId() != TSBEmptyListElement) return true;
+    if (remaining == 0) return false;
+    --remaining;
+    return true;
+  };
+
+private:
+  unsigned int remaining;
+};
 /** @endcond */
 
 
+/*
+ * Reads the comments completed by the next bytes of a document.
+ */
+int
+TSBReader::feed (const char* data, size_t length)
+{
+  if (data == NULL && length > 0)
+  {
+    return LIBTSB_OPERATION_FAILED;
+  }
+
+  if (mPushParser == NULL)
+  {
+    mPushParser = new TSBPushParser(createDocument());
+  }
+  else if (mPushParser->getDocument() == NULL)
+  {
+    mPushParser->reset(createDocument());
+  }
+
+  TSBDocument* d = mPushParser->getDocument();
+
+  d->setLazyParsing(mLazyParsing);
+  d->setTrustedInput(mTrustedInput);
+  d->setCommentPool(&mRecycledComments);
+  mPushParser->feed(data, length);
+  d->setLazyParsing(false);
+  d->setTrustedInput(false);
+  d->setCommentPool(NULL);
+
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+/*
+ * Returns the number of comments read from the fed bytes and not taken.
+ */
+unsigned int
+TSBReader::getNumCompletedComments () const
+{
+  if (mPushParser == NULL || mPushParser->getDocument() == NULL)
+  {
+    return 0;
+  }
+
+  return mPushParser->getDocument()->getNumComments();
+}
+
+
+/*
+ * Removes the first comment read from the fed bytes and returns it.
+ */
+TSBComment*
+TSBReader::takeCompletedComment ()
+{
+  if (getNumCompletedComments() == 0)
+  {
+    return NULL;
+  }
+
+  return mPushParser->getDocument()->removeComment(0);
+}
+
+
+/*
+ * Reads what remains of the fed document and returns it.
+ */
+TSBDocument*
+TSBReader::finish ()
+{
+  if (mPushParser == NULL || mPushParser->getDocument() == NULL)
+  {
+    return readTSBFromBuffer("", 1);
+  }
+
+  mPushParser->finish();
+
+  // the skeleton is the input without the comments already read
+  const string& skeleton = mPushParser->getSkeleton();
+  TSBDocument* d = readTSBFromBuffer(skeleton.c_str(), skeleton.size() + 1);
+
+  // the lists emptied by reading their comments are not empty
+  if (mPushParser->hasReadComments())
+  {
+    d->getErrorLog()->retainIf(
+      KeepEmptyListErrors(mPushParser->getNumEmptyLists()));
+  }
+
+  TSBDocument* pushed = mPushParser->getDocument();
+  mPushParser->reset(NULL);
+
+  // the errors of the comments read early are suspect once the rest of
+  // the document has turned out to be malformed
+  bool critical = false;
+  for (unsigned int i = 0; i < d->getNumErrors() && !mTrustedInput; ++i)
+  {
+    critical = critical || isCriticalError(getLoggedError(d, i)->getErrorId());
+  }
+
+  if (!critical)
+  {
+    for (unsigned int i = 0; i < pushed->getNumErrors(); ++i)
+    {
+      XMLErrorLog* log = d->getErrorLog();
+      log->add(*getLoggedError(pushed, i));
+    }
+  }
+
+  vector<TSBBase*> items;
+  pushed->getListOfComments()->releaseItems(items);
+
+  for (size_t i = 0; i < items.size(); ++i)
+  {
+    d->getListOfComments()->insertAndOwn((int)i, items[i]);
+  }
+
+  recycleDocument(pushed);
+
+  return d;
+}
+
+
 /** @cond doxygenLibtsbInternal */
 /*
  * Used by readTSB() and readTSBFromString().
@@ -212,7 +578,7 @@ isCriticalError(const unsigned int errorId)
 TSBDocument*
 TSBReader::readInternal (const char* content, bool isFile)
 {
-  TSBDocument* d = new TSBDocument();
+  TSBDocument* d = createDocument();
 
   if (isFile && content != NULL && (tsb_util_file_exists(content) == false))
   {
@@ -229,7 +595,20 @@ TSBReader::readInternal (const char* content, bool isFile)
 	  return d;
     }
 	
+    d->setLazyParsing(mLazyParsing);
+    d->setTrustedInput(mTrustedInput);
+    d->setCommentPool(&mRecycledComments);
     d->read(stream);
+    d->setLazyParsing(false);
+    d->setTrustedInput(false);
+    d->setCommentPool(NULL);
+
+    // trusted input keeps the errors as the parser reported them and
+    // does not have its XML declaration checked
+    if (mTrustedInput)
+    {
+      return d;
+    }
     
     if (stream.isError())
     {
@@ -239,19 +618,14 @@ TSBReader::readInternal (const char* content, bool isFile)
       // different parsers to report different validation errors, we bring
       // all parsers back to the same point.
 
-      for (unsigned int i = 0; i < d->getNumErrors(); ++i)      
+      for (unsigned int i = 0; i < d->getNumErrors(); ++i)
       {
-        if (isCriticalError(d->getError(i)->getErrorId()))
+        if (isCriticalError(getLoggedError(d, i)->getErrorId()))
         {
           // If we find even one critical error, all other errors are
           // suspect and may be bogus.  Remove them.
 
-          for (int n = (int)d->getNumErrors()-1; n >= 0; --n)
-            if (!isCriticalError(d->getError((unsigned int)n)->getErrorId()))
-            {
-              d->getErrorLog()->remove(d->getError((unsigned int)n)->getErrorId());
-            }
-
+          d->getErrorLog()->retainIf(IsCriticalError());
           break;
         }
       }
@@ -283,6 +657,23 @@ TSBReader::readInternal (const char* content, bool isFile)
   }
   return d;
 }
+
+
+/*
+ * Returns a recycled document, or a new one if there is none.
+ */
+TSBDocument*
+TSBReader::createDocument ()
+{
+  if (mRecycledDocuments.empty())
+  {
+    return new TSBDocument();
+  }
+
+  TSBDocument* d = mRecycledDocuments.back();
+  mRecycledDocuments.pop_back();
+  return d;
+}
 /** @endcond */
 
 
@@ -331,13 +722,125 @@ TSBDocument_t *
 TSBReader_readTSBFromString (TSBReader_t *sr, const char *xml)
 {
   if (sr != NULL)
-    return (xml != NULL) ? sr->readTSBFromString(xml) :
+    return (xml != NULL) ? sr->readTSBFromBuffer(xml, strlen(xml) + 1) :
                          sr->readTSBFromString("");
   else
     return NULL;
 }
 
 
+LIBTSB_EXTERN
+TSBDocument_t *
+TSBReader_readTSBFromBuffer (TSBReader_t *sr, const char *data, size_t length)
+{
+  return (sr != NULL) ? sr->readTSBFromBuffer(data, length) : NULL;
+}
+
+
+LIBTSB_EXTERN
+TSBDocument_t *
+TSBReader_readTSBBinary (TSBReader_t *sr, const char *filename)
+{
+  if (sr != NULL)
+    return (filename != NULL) ? sr->readTSBBinary(filename) :
+                                sr->readTSBBinary("");
+  else
+    return NULL;
+}
+
+
+LIBTSB_EXTERN
+TSBDocument_t *
+TSBReader_readTSBBinaryFromBuffer (TSBReader_t *sr, const char *data,
+                                   size_t length)
+{
+  return (sr != NULL) ? sr->readTSBBinaryFromBuffer(data, length) : NULL;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBReader_setLazyParsing (TSBReader_t *sr, int lazy)
+{
+  if (sr == NULL) return LIBTSB_INVALID_OBJECT;
+
+  sr->setLazyParsing(lazy != 0);
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBReader_getLazyParsing (const TSBReader_t *sr)
+{
+  return (sr != NULL) ? static_cast<int>(sr->getLazyParsing()) : 0;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBReader_setTrustedInput (TSBReader_t *sr, int trusted)
+{
+  if (sr == NULL) return LIBTSB_INVALID_OBJECT;
+
+  sr->setTrustedInput(trusted != 0);
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBReader_getTrustedInput (const TSBReader_t *sr)
+{
+  return (sr != NULL) ? static_cast<int>(sr->getTrustedInput()) : 0;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBReader_recycleDocument (TSBReader_t *sr, TSBDocument_t *d)
+{
+  if (sr == NULL) return LIBTSB_INVALID_OBJECT;
+
+  sr->recycleDocument(d);
+  return LIBTSB_OPERATION_SUCCESS;
+}
+
+
+LIBTSB_EXTERN
+int
+TSBReader_feed (TSBReader_t *sr, const char *data, size_t length)
+{
+  if (sr == NULL) return LIBTSB_INVALID_OBJECT;
+
+  return sr->feed(data, length);
+}
+
+
+LIBTSB_EXTERN
+unsigned int
+TSBReader_getNumCompletedComments (const TSBReader_t *sr)
+{
+  return (sr != NULL) ? sr->getNumCompletedComments() : 0;
+}
+
+
+LIBTSB_EXTERN
+TSBComment_t *
+TSBReader_takeCompletedComment (TSBReader_t *sr)
+{
+  return (sr != NULL) ? sr->takeCompletedComment() : NULL;
+}
+
+
+LIBTSB_EXTERN
+TSBDocument_t *
+TSBReader_finish (TSBReader_t *sr)
+{
+  return (sr != NULL) ? sr->finish() : NULL;
+}
+
+
 LIBTSB_EXTERN
 int
 TSBReader_hasZlib (void)
@@ -377,7 +880,36 @@ TSBDocument_t *
 readTSBFromString (const char *xml)
 {
   TSBReader sr;
-  return (xml != NULL) ? sr.readTSBFromString(xml) : sr.readTSBFromString("");
+  return (xml != NULL) ? sr.readTSBFromBuffer(xml, strlen(xml) + 1) :
+                         sr.readTSBFromString("");
+}
+
+
+LIBTSB_EXTERN
+TSBDocument_t *
+readTSBFromBuffer (const char *data, size_t length)
+{
+  TSBReader sr;
+  return sr.readTSBFromBuffer(data, length);
+}
+
+
+LIBTSB_EXTERN
+TSBDocument_t *
+readTSBBinary (const char *filename)
+{
+  TSBReader sr;
+  return (filename != NULL) ? sr.readTSBBinary(filename) :
+                              sr.readTSBBinary("");
+}
+
+
+LIBTSB_EXTERN
+TSBDocument_t *
+readTSBBinaryFromBuffer (const char *data, size_t length)
+{
+  TSBReader sr;
+  return sr.readTSBBinaryFromBuffer(data, length);
 }
 
 LIBTSB_CPP_NAMESPACE_END
@@ -46,14 +46,19 @@
 #include <tsb/common/extern.h>
 #include <tsb/common/tsbfwd.h>
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 
 
 #include <string>
+#include <vector>
 
 LIBTSB_CPP_NAMESPACE_BEGIN
 
 class TSBDocument;
+class TSBComment;
+class TSBPushParser;
 
 
 class LIBTSB_EXTERN TSBReader
@@ -118,6 +123,228 @@ public:
   TSBDocument* readTSBFromString (const std::string& xml);
 
 
+  /**
+   * Reads a TSB document from @p length bytes of memory starting at
+   * @p data, such as a buffer filled from the network.
+   *
+   * The buffer does not need to be NUL-terminated, so callers do not have
+   * to copy it into a string first.  The content ends at the first NUL
+   * character in the buffer, if there is one.  When the buffer holds that
+   * NUL character and starts with an XML declaration, the document is
+   * parsed in place; otherwise the content is copied once into a buffer
+   * owned by this TSBReader, which is reused by later calls.
+   *
+   * @param data the first byte of the TSB content.
+   * @param length the number of bytes available at @p data.
+   *
+   * @return a pointer to the TSBDocument created from the TSB content.
+   *
+   * @see readTSBFromString(@if java String@endif)
+   */
+  TSBDocument* readTSBFromBuffer (const char* data, size_t length);
+
+
+  /**
+   * Reads a TSB document from a file written by
+   * TSBWriter::writeTSBBinary().
+   *
+   * The binary data is checked in full before any object is created, so a
+   * truncated or damaged file gives a document with a
+   * @c TSBBadBinaryFormat error and no comments.
+   *
+   * @param filename the name or full pathname of the file to be read.
+   *
+   * @return a pointer to the TSBDocument created from the binary data.
+   *
+   * @see readTSBBinaryFromBuffer(const char* data, size_t length)
+   */
+  TSBDocument* readTSBBinary (const std::string& filename);
+
+
+  /**
+   * Reads a TSB document from @p length bytes of binary TSB data starting
+   * at @p data, such as a file mapped into memory.
+   *
+   * The data need not be aligned and is not modified or kept.
+   *
+   * @param data the first byte of the binary data.
+   * @param length the number of bytes available at @p data.
+   *
+   * @return a pointer to the TSBDocument created from the binary data.
+   *
+   * @see readTSBBinary(const std::string& filename)
+   */
+  TSBDocument* readTSBBinaryFromBuffer (const char* data, size_t length);
+
+
+  /**
+   * Sets whether documents read by this TSBReader parse their
+   * <code>&lt;notes&gt;</code> and <code>&lt;testAnnotation&gt;</code>
+   * elements lazily.
+   *
+   * When lazy parsing is on, the content of these elements is kept as the
+   * list of its XML tokens and the XMLNode tree is only built the first
+   * time TSBBase::getNotes() or TSBBase::getTestAnnotation() is called
+   * on the object that carries it.  This saves building the trees of
+   * annotation-heavy documents whose notes are never looked at; the
+   * tokens take about as much memory as the tree would.
+   *
+   * The namespace checks made while reading are the same in both modes.
+   *
+   * @param lazy @c true to parse lazily, @c false (the default) to build
+   * the trees while reading.
+   */
+  void setLazyParsing (bool lazy);
+
+
+  /**
+   * Returns whether this TSBReader parses notes and testAnnotation
+   * elements lazily.
+   *
+   * @return @c true if lazy parsing is on, @c false otherwise.
+   *
+   * @see setLazyParsing(bool lazy)
+   */
+  bool getLazyParsing () const;
+
+
+  /**
+   * Sets whether this TSBReader trusts the documents it reads.
+   *
+   * Trusted input is meant for documents written by libTSB itself or by
+   * another producer that is known to write valid TSB.  When it is on,
+   * the reader skips the checks that cost time on clean documents: the
+   * unknown attribute and element checks, the namespace and prefix checks
+   * made on every element, the empty-string and empty-list checks, the
+   * checks of the top-level children of <code>&lt;testAnnotation&gt;</code>
+   * elements and the XML declaration checks.  It also leaves the error
+   * log as the parser reported it when the XML is malformed.
+   *
+   * Malformed XML is still detected and reported, and attribute values
+   * that cannot be converted to their type are still logged.  The
+   * resulting document should not be assumed to be valid TSB: use the
+   * default mode for input of unknown origin.
+   *
+   * @param trusted @c true to skip the checks, @c false (the default) to
+   * make them.
+   */
+  void setTrustedInput (bool trusted);
+
+
+  /**
+   * Returns whether this TSBReader trusts the documents it reads.
+   *
+   * @return @c true if the validation checks are skipped, @c false
+   * otherwise.
+   *
+   * @see setTrustedInput(bool trusted)
+   */
+  bool getTrustedInput () const;
+
+
+  /**
+   * Hands a document back to this TSBReader so that its storage is reused
+   * by the next read, instead of deleting it.
+   *
+   * Servers that read many small documents with the same TSBReader spend
+   * much of each read creating the document and its objects.  A recycled
+   * document is reset and returned by the next readTSB(),
+   * readTSBFromFile() or readTSBFromString() call, and its comments are
+   * reused for the comments read, so that a steady stream of reads
+   * allocates little beyond what the XML parser needs.
+   *
+   * The TSBReader takes ownership of @p document, which must not be used
+   * after this call, nor must any object obtained from it.  It keeps a few
+   * documents and a bounded number of comments; the rest are deleted.
+   *
+   * @param document the document to recycle; @c NULL is ignored.
+   *
+   * @see clearRecycledDocuments()
+   */
+  void recycleDocument (TSBDocument* document);
+
+
+  /**
+   * Deletes the documents and objects kept by recycleDocument().
+   */
+  void clearRecycledDocuments ();
+
+
+  /**
+   * Passes the next @p length bytes of a document to this TSBReader.
+   *
+   * A document that arrives in pieces, for example from a socket, can be
+   * read as it arrives rather than after it has been collected in memory:
+   * each call reads what the new bytes complete, and every
+   * <code>&lt;comment&gt;</code> element that has been read in full is
+   * available from takeCompletedComment() at once, before the closing
+   * <code>&lt;/tsb&gt;</code> tag has arrived.  The chunks may be split
+   * anywhere, including in the middle of a tag or of a UTF-8 character.
+   *
+   * The document is completed by finish(), which returns the same
+   * document as readTSBFromString() would for the whole input, except for
+   * the comments already taken.  It has the same errors, but those found
+   * while feeding, in the comments read and for a repeated
+   * <code>&lt;listOfComments&gt;</code>, are listed after the errors of
+   * the rest of the document rather than in document order.  If the input
+   * turns out to be malformed, the comments completed before the error
+   * are kept, as they may already have been taken.  The lazy parsing and
+   * trusted input settings in effect while feeding apply.
+   *
+   * Only one document can be fed at a time.  The first call after
+   * finish() starts a new document.
+   *
+   * @param data the next bytes of the document.
+   * @param length the number of bytes at @p data.
+   *
+   * @copydetails doc_returns_success_code
+   * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+   * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+   *
+   * @see finish()
+   * @see takeCompletedComment()
+   */
+  int feed (const char* data, size_t length);
+
+
+  /**
+   * Returns the number of comments of the document being fed that have
+   * been read in full and not yet taken.
+   *
+   * @return the number of comments that takeCompletedComment() can
+   * return.
+   *
+   * @see feed(const char* data, size_t length)
+   */
+  unsigned int getNumCompletedComments () const;
+
+
+  /**
+   * Removes the first completed comment of the document being fed and
+   * returns it.
+   *
+   * The caller owns the comment, which is no longer part of the document
+   * returned by finish().
+   *
+   * @return the first completed comment, or @c NULL if there is none.
+   *
+   * @see getNumCompletedComments()
+   */
+  TSBComment* takeCompletedComment ();
+
+
+  /**
+   * Ends the document passed to feed() and returns it.
+   *
+   * @return a pointer to the TSBDocument created from the bytes fed since
+   * the last call to finish(), without the comments that have been taken
+   * with takeCompletedComment().
+   *
+   * @see feed(const char* data, size_t length)
+   */
+  TSBDocument* finish ();
+
+
   /**
    * Static method; returns @c true if this copy of libTSB supports
    * <i>gzip</I> and <i>zip</i> format compression.
@@ -149,6 +376,27 @@ protected:
    */
   TSBDocument* readInternal (const char* content, bool isFile = true);
 
+  /**
+   * Returns a recycled document, or a new one if there is none.
+   */
+  TSBDocument* createDocument ();
+
+  bool mLazyParsing;
+  bool mTrustedInput;
+
+  std::vector<TSBDocument*> mRecycledDocuments;
+  std::vector<TSBComment*>  mRecycledComments;
+
+  std::string mBuffer;
+
+  TSBPushParser* mPushParser;
+
+
+private:
+  /* the recycled objects are owned by a single reader */
+  TSBReader (const TSBReader&);
+  TSBReader& operator= (const TSBReader&);
+
   /** @endcond */
 };
 
@@ -246,6 +494,233 @@ TSBDocument_t *
 TSBReader_readTSBFromString (TSBReader_t *sr, const char *xml);
 
 
+/**
+ * Reads a TSB document from @p length bytes of memory starting at
+ * @p data, which do not need to be NUL-terminated.
+ *
+ * @param sr the TSBReader_t structure to use
+ * @param data the first byte of the TSB content
+ * @param length the number of bytes available at @p data
+ *
+ * @return a pointer to the TSBDocument read.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+TSBDocument_t *
+TSBReader_readTSBFromBuffer (TSBReader_t *sr, const char *data, size_t length);
+
+
+/**
+ * Reads a TSB document from a file in the binary TSB format.
+ *
+ * @param sr the TSBReader_t structure to use
+ * @param filename the name or full pathname of the file to be read
+ *
+ * @return a pointer to the TSBDocument read.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+TSBDocument_t *
+TSBReader_readTSBBinary (TSBReader_t *sr, const char *filename);
+
+
+/**
+ * Reads a TSB document from @p length bytes of binary TSB data starting
+ * at @p data.
+ *
+ * @param sr the TSBReader_t structure to use
+ * @param data the first byte of the binary data
+ * @param length the number of bytes available at @p data
+ *
+ * @return a pointer to the TSBDocument read.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+TSBDocument_t *
+TSBReader_readTSBBinaryFromBuffer (TSBReader_t *sr, const char *data,
+                                   size_t length);
+
+
+/**
+ * Sets whether notes and testAnnotation elements are parsed lazily by
+ * the given TSBReader_t.
+ *
+ * @param sr the TSBReader_t structure to use
+ *
+ * @param lazy @c non-zero to parse lazily, @c zero otherwise.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+int
+TSBReader_setLazyParsing (TSBReader_t *sr, int lazy);
+
+
+/**
+ * Returns whether notes and testAnnotation elements are parsed lazily by
+ * the given TSBReader_t.
+ *
+ * @param sr the TSBReader_t structure to use
+ *
+ * @return @c non-zero if lazy parsing is on, @c zero otherwise.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+int
+TSBReader_getLazyParsing (const TSBReader_t *sr);
+
+
+/**
+ * Sets whether the given TSBReader_t trusts the documents it reads and
+ * skips the validation checks made while reading.
+ *
+ * @param sr the TSBReader_t structure to use
+ *
+ * @param trusted @c non-zero to skip the checks, @c zero otherwise.
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+int
+TSBReader_setTrustedInput (TSBReader_t *sr, int trusted);
+
+
+/**
+ * Returns whether the given TSBReader_t skips the validation checks made
+ * while reading.
+ *
+ * @param sr the TSBReader_t structure to use
+ *
+ * @return @c non-zero if the input is trusted, @c zero otherwise.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+int
+TSBReader_getTrustedInput (const TSBReader_t *sr);
+
+
+/**
+ * Hands a document back to the given TSBReader_t so that its storage is
+ * reused by the next read.
+ *
+ * The TSBReader_t takes ownership of @p d, which must not be used or freed
+ * after this call.
+ *
+ * @param sr the TSBReader_t structure to use
+ * @param d the TSBDocument_t structure to recycle
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+int
+TSBReader_recycleDocument (TSBReader_t *sr, TSBDocument_t *d);
+
+
+/**
+ * Passes the next @p length bytes of a document to the given TSBReader_t,
+ * which reads what they complete.
+ *
+ * @param sr the TSBReader_t structure to use
+ * @param data the next bytes of the document
+ * @param length the number of bytes at @p data
+ *
+ * @copydetails doc_returns_success_code
+ * @li @tsbconstant{LIBTSB_OPERATION_SUCCESS, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_OPERATION_FAILED, OperationReturnValues_t}
+ * @li @tsbconstant{LIBTSB_INVALID_OBJECT, OperationReturnValues_t}
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+int
+TSBReader_feed (TSBReader_t *sr, const char *data, size_t length);
+
+
+/**
+ * Returns the number of comments of the document being fed to the given
+ * TSBReader_t that have been read in full and not yet taken.
+ *
+ * @param sr the TSBReader_t structure to use
+ *
+ * @return the number of completed comments.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+unsigned int
+TSBReader_getNumCompletedComments (const TSBReader_t *sr);
+
+
+/**
+ * Removes the first completed comment of the document being fed to the
+ * given TSBReader_t and returns it.  The caller owns the comment.
+ *
+ * @param sr the TSBReader_t structure to use
+ *
+ * @return the first completed comment, or @c NULL if there is none.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+TSBComment_t *
+TSBReader_takeCompletedComment (TSBReader_t *sr);
+
+
+/**
+ * Ends the document fed to the given TSBReader_t and returns it.
+ *
+ * @param sr the TSBReader_t structure to use
+ *
+ * @return a pointer to the TSBDocument read.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+TSBDocument_t *
+TSBReader_finish (TSBReader_t *sr);
+
+
 /**
  * Returns @c true if the underlying libTSB supports @em gzip and @em zlib
  * format compression.
@@ -326,6 +801,55 @@ TSBDocument_t *
 readTSBFromString (const char *xml);
 
 
+/**
+ * @param data the first byte of the TSB content
+ * @param length the number of bytes available at @p data, which do not
+ * need to be NUL-terminated
+ *
+ * @return a pointer to the TSBDocument structure created from the TSB
+ * content at @p data.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+TSBDocument_t *
+readTSBFromBuffer (const char *data, size_t length);
+
+
+/**
+ * @param filename the name or full pathname of a file written in the
+ * binary TSB format
+ *
+ * @return a pointer to the TSBDocument structure created from the binary
+ * data in @p filename.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+TSBDocument_t *
+readTSBBinary (const char *filename);
+
+
+/**
+ * @param data the first byte of the binary TSB data
+ * @param length the number of bytes available at @p data
+ *
+ * @return a pointer to the TSBDocument structure created from the binary
+ * data at @p data.
+ *
+ * @if conly
+ * @memberof TSBReader_t
+ * @endif
+ */
+LIBTSB_EXTERN
+TSBDocument_t *
+readTSBBinaryFromBuffer (const char *data, size_t length);
+
+
 END_C_DECLS
 LIBTSB_CPP_NAMESPACE_END
 
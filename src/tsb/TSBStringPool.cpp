@@ -0,0 +1,185 @@
+/**
+ * @file TSBStringPool.cpp
+ * @brief Implementation of the TSBStringPool class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+
+
+#include <tsb/TSBStringPool.h>
+
+#include <algorithm>
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/** @cond doxygenlibTSBInternal */
+
+/* the pool is not swept before it holds this many strings */
+static const size_t minSweepSize = 64;
+
+
+/*
+ * Creates an empty pool.
+ */
+TSBStringPool::TSBStringPool()
+  : mStrings()
+  , mSweepSize(minSweepSize)
+{
+}
+
+
+/*
+ * Returns the pooled string equal to value.
+ */
+TSBPooledString
+TSBStringPool::intern(const std::string& value)
+{
+  if (value.empty())
+  {
+    return TSBPooledString();
+  }
+
+  Key key = { &value };
+  unordered_map<Key, TSBPooledString, KeyHash, KeyEqual>::const_iterator it =
+    mStrings.find(key);
+  if (it != mStrings.end())
+  {
+    return it->second;
+  }
+
+  // value is not pooled, so it survives the strings being removed
+  if (mStrings.size() >= mSweepSize)
+  {
+    removeUnused();
+  }
+
+  TSBPooledString pooled = make_shared<const string>(value);
+  key.value = pooled.get();
+  mStrings.insert(make_pair(key, pooled));
+  return pooled;
+}
+
+
+/*
+ * Returns the pooled string equal to *value, adding value itself if there
+ * is none.
+ */
+TSBPooledString
+TSBStringPool::intern(const TSBPooledString& value)
+{
+  if (value == NULL || value->empty())
+  {
+    return TSBPooledString();
+  }
+
+  Key key = { value.get() };
+  unordered_map<Key, TSBPooledString, KeyHash, KeyEqual>::const_iterator it =
+    mStrings.find(key);
+  if (it != mStrings.end())
+  {
+    return it->second;
+  }
+
+  if (mStrings.size() >= mSweepSize)
+  {
+    removeUnused();
+  }
+
+  mStrings.insert(make_pair(key, value));
+  return value;
+}
+
+
+/*
+ * Returns the number of distinct strings in the pool.
+ */
+size_t
+TSBStringPool::size() const
+{
+  return mStrings.size();
+}
+
+
+/*
+ * Removes every string from the pool.
+ */
+void
+TSBStringPool::clear()
+{
+  mStrings.clear();
+  mSweepSize = minSweepSize;
+}
+
+
+/*
+ * Removes the strings that only the pool holds.
+ */
+void
+TSBStringPool::removeUnused()
+{
+  unordered_map<Key, TSBPooledString, KeyHash, KeyEqual>::iterator it =
+    mStrings.begin();
+  while (it != mStrings.end())
+  {
+    if (it->second.use_count() == 1)
+    {
+      it = mStrings.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  // sweeping again once the pool has doubled keeps intern() amortized
+  // constant time
+  mSweepSize = max(minSweepSize, 2 * mStrings.size());
+}
+
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+LIBTSB_CPP_NAMESPACE_END
@@ -0,0 +1,164 @@
+/**
+ * @file TSBStringPool.h
+ * @brief Definition of the TSBStringPool class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class TSBStringPool
+ * @sbmlbrief{} Stores each distinct string value of a document once.
+ *
+ * A TSBDocument keeps a TSBStringPool for attribute values that repeat
+ * across many objects, such as the contributors of its comments.  Values
+ * are held as TSBPooledString, a shared pointer to a constant string:
+ * interning a value returns the pooled pointer for it, so objects of the
+ * same document with equal values share one allocation and can be
+ * compared by pointer.  Because the strings are reference counted, an
+ * object keeps its value when it leaves the document or outlives it.
+ *
+ * The pool is meant for values with few distinct instances.  The strings
+ * that no object holds any more are dropped as the pool grows, so values
+ * that are replaced do not accumulate.
+ */
+
+
+#ifndef TSBStringPool_H__
+#define TSBStringPool_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+
+
+#ifdef __cplusplus
+
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+/** @cond doxygenlibTSBInternal */
+#ifndef SWIG
+
+/*
+ * A pooled string value; a NULL pointer stands for an unset value.
+ */
+typedef std::shared_ptr<const std::string> TSBPooledString;
+
+
+class LIBTSB_EXTERN TSBStringPool
+{
+public:
+
+  /**
+   * Creates an empty pool.
+   */
+  TSBStringPool();
+
+
+  /**
+   * Returns the pooled string equal to value, adding it to the pool if it
+   * is not there yet.  An empty value gives a NULL pointer.
+   */
+  TSBPooledString intern(const std::string& value);
+
+
+  /**
+   * Returns the pooled string equal to *value.  If the pool does not hold
+   * one yet, value itself is added, so that its storage is shared rather
+   * than copied.
+   */
+  TSBPooledString intern(const TSBPooledString& value);
+
+
+  /**
+   * Returns the number of distinct strings in the pool.
+   */
+  size_t size() const;
+
+
+  /**
+   * Removes every string from the pool.  Strings still held by objects
+   * remain valid.
+   */
+  void clear();
+
+
+  /**
+   * Removes the strings that only the pool holds.  intern() calls this
+   * whenever the pool has doubled in size since the last call.
+   */
+  void removeUnused();
+
+
+private:
+
+  /* a key that compares the string it points to */
+  struct Key
+  {
+    const std::string* value;
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const
+    {
+      return std::hash<std::string>()(*key.value);
+    }
+  };
+
+  struct KeyEqual
+  {
+    bool operator()(const Key& a, const Key& b) const
+    {
+      return *a.value == *b.value;
+    }
+  };
+
+  std::unordered_map<Key, TSBPooledString, KeyHash, KeyEqual> mStrings;
+
+  /* the size at which intern() next removes the unused strings */
+  size_t mSweepSize;
+};
+
+#endif /* !SWIG */
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+#endif /* !TSBStringPool_H__ */
@@ -48,6 +48,10 @@
 
 #include <tsb/TSBDocument.h>
 #include <tsb/TSBComment.h>
+#include <tsb/TSBCommentColumns.h>
+#include <tsb/TSBDocumentView.h>
+#include <tsb/TSBDocumentDiff.h>
+#include <tsb/TSBAllocationTrace.h>
 
 #include <tsb/TSBReader.h>
 #include <tsb/TSBWriter.h>
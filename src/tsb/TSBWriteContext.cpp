@@ -0,0 +1,156 @@
+/**
+ * @file TSBWriteContext.cpp
+ * @brief Implementation of the TSBWriteContext class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+#include <tsb/TSBWriteContext.h>
+#include <tsb/TSBBase.h>
+#include <tsb/TSBNamespaces.h>
+#include <xml/XMLNamespaces.h>
+
+
+using namespace std;
+
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+
+
+
+#ifdef __cplusplus
+
+
+/** @cond doxygenlibTSBInternal */
+
+/*
+ * Creates a new, empty TSBWriteContext.
+ */
+TSBWriteContext::TSBWriteContext()
+  : mNamespaces (NULL)
+  , mHasDocument (false)
+  , mPrefixes ()
+  , mTSBPrefixResolved (false)
+  , mHasTSBPrefix (false)
+  , mTSBPrefix ()
+{
+}
+
+
+/*
+ * Clears the cache if object uses a different set of namespaces.
+ */
+void
+TSBWriteContext::checkNamespaces(const TSBBase* object)
+{
+  const XMLNamespaces* xmlns = object->getNamespaces();
+  bool hasDocument = (object->mTSB != NULL);
+
+  if (xmlns != mNamespaces || hasDocument != mHasDocument)
+  {
+    mNamespaces = xmlns;
+    mHasDocument = hasDocument;
+    mPrefixes.clear();
+    mTSBPrefixResolved = false;
+    mHasTSBPrefix = false;
+    mTSBPrefix.clear();
+  }
+}
+
+
+/*
+ * Returns the prefix of the element written for object.
+ */
+string
+TSBWriteContext::getPrefix(const TSBBase* object)
+{
+  checkNamespaces(object);
+
+  const string& uri = object->mURI;
+
+  // there are only ever a handful of element namespaces in a document
+  for (size_t i = 0; i < mPrefixes.size(); ++i)
+  {
+    if (mPrefixes[i].first == uri)
+    {
+      return mPrefixes[i].second;
+    }
+  }
+
+  string prefix;
+  if (mNamespaces != NULL && mHasDocument)
+  {
+    prefix = mNamespaces->getPrefix(uri);
+  }
+
+  mPrefixes.push_back(make_pair(uri, prefix));
+  return mPrefixes.back().second;
+}
+
+
+/*
+ * Returns the prefix used for the TSB attributes of object.
+ */
+string
+TSBWriteContext::getTSBPrefix(const TSBBase* object)
+{
+  checkNamespaces(object);
+
+  if (!mTSBPrefixResolved)
+  {
+    mTSBPrefixResolved = true;
+
+    if (mNamespaces != NULL)
+    {
+      for (int i = 0; i < mNamespaces->getNumNamespaces(); i++)
+      {
+        if (TSBNamespaces::isTSBNamespace(mNamespaces->getURI(i)))
+        {
+          mHasTSBPrefix = true;
+          mTSBPrefix = mNamespaces->getPrefix(i);
+          break;
+        }
+      }
+    }
+  }
+
+  return mHasTSBPrefix ? mTSBPrefix : getPrefix(object);
+}
+
+/** @endcond */
+
+
+#endif /* __cplusplus */
+
+
+LIBTSB_CPP_NAMESPACE_END
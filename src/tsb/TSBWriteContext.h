@@ -0,0 +1,131 @@
+/**
+ * @file TSBWriteContext.h
+ * @brief Definition of the TSBWriteContext class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ *
+ * @class TSBWriteContext
+ * @sbmlbrief{} Prefixes resolved once while a document is written.
+ *
+ * A TSBWriteContext is created by TSBBase::write() at the top of a write
+ * and passed down through TSBBase::writeElements() and
+ * TSBBase::writeAttributes().  The XML prefixes of the elements and the
+ * prefix used for TSB attributes such as "metaid" are resolved the first
+ * time they are needed and reused for every other object written against
+ * the same set of namespaces.  Objects within one document share the
+ * namespaces of the TSBDocument, so in practice each prefix is looked up
+ * once per document.  The cache is cleared whenever an object with a
+ * different set of namespaces is written.
+ */
+
+
+#ifndef TSBWriteContext_H__
+#define TSBWriteContext_H__
+
+
+#include <tsb/common/extern.h>
+#include <tsb/common/tsbfwd.h>
+
+
+#ifdef __cplusplus
+
+
+#include <string>
+#include <vector>
+#include <utility>
+
+
+class XMLNamespaces;
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+
+class TSBBase;
+
+
+/** @cond doxygenlibTSBInternal */
+#ifndef SWIG
+class LIBTSB_EXTERN TSBWriteContext
+{
+public:
+
+  /**
+   * Creates a new, empty TSBWriteContext.
+   */
+  TSBWriteContext();
+
+
+  /**
+   * Returns the XML prefix of the element written for @p object.
+   *
+   * This is the value TSBBase::getPrefix() would return.  It is returned
+   * by value, as resolving the prefix of another object may change the
+   * cache.
+   */
+  std::string getPrefix(const TSBBase* object);
+
+
+  /**
+   * Returns the XML prefix used for the TSB attributes of @p object.
+   *
+   * This is the value TSBBase::getTSBPrefix() would return.
+   */
+  std::string getTSBPrefix(const TSBBase* object);
+
+
+protected:
+
+  /**
+   * Clears the cache if @p object uses a different set of namespaces from
+   * the objects written so far.
+   */
+  void checkNamespaces(const TSBBase* object);
+
+
+  const XMLNamespaces* mNamespaces;
+  bool mHasDocument;
+
+  // element namespace URI -> prefix
+  std::vector< std::pair<std::string, std::string> > mPrefixes;
+
+  bool mTSBPrefixResolved;
+  bool mHasTSBPrefix;
+  std::string mTSBPrefix;
+};
+#endif /* !SWIG */
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+
+#endif /* __cplusplus */
+#endif /* !TSBWriteContext_H__ */
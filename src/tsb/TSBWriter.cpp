@@ -48,6 +48,7 @@
 #include <tsb/TSBErrorLog.h>
 #include <tsb/TSBDocument.h>
 #include <tsb/TSBWriter.h>
+#include <tsb/TSBBinaryFormat.h>
 
 #include <compress/CompressCommon.h>
 #include <compress/OutputCompressor.h>
@@ -255,6 +256,61 @@ TSBWriter::writeTSB (const TSBDocument* d, std::ostream& stream)
 }
 
 
+/*
+ * Writes the given TSBDocument to filename in the binary TSB format.
+ */
+bool
+TSBWriter::writeTSBBinary (const TSBDocument* d, const std::string& filename,
+                           bool withMarkup)
+{
+  if (d == NULL) return false;
+
+  std::ofstream stream(filename.c_str(), ios_base::out | ios_base::binary);
+
+  if ( stream.fail() || stream.bad() )
+  {
+    TSBErrorLog *log = (const_cast<TSBDocument *>(d))->getErrorLog();
+    log->logError(XMLFileUnwritable);
+    return false;
+  }
+
+  return writeTSBBinary(d, stream, withMarkup);
+}
+
+
+/*
+ * Writes the given TSBDocument to the output stream in the binary TSB
+ * format.
+ */
+bool
+TSBWriter::writeTSBBinary (const TSBDocument* d, std::ostream& stream,
+                           bool withMarkup)
+{
+  if (d == NULL) return false;
+
+  bool result = false;
+
+  try
+  {
+    stream.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
+
+    std::string data;
+    TSBBinaryFormat::write(*d, data, withMarkup);
+    stream.write(data.data(), data.size());
+    stream.flush();
+
+    result = true;
+  }
+  catch (ios_base::failure&)
+  {
+    TSBErrorLog *log = (const_cast<TSBDocument *>(d))->getErrorLog();
+    log->logError(XMLFileOperationError);
+  }
+
+  return result;
+}
+
+
 /** @cond doxygenLibtsbInternal */
 /*
  * Writes the given TSBDocument to an in-memory string and returns a
@@ -396,6 +452,21 @@ TSBWriter_writeTSBToFile ( TSBWriter_t         *sw,
 }
 
 
+LIBTSB_EXTERN
+int
+TSBWriter_writeTSBBinary ( TSBWriter_t         *sw,
+                           const TSBDocument_t *d,
+                           const char          *filename,
+                           int                  withMarkup )
+{
+  if (sw == NULL || d == NULL || filename == NULL)
+    return 0;
+  else
+    return static_cast<int>( sw->writeTSBBinary(d, filename,
+                                                withMarkup != 0) );
+}
+
+
 LIBTSB_EXTERN
 char *
 TSBWriter_writeTSBToString (TSBWriter_t *sw, const TSBDocument_t *d)
@@ -447,6 +518,18 @@ writeTSBToFile (const TSBDocument_t *d, const char *filename)
 }
 
 
+LIBTSB_EXTERN
+int
+writeTSBBinary (const TSBDocument_t *d, const char *filename)
+{
+  TSBWriter sw;
+  if (d == NULL || filename == NULL)
+    return 0;
+  else
+    return static_cast<int>( sw.writeTSBBinary(d, filename) );
+}
+
+
 LIBTSB_EXTERN
 char *
 writeTSBToString (const TSBDocument_t *d)
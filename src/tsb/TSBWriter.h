@@ -168,6 +168,51 @@ public:
   bool writeTSB (const TSBDocument* d, std::ostream& stream);
 
 
+  /**
+   * Writes the given TSBDocument to filename in the binary TSB format.
+   *
+   * The binary format keeps the level, version, namespaces and the
+   * attributes of every comment, storing each distinct string once.  It is
+   * read back by TSBReader::readTSBBinary() much faster than the XML is
+   * parsed.  The file is never compressed, whatever its name.
+   *
+   * @param d the TSBDocument to be written
+   *
+   * @param filename the name or full pathname of the file where the binary
+   * data is to be written.
+   *
+   * @param withMarkup if @c true (the default), the notes and annotations
+   * of the document, its list of comments and each comment are written as
+   * XML strings; otherwise they are left out.
+   *
+   * @return @c true on success and @c false if the filename could not be
+   * opened for writing.
+   *
+   * @see TSBReader::readTSBBinary(const std::string& filename)
+   */
+  bool writeTSBBinary (const TSBDocument* d, const std::string& filename,
+                       bool withMarkup = true);
+
+
+  /**
+   * Writes the given TSBDocument to the output stream in the binary TSB
+   * format.
+   *
+   * @param d the TSBDocument to be written
+   *
+   * @param stream the stream object where the binary data is to be
+   * written; it should have been opened in binary mode.
+   *
+   * @param withMarkup if @c true (the default), the notes and annotations
+   * are written as well.
+   *
+   * @return @c true on success and @c false if the stream could not be
+   * written.
+   */
+  bool writeTSBBinary (const TSBDocument* d, std::ostream& stream,
+                       bool withMarkup = true);
+
+
   /** @cond doxygenLibtsbInternal */
 
   /**
@@ -438,6 +483,31 @@ TSBWriter_writeTSBToFile ( TSBWriter_t         *sw,
                        const char           *filename );
 
 
+/**
+ * Writes the given TSBDocument to filename in the binary TSB format.
+ *
+ * @param sw the TSBWriter_t structure.
+ *
+ * @param d the TSBDocument_t structure to be written.
+ *
+ * @param filename the name or full pathname of the file to write.
+ *
+ * @param withMarkup non-zero if the notes and annotations should be
+ * written as well.
+ *
+ * @return non-zero on success and zero if the filename could not be opened
+ * for writing.
+ *
+ * @memberof TSBWriter_t
+ */
+LIBTSB_EXTERN
+int
+TSBWriter_writeTSBBinary ( TSBWriter_t         *sw,
+                           const TSBDocument_t *d,
+                           const char          *filename,
+                           int                  withMarkup );
+
+
 /**
  * Writes the given TSBDocument to an in-memory string and returns a
  * pointer to it.  The string is owned by the caller and should be freed
@@ -578,6 +648,30 @@ int
 writeTSBToFile (const TSBDocument_t *d, const char *filename);
 
 
+/**
+ * Writes the given TSBDocument @p d to the file @p filename in the binary
+ * TSB format, notes and annotations included.  This convenience function
+ * is functionally equivalent to:
+ *
+ *   TSBWriter_writeTSBBinary(TSBWriter_create(), d, filename, 1);
+ *
+ * @param d an TSBDocument object to be written out.
+ *
+ * @param filename a string giving the path to a file where the binary
+ * data is to be written.
+ *
+ * @return @c 1 on success and @c 0 (zero) if @p filename could not be
+ * written.
+ *
+ * @if conly
+ * @memberof TSBWriter_t
+ * @endif
+ */
+LIBTSB_EXTERN
+int
+writeTSBBinary (const TSBDocument_t *d, const char *filename);
+
+
 END_C_DECLS
 LIBTSB_CPP_NAMESPACE_END
 
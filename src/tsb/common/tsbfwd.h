@@ -67,6 +67,8 @@ typedef CLASS_OR_STRUCT TSBBase       TSBBase_t;
 typedef CLASS_OR_STRUCT TSBListOf     TSBListOf_t;
 typedef CLASS_OR_STRUCT TSBReader     TSBReader_t;
 typedef CLASS_OR_STRUCT TSBWriter     TSBWriter_t;
+typedef CLASS_OR_STRUCT TSBDocumentView TSBDocumentView_t;
+typedef CLASS_OR_STRUCT TSBDocumentDiff TSBDocumentDiff_t;
 typedef CLASS_OR_STRUCT TSBNamespaces TSBNamespaces_t;
 typedef CLASS_OR_STRUCT TSBError      TSBError_t;
 typedef CLASS_OR_STRUCT List                      List_t;
@@ -0,0 +1,250 @@
+/**
+ * \file    TestAllocationTrace.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+#include <tsb/util/memory.h>
+#include <tsb/util/util.h>
+
+
+/*
+ * Turns tracing on with fresh counts for one test case, and off again
+ * when the test case ends.
+ */
+struct TraceSession
+{
+  TraceSession()
+  {
+    TSBAllocationTrace::reset();
+    TSBAllocationTrace::setEnabled(true);
+  }
+
+  ~TraceSession()
+  {
+    TSBAllocationTrace::setEnabled(false);
+    TSBAllocationTrace::setSampleInterval(0);
+    TSBAllocationTrace::setMaxSamples(1024);
+    TSBAllocationTrace::reset();
+  }
+};
+
+
+static void
+createComments(unsigned int n)
+{
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    TSBComment comment(1, 1);
+    comment.setNumber(i);
+  }
+}
+
+
+TEST_CASE("Nothing is counted while tracing is off")
+{
+  TSBAllocationTrace::reset();
+  REQUIRE(TSBAllocationTrace::isEnabled() == false);
+
+  createComments(3);
+
+  REQUIRE(TSBAllocationTrace::getCounts(TSB_ALLOCATION_COMMENT).numAllocations == 0);
+  REQUIRE(TSBAllocationTrace::getCounts(TSB_ALLOCATION_NAMESPACES).numAllocations == 0);
+}
+
+
+TEST_CASE("Comments and namespaces are counted by type")
+{
+  TraceSession session;
+
+  TSBDocument* d = new TSBDocument(1, 1);
+  d->createComments(10);
+
+  TSBAllocationCounts_t counts =
+    TSBAllocationTrace::getCounts(TSB_ALLOCATION_COMMENT);
+  REQUIRE(counts.numAllocations == 10);
+  REQUIRE(counts.bytesAllocated == 10 * sizeof(TSBComment));
+  REQUIRE(counts.numFrees == 0);
+  REQUIRE(TSBAllocationTrace::getCounts(TSB_ALLOCATION_NAMESPACES).numAllocations >= 1);
+
+  delete d;
+
+  counts = TSBAllocationTrace::getCounts(TSB_ALLOCATION_COMMENT);
+  REQUIRE(counts.numFrees == 10);
+  REQUIRE(counts.bytesFreed == counts.bytesAllocated);
+
+  counts = TSBAllocationTrace::getCounts(TSB_ALLOCATION_NAMESPACES);
+  REQUIRE(counts.numFrees == counts.numAllocations);
+
+  TSBAllocationTrace::reset();
+  REQUIRE(TSBAllocationTrace::getCounts(TSB_ALLOCATION_COMMENT).numAllocations == 0);
+  REQUIRE(TSBAllocationTrace::getThreadCounts(TSB_ALLOCATION_COMMENT).numAllocations == 0);
+  REQUIRE(TSBAllocationTrace::getCounts(TSB_ALLOCATION_NUM_TYPES).numAllocations == 0);
+}
+
+
+TEST_CASE("Each thread counts on its own and the totals add up")
+{
+  TraceSession session;
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < 4; ++t)
+  {
+    threads.push_back(std::thread(createComments, 1000));
+  }
+  for (unsigned int t = 0; t < 4; ++t)
+  {
+    threads[t].join();
+  }
+
+  createComments(10);
+
+  TSBAllocationCounts_t counts =
+    TSBAllocationTrace::getCounts(TSB_ALLOCATION_COMMENT);
+  REQUIRE(counts.numAllocations == 4010);
+  REQUIRE(counts.numFrees == 4010);
+  REQUIRE(TSBAllocationTrace::getCounts(TSB_ALLOCATION_NAMESPACES).numAllocations >= 4010);
+
+  counts = TSBAllocationTrace::getThreadCounts(TSB_ALLOCATION_COMMENT);
+  REQUIRE(counts.numAllocations == 10);
+}
+
+
+TEST_CASE("Allocations are sampled with their call stacks")
+{
+  TraceSession session;
+  TSBAllocationTrace::setSampleInterval(1);
+  TSBAllocationTrace::setMaxSamples(4);
+
+  createComments(10);
+
+  // every allocation is sampled and only the latest four are kept
+  REQUIRE(TSBAllocationTrace::getNumSamples() == 4);
+
+  TSBAllocationSample_t sample;
+  unsigned int numComments = 0;
+  for (unsigned int n = 0; n < 4; ++n)
+  {
+    REQUIRE(TSBAllocationTrace::getSample(n, sample) == true);
+    if (sample.type == TSB_ALLOCATION_COMMENT)
+    {
+      REQUIRE(sample.size == sizeof(TSBComment));
+      ++numComments;
+    }
+  }
+  REQUIRE(numComments > 0);
+  REQUIRE(TSBAllocationTrace::getSample(4, sample) == false);
+
+  // one sample for about every sizeof(TSBComment) * 10 bytes
+  TSBAllocationTrace::reset();
+  TSBAllocationTrace::setMaxSamples(1000);
+  TSBAllocationTrace::setSampleInterval(sizeof(TSBComment) * 10);
+  createComments(100);
+
+  TSBAllocationCounts_t comments =
+    TSBAllocationTrace::getCounts(TSB_ALLOCATION_COMMENT);
+  TSBAllocationCounts_t namespaces =
+    TSBAllocationTrace::getCounts(TSB_ALLOCATION_NAMESPACES);
+  unsigned int expected = (unsigned int)((comments.bytesAllocated +
+    namespaces.bytesAllocated) / TSBAllocationTrace::getSampleInterval());
+  REQUIRE(TSBAllocationTrace::getNumSamples() >= expected - 1);
+  REQUIRE(TSBAllocationTrace::getNumSamples() <= expected + 1);
+}
+
+
+TEST_CASE("Notes built by the reader and safe_malloc are counted")
+{
+  TSBDocument d(1, 1);
+  d.createComment()->setNotes(
+    "<p xmlns=\"http://www.w3.org/1999/xhtml\">comment <b>notes</b></p>");
+  const std::string xml = writeTSBToStdString(&d);
+
+  TraceSession session;
+
+  TSBReader reader;
+  reader.setLazyParsing(true);
+  TSBDocument* lazy = reader.readTSBFromString(xml);
+  REQUIRE(TSBAllocationTrace::getCounts(TSB_ALLOCATION_XMLNODE).numAllocations == 0);
+
+  REQUIRE(lazy->getComment(0)->getNotes() != NULL);
+  TSBAllocationCounts_t counts =
+    TSBAllocationTrace::getCounts(TSB_ALLOCATION_XMLNODE);
+  REQUIRE(counts.numAllocations >= 3);
+  REQUIRE(counts.bytesAllocated == counts.numAllocations * sizeof(XMLNode));
+  delete lazy;
+
+  char* copy = tsb_safe_strdup("twelve chars");
+  REQUIRE(TSBAllocationTrace::getCounts(TSB_ALLOCATION_MEMORY).bytesAllocated == 13);
+  free(copy);
+
+  // a block allocated by safe_realloc() is counted, resizing it is not
+  void* block = safe_realloc(NULL, 16);
+  block = safe_realloc(block, 64);
+  counts = TSBAllocationTrace::getCounts(TSB_ALLOCATION_MEMORY);
+  REQUIRE(counts.numAllocations == 2);
+  REQUIRE(counts.bytesAllocated == 29);
+  free(block);
+}
+
+
+TEST_CASE("Allocation tracing is available through the C API")
+{
+  TSBAllocationTrace_reset();
+  TSBAllocationTrace_setEnabled(1);
+  REQUIRE(TSBAllocationTrace_isEnabled() == 1);
+  TSBAllocationTrace_setSampleInterval(1);
+
+  TSBComment_t* c = TSBComment_create(1, 1);
+  TSBComment_free(c);
+
+  REQUIRE(TSBAllocationTrace_getCounts(TSB_ALLOCATION_COMMENT).numFrees == 1);
+  REQUIRE(TSBAllocationTrace_getThreadCounts(TSB_ALLOCATION_COMMENT).numAllocations == 1);
+  REQUIRE(TSBAllocationTrace_getNumSamples() > 0);
+
+  TSBAllocationSample_t sample;
+  REQUIRE(TSBAllocationTrace_getSample(0, &sample) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(TSBAllocationTrace_getSample(0, NULL) == LIBTSB_INVALID_OBJECT);
+  REQUIRE(TSBAllocationTrace_getSample(10000, &sample) == LIBTSB_INDEX_EXCEEDS_SIZE);
+
+  TSBAllocationTrace_setEnabled(0);
+  TSBAllocationTrace_setSampleInterval(0);
+  TSBAllocationTrace_reset();
+}
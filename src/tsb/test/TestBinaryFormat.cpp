@@ -0,0 +1,193 @@
+/**
+ * \file    TestBinaryFormat.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+#include <tsb/TSBBinaryFormat.h>
+
+
+static const std::string xml =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\" "
+  "metaid=\"doc\">"
+  "<listOfComments metaid=\"list\">"
+  "<comment contributor=\"a\" number=\"1.5\" metaid=\"c1\"/>"
+  "<comment contributor=\"b\" point=\"p\"/>"
+  "<comment contributor=\"a\" number=\"-2\" point=\"\"/>"
+  "<comment/>"
+  "</listOfComments></tsb>\n";
+
+
+static std::string toBinary(const TSBDocument* d, bool withMarkup = true)
+{
+  std::string data;
+  TSBBinaryFormat::write(*d, data, withMarkup);
+  return data;
+}
+
+
+TEST_CASE("Binary TSB data reads back the same document")
+{
+  TSBReader reader;
+  TSBDocument* d = reader.readTSBFromString(xml);
+  REQUIRE(d->getNumComments() == 4);
+
+  const std::string data = toBinary(d);
+  REQUIRE(TSBBinaryFormat::isBinary(data.data(), data.size()));
+  REQUIRE(!TSBBinaryFormat::isBinary(xml.data(), xml.size()));
+
+  TSBDocument* copy = reader.readTSBBinaryFromBuffer(data.data(), data.size());
+  REQUIRE(copy->getNumErrors() == 0);
+  REQUIRE(copy->getNumComments() == 4);
+  REQUIRE(writeTSBToStdString(copy) == writeTSBToStdString(d));
+
+  REQUIRE(!copy->getComment(1)->isSetNumber());
+  REQUIRE(copy->getComment(1)->getPoint() == "p");
+  REQUIRE(copy->getComment(0)->getMetaId() == "c1");
+  REQUIRE(copy->getListOfComments()->getMetaId() == "list");
+  REQUIRE(copy->getMetaId() == "doc");
+
+  // the data need not be aligned
+  std::string shifted = " " + data;
+  TSBDocument* unaligned =
+    reader.readTSBBinaryFromBuffer(shifted.data() + 1, data.size());
+  REQUIRE(writeTSBToStdString(unaligned) == writeTSBToStdString(d));
+
+  delete unaligned;
+  delete copy;
+  delete d;
+}
+
+
+TEST_CASE("Binary TSB data keeps notes only when asked to")
+{
+  TSBReader reader;
+  TSBDocument* d = reader.readTSBFromString(xml);
+  d->getComment(0)->setNotes(
+    "<notes><p xmlns=\"http://www.w3.org/1999/xhtml\">note</p></notes>");
+  REQUIRE(d->getComment(0)->isSetNotes());
+
+  std::string data = toBinary(d);
+  TSBDocument* copy = reader.readTSBBinaryFromBuffer(data.data(), data.size());
+  REQUIRE(copy->getComment(0)->isSetNotes());
+  REQUIRE(writeTSBToStdString(copy) == writeTSBToStdString(d));
+  delete copy;
+
+  data = toBinary(d, false);
+  copy = reader.readTSBBinaryFromBuffer(data.data(), data.size());
+  REQUIRE(copy->getNumErrors() == 0);
+  REQUIRE(copy->getNumComments() == 4);
+  REQUIRE(!copy->getComment(0)->isSetNotes());
+  delete copy;
+
+  delete d;
+}
+
+
+TEST_CASE("Damaged binary TSB data is rejected")
+{
+  TSBReader reader;
+  TSBDocument* d = reader.readTSBFromString(xml);
+  const std::string data = toBinary(d);
+  delete d;
+
+  for (size_t length = 0; length < data.size(); ++length)
+  {
+    d = reader.readTSBBinaryFromBuffer(data.data(), length);
+    REQUIRE(d->getNumErrors() == 1);
+    REQUIRE(d->getError(0)->getErrorId() == TSBBadBinaryFormat);
+    REQUIRE(d->getNumComments() == 0);
+    delete d;
+  }
+
+  // a newer format version
+  std::string damaged = data;
+  damaged[4] = 9;
+  d = reader.readTSBBinaryFromBuffer(damaged.data(), damaged.size());
+  REQUIRE(d->getError(0)->getErrorId() == TSBBadBinaryFormat);
+  delete d;
+
+  // a string code past the string table
+  damaged = data;
+  memset(&damaged[damaged.size() - 40], 0xff, 16);
+  d = reader.readTSBBinaryFromBuffer(damaged.data(), damaged.size());
+  REQUIRE(d->getNumErrors() == 1);
+  REQUIRE(d->getNumComments() == 0);
+  delete d;
+
+  d = reader.readTSBBinaryFromBuffer(NULL, 0);
+  REQUIRE(d->getError(0)->getErrorId() == TSBBadBinaryFormat);
+  delete d;
+}
+
+
+TEST_CASE("Binary TSB files through the C API")
+{
+  const char* filename = "binary-format-test.tsbb";
+
+  TSBDocument_t* d = readTSBFromString(xml.c_str());
+  TSBWriter_t* writer = TSBWriter_create();
+  REQUIRE(TSBWriter_writeTSBBinary(writer, d, filename, 1) == 1);
+  REQUIRE(TSBWriter_writeTSBBinary(writer, NULL, filename, 1) == 0);
+  TSBWriter_free(writer);
+
+  TSBReader_t* reader = TSBReader_create();
+  TSBDocument_t* copy = TSBReader_readTSBBinary(reader, filename);
+  REQUIRE(copy->getNumErrors() == 0);
+  REQUIRE(writeTSBToStdString(copy) == writeTSBToStdString(d));
+  delete copy;
+  REQUIRE(TSBReader_readTSBBinary(NULL, filename) == NULL);
+  TSBReader_free(reader);
+
+  REQUIRE(writeTSBBinary(d, filename) == 1);
+  copy = readTSBBinary(filename);
+  REQUIRE(copy->getNumComments() == 4);
+  delete copy;
+  remove(filename);
+
+  copy = readTSBBinary(filename);
+  REQUIRE(copy->getNumErrors() == 1);
+  REQUIRE(copy->getError(0)->getErrorId() == XMLFileUnreadable);
+  delete copy;
+
+  delete d;
+}
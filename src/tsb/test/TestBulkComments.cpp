@@ -0,0 +1,153 @@
+/**
+ * \file    TestBulkComments.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+
+#include <memory>
+#include <vector>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+static std::unique_ptr<TSBComment>
+makeComment(TSBNamespaces* tsbns, const std::string& contributor, double n)
+{
+  std::unique_ptr<TSBComment> c(new TSBComment(tsbns));
+  c->setContributor(contributor);
+  c->setNumber(n);
+  return c;
+}
+
+
+TEST_CASE("createComments appends n comments to a document")
+{
+  TSBDocument d;
+  d.createComment()->setContributor("first");
+
+  REQUIRE(d.createComments(3) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d.getNumComments() == 4);
+  REQUIRE(d.getComment(0)->getContributor() == "first");
+
+  for (unsigned int i = 1; i < 4; ++i)
+  {
+    TSBComment* c = d.getComment(i);
+    REQUIRE(c->getTSBDocument() == &d);
+    REQUIRE(c->getParentTSBObject() == d.getListOfComments());
+    REQUIRE(c->getTSBNamespaces() == d.getTSBNamespaces());
+    REQUIRE(c->isSetContributor() == false);
+  }
+
+  REQUIRE(d.createComments(0) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d.getNumComments() == 4);
+
+  REQUIRE(TSBDocument_createComments(&d, 2) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d.getNumComments() == 6);
+  REQUIRE(TSBDocument_createComments(NULL, 2) == LIBTSB_INVALID_OBJECT);
+}
+
+
+TEST_CASE("Comments created in bulk are indexed")
+{
+  TSBDocument d;
+  d.getListOfComments()->setIndexed(true);
+  REQUIRE(d.createComments(2) == LIBTSB_OPERATION_SUCCESS);
+
+  d.getComment(1)->setContributor("b");
+  d.getComment(1)->setNumber(4);
+
+  REQUIRE(d.getListOfComments()->getCommentsByContributor("b").size() == 1);
+  REQUIRE(d.getListOfComments()->getCommentsInNumberRange(3, 5).size() == 1);
+}
+
+
+TEST_CASE("addComments takes ownership of a whole batch")
+{
+  TSBDocument d;
+  TSBNamespaces tsbns(1, 1);
+
+  std::vector<std::unique_ptr<TSBComment> > batch;
+  batch.push_back(makeComment(&tsbns, "a", 1));
+  batch.push_back(makeComment(&tsbns, "b", 2));
+  const TSBComment* first = batch[0].get();
+
+  REQUIRE(d.addComments(std::move(batch)) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(batch.empty());
+  REQUIRE(d.getNumComments() == 2);
+  REQUIRE(d.getComment(0) == first);
+  REQUIRE(d.getComment(1)->getContributor() == "b");
+  REQUIRE(d.getComment(1)->getParentTSBObject() == d.getListOfComments());
+
+  std::vector<std::unique_ptr<TSBComment> > none;
+  REQUIRE(d.addComments(std::move(none)) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d.getNumComments() == 2);
+}
+
+
+TEST_CASE("addComments adds nothing when one comment is rejected")
+{
+  TSBDocument d;
+  TSBNamespaces tsbns(1, 1);
+
+  std::vector<std::unique_ptr<TSBComment> > batch;
+  batch.push_back(makeComment(&tsbns, "a", 1));
+  batch.push_back(std::unique_ptr<TSBComment>(new TSBComment(&tsbns)));
+
+  REQUIRE(d.addComments(std::move(batch)) == LIBTSB_INVALID_OBJECT);
+  REQUIRE(batch.size() == 2);
+  REQUIRE(batch[0].get() != NULL);
+  REQUIRE(d.getNumComments() == 0);
+
+  batch[1] = nullptr;
+  REQUIRE(d.addComments(std::move(batch)) == LIBTSB_OPERATION_FAILED);
+  REQUIRE(d.getNumComments() == 0);
+}
+
+
+TEST_CASE("reserve does not change the items of a list")
+{
+  TSBDocument d;
+  d.createComments(2);
+
+  TSBListOfComments* lo = d.getListOfComments();
+  TSBComment* first = lo->get(0);
+  lo->reserve(100);
+  REQUIRE(lo->size() == 2);
+  REQUIRE(lo->get(0) == first);
+
+  REQUIRE(TSBListOf_reserve(lo, 10) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(TSBListOf_reserve(NULL, 10) == LIBTSB_INVALID_OBJECT);
+}
@@ -39,6 +39,8 @@
 
 #include <tsb/common/common.h>
 #include <tsb/TSBComment.h>
+#include <tsb/TSBDocument.h>
+#include <tsb/TSBReader.h>
 
 
 
@@ -64,3 +66,108 @@ TEST_CASE("Comment contributor")
 
   delete c;
 }
+
+
+TEST_CASE("Comment appendNotes")
+{
+  TSBComment *c = new TSBComment(1, 1);
+
+  REQUIRE(c->appendNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">one</p>")
+          == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(c->appendNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">two</p>")
+          == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(c->getNotes()->getNumChildren() == 2);
+
+  c->setNotes("<body xmlns=\"http://www.w3.org/1999/xhtml\"><p>one</p></body>");
+  REQUIRE(c->appendNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">two</p>")
+          == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(c->getNotes()->getNumChildren() == 1);
+  REQUIRE(c->getNotes()->getChild(0).getNumChildren() == 2);
+
+  delete c;
+}
+
+
+TEST_CASE("Comment appendTestAnnotation")
+{
+  TSBComment *c = new TSBComment(1, 1);
+
+  REQUIRE(c->appendTestAnnotation("<a:x xmlns:a=\"http://a.org\"/>")
+          == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(c->appendTestAnnotation("<b:y xmlns:b=\"http://b.org\"/>")
+          == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(c->getTestAnnotation()->getNumChildren() == 2);
+
+  REQUIRE(c->appendTestAnnotation("<a:x xmlns:a=\"http://a.org\"/>")
+          == LIBTSB_DUPLICATE_ANNOTATION_NS);
+  REQUIRE(c->getTestAnnotation()->getNumChildren() == 2);
+
+  REQUIRE(c->replaceTopLevelTestAnnotationElement(
+          "<a:x xmlns:a=\"http://a.org\"><a:z/></a:x>") == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(c->getTestAnnotation()->getNumChildren() == 2);
+  REQUIRE(c->getTestAnnotation()->getChild(0).getNumChildren() == 1);
+
+  delete c;
+}
+
+
+TEST_CASE("Comment readAttributes")
+{
+  TSBDocument *d = readTSBFromString(
+    "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">"
+    "<listOfComments>"
+    "<comment contributor=\"sarah\" number=\" 2.5 \" point=\"p\"/>"
+    "<comment contributor=\"frank\" number=\"two\" colour=\"red\"/>"
+    "</listOfComments></tsb>");
+
+  REQUIRE(d->getNumComments() == 2);
+
+  TSBComment *c = d->getComment(0);
+  REQUIRE(c->getContributor() == "sarah");
+  REQUIRE(c->isSetNumber() == true);
+  REQUIRE(c->getNumber() == 2.5);
+  REQUIRE(c->getPoint() == "p");
+
+  c = d->getComment(1);
+  REQUIRE(c->getContributor() == "frank");
+  REQUIRE(c->isSetNumber() == false);
+  REQUIRE(c->isSetPoint() == false);
+
+  REQUIRE(d->getNumErrors() == 2);
+  REQUIRE(d->getError(0)->getErrorId() == TsbCommentAllowedAttributes);
+  REQUIRE(d->getError(1)->getErrorId() == TsbCommentNumberMustBeDouble);
+
+  delete d;
+}
+
+
+TEST_CASE("Comment read trusted input")
+{
+  const char* xml =
+    "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">"
+    "<listOfComments>"
+    "<comment contributor=\"\" number=\"1\" colour=\"red\"/>"
+    "</listOfComments><unknown/></tsb>";
+
+  TSBReader reader;
+  TSBDocument *d = reader.readTSBFromString(xml);
+  REQUIRE(d->getNumErrors() == 3);
+  delete d;
+
+  reader.setTrustedInput(true);
+  REQUIRE(reader.getTrustedInput() == true);
+
+  d = reader.readTSBFromString(xml);
+  REQUIRE(d->getNumErrors() == 0);
+  REQUIRE(d->getNumComments() == 1);
+  REQUIRE(d->getComment(0)->getNumber() == 1);
+  delete d;
+
+  // malformed XML is still reported
+  d = reader.readTSBFromString(
+    "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">"
+    "<listOfComments><comment contributor=\"a\" number=\"1\">"
+    "</listOfComments></tsb>");
+  REQUIRE(d->getNumErrors() > 0);
+  delete d;
+}
@@ -0,0 +1,167 @@
+/**
+ * \file    TestCommentColumns.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+static void fillDocument(TSBDocument& d, unsigned int numComments)
+{
+  const char* contributors[] = { "ann", "bob", "", "cy" };
+
+  for (unsigned int i = 0; i < numComments; ++i)
+  {
+    TSBComment* c = d.createComment();
+    c->setContributor(contributors[i % 4]);
+    if (i % 5 != 0)
+    {
+      c->setNumber((i * 37 % 101) / 4.0 - 10);
+    }
+    if (i % 3 == 0)
+    {
+      c->setPoint(std::string(i % 7, 'p'));
+    }
+  }
+}
+
+
+TEST_CASE("Comment columns copy the attributes of the comments")
+{
+  TSBDocument d(1, 1);
+  fillDocument(d, 70);
+
+  TSBCommentColumns columns(d);
+  REQUIRE(columns.getNumComments() == 70);
+  REQUIRE(columns.getNumContributors() == 4);
+  REQUIRE(columns.getContributor(2) == "");
+  REQUIRE(columns.getContributor(4) == "");
+
+  for (unsigned int i = 0; i < 70; ++i)
+  {
+    const TSBComment* c = d.getComment(i);
+
+    REQUIRE(columns.isSetNumber(i) == c->isSetNumber());
+    if (c->isSetNumber())
+    {
+      REQUIRE(columns.getNumbers()[i] == c->getNumber());
+    }
+    else
+    {
+      REQUIRE(std::isnan(columns.getNumbers()[i]));
+    }
+
+    REQUIRE(columns.getContributor(columns.getContributorCodes()[i])
+            == c->getContributor());
+    REQUIRE(columns.getPoint(i) == c->getPoint());
+  }
+
+  REQUIRE(columns.getPointOffsets()[70] == columns.getPointData().size());
+  REQUIRE(columns.isSetNumber(70) == false);
+  REQUIRE(((columns.getNumberValidity()[1] >> 1) & 1) == 0);
+
+  // the columns are a copy
+  d.getComment(1)->setNumber(1000);
+  REQUIRE(columns.maxNumber() < 1000);
+
+  columns.assign(*d.getListOfComments());
+  REQUIRE(columns.maxNumber() == 1000);
+}
+
+
+TEST_CASE("Comment column aggregates match a plain loop")
+{
+  for (unsigned int size = 0; size < 20; ++size)
+  {
+    TSBDocument d(1, 1);
+    fillDocument(d, size);
+
+    // a number that is set to NaN is skipped like an unset one
+    if (size > 3)
+    {
+      d.getComment(3)->setNumber(std::numeric_limits<double>::quiet_NaN());
+    }
+
+    unsigned int count = 0;
+    double sum = 0;
+    double min = std::numeric_limits<double>::quiet_NaN();
+    double max = min;
+    std::vector<unsigned int> bins(3, 0);
+
+    for (unsigned int i = 0; i < size; ++i)
+    {
+      double x = d.getComment(i)->getNumber();
+      if (!d.getComment(i)->isSetNumber() || std::isnan(x)) continue;
+
+      ++count;
+      sum += x;
+      if (count == 1 || x < min) min = x;
+      if (count == 1 || x > max) max = x;
+      if (x >= -10 && x <= 5)
+      {
+        ++bins[std::min(2, (int)((x + 10) / 5))];
+      }
+    }
+
+    TSBCommentColumns columns(*d.getListOfComments());
+    REQUIRE(columns.countNumbers() == count);
+    REQUIRE(columns.sumNumbers() == Approx(sum));
+    REQUIRE(columns.histogram(-10, 5, 3) == bins);
+
+    if (count == 0)
+    {
+      REQUIRE(std::isnan(columns.minNumber()));
+      REQUIRE(std::isnan(columns.maxNumber()));
+    }
+    else
+    {
+      REQUIRE(columns.minNumber() == min);
+      REQUIRE(columns.maxNumber() == max);
+    }
+  }
+
+  TSBCommentColumns empty;
+  REQUIRE(empty.getNumComments() == 0);
+  REQUIRE(empty.getNumbers() == NULL);
+  REQUIRE(empty.sumNumbers() == 0);
+  REQUIRE(empty.histogram(0, 1, 0).empty());
+  REQUIRE(empty.histogram(1, 1, 4).empty());
+  REQUIRE(empty.histogram(0, 1, 4) == std::vector<unsigned int>(4, 0));
+}
@@ -0,0 +1,264 @@
+/**
+ * \file    TestCommentIndex.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <algorithm>
+#include <cstdlib>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+/*
+ * Returns the comments in a canonical order, so that the results of two
+ * queries can be compared.
+ */
+static std::vector<TSBComment*> sorted(std::vector<TSBComment*> comments)
+{
+  std::sort(comments.begin(), comments.end());
+  return comments;
+}
+
+
+/*
+ * Checks that the indexed list answers as a linear search would.
+ */
+static void requireConsistent(TSBListOfComments& list)
+{
+  REQUIRE(list.isIndexed() == true);
+
+  const char* contributors[] = { "", "ann", "bob", "cy" };
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    list.setIndexed(false);
+    std::vector<TSBComment*> expected =
+      sorted(list.getCommentsByContributor(contributors[i]));
+    list.setIndexed(true);
+    REQUIRE(sorted(list.getCommentsByContributor(contributors[i]))
+            == expected);
+  }
+
+  for (double min = -1; min < 6; min += 1.5)
+  {
+    list.setIndexed(false);
+    std::vector<TSBComment*> expected =
+      list.getCommentsInNumberRange(min, min + 2);
+    list.setIndexed(true);
+    std::vector<TSBComment*> found =
+      list.getCommentsInNumberRange(min, min + 2);
+
+    REQUIRE(sorted(found) == sorted(expected));
+    for (size_t n = 1; n < found.size(); ++n)
+    {
+      REQUIRE(found[n - 1]->getNumber() <= found[n]->getNumber());
+    }
+  }
+}
+
+
+static TSBComment* addComment(TSBDocument& d, const std::string& contributor,
+                              double number)
+{
+  TSBComment* c = d.createComment();
+  c->setContributor(contributor);
+  c->setNumber(number);
+  return c;
+}
+
+
+TEST_CASE("Querying comments by contributor and number")
+{
+  TSBDocument d(1, 1);
+  TSBListOfComments* list = d.getListOfComments();
+  REQUIRE(list->isIndexed() == false);
+
+  addComment(d, "ann", 3);
+  addComment(d, "bob", 1);
+  addComment(d, "ann", 2);
+  d.createComment()->setContributor("cy");
+
+  for (int indexed = 0; indexed < 2; ++indexed)
+  {
+    list->setIndexed(indexed == 1);
+
+    REQUIRE(list->getCommentsByContributor("ann").size() == 2);
+    REQUIRE(list->getCommentsByContributor("dan").empty());
+    REQUIRE(list->getCommentsByContributor("").empty());
+
+    std::vector<TSBComment*> range = list->getCommentsInNumberRange(1, 2.5);
+    REQUIRE(range.size() == 2);
+    REQUIRE(range[0]->getContributor() == "bob");
+    REQUIRE(range[1]->getNumber() == 2);
+
+    REQUIRE(list->getCommentsInNumberRange(3, 1).empty());
+    REQUIRE(list->getCommentsInNumberRange(-1e300, 1e300).size() == 3);
+
+    const TSBListOfComments* constList = list;
+    REQUIRE(constList->getCommentsByContributor("cy").size() == 1);
+    REQUIRE(constList->getCommentsInNumberRange(3, 3).size() == 1);
+  }
+}
+
+
+TEST_CASE("Comment indexes follow changes to the comments")
+{
+  TSBDocument d(1, 1);
+  TSBListOfComments* list = d.getListOfComments();
+  list->setIndexed(true);
+
+  TSBComment* a = addComment(d, "ann", 1);
+  TSBComment* b = addComment(d, "bob", 2);
+  TSBComment* c = addComment(d, "ann", 3);
+  requireConsistent(*list);
+
+  a->setContributor("cy");
+  b->setNumber(5);
+  c->unsetNumber();
+  requireConsistent(*list);
+
+  b->unsetContributor();
+  c->setAttribute("contributor", std::string("bob"));
+  a->setAttribute("number", 4.0);
+  requireConsistent(*list);
+
+  *a = *c;
+  requireConsistent(*list);
+
+  c->setId("third");
+  delete list->remove("third");
+  delete list->remove(0);
+  requireConsistent(*list);
+  REQUIRE(list->getCommentsByContributor("bob").empty());
+
+  // a removed comment no longer affects the list
+  TSBComment* removed = list->remove(0);
+  removed->setContributor("ann");
+  removed->setNumber(1);
+  REQUIRE(list->getCommentsByContributor("ann").empty());
+  REQUIRE(list->getCommentsInNumberRange(0, 10).empty());
+  list->appendAndOwn(removed);
+  REQUIRE(list->getCommentsByContributor("ann").size() == 1);
+  requireConsistent(*list);
+
+  list->clear();
+  REQUIRE(list->getCommentsInNumberRange(0, 10).empty());
+  requireConsistent(*list);
+}
+
+
+TEST_CASE("Comment indexes follow assignment in both directions")
+{
+  TSBDocument d(1, 1);
+  TSBListOfComments* list = d.getListOfComments();
+  list->setIndexed(true);
+
+  TSBComment* indexed = addComment(d, "ann", 1);
+  addComment(d, "bob", 2);
+
+  // a detached object assigned from an indexed one is not indexed
+  {
+    TSBComment copy(1, 1);
+    copy = *indexed;
+    copy.setContributor("y");
+    copy.setNumber(7);
+
+    TSBComment moved(1, 1);
+    moved = TSBComment(*indexed);
+    moved.setContributor("z");
+  }
+  REQUIRE(list->getCommentsByContributor("y").empty());
+  REQUIRE(list->getCommentsByContributor("z").empty());
+  REQUIRE(list->getCommentsInNumberRange(7, 7).empty());
+  requireConsistent(*list);
+
+  // an indexed object assigned from a detached one is indexed by its new
+  // values
+  TSBComment detached(1, 1);
+  detached.setContributor("cy");
+  detached.setNumber(3);
+  *indexed = detached;
+  REQUIRE(list->getCommentsByContributor("ann").empty());
+  REQUIRE(list->getCommentsByContributor("cy").size() == 1);
+  REQUIRE(list->getCommentsInNumberRange(3, 3).size() == 1);
+  requireConsistent(*list);
+
+  detached.setContributor("dan");
+  *indexed = std::move(detached);
+  REQUIRE(list->getCommentsByContributor("cy").empty());
+  REQUIRE(list->getCommentsByContributor("dan")[0] == indexed);
+  requireConsistent(*list);
+}
+
+
+TEST_CASE("Comment indexes survive copies, snapshots and reads")
+{
+  TSBDocument d(1, 1);
+  d.getListOfComments()->setIndexed(true);
+  for (unsigned int i = 0; i < 20; ++i)
+  {
+    const char* contributors[] = { "ann", "bob", "cy" };
+    addComment(d, contributors[i % 3], i % 7);
+  }
+  requireConsistent(*d.getListOfComments());
+
+  TSBDocument copy(d);
+  REQUIRE(copy.getListOfComments()->isIndexed() == true);
+  requireConsistent(*copy.getListOfComments());
+  REQUIRE(copy.getListOfComments()->getCommentsByContributor("cy")[0]
+          ->getParentTSBObject() == copy.getListOfComments());
+
+  TSBListOfComments moved(std::move(*copy.getListOfComments()));
+  requireConsistent(moved);
+
+  REQUIRE(d.takeSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  d.getComment(0)->setContributor("dan");
+  delete d.removeComment(1);
+  addComment(d, "dan", 2);
+  requireConsistent(*d.getListOfComments());
+  REQUIRE(d.restoreSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d.getListOfComments()->getCommentsByContributor("dan").empty());
+  requireConsistent(*d.getListOfComments());
+
+  // a document read back is not indexed until asked
+  std::string xml = writeTSBToStdString(&d);
+  TSBDocument* read = readTSBFromString(xml.c_str());
+  REQUIRE(read->getListOfComments()->isIndexed() == false);
+  read->getListOfComments()->setIndexed(true);
+  REQUIRE(read->getListOfComments()->getCommentsByContributor("bob").size()
+          == 7);
+  requireConsistent(*read->getListOfComments());
+  delete read;
+}
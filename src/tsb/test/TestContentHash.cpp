@@ -0,0 +1,236 @@
+/**
+ * \file    TestContentHash.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+
+#include <string>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+#include <tsb/util/util.h>
+
+
+/*
+ * Fills d with n comments numbered 0 to n - 1.
+ */
+static void
+fillDocument(TSBDocument& d, unsigned int n)
+{
+  d.createComments(n);
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    d.getComment(i)->setNumber(i);
+    d.getComment(i)->setContributor(i % 2 == 0 ? "even" : "odd");
+    d.getComment(i)->setPoint("point");
+  }
+}
+
+
+TEST_CASE("Equal content gives equal hashes")
+{
+  TSBDocument d(1, 1);
+  fillDocument(d, 10);
+
+  TSBDocument copy(d);
+  REQUIRE(copy.getContentHash() == d.getContentHash());
+  REQUIRE(copy.getListOfComments()->getContentHash() ==
+          d.getListOfComments()->getContentHash());
+  REQUIRE(copy.getComment(3)->getContentHash() ==
+          d.getComment(3)->getContentHash());
+
+  // the same content written and read again
+  TSBDocument* read = readTSBFromString(writeTSBToStdString(&d).c_str());
+  REQUIRE(read->getContentHash() == d.getContentHash());
+  delete read;
+
+  REQUIRE(d.getComment(0)->getContentHash() !=
+          d.getComment(1)->getContentHash());
+  REQUIRE(TSBDocument(1, 1).getContentHash() !=
+          TSBDocument(1, 2).getContentHash());
+}
+
+
+TEST_CASE("Setters invalidate the hashes of an object and its ancestors")
+{
+  TSBDocument d(1, 1);
+  fillDocument(d, 100);
+
+  const uint64_t original = d.getContentHash();
+  const uint64_t comment = d.getComment(42)->getContentHash();
+
+  d.getComment(42)->setPoint("elsewhere");
+  REQUIRE(d.getComment(42)->getContentHash() != comment);
+  const uint64_t edited = d.getContentHash();
+  REQUIRE(edited != original);
+
+  // the incrementally updated hash matches one computed from scratch
+  TSBDocument copy(d);
+  REQUIRE(copy.getContentHash() == edited);
+
+  d.getComment(42)->setPoint("point");
+  REQUIRE(d.getComment(42)->getContentHash() == comment);
+  REQUIRE(d.getContentHash() == original);
+
+  d.getComment(7)->unsetContributor();
+  REQUIRE(d.getContentHash() != original);
+  d.getComment(7)->setContributor("odd");
+  REQUIRE(d.getContentHash() == original);
+
+  d.setVersion(2);
+  REQUIRE(d.getContentHash() != original);
+  d.setVersion(1);
+  REQUIRE(d.getContentHash() == original);
+}
+
+
+TEST_CASE("Hashes depend on the order and number of items")
+{
+  TSBDocument d(1, 1);
+  fillDocument(d, 20);
+  const uint64_t original = d.getContentHash();
+
+  // swapping two values changes the hash although the multiset is the same
+  d.getComment(2)->setNumber(3);
+  d.getComment(3)->setNumber(2);
+  const uint64_t swapped = d.getContentHash();
+  REQUIRE(swapped != original);
+
+  d.getListOfComments()->sortByNumber();
+  REQUIRE(d.getContentHash() != swapped);
+  REQUIRE(d.getContentHash() == TSBDocument(d).getContentHash());
+
+  TSBComment* removed = d.removeComment(19);
+  REQUIRE(d.getContentHash() != original);
+  REQUIRE(d.getContentHash() == TSBDocument(d).getContentHash());
+
+  d.addComment(removed);
+  delete removed;
+  REQUIRE(d.getContentHash() == TSBDocument(d).getContentHash());
+}
+
+
+TEST_CASE("Numbers and notes are hashed canonically")
+{
+  TSBComment a(1, 1);
+  TSBComment b(1, 1);
+
+  a.setNumber(0.0);
+  b.setNumber(-0.0);
+  REQUIRE(a.getContentHash() == b.getContentHash());
+
+  a.setNumber(tsb_util_NaN());
+  b.setNumber(-tsb_util_NaN());
+  REQUIRE(a.getContentHash() == b.getContentHash());
+
+  // an unset number differs from any value
+  b.unsetNumber();
+  REQUIRE(a.getContentHash() != b.getContentHash());
+
+  a.unsetNumber();
+  REQUIRE(a.getContentHash() == b.getContentHash());
+  a.setNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">notes</p>");
+  REQUIRE(a.getContentHash() != b.getContentHash());
+  b.setNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">notes</p>");
+  REQUIRE(a.getContentHash() == b.getContentHash());
+  b.unsetNotes();
+  REQUIRE(a.getContentHash() != b.getContentHash());
+}
+
+
+TEST_CASE("Notes and annotation edited in place invalidate the hashes")
+{
+  TSBDocument d(1, 1);
+  fillDocument(d, 3);
+  TSBComment* c = d.getComment(1);
+  c->setNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">notes</p>");
+  c->setTestAnnotation("<a:info xmlns:a=\"http://a.org\"/>");
+
+  const uint64_t original = d.getContentHash();
+  const uint64_t comment = c->getContentHash();
+
+  XMLNode* notes = c->getNotes();
+  notes->getChild(0).addChild(XMLNode(" and more"));
+  REQUIRE(c->getContentHash() != comment);
+  REQUIRE(c->getContentHash() == TSBComment(*c).getContentHash());
+  REQUIRE(d.getContentHash() != original);
+
+  // a node kept across getContentHash() is edited after getting it again
+  delete notes->getChild(0).removeChild(1);
+  c->getNotes();
+  REQUIRE(c->getContentHash() == comment);
+  REQUIRE(d.getContentHash() == original);
+
+  c->getTestAnnotation()->addChild(
+    XMLNode(XMLTriple("item", "http://a.org", "a"), XMLAttributes()));
+  REQUIRE(c->getContentHash() != comment);
+  REQUIRE(c->getContentHash() == TSBComment(*c).getContentHash());
+  REQUIRE(d.getContentHash() != original);
+}
+
+
+TEST_CASE("Lazily parsed notes give the same hash")
+{
+  TSBDocument d(1, 1);
+  fillDocument(d, 3);
+  d.getComment(1)->setNotes(
+    "<p xmlns=\"http://www.w3.org/1999/xhtml\">comment <b>notes</b></p>");
+  const std::string xml = writeTSBToStdString(&d);
+
+  TSBReader reader;
+  TSBDocument* eager = reader.readTSBFromString(xml);
+  reader.setLazyParsing(true);
+  TSBDocument* lazy = reader.readTSBFromString(xml);
+
+  REQUIRE(lazy->getContentHash() == eager->getContentHash());
+
+  delete eager;
+  delete lazy;
+}
+
+
+TEST_CASE("Content hashes are available through the C API")
+{
+  TSBDocument_t* d = TSBDocument_create(1, 1);
+  TSBComment_t* c = TSBDocument_createComment(d);
+
+  const uint64_t original = TSBBase_getContentHash(d);
+  REQUIRE(original == d->getContentHash());
+  TSBComment_setNumber(c, 1);
+  REQUIRE(TSBBase_getContentHash(d) != original);
+  REQUIRE(TSBBase_getContentHash(NULL) == 0);
+
+  TSBDocument_free(d);
+}
@@ -40,6 +40,7 @@
 
 #include <tsb/common/common.h>
 #include <tsb/TSBNamespaces.h>
+#include <tsb/TSBDocument.h>
 
 
 
@@ -63,6 +64,139 @@ TEST_CASE("test_NS_copyConstructor")
   //delete ns2;
   delete ns;
 }
+
+
+TEST_CASE("test_Comment_moveConstructor")
+{
+  TSBComment c(1, 1);
+  c.setContributor("sarah");
+  c.setNumber(2.5);
+  c.setPoint("a point");
+
+  TSBComment moved(std::move(c));
+
+  REQUIRE(moved.getContributor() == "sarah");
+  REQUIRE(moved.getNumber() == 2.5);
+  REQUIRE(moved.getPoint() == "a point");
+  REQUIRE(moved.getLevel() == 1);
+  REQUIRE(moved.getVersion() == 1);
+}
+
+
+TEST_CASE("test_Document_moveAndAddOwned")
+{
+  TSBDocument d(1, 1);
+
+  std::unique_ptr<TSBComment> c(new TSBComment(1, 1));
+  c->setContributor("sarah");
+  c->setNumber(1);
+  TSBComment* raw = c.get();
+
+  REQUIRE(d.addComment(std::move(c)) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(c.get() == NULL);
+  REQUIRE(d.getNumComments() == 1);
+  REQUIRE(d.getComment(0) == raw);
+
+  TSBDocument moved(std::move(d));
+
+  REQUIRE(moved.getNumComments() == 1);
+  REQUIRE(d.getNumComments() == 0);
+  REQUIRE(moved.getComment(0) == raw);
+  REQUIRE(raw->getTSBDocument() == &moved);
+
+  TSBDocument assigned(1, 1);
+  assigned.createComment();
+  assigned = std::move(moved);
+
+  REQUIRE(assigned.getNumComments() == 1);
+  REQUIRE(assigned.getComment(0) == raw);
+  REQUIRE(raw->getTSBDocument() == &assigned);
+}
+
+
+TEST_CASE("test_Comment_removeDetaches")
+{
+  TSBDocument* d = new TSBDocument(1, 1);
+  d->createComment()->setContributor("sarah");
+  d->createComment()->setContributor("frank");
+
+  TSBComment* removed = d->removeComment(0);
+
+  REQUIRE(removed->getTSBDocument() == NULL);
+  REQUIRE(removed->getParentTSBObject() == NULL);
+
+  TSBListOfComments* list = d->getListOfComments();
+  TSBBase* released = list->get(0);
+  list->clear(false);
+
+  REQUIRE(released->getTSBDocument() == NULL);
+  REQUIRE(released->getParentTSBObject() == NULL);
+
+  delete d;
+
+  // the detached objects keep their own namespaces
+  REQUIRE(removed->getLevel() == 1);
+  REQUIRE(removed->getTSBNamespaces()->getURI() == TSB_XMLNS_L1V1);
+  REQUIRE(static_cast<TSBComment*>(released)->getContributor() == "frank");
+
+  delete removed;
+  delete released;
+}
+
+
+TEST_CASE("test_Comment_removeByIdDetaches")
+{
+  TSBDocument* d = new TSBDocument(1, 1);
+  d->createComment()->setId("c1");
+
+  TSBComment* removed = d->getListOfComments()->remove("c1");
+  REQUIRE(removed != NULL);
+  REQUIRE(d->getNumComments() == 0);
+  REQUIRE(removed->getTSBDocument() == NULL);
+  REQUIRE(removed->getParentTSBObject() == NULL);
+
+  delete d;
+  REQUIRE(removed->getLevel() == 1);
+  delete removed;
+}
+
+
+TEST_CASE("test_Comment_assignmentKeepsOwner")
+{
+  TSBDocument* d = new TSBDocument(1, 1);
+  d->createComment()->setContributor("sarah");
+  TSBComment* owned = d->getComment(0);
+
+  // a detached object assigned from an owned one stays detached
+  TSBComment copy(1, 1);
+  copy = *owned;
+  REQUIRE(copy.getContributor() == "sarah");
+  REQUIRE(copy.getTSBDocument() == NULL);
+  REQUIRE(copy.getParentTSBObject() == NULL);
+
+  TSBComment moved(1, 1);
+  moved = std::move(TSBComment(*owned));
+  REQUIRE(moved.getTSBDocument() == NULL);
+  REQUIRE(moved.getParentTSBObject() == NULL);
+
+  // an owned object assigned from a detached one stays in its document
+  TSBComment detached(1, 1);
+  detached.setContributor("frank");
+  *owned = detached;
+  REQUIRE(owned->getContributor() == "frank");
+  REQUIRE(owned->getTSBDocument() == d);
+  REQUIRE(owned->getParentTSBObject() == d->getListOfComments());
+
+  *owned = std::move(detached);
+  REQUIRE(owned->getTSBDocument() == d);
+  REQUIRE(owned->getParentTSBObject() == d->getListOfComments());
+
+  delete d;
+
+  REQUIRE(copy.getLevel() == 1);
+  REQUIRE(copy.getTSBNamespaces()->getURI() == TSB_XMLNS_L1V1);
+  REQUIRE(moved.getLevel() == 1);
+}
 //
 //
 ////START_TEST ( test_NS_assignmentOperator )
@@ -0,0 +1,249 @@
+/**
+ * \file    TestDocumentDiff.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+
+#include <string>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+static TSBComment*
+addComment(TSBDocument& d, const std::string& metaid,
+           const std::string& contributor, double number)
+{
+  TSBComment* c = d.createComment();
+  if (!metaid.empty()) c->setMetaId(metaid);
+  c->setContributor(contributor);
+  c->setNumber(number);
+  return c;
+}
+
+
+/*
+ * Requires the two documents to serialize identically.
+ */
+static void
+requireSameDocument(TSBDocument& a, TSBDocument& b)
+{
+  char* x = writeTSBToString(&a);
+  char* y = writeTSBToString(&b);
+  REQUIRE(std::string(x) == std::string(y));
+  free(x);
+  free(y);
+}
+
+
+TEST_CASE("Identical documents have an empty difference")
+{
+  TSBDocument older;
+  addComment(older, "c1", "a", 1);
+  addComment(older, "", "b", 2);
+  TSBDocument newer(older);
+
+  TSBDocumentDiff diff(older, newer);
+  REQUIRE(diff.isEmpty());
+  REQUIRE(diff.getNumAdded() == 0);
+  REQUIRE(diff.getNumRemoved() == 0);
+  REQUIRE(diff.getNumChanged() == 0);
+  REQUIRE(diff.getPatch() == "TSBPATCH 1 1 1 2 2 1\nK 0 2\n");
+
+  TSBDocument empty;
+  REQUIRE(TSBDocumentDiff(empty, empty).isEmpty());
+}
+
+
+TEST_CASE("Comments are matched by metaid and by content")
+{
+  TSBDocument older;
+  addComment(older, "c1", "a", 1);
+  addComment(older, "c2", "b", 2);
+  addComment(older, "", "c", 3);
+  addComment(older, "", "d", 4);
+
+  TSBDocument newer;
+  addComment(newer, "", "d", 4);
+  addComment(newer, "c2", "b", 20);
+  addComment(newer, "c3", "e", 5);
+  addComment(newer, "", "c", 3)->setPoint("moved");
+
+  TSBDocumentDiff diff;
+  REQUIRE(diff.compute(older, newer) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(diff.isEmpty() == false);
+  REQUIRE(diff.getNumOlderComments() == 4);
+  REQUIRE(diff.getNumNewerComments() == 4);
+
+  // the unkeyed comment whose point changed no longer matches by content
+  REQUIRE(diff.getNumAdded() == 2);
+  REQUIRE(diff.getAddedIndex(0) == 2);
+  REQUIRE(diff.getAddedIndex(1) == 3);
+  REQUIRE(diff.getNumRemoved() == 2);
+  REQUIRE(diff.getRemovedIndex(0) == 0);
+  REQUIRE(diff.getRemovedIndex(1) == 2);
+
+  REQUIRE(diff.getNumChanged() == 1);
+  REQUIRE(diff.getChangedOlderIndex(0) == 1);
+  REQUIRE(diff.getChangedNewerIndex(0) == 1);
+  REQUIRE(diff.getChangedFields(0) == TSB_COMMENT_FIELD_NUMBER);
+}
+
+
+TEST_CASE("A difference applied to the older document gives the newer one")
+{
+  TSBDocument older;
+  for (unsigned int i = 0; i < 20; ++i)
+  {
+    addComment(older, i % 2 ? "c" + std::to_string(i) : "", "x", i);
+  }
+  older.getComment(4)->setNotes(
+    "<notes><p xmlns=\"http://www.w3.org/1999/xhtml\">old</p></notes>");
+
+  TSBDocument newer(older);
+  delete newer.removeComment(0);
+  delete newer.removeComment(6);
+  newer.getComment(3)->setNotes(
+    "<notes><p xmlns=\"http://www.w3.org/1999/xhtml\">new</p></notes>");
+  newer.getComment(8)->setContributor("changed");
+  newer.getComment(9)->unsetNumber();
+  newer.getComment(10)->setNumber(tsb_util_NaN());
+  addComment(newer, "c99", "added", 99)->setPoint("p\nwith: lines");
+  newer.getListOfComments()->sortByNumber();
+
+  TSBDocumentDiff diff(older, newer);
+  // comments without a metaid that changed are removed and added again
+  REQUIRE(diff.getNumRemoved() == 5);
+  REQUIRE(diff.getRemovedIndex(1) == 4);
+  REQUIRE(diff.getNumAdded() == 4);
+  REQUIRE(diff.getNumChanged() == 1);
+  REQUIRE(diff.getChangedOlderIndex(0) == 11);
+
+  TSBComment* kept = older.getComment(1);
+  REQUIRE(diff.apply(older) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(older.getNumComments() == newer.getNumComments());
+  REQUIRE(older.getComment(0) == kept);
+  requireSameDocument(older, newer);
+  REQUIRE(TSBDocumentDiff(older, newer).isEmpty());
+
+  // the list no longer has the comments the difference applies to
+  REQUIRE(diff.apply(older) == LIBTSB_OPERATION_FAILED);
+}
+
+
+TEST_CASE("A patch read back applies like the difference it came from")
+{
+  TSBDocument older;
+  addComment(older, "c1", "a", 1);
+  addComment(older, "c2", "b", 2);
+  addComment(older, "c3", "c", 3);
+
+  TSBDocument newer(older);
+  newer.getComment(1)->setNumber(-0.1);
+  delete newer.removeComment(2);
+  addComment(newer, "", "d:e\n", 4.5)->setId("");
+
+  std::string patch = TSBDocumentDiff(older, newer).getPatch();
+
+  TSBDocumentDiff read;
+  REQUIRE(read.setPatch(patch) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(read.getPatch() == patch);
+  REQUIRE(read.getNumChanged() == 1);
+  REQUIRE(read.getNumRemoved() == 1);
+  REQUIRE(read.getNumAdded() == 1);
+
+  REQUIRE(read.apply(older) == LIBTSB_OPERATION_SUCCESS);
+  requireSameDocument(older, newer);
+
+  REQUIRE(read.setPatch("TSBPATCH 1 1 1 2 2 1\nK 1 2\n") ==
+          LIBTSB_OPERATION_FAILED);
+  REQUIRE(read.getNumOlderComments() == 0);
+  REQUIRE(read.setPatch("TSBPATCH 1 1 1 0 1 1\nA 1\n5:ab\n") ==
+          LIBTSB_OPERATION_FAILED);
+  REQUIRE(read.setPatch(patch.substr(0, patch.size() - 1)) ==
+          LIBTSB_OPERATION_FAILED);
+}
+
+
+TEST_CASE("Applying a difference can be undone with a snapshot")
+{
+  TSBDocument older;
+  addComment(older, "c1", "a", 1);
+  addComment(older, "c2", "b", 2);
+  TSBDocument original(older);
+
+  TSBDocument newer;
+  addComment(newer, "c2", "b", 5);
+  addComment(newer, "c4", "d", 4);
+
+  TSBDocumentDiff diff(older, newer);
+  REQUIRE(older.takeSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(diff.apply(older) == LIBTSB_OPERATION_SUCCESS);
+  requireSameDocument(older, newer);
+
+  REQUIRE(older.restoreSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  requireSameDocument(older, original);
+}
+
+
+TEST_CASE("TSBDocumentDiff C API")
+{
+  TSBDocument older;
+  addComment(older, "c1", "a", 1);
+  TSBDocument newer;
+  addComment(newer, "c1", "a", 2);
+  addComment(newer, "c2", "b", 3);
+
+  TSBDocumentDiff_t* dd = TSBDocumentDiff_create();
+  REQUIRE(TSBDocumentDiff_compute(dd, &older, &newer) ==
+          LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(TSBDocumentDiff_getNumAdded(dd) == 1);
+  REQUIRE(TSBDocumentDiff_getNumRemoved(dd) == 0);
+  REQUIRE(TSBDocumentDiff_getNumChanged(dd) == 1);
+
+  char* patch = TSBDocumentDiff_getPatch(dd);
+  REQUIRE(TSBDocumentDiff_setPatch(dd, patch) == LIBTSB_OPERATION_SUCCESS);
+  free(patch);
+
+  REQUIRE(TSBDocumentDiff_apply(dd, &older) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(older.getNumComments() == 2);
+  REQUIRE(older.getComment(0)->getNumber() == 2);
+
+  REQUIRE(TSBDocumentDiff_compute(NULL, &older, &newer) ==
+          LIBTSB_INVALID_OBJECT);
+  REQUIRE(TSBDocumentDiff_apply(dd, NULL) == LIBTSB_INVALID_OBJECT);
+  REQUIRE(TSBDocumentDiff_getPatch(NULL) == NULL);
+  TSBDocumentDiff_free(dd);
+}
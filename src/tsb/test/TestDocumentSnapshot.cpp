@@ -0,0 +1,169 @@
+/**
+ * \file    TestDocumentSnapshot.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <cstdlib>
+#include <string>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBDocument.h>
+
+
+static TSBDocument* createDocument(unsigned int numComments)
+{
+  TSBDocument *d = new TSBDocument(1, 1);
+
+  for (unsigned int i = 0; i < numComments; ++i)
+  {
+    TSBComment* c = d->createComment();
+    c->setContributor("sarah");
+    c->setNumber(i);
+  }
+
+  return d;
+}
+
+
+TEST_CASE("Snapshot only copies modified comments")
+{
+  TSBDocument *d = createDocument(10);
+  TSBComment* unchanged = d->getComment(0);
+
+  REQUIRE(d->hasSnapshot() == false);
+  REQUIRE(d->restoreSnapshot() == LIBTSB_OPERATION_FAILED);
+
+  REQUIRE(d->takeSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d->hasSnapshot() == true);
+
+  d->getComment(3)->setContributor("mike");
+  d->getComment(3)->setNumber(42);
+  delete d->removeComment(5);
+  d->createComment()->setContributor("new");
+
+  REQUIRE(d->getNumComments() == 10);
+
+  TSBDocument *copy = d->cloneSnapshot();
+  REQUIRE(copy != NULL);
+  REQUIRE(copy->getNumComments() == 10);
+  REQUIRE(copy->getComment(3)->getContributor() == "sarah");
+  REQUIRE(copy->getComment(5)->getNumber() == 5);
+
+  REQUIRE(d->restoreSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d->hasSnapshot() == false);
+
+  REQUIRE(d->getNumComments() == 10);
+  REQUIRE(d->getComment(0) == unchanged);
+  REQUIRE(d->getComment(3)->getContributor() == "sarah");
+  REQUIRE(d->getComment(3)->getNumber() == 3);
+  REQUIRE(d->getComment(5)->getNumber() == 5);
+  REQUIRE(d->getComment(9)->getContributor() == "sarah");
+  REQUIRE(d->getComment(3)->getTSBDocument() == d);
+
+  delete copy;
+  delete d;
+}
+
+
+TEST_CASE("Restoring a snapshot undoes assignment to a comment")
+{
+  TSBDocument *d = createDocument(3);
+
+  TSBComment other(1, 1);
+  other.setContributor("mike");
+  other.setNumber(42);
+
+  d->takeSnapshot();
+  *d->getComment(0) = other;
+  *d->getComment(1) = std::move(other);
+  REQUIRE(d->getComment(0)->getContributor() == "mike");
+
+  // a comment added after the snapshot can change freely
+  d->createComment()->setContributor("new");
+  d->getComment(3)->setNumber(7);
+
+  REQUIRE(d->restoreSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d->getNumComments() == 3);
+  REQUIRE(d->getComment(0)->getContributor() == "sarah");
+  REQUIRE(d->getComment(0)->getNumber() == 0);
+  REQUIRE(d->getComment(1)->getNumber() == 1);
+
+  delete d;
+}
+
+
+TEST_CASE("Restoring a snapshot undoes edits to notes and annotation")
+{
+  TSBDocument *d = createDocument(2);
+  d->getComment(0)->setNotes(
+    "<p xmlns=\"http://www.w3.org/1999/xhtml\">first</p>");
+  d->getComment(1)->setTestAnnotation(
+    "<testAnnotation><a:info xmlns:a=\"http://a.org\"/></testAnnotation>");
+
+  const std::string notes = d->getComment(0)->getNotesString();
+  const std::string annotation = d->getComment(1)->getTestAnnotationString();
+
+  d->takeSnapshot();
+
+  // edited in place through the nodes returned by the non-const getters
+  d->getComment(0)->getNotes()->getChild(0).addChild(XMLNode(" and more"));
+  d->getComment(1)->getTestAnnotation()->addChild(
+    XMLNode(XMLTriple("item", "http://a.org", "a"), XMLAttributes()));
+
+  REQUIRE(d->getComment(0)->getNotesString() != notes);
+  REQUIRE(d->getComment(1)->getTestAnnotationString() != annotation);
+
+  REQUIRE(d->restoreSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d->getComment(0)->getNotesString() == notes);
+  REQUIRE(d->getComment(1)->getTestAnnotationString() == annotation);
+
+  delete d;
+}
+
+
+TEST_CASE("Released snapshot keeps changes")
+{
+  TSBDocument *d = createDocument(3);
+
+  d->takeSnapshot();
+  d->getComment(1)->unsetNumber();
+  REQUIRE(d->releaseSnapshot() == LIBTSB_OPERATION_SUCCESS);
+
+  REQUIRE(d->hasSnapshot() == false);
+  REQUIRE(d->getComment(1)->isSetNumber() == false);
+  REQUIRE(d->cloneSnapshot() == NULL);
+
+  delete d;
+}
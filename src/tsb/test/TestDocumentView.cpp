@@ -0,0 +1,152 @@
+/**
+ * \file    TestDocumentView.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+static const std::string xml =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">"
+  "<listOfComments>"
+  "<comment contributor=\"a\" number=\"1.5\" point=\"first\"/>"
+  "<comment contributor=\"b\" point=\"p\"/>"
+  "<comment contributor=\"a\" number=\"-2\"/>"
+  "</listOfComments></tsb>\n";
+
+
+TEST_CASE("Viewing a binary TSB file")
+{
+  const char* filename = "document-view-test.tsbb";
+
+  TSBDocument* d = readTSBFromString(xml.c_str());
+  TSBWriter writer;
+  REQUIRE(writer.writeTSBBinary(d, filename));
+
+  TSBDocumentView view;
+  REQUIRE(!view.isOpen());
+  REQUIRE(view.getNumComments() == 0);
+  REQUIRE(view.open(filename) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(view.isOpen());
+  REQUIRE(view.getLevel() == 1);
+  REQUIRE(view.getVersion() == 1);
+
+  REQUIRE(view.getNumComments() == d->getNumComments());
+  for (unsigned int n = 0; n < view.getNumComments(); ++n)
+  {
+    const TSBComment* comment = d->getComment(n);
+    REQUIRE(view.getContributor(n) == comment->getContributor());
+    REQUIRE(view.getPoint(n) == comment->getPoint());
+    REQUIRE(view.isSetNumber(n) == comment->isSetNumber());
+    if (comment->isSetNumber())
+    {
+      REQUIRE(view.getNumber(n) == comment->getNumber());
+    }
+  }
+  REQUIRE(std::isnan(view.getNumber(1)));
+
+  // out of range
+  REQUIRE(view.getContributor(3) == NULL);
+  REQUIRE(view.getPoint(3) == NULL);
+  REQUIRE(!view.isSetNumber(3));
+
+  view.close();
+  REQUIRE(!view.isOpen());
+  REQUIRE(view.getContributor(0) == NULL);
+
+  remove(filename);
+  REQUIRE(view.open(filename) == LIBTSB_OPERATION_FAILED);
+
+  delete d;
+}
+
+
+TEST_CASE("Viewing damaged binary TSB data")
+{
+  TSBDocument* d = readTSBFromString(xml.c_str());
+  std::string data;
+  TSBBinaryFormat::write(*d, data, false);
+  delete d;
+
+  TSBDocumentView view;
+  REQUIRE(view.openBuffer(xml.data(), xml.size()) == LIBTSB_OPERATION_FAILED);
+  REQUIRE(view.openBuffer(data.data(), 40) == LIBTSB_OPERATION_FAILED);
+  REQUIRE(view.openBuffer(data.data(), data.size() - 1)
+          == LIBTSB_OPERATION_FAILED);
+  REQUIRE(!view.isOpen());
+
+  // the accessors check what they read
+  std::string damaged = data;
+  memset(&damaged[damaged.size() - 50], 0xff, 50);
+  REQUIRE(view.openBuffer(damaged.data(), damaged.size())
+          == LIBTSB_OPERATION_SUCCESS);
+  for (unsigned int n = 0; n < view.getNumComments(); ++n)
+  {
+    REQUIRE(view.getPoint(n) == NULL);
+  }
+}
+
+
+TEST_CASE("Viewing a binary TSB file through the C API")
+{
+  const char* filename = "document-view-c-test.tsbb";
+
+  TSBDocument_t* d = readTSBFromString(xml.c_str());
+  REQUIRE(writeTSBBinary(d, filename) == 1);
+  delete d;
+
+  TSBDocumentView_t* view = TSBDocumentView_create();
+  REQUIRE(TSBDocumentView_open(view, filename) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(TSBDocumentView_getNumComments(view) == 3);
+  REQUIRE(strcmp(TSBDocumentView_getContributor(view, 1), "b") == 0);
+  REQUIRE(strcmp(TSBDocumentView_getPoint(view, 0), "first") == 0);
+  REQUIRE(TSBDocumentView_isSetNumber(view, 2) == 1);
+  REQUIRE(TSBDocumentView_getNumber(view, 2) == -2);
+  TSBDocumentView_close(view);
+  REQUIRE(TSBDocumentView_getNumComments(view) == 0);
+  TSBDocumentView_free(view);
+
+  REQUIRE(TSBDocumentView_open(NULL, filename) == LIBTSB_INVALID_OBJECT);
+  REQUIRE(TSBDocumentView_getContributor(NULL, 0) == NULL);
+  remove(filename);
+}
@@ -0,0 +1,106 @@
+/**
+ * \file    TestErrorLog.cpp
+ * \brief   TSBErrorLog unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <cstdlib>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBErrorLog.h>
+
+
+struct OnEvenLine
+{
+  bool operator() (const XMLError& error) const
+  {
+    return error.getLine() % 2 == 0;
+  }
+};
+
+
+TEST_CASE("ErrorLog retainIf", "[ErrorLog]")
+{
+  TSBErrorLog log;
+
+  for (unsigned int i = 0; i < 6; ++i)
+  {
+    log.logError(TsbCommentAllowedAttributes, 1, 1, "", i);
+  }
+
+  REQUIRE(log.retainIf(OnEvenLine()) == 3);
+  REQUIRE(log.getNumErrors() == 3);
+
+  // the retained errors keep their order
+  REQUIRE(log.getError(0)->getLine() == 0);
+  REQUIRE(log.getError(1)->getLine() == 2);
+  REQUIRE(log.getError(2)->getLine() == 4);
+
+  REQUIRE(log.retainIf(OnEvenLine()) == 0);
+  REQUIRE(log.getNumErrors() == 3);
+}
+
+
+TEST_CASE("ErrorLog retainIf sees parser errors as XMLError", "[ErrorLog]")
+{
+  TSBErrorLog log;
+
+  // errors of the XML parser are plain XMLError objects
+  XMLErrorLog& base = log;
+  base.add(XMLError(BadlyFormedXML, "", 1));
+  log.logError(TsbCommentAllowedAttributes, 1, 1, "", 2);
+  base.add(XMLError(BadlyFormedXML, "", 4));
+  log.logError(TsbCommentAllowedAttributes, 1, 1, "", 5);
+
+  REQUIRE(log.retainIf(OnEvenLine()) == 2);
+  REQUIRE(log.getNumErrors() == 2);
+  REQUIRE(base.getError(0)->getErrorId() == TsbCommentAllowedAttributes);
+  REQUIRE(base.getError(1)->getErrorId() == BadlyFormedXML);
+}
+
+
+TEST_CASE("ErrorLog removeAll", "[ErrorLog]")
+{
+  TSBErrorLog log;
+
+  log.logError(TsbCommentAllowedAttributes);
+  log.logError(TsbDocumentAllowedAttributes);
+  log.logError(TsbCommentAllowedAttributes);
+
+  log.removeAll(TsbCommentAllowedAttributes);
+
+  REQUIRE(log.getNumErrors() == 1);
+  REQUIRE(log.getError(0)->getErrorId() == TsbDocumentAllowedAttributes);
+  REQUIRE(log.contains(TsbCommentAllowedAttributes) == false);
+}
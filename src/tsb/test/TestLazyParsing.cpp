@@ -0,0 +1,135 @@
+/**
+ * \file    TestLazyParsing.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <cstdlib>
+#include <cstdlib>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+static std::string createAnnotatedDocument()
+{
+  TSBDocument d(1, 1);
+  d.setNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">document notes</p>");
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    TSBComment* c = d.createComment();
+    c->setContributor("sarah");
+    c->setNumber(i);
+    c->setNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">comment <b>notes</b></p>");
+    c->setTestAnnotation("<testAnnotation><a:info xmlns:a=\"http://a.org\">"
+      "<a:item value=\"1\"/><a:item><a:nested/></a:item></a:info></testAnnotation>");
+  }
+
+  return writeTSBToStdString(&d);
+}
+
+
+TEST_CASE("Lazy parsing gives the same notes and annotations")
+{
+  std::string xml = createAnnotatedDocument();
+
+  TSBReader reader;
+  REQUIRE(reader.getLazyParsing() == false);
+  TSBDocument* eager = reader.readTSBFromString(xml);
+
+  reader.setLazyParsing(true);
+  REQUIRE(reader.getLazyParsing() == true);
+  TSBDocument* lazy = reader.readTSBFromString(xml);
+
+  REQUIRE(lazy->getNumErrors() == eager->getNumErrors());
+  REQUIRE(lazy->getNumComments() == 3);
+
+  REQUIRE(lazy->isSetNotes() == true);
+  REQUIRE(lazy->getComment(1)->isSetTestAnnotation() == true);
+
+  // writing does not need the trees to be built
+  REQUIRE(writeTSBToStdString(lazy) == writeTSBToStdString(eager));
+
+  REQUIRE(lazy->getNotesString() == eager->getNotesString());
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    const TSBComment* c = lazy->getComment(i);
+    REQUIRE(c->getNotesString() == eager->getComment(i)->getNotesString());
+    REQUIRE(c->getTestAnnotationString() ==
+            eager->getComment(i)->getTestAnnotationString());
+    REQUIRE(c->getTestAnnotation()->getChild(0).getNumChildren() == 2);
+  }
+
+  delete eager;
+  delete lazy;
+}
+
+
+TEST_CASE("Lazily read content can be copied and replaced")
+{
+  std::string xml = createAnnotatedDocument();
+
+  TSBReader reader;
+  reader.setLazyParsing(true);
+  TSBDocument* lazy = reader.readTSBFromString(xml);
+
+  TSBDocument* copy = lazy->clone();
+  REQUIRE(copy->getComment(0)->getNotesString() ==
+          lazy->getComment(0)->getNotesString());
+
+  TSBComment* c = lazy->getComment(2);
+  REQUIRE(c->unsetNotes() == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(c->isSetNotes() == false);
+
+  REQUIRE(c->removeTopLevelTestAnnotationElement("info")
+          == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(c->isSetTestAnnotation() == false);
+  REQUIRE(copy->getComment(2)->getTestAnnotation()->getNumChildren() == 1);
+
+  delete copy;
+  delete lazy;
+}
+
+
+TEST_CASE("Lazy parsing can be set through the C API")
+{
+  TSBReader_t* reader = TSBReader_create();
+  REQUIRE(TSBReader_setLazyParsing(reader, 1) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(TSBReader_getLazyParsing(reader) == 1);
+  REQUIRE(TSBReader_setLazyParsing(NULL, 1) == LIBTSB_INVALID_OBJECT);
+  REQUIRE(TSBReader_getLazyParsing(NULL) == 0);
+  TSBReader_free(reader);
+}
@@ -0,0 +1,111 @@
+/**
+ * \file    TestParallelForEach.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <cstdlib>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBDocument.h>
+
+
+struct CommentStats
+{
+  unsigned int count;
+  unsigned int withNumber;
+  double sum;
+
+  CommentStats() : count(0), withNumber(0), sum(0) { }
+
+  void operator() (const TSBComment* c)
+  {
+    ++count;
+    if (c->isSetNumber())
+    {
+      ++withNumber;
+      sum += c->getNumber();
+    }
+  }
+
+  void merge(const CommentStats& other)
+  {
+    count += other.count;
+    withNumber += other.withNumber;
+    sum += other.sum;
+  }
+};
+
+
+TEST_CASE("Parallel traversal of comments")
+{
+  TSBDocument *d = new TSBDocument(1, 1);
+
+  for (unsigned int i = 0; i < 1000; ++i)
+  {
+    TSBComment* c = d->createComment();
+    c->setContributor("sarah");
+    if (i % 2 == 0)
+    {
+      c->setNumber(i);
+    }
+  }
+
+  // 0 + 2 + ... + 998
+  double expected = 249500;
+
+  unsigned int threads[] = { 0, 1, 3, 8, 2000 };
+  for (unsigned int t = 0; t < 5; ++t)
+  {
+    CommentStats stats = d->parallelForEachComment(CommentStats(), threads[t]);
+
+    REQUIRE(stats.count == 1000);
+    REQUIRE(stats.withNumber == 500);
+    REQUIRE(stats.sum == expected);
+  }
+
+  delete d;
+}
+
+
+TEST_CASE("Parallel traversal of an empty list")
+{
+  TSBDocument *d = new TSBDocument(1, 1);
+
+  CommentStats stats = d->parallelForEachComment(CommentStats(), 4);
+
+  REQUIRE(stats.count == 0);
+
+  delete d;
+}
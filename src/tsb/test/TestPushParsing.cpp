@@ -0,0 +1,313 @@
+/**
+ * \file    TestPushParsing.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+static const std::string document =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">\n"
+  "  <notes><p xmlns=\"http://www.w3.org/1999/xhtml\">document</p></notes>\n"
+  "  <listOfComments>\n"
+  "    <!-- a > comment -->\n"
+  "    <comment contributor=\"sarah\" number=\"1\"/>\n"
+  "    <comment contributor=\"s&amp;b\"\n"
+  "             number=\"2\" point=\"a &lt;point&gt;\">\n"
+  "      <notes><p xmlns=\"http://www.w3.org/1999/xhtml\">caf\xc3\xa9</p></notes>\n"
+  "      <testAnnotation><a:info xmlns:a=\"http://a.org\"><a:item/>"
+  "</a:info></testAnnotation>\n"
+  "    </comment>\n"
+  "    <comment contributor=\"x\" number=\"3\" unknown=\"4\"/>\n"
+  "  </listOfComments>\n"
+  "</tsb>\n";
+
+
+static std::string describeErrors(const TSBDocument* d, bool sorted = false)
+{
+  // parser errors are plain XMLError objects, so read them through the base
+  const XMLErrorLog* log = d->getErrorLog();
+  std::vector<std::string> errors;
+  for (unsigned int i = 0; i < log->getNumErrors(); ++i)
+  {
+    std::ostringstream error;
+    error << log->getError(i)->getErrorId() << "@"
+          << log->getError(i)->getLine() << ":"
+          << log->getError(i)->getColumn() << " ";
+    errors.push_back(error.str());
+  }
+
+  if (sorted)
+  {
+    std::sort(errors.begin(), errors.end());
+  }
+
+  std::string description;
+  for (size_t i = 0; i < errors.size(); ++i)
+  {
+    description += errors[i];
+  }
+  return description;
+}
+
+
+static TSBDocument* feedInChunks(TSBReader& reader, const std::string& xml,
+                                 size_t chunk)
+{
+  for (size_t i = 0; i < xml.size(); i += chunk)
+  {
+    REQUIRE(reader.feed(xml.data() + i,
+                        std::min(chunk, xml.size() - i)) == LIBTSB_OPERATION_SUCCESS);
+  }
+  return reader.finish();
+}
+
+
+static void requireSameAsString(const std::string& xml,
+                                bool malformed = false, bool trusted = false)
+{
+  TSBReader reader;
+  reader.setTrustedInput(trusted);
+  reader.setLazyParsing(trusted);
+  TSBDocument* expected = reader.readTSBFromString(xml);
+  const std::string written = writeTSBToStdString(expected);
+
+  size_t chunks[] = { 1, 2, 7, 64, xml.size() };
+  for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); ++i)
+  {
+    TSBDocument* d = feedInChunks(reader, xml, chunks[i]);
+    REQUIRE(describeErrors(d) == describeErrors(expected));
+
+    // comments completed before the input turns out to be malformed are
+    // kept, whatever the XML parser makes of the rest
+    if (malformed)
+    {
+      REQUIRE(d->getNumComments() >= expected->getNumComments());
+    }
+    else
+    {
+      REQUIRE(d->getNumComments() == expected->getNumComments());
+      REQUIRE(writeTSBToStdString(d) == written);
+    }
+    delete d;
+  }
+
+  delete expected;
+}
+
+
+// the errors found while feeding are listed after the others
+static void requireSameErrorsAsString(const std::string& xml)
+{
+  TSBReader reader;
+  TSBDocument* expected = reader.readTSBFromString(xml);
+  const std::string written = writeTSBToStdString(expected);
+
+  size_t chunks[] = { 1, 7, xml.size() };
+  for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); ++i)
+  {
+    TSBDocument* d = feedInChunks(reader, xml, chunks[i]);
+    REQUIRE(describeErrors(d, true) == describeErrors(expected, true));
+    REQUIRE(d->getNumComments() == expected->getNumComments());
+    REQUIRE(writeTSBToStdString(d) == written);
+    delete d;
+  }
+
+  delete expected;
+}
+
+
+TEST_CASE("Feeding a document in chunks reads the same document")
+{
+  requireSameAsString(document);
+  requireSameAsString(document, false, true);
+}
+
+
+TEST_CASE("Comments are available before the document ends")
+{
+  TSBReader reader;
+  const size_t end = document.find("<comment contributor=\"x\"");
+
+  REQUIRE(reader.feed(document.data(), end) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(reader.getNumCompletedComments() == 2);
+
+  TSBComment* first = reader.takeCompletedComment();
+  REQUIRE(first->getContributor() == "sarah");
+  REQUIRE(first->getParentTSBObject() == NULL);
+  REQUIRE(reader.getNumCompletedComments() == 1);
+
+  reader.feed(document.data() + end, document.size() - end);
+  REQUIRE(reader.getNumCompletedComments() == 2);
+
+  TSBDocument* d = reader.finish();
+  REQUIRE(reader.getNumCompletedComments() == 0);
+  REQUIRE(d->getNumComments() == 2);
+  REQUIRE(d->getComment(0)->getContributor() == "s&b");
+  REQUIRE(d->getComment(0)->getNotesString().find("caf\xc3\xa9")
+          != std::string::npos);
+  REQUIRE(d->getComment(1)->getLine() == 12);
+  REQUIRE(d->getNumErrors() == 1);
+  REQUIRE(d->getError(0)->getLine() == 12);
+
+  // the taken comment outlives the document it was read into
+  delete d;
+  REQUIRE(first->getNumber() == 1);
+  delete first;
+
+  d = reader.finish();
+  REQUIRE(d->getNumComments() == 0);
+  delete d;
+}
+
+
+TEST_CASE("Feeding malformed or unusual documents")
+{
+  requireSameAsString("");
+  requireSameAsString("<notTsb/>");
+  requireSameAsString(
+    "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">"
+    "<listOfComments/></tsb>");
+  requireSameAsString(
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">\n"
+    "<listOfComments></listOfComments></tsb>");
+
+  // comments are decoded with the encoding the document declares
+  requireSameAsString(
+    "<?xml version='1.0' encoding = 'ISO-8859-1'?>\n"
+    "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">\n"
+    "<listOfComments><comment contributor=\"caf\xe9\" number=\"1\"/>"
+    "</listOfComments></tsb>");
+
+  // an unclosed comment and a mismatched tag after complete comments
+  std::string truncated = document.substr(0, document.find("</comment>"));
+  requireSameAsString(truncated, true);
+
+  std::string mismatched = document;
+  mismatched.replace(mismatched.find("</comment>"), 10, "</commant>");
+  requireSameAsString(mismatched, true);
+}
+
+
+TEST_CASE("Feeding documents with misplaced elements")
+{
+  const std::string head =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">\n";
+
+  // a stray element between comments and a second list of comments
+  const std::string misplaced = head +
+    "  <listOfComments>\n"
+    "    <comment contributor=\"a\" number=\"1\" u=\"1\"/>\n"
+    "    <stray/>\n"
+    "    <comment contributor=\"b\" number=\"2\" u=\"2\"/>\n"
+    "  </listOfComments>\n"
+    "  <listOfComments>\n"
+    "    <comment contributor=\"c\" number=\"3\" u=\"3\"/>\n"
+    "  </listOfComments>\n"
+    "</tsb>\n";
+  requireSameErrorsAsString(misplaced);
+
+  TSBReader reader;
+  REQUIRE(reader.feed(misplaced.data(), misplaced.size())
+          == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(reader.getNumCompletedComments() == 3);
+
+  TSBDocument* d = reader.finish();
+  const XMLErrorLog* log = d->getErrorLog();
+  REQUIRE(log->getNumErrors() == 5);
+  REQUIRE(log->getError(0)->getErrorId() == TSBUnrecognizedElement);
+  REQUIRE(log->getError(1)->getErrorId() == TsbCommentAllowedAttributes);
+  REQUIRE(log->getError(1)->getLine() == 4);
+  REQUIRE(log->getError(2)->getLine() == 6);
+  REQUIRE(log->getError(3)->getErrorId() == TsbDocumentAllowedElements);
+  REQUIRE(log->getError(3)->getLine() == 2);
+  REQUIRE(log->getError(4)->getLine() == 9);
+  delete d;
+
+  // the first comment read takes over the errors of the attributes of
+  // the lists before it, so such lists are left to the reader
+  const std::string attributes = head +
+    "  <listOfComments metaid=\"m\"/>\n"
+    "  <listOfComments/>\n"
+    "  <listOfComments>\n"
+    "    <comment contributor=\"a\" number=\"1\"/>\n"
+    "  </listOfComments>\n"
+    "</tsb>\n";
+  requireSameAsString(attributes);
+
+  REQUIRE(reader.feed(attributes.data(), attributes.size())
+          == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(reader.getNumCompletedComments() == 0);
+  delete reader.finish();
+
+  requireSameAsString(head +
+    "  <listOfComments id=\"l\">\n"
+    "    <comment contributor=\"a\" number=\"1\" u=\"1\"/>\n"
+    "  </listOfComments>\n"
+    "</tsb>\n");
+}
+
+
+TEST_CASE("Feeding documents through the C API")
+{
+  TSBReader_t* reader = TSBReader_create();
+
+  REQUIRE(TSBReader_feed(reader, NULL, 1) == LIBTSB_OPERATION_FAILED);
+  REQUIRE(TSBReader_feed(NULL, document.data(), 1) == LIBTSB_INVALID_OBJECT);
+  REQUIRE(TSBReader_feed(reader, document.data(), document.size())
+          == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(TSBReader_getNumCompletedComments(reader) == 3);
+
+  TSBComment_t* c = TSBReader_takeCompletedComment(reader);
+  REQUIRE(c != NULL);
+  delete c;
+
+  TSBDocument_t* d = TSBReader_finish(reader);
+  REQUIRE(d->getNumComments() == 2);
+  delete d;
+
+  REQUIRE(TSBReader_takeCompletedComment(reader) == NULL);
+  REQUIRE(TSBReader_finish(NULL) == NULL);
+  TSBReader_free(reader);
+}
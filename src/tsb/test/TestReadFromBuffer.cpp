@@ -0,0 +1,120 @@
+/**
+ * \file    TestReadFromBuffer.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <cstdlib>
+#include <cstring>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+static const std::string body =
+  "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">"
+  "<listOfComments><comment contributor=\"a\" number=\"1\"/>"
+  "<comment contributor=\"b\" number=\"2\" point=\"p\"/></listOfComments>"
+  "</tsb>\n";
+
+static const std::string declaration =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+
+
+static std::string readAndWrite(TSBDocument* d)
+{
+  REQUIRE(d != NULL);
+  REQUIRE(d->getNumErrors() == 0);
+  REQUIRE(d->getNumComments() == 2);
+
+  std::string result = writeTSBToStdString(d);
+  delete d;
+  return result;
+}
+
+
+TEST_CASE("Reading from a buffer that is not NUL-terminated")
+{
+  TSBReader reader;
+  const std::string expected =
+    readAndWrite(reader.readTSBFromString(declaration + body));
+
+  // the bytes after the buffer must not be read
+  std::string withDeclaration = declaration + body + "<garbage";
+  REQUIRE(readAndWrite(reader.readTSBFromBuffer(withDeclaration.data(),
+    declaration.size() + body.size())) == expected);
+
+  std::string withoutDeclaration = body + "<garbage";
+  REQUIRE(readAndWrite(reader.readTSBFromBuffer(withoutDeclaration.data(),
+    body.size())) == expected);
+
+  // the content stops at a NUL character
+  std::string terminated = declaration + body;
+  terminated.push_back('\0');
+  terminated += "<garbage";
+  REQUIRE(readAndWrite(reader.readTSBFromBuffer(terminated.data(),
+    terminated.size())) == expected);
+}
+
+
+TEST_CASE("Reading an empty buffer")
+{
+  TSBReader reader;
+  TSBDocument* fromString = reader.readTSBFromString("");
+  TSBDocument* fromBuffer = reader.readTSBFromBuffer(NULL, 0);
+
+  REQUIRE(fromBuffer->getNumErrors() == fromString->getNumErrors());
+  REQUIRE(fromBuffer->getNumComments() == 0);
+
+  delete fromString;
+  delete fromBuffer;
+}
+
+
+TEST_CASE("Reading from a buffer through the C API")
+{
+  std::string xml = body + "<garbage";
+
+  TSBReader_t* reader = TSBReader_create();
+  TSBDocument_t* d = TSBReader_readTSBFromBuffer(reader, xml.data(),
+    body.size());
+  REQUIRE(d->getNumComments() == 2);
+  delete d;
+  REQUIRE(TSBReader_readTSBFromBuffer(NULL, xml.data(), body.size()) == NULL);
+  TSBReader_free(reader);
+
+  d = readTSBFromBuffer(xml.data(), body.size());
+  REQUIRE(d->getNumComments() == 2);
+  delete d;
+}
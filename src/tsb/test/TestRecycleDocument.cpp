@@ -0,0 +1,186 @@
+/**
+ * \file    TestRecycleDocument.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+static std::string createDocument(unsigned int numComments, bool annotated)
+{
+  TSBDocument d(1, 1);
+
+  if (annotated)
+  {
+    d.setMetaId("doc");
+    d.setNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">document notes</p>");
+  }
+
+  for (unsigned int i = 0; i < numComments; ++i)
+  {
+    TSBComment* c = d.createComment();
+    c->setContributor(annotated ? "sarah" : "mike");
+    c->setNumber(i);
+
+    if (annotated)
+    {
+      c->setMetaId("c" + std::to_string(i));
+      c->setPoint("point");
+      c->setNotes("<p xmlns=\"http://www.w3.org/1999/xhtml\">notes</p>");
+    }
+  }
+
+  return writeTSBToStdString(&d);
+}
+
+
+TEST_CASE("A recycled document is reused and reset")
+{
+  std::string first = createDocument(3, true);
+  std::string second = createDocument(2, false);
+
+  TSBReader reader;
+  TSBDocument* d = reader.readTSBFromString(first);
+  d->getErrorLog()->logError(TsbCommentAllowedAttributes);
+  REQUIRE(d->getNumComments() == 3);
+
+  std::set<TSBComment*> comments;
+  for (unsigned int i = 0; i < d->getNumComments(); ++i)
+  {
+    comments.insert(d->getComment(i));
+  }
+
+  TSBDocument* recycled = d;
+  reader.recycleDocument(d);
+
+  d = reader.readTSBFromString(second);
+  REQUIRE(d == recycled);
+  REQUIRE(d->getNumErrors() == 0);
+  REQUIRE(d->isSetMetaId() == false);
+  REQUIRE(d->isSetNotes() == false);
+  REQUIRE(d->getLevel() == 1);
+  REQUIRE(d->getVersion() == 1);
+  REQUIRE(d->getNumComments() == 2);
+
+  for (unsigned int i = 0; i < d->getNumComments(); ++i)
+  {
+    TSBComment* c = d->getComment(i);
+    REQUIRE(comments.count(c) == 1);
+    REQUIRE(c->getTSBDocument() == d);
+    REQUIRE(c->getParentTSBObject() == d->getListOfComments());
+    REQUIRE(c->getContributor() == "mike");
+    REQUIRE(c->getNumber() == i);
+    REQUIRE(c->isSetPoint() == false);
+    REQUIRE(c->isSetMetaId() == false);
+    REQUIRE(c->isSetNotes() == false);
+  }
+
+  // a document read by a fresh reader is the same
+  TSBReader fresh;
+  TSBDocument* expected = fresh.readTSBFromString(second);
+  REQUIRE(writeTSBToStdString(d) == writeTSBToStdString(expected));
+  delete expected;
+
+  // the document can outgrow what was recycled
+  reader.recycleDocument(d);
+  d = reader.readTSBFromString(first);
+  REQUIRE(d->getNumComments() == 3);
+  REQUIRE(writeTSBToStdString(d) == first);
+
+  delete d;
+}
+
+
+TEST_CASE("Hashed documents are recycled beyond the documents kept")
+{
+  std::string xml = createDocument(3, true);
+  TSBReader reader;
+
+  // one more document than the reader keeps, so the last one is deleted
+  // while its comments are kept for the next reads
+  std::vector<TSBDocument*> documents;
+  for (unsigned int i = 0; i < 5; ++i)
+  {
+    documents.push_back(reader.readTSBFromString(xml));
+    documents.back()->getContentHash();
+  }
+
+  for (unsigned int i = 0; i < documents.size(); ++i)
+  {
+    reader.recycleDocument(documents[i]);
+  }
+
+  TSBReader fresh;
+  TSBDocument* expected = fresh.readTSBFromString(xml);
+
+  for (unsigned int i = 0; i < documents.size(); ++i)
+  {
+    documents[i] = reader.readTSBFromString(xml);
+    REQUIRE(documents[i]->getNumErrors() == 0);
+    REQUIRE(documents[i]->getNumComments() == 3);
+    REQUIRE(documents[i]->getContentHash() == expected->getContentHash());
+  }
+
+  // editing a comment of one document leaves the others as they were
+  documents[0]->getComment(0)->setContributor("mike");
+  REQUIRE(documents[0]->getContentHash() != expected->getContentHash());
+  REQUIRE(documents[1]->getContentHash() == expected->getContentHash());
+
+  for (unsigned int i = 0; i < documents.size(); ++i)
+  {
+    delete documents[i];
+  }
+  delete expected;
+}
+
+
+TEST_CASE("Recycling through the C API")
+{
+  TSBReader_t* reader = TSBReader_create();
+  TSBDocument_t* d = TSBReader_readTSBFromString(reader,
+    createDocument(2, true).c_str());
+
+  REQUIRE(TSBReader_recycleDocument(reader, d) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(TSBReader_recycleDocument(reader, NULL) == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(TSBReader_recycleDocument(NULL, NULL) == LIBTSB_INVALID_OBJECT);
+
+  // the reader deletes what it holds
+  TSBReader_free(reader);
+}
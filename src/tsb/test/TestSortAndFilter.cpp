@@ -0,0 +1,242 @@
+/**
+ * \file    TestSortAndFilter.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+
+#include <vector>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+/*
+ * Fills d with n comments numbered n - 1 down to 0 in steps of 1, every
+ * third of which is contributed by "c".
+ */
+static void
+fillDocument(TSBDocument& d, unsigned int n)
+{
+  d.createComments(n);
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    d.getComment(i)->setNumber(n - 1 - i);
+    d.getComment(i)->setContributor(i % 3 == 0 ? "c" : "other");
+  }
+}
+
+
+struct NumberLess
+{
+  bool operator()(const TSBComment* a, const TSBComment* b) const
+  {
+    return a->getNumber() < b->getNumber();
+  }
+};
+
+
+struct ContributorLess
+{
+  bool operator()(const TSBComment* a, const TSBComment* b) const
+  {
+    return a->getContributor() < b->getContributor();
+  }
+};
+
+
+struct ContributedByC
+{
+  bool operator()(const TSBComment* comment) const
+  {
+    return comment->getContributor() == "c";
+  }
+};
+
+
+static bool
+numberGreater(const TSBBase* a, const TSBBase* b)
+{
+  return static_cast<const TSBComment*>(a)->getNumber() >
+         static_cast<const TSBComment*>(b)->getNumber();
+}
+
+
+TEST_CASE("Comments are sorted in place")
+{
+  TSBDocument d;
+  fillDocument(d, 100);
+  TSBListOfComments* lo = d.getListOfComments();
+  TSBComment* last = lo->get(99);
+
+  lo->sort(NumberLess());
+  REQUIRE(lo->size() == 100);
+  REQUIRE(lo->get(0) == last);
+  for (unsigned int i = 0; i < 100; ++i)
+  {
+    REQUIRE(lo->get(i)->getNumber() == i);
+    REQUIRE(lo->get(i)->getParentTSBObject() == lo);
+  }
+
+  lo->TSBListOf::sort(numberGreater);
+  REQUIRE(lo->get(0)->getNumber() == 99);
+  REQUIRE(lo->get(99) == last);
+}
+
+
+TEST_CASE("A parallel sort gives the same order as a sequential one")
+{
+  TSBDocument d1;
+  TSBDocument d2;
+  fillDocument(d1, 1001);
+  fillDocument(d2, 1001);
+
+  d1.getListOfComments()->stableSort(ContributorLess());
+  d2.getListOfComments()->stableSort(ContributorLess(), 4);
+
+  for (unsigned int i = 0; i < 1001; ++i)
+  {
+    REQUIRE(d1.getComment(i)->getContributor() ==
+            d2.getComment(i)->getContributor());
+    REQUIRE(d1.getComment(i)->getNumber() == d2.getComment(i)->getNumber());
+  }
+
+  // equal contributors keep their order, so the numbers still decrease
+  REQUIRE(d2.getComment(0)->getContributor() == "c");
+  REQUIRE(d2.getComment(0)->getNumber() == 1000);
+  REQUIRE(d2.getComment(1)->getNumber() == 997);
+
+  d2.getListOfComments()->sort(NumberLess(), 0);
+  for (unsigned int i = 0; i < 1001; ++i)
+  {
+    REQUIRE(d2.getComment(i)->getNumber() == i);
+  }
+}
+
+
+TEST_CASE("sortByNumber moves comments without a number last")
+{
+  TSBDocument d;
+  fillDocument(d, 5);
+  d.getComment(1)->unsetNumber();
+  d.getComment(3)->setNumber(tsb_util_NaN());
+  TSBComment* unset = d.getComment(1);
+
+  REQUIRE(TSBListOfComments_sortByNumber(d.getListOfComments(), 1) ==
+          LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d.getComment(0)->getNumber() == 0);
+  REQUIRE(d.getComment(1)->getNumber() == 2);
+  REQUIRE(d.getComment(2)->getNumber() == 4);
+  REQUIRE(d.getComment(3) == unset);
+  REQUIRE(TSBListOfComments_sortByNumber(NULL, 1) == LIBTSB_INVALID_OBJECT);
+}
+
+
+TEST_CASE("removeIf removes the matching comments in one pass")
+{
+  TSBDocument d;
+  fillDocument(d, 10);
+  TSBListOfComments* lo = d.getListOfComments();
+
+  std::vector<TSBComment*> removed;
+  REQUIRE(lo->removeIf(ContributedByC(), &removed) == 4);
+  REQUIRE(lo->size() == 6);
+  REQUIRE(removed.size() == 4);
+  REQUIRE(removed[0]->getNumber() == 9);
+  REQUIRE(removed[0]->getParentTSBObject() == NULL);
+  REQUIRE(removed[0]->getTSBDocument() == NULL);
+  REQUIRE(lo->get(0)->getNumber() == 8);
+  REQUIRE(lo->get(1)->getNumber() == 7);
+
+  for (unsigned int i = 0; i < removed.size(); ++i)
+  {
+    delete removed[i];
+  }
+
+  REQUIRE(lo->removeIf(ContributedByC()) == 0);
+  lo->get(0)->setContributor("c");
+  REQUIRE(lo->removeIf(ContributedByC()) == 1);
+  REQUIRE(lo->size() == 5);
+}
+
+
+TEST_CASE("partition keeps the order within each group")
+{
+  TSBDocument d;
+  fillDocument(d, 10);
+  TSBListOfComments* lo = d.getListOfComments();
+
+  REQUIRE(lo->partition(ContributedByC()) == 4);
+  REQUIRE(lo->get(0)->getNumber() == 9);
+  REQUIRE(lo->get(3)->getNumber() == 0);
+  REQUIRE(lo->get(4)->getNumber() == 8);
+  REQUIRE(lo->get(4)->getContributor() == "other");
+}
+
+
+TEST_CASE("Indexes follow a sort and a removeIf")
+{
+  TSBDocument d;
+  fillDocument(d, 30);
+  TSBListOfComments* lo = d.getListOfComments();
+  lo->setIndexed(true);
+
+  lo->sortByNumber();
+  REQUIRE(lo->getCommentsByContributor("c").size() == 10);
+
+  lo->removeIf(ContributedByC());
+  REQUIRE(lo->getCommentsByContributor("c").empty());
+  REQUIRE(lo->getCommentsByContributor("other").size() == 20);
+  REQUIRE(lo->getCommentsInNumberRange(0, 2).size() == 2);
+}
+
+
+TEST_CASE("A snapshot restores the order and items changed by a sort")
+{
+  TSBDocument d;
+  fillDocument(d, 6);
+  TSBComment* second = d.getComment(1);
+
+  REQUIRE(d.takeSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  d.getListOfComments()->sortByNumber();
+  d.getListOfComments()->removeIf(ContributedByC());
+  REQUIRE(d.getNumComments() == 4);
+
+  REQUIRE(d.restoreSnapshot() == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(d.getNumComments() == 6);
+  REQUIRE(d.getComment(0)->getNumber() == 5);
+  REQUIRE(d.getComment(5)->getNumber() == 0);
+  REQUIRE(d.getComment(0)->getContributor() == "c");
+  REQUIRE(d.getComment(1) == second);
+}
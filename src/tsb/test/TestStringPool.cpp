@@ -0,0 +1,158 @@
+/**
+ * \file    TestStringPool.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+
+
+static const std::string xml =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">"
+  "<listOfComments>"
+  "<comment contributor=\"a contributor with a long name\" number=\"1\"/>"
+  "<comment contributor=\"b\" number=\"2\"/>"
+  "<comment contributor=\"a contributor with a long name\" number=\"3\"/>"
+  "</listOfComments></tsb>\n";
+
+
+TEST_CASE("Comments of a document share their contributor strings")
+{
+  TSBDocument* d = readTSBFromString(xml.c_str());
+  REQUIRE(d->getNumErrors() == 0);
+
+  TSBComment* first = d->getComment(0);
+  TSBComment* third = d->getComment(2);
+  REQUIRE(&first->getContributor() == &third->getContributor());
+  REQUIRE(first->hasSameContributor(*third));
+  REQUIRE(!first->hasSameContributor(*d->getComment(1)));
+
+  TSBComment* created = d->createComment();
+  created->setContributor("b");
+  REQUIRE(&created->getContributor() == &d->getComment(1)->getContributor());
+
+  REQUIRE(created->unsetContributor() == LIBTSB_OPERATION_SUCCESS);
+  REQUIRE(created->getContributor().empty());
+  REQUIRE(created->hasSameContributor(TSBComment(1, 1)));
+
+  // an empty contributor is still an error
+  TSBDocument* empty = readTSBFromString(
+    "<tsb xmlns=\"http://testsbxml.org/l1v1\" level=\"1\" version=\"1\">"
+    "<listOfComments><comment contributor=\"\" number=\"1\"/>"
+    "</listOfComments></tsb>");
+  REQUIRE(empty->getNumErrors() == 1);
+  REQUIRE(!empty->getComment(0)->isSetContributor());
+  delete empty;
+
+  delete d;
+}
+
+
+TEST_CASE("Comments keep their contributor when they change document")
+{
+  TSBDocument* d = readTSBFromString(xml.c_str());
+  TSBDocument other(1, 1);
+  other.createComment()->setContributor("a contributor with a long name");
+
+  // a comment moved to another document joins its pool
+  other.addComment(d->getComment(0));
+  REQUIRE(&other.getComment(1)->getContributor() ==
+          &other.getComment(0)->getContributor());
+
+  // comments of different documents are compared by value
+  REQUIRE(other.getComment(1)->hasSameContributor(*d->getComment(2)));
+
+  // a removed comment outlives its document
+  TSBComment* removed = d->removeComment(2);
+  TSBDocument* copy = d->clone();
+  delete d;
+  REQUIRE(removed->getContributor() == "a contributor with a long name");
+  REQUIRE(removed->hasSameContributor(*other.getComment(0)));
+  delete removed;
+
+  REQUIRE(copy->getComment(0)->getContributor() ==
+          "a contributor with a long name");
+  REQUIRE(writeTSBToStdString(copy).find("contributor=\"b\"")
+          != std::string::npos);
+  delete copy;
+}
+
+
+TEST_CASE("Contributors that are replaced are released from the pool")
+{
+  TSBDocument d(1, 1);
+  TSBStringPool& pool = d.getStringPool();
+  TSBComment* c = d.createComment();
+  c->setContributor("first");
+  d.createComment()->setContributor("kept");
+
+  std::weak_ptr<const std::string> first = pool.intern(std::string("first"));
+  pool.removeUnused();
+  REQUIRE(!first.expired());
+
+  c->setContributor("second");
+  pool.removeUnused();
+  REQUIRE(first.expired());
+  REQUIRE(pool.size() == 2);
+
+  // strings are also dropped as the pool grows
+  for (unsigned int i = 0; i < 1000; ++i)
+  {
+    std::ostringstream contributor;
+    contributor << "contributor " << i;
+    c->setContributor(contributor.str());
+  }
+  REQUIRE(pool.size() < 200);
+  REQUIRE(c->getContributor() == "contributor 999");
+  REQUIRE(d.getComment(1)->getContributor() == "kept");
+}
+
+
+TEST_CASE("Comparing contributors through the C API")
+{
+  TSBDocument_t* d = readTSBFromString(xml.c_str());
+  REQUIRE(TSBComment_hasSameContributor(d->getComment(0), d->getComment(2))
+          == 1);
+  REQUIRE(TSBComment_hasSameContributor(d->getComment(0), d->getComment(1))
+          == 0);
+  REQUIRE(TSBComment_hasSameContributor(NULL, d->getComment(1)) == 0);
+  delete d;
+}
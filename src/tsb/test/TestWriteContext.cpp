@@ -0,0 +1,91 @@
+/**
+ * \file    TestWriteContext.cpp
+ * \brief   Read LibLX unit tests
+ * \author  Ben Bornstein
+ * 
+ * <!--------------------------------------------------------------------------
+ * This file is part of libLX.  Please visit http://sbml.org for more
+ * information about LX, and the latest version of libLX.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *     3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *  
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ *     Pasadena, CA, USA 
+ *  
+ * Copyright (C) 2002-2005 jointly by the following organizations: 
+ *     1. California Institute of Technology, Pasadena, CA, USA
+ *     2. Japan Science and Technology Agency, Japan
+ * 
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.  A copy of the license agreement is provided
+ * in the file named "LICENSE.txt" included with this software distribution
+ * and also available online as http://sbml.org/software/libsbml/license.html
+ * ---------------------------------------------------------------------- -->*/
+#include <string>
+
+#include "catch.hpp"
+
+#include <tsb/common/common.h>
+#include <tsb/TSBTypes.h>
+#include <tsb/TSBWriteContext.h>
+
+
+static const std::string prefixed =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<t:tsb xmlns:t=\"http://testsbxml.org/l1v1\" t:level=\"1\" t:version=\"1\">\n"
+  "  <t:listOfComments>\n"
+  "    <t:comment t:metaid=\"m1\" t:contributor=\"a\" t:number=\"1\"/>\n"
+  "    <t:comment t:contributor=\"b\" t:number=\"2\"/>\n"
+  "  </t:listOfComments>\n"
+  "</t:tsb>\n";
+
+
+TEST_CASE("Prefixed documents are written with their prefixes")
+{
+  TSBDocument* d = readTSBFromString(prefixed.c_str());
+  REQUIRE(d->getNumErrors() == 0);
+
+  const std::string written = writeTSBToStdString(d);
+  REQUIRE(written.find("<t:listOfComments>") != std::string::npos);
+  REQUIRE(written.find("<t:comment t:metaid=\"m1\" t:contributor=\"a\"")
+          != std::string::npos);
+  REQUIRE(written.find("<t:comment t:contributor=\"b\"")
+          != std::string::npos);
+  REQUIRE(written.find("</t:tsb>") != std::string::npos);
+
+  delete d;
+}
+
+
+TEST_CASE("The write context resolves prefixes for each set of namespaces")
+{
+  TSBDocument* d = readTSBFromString(prefixed.c_str());
+  TSBComment standalone(1, 1);
+  TSBWriteContext context;
+
+  const std::string prefix = context.getPrefix(d->getComment(0));
+  REQUIRE(prefix == "t");
+  REQUIRE(context.getTSBPrefix(d->getComment(0)) == "t");
+
+  // an object with other namespaces clears what has been resolved
+  REQUIRE(context.getPrefix(&standalone).empty());
+  REQUIRE(context.getTSBPrefix(&standalone).empty());
+
+  REQUIRE(context.getPrefix(d->getListOfComments()) == "t");
+  REQUIRE(context.getPrefix(d) == "t");
+  REQUIRE(prefix == "t");
+
+  delete d;
+}
@@ -22,6 +22,26 @@ bool ExpectedAttributes::hasAttribute(const std::string & attribute) const
     != mAttributes.end());
 }
 
+bool ExpectedAttributes::hasAttribute(const std::string & prefix,
+                                      const std::string & name) const
+{
+  const std::string::size_type length = prefix.size() + 1 + name.size();
+
+  for (std::vector<std::string>::const_iterator it = mAttributes.begin();
+       it != mAttributes.end(); ++it)
+  {
+    if (it->size() == length &&
+        it->compare(0, prefix.size(), prefix) == 0 &&
+        (*it)[prefix.size()] == ':' &&
+        it->compare(prefix.size() + 1, name.size(), name) == 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 std::string ExpectedAttributes::get(unsigned int i) const
 {
   return (mAttributes.size() < i) ? mAttributes[i] : std::string();
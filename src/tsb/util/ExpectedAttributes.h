@@ -34,6 +34,9 @@ public:
 
   bool hasAttribute(const std::string& attribute) const;
 
+  /* same as hasAttribute(prefix + ":" + name) without building the string */
+  bool hasAttribute(const std::string& prefix, const std::string& name) const;
+
 private:
   std::vector<std::string> mAttributes;
 };
@@ -0,0 +1,181 @@
+/**
+ * @file XMLTokenBuffer.cpp
+ * @brief Implementation of the XMLTokenBuffer class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ */
+
+
+#include <tsb/common/tsbfwd.h>
+#include <tsb/common/common.h>
+#include <tsb/util/XMLTokenBuffer.h>
+
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+#ifdef __cplusplus
+
+/*
+ * The tokens are consumed following the same rules as the XMLNode
+ * constructor that reads from a stream, so that createXMLNode() gives the
+ * same tree that reading the element eagerly would have.  Only the end
+ * tags of nested elements are kept; the closing tag of the buffered
+ * element itself is implied.
+ */
+XMLTokenBuffer::XMLTokenBuffer(XMLInputStream& stream)
+{
+  mTokens.push_back(stream.next());
+
+  if (!mTokens[0].isStart() || mTokens[0].isEnd())
+  {
+    return;
+  }
+
+  unsigned int depth = 0;
+
+  while (stream.isGood())
+  {
+    const XMLToken& next = stream.peek();
+
+    if (next.isEOF())
+    {
+      break;
+    }
+    else if (next.isEnd() && !next.isStart())
+    {
+      if (depth == 0)
+      {
+        bool done = next.isEndFor(mTokens[0]);
+        stream.next();
+        if (done) break;
+        continue;
+      }
+
+      --depth;
+      mTokens.push_back(stream.next());
+    }
+    else if (next.isStart() || next.isText())
+    {
+      if (next.isStart() && !next.isEnd())
+      {
+        ++depth;
+      }
+      mTokens.push_back(stream.next());
+    }
+    else
+    {
+      stream.next();
+    }
+  }
+}
+
+
+const XMLToken&
+XMLTokenBuffer::getElement() const
+{
+  return mTokens[0];
+}
+
+
+unsigned int
+XMLTokenBuffer::getNumTokens() const
+{
+  return (unsigned int)(mTokens.size());
+}
+
+
+XMLNode*
+XMLTokenBuffer::createXMLNode() const
+{
+  return build(false);
+}
+
+
+XMLNode*
+XMLTokenBuffer::createOutline() const
+{
+  return build(true);
+}
+
+
+/*
+ * Builds the tree top-down, keeping the chain of currently open elements
+ * on a stack, so that each token is copied once rather than once per
+ * level of nesting.
+ */
+XMLNode*
+XMLTokenBuffer::build(bool outlineOnly) const
+{
+  XMLNode* root = new XMLNode(mTokens[0]);
+
+  std::vector<XMLNode*> open;
+  open.push_back(root);
+
+  unsigned int depth = 0;
+
+  for (size_t i = 1; i < mTokens.size(); ++i)
+  {
+    const XMLToken& token = mTokens[i];
+    bool opens = token.isStart() && !token.isEnd();
+
+    if (token.isEnd() && !token.isStart())
+    {
+      --depth;
+      if (!outlineOnly || depth == 0)
+      {
+        open.pop_back();
+      }
+      continue;
+    }
+
+    if (!outlineOnly || depth == 0)
+    {
+      XMLNode* parent = open.back();
+      parent->addChild(XMLNode(token));
+
+      if (opens)
+      {
+        open.push_back(&parent->getChild(parent->getNumChildren() - 1));
+      }
+    }
+
+    if (opens)
+    {
+      ++depth;
+    }
+  }
+
+  return root;
+}
+
+
+#endif /* __cplusplus */
+LIBTSB_CPP_NAMESPACE_END
@@ -0,0 +1,109 @@
+/**
+ * @file XMLTokenBuffer.h
+ * @brief Definition of the XMLTokenBuffer class.
+ *
+ * <!--------------------------------------------------------------------------
+ * This file is part of libSBML. Please visit http://sbml.org for more
+ * information about SBML, and the latest version of libSBML.
+ *
+ * Copyright (C) 2019 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2013-2018 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ * 3. University of Heidelberg, Heidelberg, Germany
+ *
+ * Copyright (C) 2009-2013 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. EMBL European Bioinformatics Institute (EMBL-EBI), Hinxton, UK
+ *
+ * Copyright (C) 2006-2008 by the California Institute of Technology,
+ * Pasadena, CA, USA
+ *
+ * Copyright (C) 2002-2005 jointly by the following organizations:
+ * 1. California Institute of Technology, Pasadena, CA, USA
+ * 2. Japan Science and Technology Agency, Japan
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation. A copy of the license agreement is provided in the
+ * file named "LICENSE.txt" included with this software distribution and also
+ * available online as http://sbml.org/software/libsbml/license.html
+ * ------------------------------------------------------------------------ -->
+ *
+ * @class XMLTokenBuffer
+ * @sbmlbrief{} The tokens of an XML element, from which its XMLNode tree
+ * is built on demand.
+ *
+ * A TSBReader with lazy parsing on keeps the notes and testAnnotation
+ * elements it reads in XMLTokenBuffer objects, so that their trees are
+ * only built for the elements that are looked at.
+ */
+
+#ifndef XML_TOKEN_BUFFER_H
+#define XML_TOKEN_BUFFER_H
+
+#include <tsb/common/extern.h>
+
+
+#ifdef __cplusplus
+
+#include <vector>
+
+#include <xml/XMLToken.h>
+#include <xml/XMLNode.h>
+#include <xml/XMLInputStream.h>
+
+LIBTSB_CPP_NAMESPACE_BEGIN
+/** @cond doxygenLibtsbInternal */
+#ifndef SWIG
+class LIBTSB_EXTERN XMLTokenBuffer
+{
+public:
+
+  /*
+   * Consumes the element at the front of @p stream, up to and including
+   * its matching end tag, and keeps its tokens as a flat list.
+   */
+  XMLTokenBuffer(XMLInputStream& stream);
+
+  /*
+   * Returns the start token of the buffered element.
+   */
+  const XMLToken& getElement() const;
+
+  unsigned int getNumTokens() const;
+
+  /*
+   * Builds the full XMLNode tree for the buffered element.  The caller
+   * owns the returned node.
+   */
+  XMLNode* createXMLNode() const;
+
+  /*
+   * Builds an XMLNode holding the buffered element and its top-level
+   * children only, without their content.  This is enough for checks
+   * that look at the direct children of an element.  The caller owns the
+   * returned node.
+   */
+  XMLNode* createOutline() const;
+
+private:
+
+  XMLNode* build(bool outlineOnly) const;
+
+  std::vector<XMLToken> mTokens;
+};
+
+
+#endif //SWIG
+/** @endcond */
+
+
+LIBTSB_CPP_NAMESPACE_END
+
+#endif  /* __cplusplus */
+
+#endif  /* XML_TOKEN_BUFFER_H */
@@ -7,6 +7,7 @@
 
 #include <tsb/common/common.h>
 #include <tsb/util/memory.h>
+#include <tsb/TSBAllocationTrace.h>
 
 #include <tsb/common/extern.h>
 
@@ -51,6 +52,10 @@ safe_malloc (size_t size)
     exit(-1);
 #endif
   }
+  else
+  {
+    TSBAllocationTrace_recordAllocation(TSB_ALLOCATION_MEMORY, size);
+  }
 
   return p;
 }
@@ -75,6 +80,10 @@ safe_calloc (size_t nmemb, size_t size)
     exit(-1);
 #endif
   }
+  else
+  {
+    TSBAllocationTrace_recordAllocation(TSB_ALLOCATION_MEMORY, nmemb * size);
+  }
 
   return p;
 }
@@ -99,6 +108,12 @@ safe_realloc (void *ptr, size_t size)
     exit(-1);
 #endif
   }
+  else if (ptr == NULL)
+  {
+    /* the size of a block being resized is not known, so only new blocks
+     * are counted */
+    TSBAllocationTrace_recordAllocation(TSB_ALLOCATION_MEMORY, size);
+  }
 
   return p;
 }
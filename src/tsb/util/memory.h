@@ -52,6 +52,15 @@ safe_realloc (void *ptr, size_t size);
 #ifdef TRACE_MEMORY
 
 
+/*
+ * The MemTrace functions keep every allocation in global lists without
+ * locking, so they may only be used by single-threaded programs.  They are
+ * superseded by TSBAllocationTrace, which counts the blocks allocated by
+ * safe_malloc(), safe_calloc() and safe_realloc() as TSB_ALLOCATION_MEMORY
+ * in every build and can be turned on at run time.
+ */
+
+
 /**
  * Initializes the memory tracing facility.  Multiple calls are gracefully
  * ignored.